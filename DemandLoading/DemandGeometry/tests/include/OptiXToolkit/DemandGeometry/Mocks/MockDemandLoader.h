@@ -41,14 +41,26 @@ class MockDemandLoader : public demandLoading::DemandLoader
                    unsigned int                                   vdim,
                    int                                            baseTextureId,
                    unsigned int                                   numChannelTextures ) );
+    MOCK_METHOD( std::vector<unsigned int>,
+                 createTextures,
+                 ( const std::vector<std::shared_ptr<imageSource::ImageSource>>& images,
+                   const std::vector<demandLoading::TextureDescriptor>&          textureDescs,
+                   bool                                                          openImages ) );
+    MOCK_METHOD( void, destroyTexture, ( unsigned int textureId ) );
     MOCK_METHOD( unsigned int, createResource, ( unsigned int numPages, demandLoading::ResourceCallback callback, void* callbackContext ) );
     MOCK_METHOD( void, invalidatePage, ( unsigned int pageId ) );
     MOCK_METHOD( void, loadTextureTiles, ( CUstream stream, unsigned int textureId, bool reloadIfResident ) );
     MOCK_METHOD( void, unloadTextureTiles, ( unsigned int textureId ) );
+    MOCK_METHOD( void, pinTexture, ( unsigned int textureId, unsigned int minLevel ) );
+    MOCK_METHOD( void, unpinTexture, ( unsigned int textureId ) );
+    MOCK_METHOD( unsigned int, createResidencyGroup, ( size_t maxTexMem, bool hardQuota ) );
+    MOCK_METHOD( void, setResidencyGroup, ( unsigned int textureId, unsigned int groupId ) );
+    MOCK_METHOD( void, addTextureGroup, ( const std::vector<unsigned int>& textureIds ) );
     MOCK_METHOD( void, setPageTableEntry, ( unsigned int pageId, bool evictable, unsigned long long pageTableEntry ) );
     MOCK_METHOD( void,
                  replaceTexture,
                  ( CUstream stream, unsigned int textureId, std::shared_ptr<imageSource::ImageSource> image, const demandLoading::TextureDescriptor& textureDesc, bool migrateTiles ) );
+    MOCK_METHOD( void, reloadTexture, ( CUstream stream, unsigned int textureId, std::shared_ptr<imageSource::ImageSource> image ) );
     MOCK_METHOD( bool, launchPrepare, ( unsigned int deviceIndex, CUstream stream, demandLoading::DeviceContext& context ) );
     MOCK_METHOD( demandLoading::Ticket,
                  processRequests,
@@ -66,6 +78,8 @@ class MockDemandLoader : public demandLoading::DemandLoader
     MOCK_METHOD( unsigned int, getMipTailFirstLevel, (unsigned int), ( override ) );
     MOCK_METHOD( void, loadTextureTile, (CUstream, unsigned int, unsigned int, unsigned int, unsigned int), ( override ) );
     MOCK_METHOD( bool, pageResident, (unsigned int), ( override ) );
+    MOCK_METHOD( demandLoading::TextureResidency, getResidency, (unsigned int), ( override ) );
+    MOCK_METHOD( std::vector<demandLoading::TextureResidency>, getResidency, (const std::vector<unsigned int>&), ( override ) );
     MOCK_METHOD( bool, launchPrepare, (CUstream, demandLoading::DeviceContext&), ( override ) );
     MOCK_METHOD( demandLoading::Ticket, processRequests, (CUstream, const demandLoading::DeviceContext&), ( override ) );
     MOCK_METHOD( CUcontext, getCudaContext, (), ( override ) );
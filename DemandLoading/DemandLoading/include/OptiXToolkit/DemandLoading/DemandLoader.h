@@ -38,6 +38,7 @@
 #include <OptiXToolkit/DemandLoading/SparseTextureDevices.h>
 #include <OptiXToolkit/DemandLoading/Statistics.h>
 #include <OptiXToolkit/DemandLoading/TextureDescriptor.h>
+#include <OptiXToolkit/DemandLoading/TextureResidency.h>
 #include <OptiXToolkit/DemandLoading/Ticket.h>
 
 #include <cuda.h>
@@ -64,9 +65,18 @@ class DemandLoader
     virtual const DemandTexture& createTexture( std::shared_ptr<imageSource::ImageSource> image,
                                                 const TextureDescriptor&                  textureDesc ) = 0;
 
+    /// Create demand-loaded textures for the given images and descriptors, which must be the same
+    /// length.  Equivalent to calling createTexture for each image, but much faster for large
+    /// batches.  If openImages is true, the images are opened in parallel before returning, so that
+    /// their TextureInfo is available before the first launch.  Returns the texture ids.
+    virtual std::vector<unsigned int> createTextures( const std::vector<std::shared_ptr<imageSource::ImageSource>>& images,
+                                                      const std::vector<TextureDescriptor>& textureDescs,
+                                                      bool                                  openImages = false ) = 0;
+
     /// Create a demand-loaded UDIM texture for a given set of images.  If a baseTexture is used,
     /// it should be created first by calling createTexture.  The id of the returned texture should be used
     /// when calling tex2DGradUdim.  All of the image readers are retained for the lifetime of the DemandLoader.
+    /// Null entries in imageSources are empty slots of the udim grid, which do not consume texture ids.
     virtual const DemandTexture& createUdimTexture( std::vector<std::shared_ptr<imageSource::ImageSource>>& imageSources,
                                                     std::vector<TextureDescriptor>&                         textureDescs,
                                                     unsigned int                                            udim,
@@ -74,6 +84,15 @@ class DemandLoader
                                                     int                                                     baseTextureId,
                                                     unsigned int                                            numChannelTextures = 1 ) = 0;
 
+    /// Destroy a texture, releasing its tiles, sampler, texture arrays, and page table entries.
+    /// Its page table entries are invalidated when launchPrepare is called next.  Its resources are
+    /// reclaimed by a later launchPrepare, once the launches issued before that invalidation are
+    /// done, after which the texture id may be returned by createTexture again.  The texture must
+    /// not be referenced by kernels launched later, and a texture with variants cannot be destroyed
+    /// until its variants have been destroyed.  Destroying a udim texture (given the id returned by createUdimTexture)
+    /// destroys its subtextures.
+    virtual void destroyTexture( unsigned int textureId ) = 0;
+
     /// Create an arbitrary resource with the specified number of pages.  \see ResourceCallback.
     /// Returns the starting index of the resource in the page table.  The user-supplied callbackContext
     /// value is forwarded to the callback during request processing.
@@ -88,6 +107,34 @@ class DemandLoader
     /// Schedule a list of textures to be unloaded when launchPrepare is called next.
     virtual void unloadTextureTiles( unsigned int textureId ) = 0;
 
+    /// Pin the tiles of a texture in mip levels minLevel and coarser (including the mip tail), so that
+    /// they are never evicted.  Tiles that are already resident are pinned immediately, and the rest are
+    /// pinned as they are loaded.  Pinned tiles count against Options::maxPinnedTexMemPerDevice; tiles
+    /// that do not fit in the pinned budget remain evictable.
+    virtual void pinTexture( unsigned int textureId, unsigned int minLevel ) = 0;
+
+    /// Unpin the tiles of a texture, making them evictable again.
+    virtual void unpinTexture( unsigned int textureId ) = 0;
+
+    /// Create a residency group with a quota of maxTexMem bytes of resident texture tiles, and return
+    /// its id.  When tiles are evicted, tiles from groups that are over their quota are evicted first.
+    /// A hard quota is enforced: tiles in the group are evicted even when eviction is not active, and
+    /// requests for the group's tiles are deferred while the group is at its quota, until stale tiles
+    /// of the group are evicted.  The deferred requests are counted in Statistics::numQuotaDeferredRequests.
+    /// Textures belong to group 0, which has no quota, until setResidencyGroup is called.
+    virtual unsigned int createResidencyGroup( size_t maxTexMem, bool hardQuota ) = 0;
+
+    /// Assign a texture to a residency group.  Tiles that are already resident move to the new group.
+    virtual void setResidencyGroup( unsigned int textureId, unsigned int groupId ) = 0;
+
+    /// Declare a group of textures that share a texture coordinate layout, such as the maps of a
+    /// material.  When a tile of one member is requested, the tiles covering the same region of the
+    /// other members (or their samplers, until they are initialized) are requested speculatively.
+    /// Speculative requests are filled only when no other requests are queued, and are not tracked by
+    /// the ticket returned by processRequests.  A texture belongs to at most one group, so the textures
+    /// are removed from any earlier group.  Variants are grouped via their master textures.
+    virtual void addTextureGroup( const std::vector<unsigned int>& textureIds ) = 0;
+
     /// Set the value of a page table entry (does not take effect until launchPrepare is called).
     /// It's usually not necessary to call this.  It is helpful for asynchronous resource request
     /// handling, in which a ResourceCallback enqueues a request and returns false, indicating that
@@ -102,6 +149,12 @@ class DemandLoader
                                  const TextureDescriptor&                  textureDesc,
                                  bool                                      migrateTiles ) = 0;
 
+    /// Reload the indicated texture from a new version of its image, such as an edited file.  When
+    /// Options::useIncrementalReload is set and the new image has the same dimensions and format, only
+    /// the resident tiles whose contents changed are invalidated (and refetched when next requested).
+    /// Otherwise the texture is replaced as by replaceTexture, unloading all of its tiles.
+    virtual void reloadTexture( CUstream stream, unsigned int textureId, std::shared_ptr<imageSource::ImageSource> image ) = 0;
+
     /// Pre-initialize the texture on the device corresponding to the given stream.  The caller must
     /// ensure that the current CUDA context matches the given stream.
     virtual void initTexture( CUstream stream, unsigned int textureId ) = 0;
@@ -123,6 +176,14 @@ class DemandLoader
     /// CUDA context.
     virtual bool pageResident( unsigned int pageId ) = 0;
 
+    /// Get a snapshot of the resident tiles of a texture, per mip level, from the host page table of
+    /// the device corresponding to the current CUDA context.  Nothing is read from the device.  A
+    /// destroyed texture has no resident pages.
+    virtual TextureResidency getResidency( unsigned int textureId ) = 0;
+
+    /// Get the residency of each of the given textures (see above), under a single lock.
+    virtual std::vector<TextureResidency> getResidency( const std::vector<unsigned int>& textureIds ) = 0;
+
     /// Prepare for launch.  The caller must ensure that the current CUDA context matches the given
     /// stream.  The stream and its context are retained until the DemandLoader is destroyed.
     /// Returns false if the corresponding device does not support sparse textures.  If
@@ -152,7 +213,8 @@ class DemandLoader
     /// Turn on or off eviction
     virtual void enableEviction( bool evictionActive ) = 0;
 
-    /// Set the max memory per device to be used for texture tiles, deleting memory arenas if needed
+    /// Set the max memory per device to be used for texture tiles and texture atlas pages, deleting
+    /// tile memory arenas if needed
     virtual void setMaxTextureMemory( size_t maxMem ) = 0;
 
     /// Get the CUDA context associated with this demand loader
@@ -61,6 +61,11 @@ class DemandPageLoader
     /// Allocate a contiguous range of page ids.  Returns the first page id in the the allocated range.
     virtual unsigned int allocatePages( unsigned int numPages, bool backed ) = 0;
 
+    /// Release the range of page ids allocated by allocatePages() that starts at the given page.
+    /// Its page table entries are invalidated by the next call to pushMappings(), after which the
+    /// page ids can be returned by allocatePages() again.
+    virtual void releasePages( unsigned int startPage ) = 0;
+
     /// Set the page table entry for the given page.  Sets the associated page as resident.
     virtual void setPageTableEntry( unsigned int pageId, bool evictable, unsigned long long pageTableEntry ) = 0;
 
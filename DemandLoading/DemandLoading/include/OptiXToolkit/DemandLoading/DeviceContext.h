@@ -58,7 +58,7 @@ struct PageMapping
 struct DeviceContext
 {
     DeviceArray<unsigned long long> pageTable;
-    unsigned int                    maxNumPages;  // the actual capacity of the page table is smaller
+    unsigned int                    maxNumPages;  // capacity of the bit vectors and LRU table; the page table is smaller
     unsigned int                    maxTextures;
     unsigned int*                   referenceBits;
     unsigned int*                   residenceBits;
@@ -43,21 +43,29 @@ struct Options
 {
     // Page table size
     unsigned int numPages            = 64 * 1024 * 1024;  ///< total virtual pages (4 TB of 64k texture tiles)
-    unsigned int numPageTableEntries = 1024 * 1024;  ///< num page table entries, used for texture samplers and base colors.
+    unsigned int numPageTableEntries = 1024 * 1024;  ///< num page table entries, used for texture samplers and base colors (two per texture, raised to cover maxTextures) and backed resources.
 
     // Demand loading
     unsigned int maxRequestedPages = 8192;  ///< max requests to pull from device in processRequests
     unsigned int maxFilledPages    = 8192;  ///< num slots to push mappings back to device in processRequests
 
     // Demand load textures
-    unsigned int maxTextures         = 256 * 1024;  ///< The maximum demand load textures that can be defined
+    unsigned int maxTextures         = 256 * 1024;  ///< The maximum demand load textures that can be defined (a million or more is supported)
     bool useSparseTextures           = true;   ///< whether to use sparse or dense textures
     bool useSmallTextureOptimization = false;  ///< whether to use dense textures for very small textures
     bool useCascadingTextureSizes    = false;  ///< whether to use cascading texture sizes
+    bool useTextureAtlas             = false;  ///< whether to pack small dense textures into shared atlas arrays
+    bool useTileDeduplication        = false;  ///< whether texture tiles with identical contents share device memory
+    bool useConstantTiles            = false;  ///< whether uniform texture tiles with the same value share device memory
+    bool useIncrementalReload        = false;  ///< whether to hash filled tiles, so reloadTexture() refetches only changed tiles
+    std::string encodedTileCacheDir;           ///< existing directory caching data block compressed on the host (disabled if empty)
+    bool computeMissingBaseColors    = false;  ///< whether to compute base colors of images without a 1x1 mip level in the background
+    unsigned int maxRecycledSparseArrays = 64;  ///< max released sparse arrays kept for reuse by textures of the same size and format (0 disables recycling)
 
     // Memory limits
     size_t maxTexMemPerDevice = 0;  ///< texture to allocate per device (in MB) before starting eviction (0 is unlimited)
     size_t maxPinnedMemory = 64 * 1024 * 1024;  ///< max pinned memory to use for data transfer between host and device
+    size_t maxPinnedTexMemPerDevice = 0;  ///< texture memory per device that pinned textures may hold (0 is unlimited)
 
     // Eviction
     unsigned int maxStalePages       = 8192;  ///< max stale (resident but not used) pages to pull from device in processRequests
@@ -67,6 +75,7 @@ struct Options
     unsigned int maxRequestQueueSize = 8192;  ///< max size for host-side request queue (filled over multiple processRequests cycles)
     bool useLruTable                 = true;  ///< Whether to use LRU table, or randomized eviction
     bool evictionActive              = true;  ///< whether eviction is active. (turning it off speeds up texture ops)
+    unsigned int maxUnreferencedLaunches = 0; ///< evict whole textures not referenced in this many launches (0 is disabled)
 
     // Concurrency
     unsigned int maxThreads = 0;  ///< max threads for processing requests. (0 means std::thread::hardware_concurrency)
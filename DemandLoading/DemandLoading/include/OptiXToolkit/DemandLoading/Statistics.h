@@ -45,7 +45,11 @@ struct Statistics
     // Per-device stats
     size_t deviceMemoryUsed;
     size_t bytesTransferredToDevice;
+    size_t numCopiesToDevice;
     unsigned int numEvictions;
+    unsigned int numTextureEvictions;
+    size_t numDeduplicatedTiles;
+    size_t numQuotaDeferredRequests;  // Requests deferred because their residency group was at its hard quota
 };
 
 }  // namespace demandLoading
@@ -278,6 +278,49 @@ D_INLINE bool requestTexFootprint2DLod( const TextureSampler& sampler,
 #endif  // ndef DOXYGEN_SKIP
 
 
+/// Get the coarsest mip level of an atlas texture that does not blend with its neighbors in the atlas.
+D_INLINE float getAtlasMaxLod( const TextureSampler& sampler )
+{
+    const float minDim = static_cast<float>( min( sampler.width, sampler.height ) );
+    return fminf( static_cast<float>( sampler.desc.numMipLevels - 1 ), floorf( log2f( minDim ) ) );
+}
+
+/// Map a texture coordinate of an atlas texture to the atlas.  The atlas texture object clamps, so
+/// the wrap mode is applied here, and the coordinate is kept half a texel of the coarsest sampled
+/// mip level (the given lod, rounded up) off the texture's edges so that filtering does not pick up
+/// its neighbors at any level.
+D_INLINE void remapAtlasCoord( const TextureSampler& sampler, float& x, float& y, float lod )
+{
+    if( sampler.desc.wrapMode0 == CU_TR_ADDRESS_MODE_MIRROR )
+        x = 1.0f - fabsf( 1.0f - ( x - 2.0f * floorf( x * 0.5f ) ) );
+    if( sampler.desc.wrapMode1 == CU_TR_ADDRESS_MODE_MIRROR )
+        y = 1.0f - fabsf( 1.0f - ( y - 2.0f * floorf( y * 0.5f ) ) );
+
+    const float halfTexelSize = 0.5f * exp2f( ceilf( fmaxf( lod, 0.0f ) ) );
+    const float halfTexelX    = fminf( halfTexelSize / sampler.width, 0.5f );
+    const float halfTexelY    = fminf( halfTexelSize / sampler.height, 0.5f );
+    x = clampf( wrapTexCoord( x, static_cast<CUaddress_mode>( sampler.desc.wrapMode0 ) ), halfTexelX, 1.0f - halfTexelX );
+    y = clampf( wrapTexCoord( y, static_cast<CUaddress_mode>( sampler.desc.wrapMode1 ) ), halfTexelY, 1.0f - halfTexelY );
+
+    x = sampler.atlasOffset.x + x * sampler.atlasScale.x;
+    y = sampler.atlasOffset.y + y * sampler.atlasScale.y;
+}
+
+/// Map the texture gradients of an atlas texture to the atlas, limiting the footprint to the
+/// texture's own mip levels.  Returns the (conservative) lod of the footprint, for remapAtlasCoord.
+D_INLINE float remapAtlasGrad( const TextureSampler& sampler, float2& ddx, float2& ddy )
+{
+    const float pixelSpanX = fmaxf( fabsf( ddx.x ), fabsf( ddy.x ) ) * sampler.width;
+    const float pixelSpanY = fmaxf( fabsf( ddx.y ), fabsf( ddy.y ) ) * sampler.height;
+    const float pixelSpan  = fmaxf( pixelSpanX, pixelSpanY );
+    const float maxSpan    = exp2f( getAtlasMaxLod( sampler ) );
+    const float scale      = ( pixelSpan > maxSpan ) ? maxSpan / pixelSpan : 1.0f;
+
+    ddx = make_float2( ddx.x * scale * sampler.atlasScale.x, ddx.y * scale * sampler.atlasScale.y );
+    ddy = make_float2( ddy.x * scale * sampler.atlasScale.x, ddy.y * scale * sampler.atlasScale.y );
+    return log2f( fmaxf( fminf( pixelSpan, maxSpan ), 1.0f ) );
+}
+
 /// Fetch the base color of a texture stored in the demand loader page table as a half4
 template <class Sample> 
 D_INLINE bool 
@@ -347,6 +390,13 @@ tex2DGrad( const DeviceContext& context, unsigned int textureId, float x, float
     x = x + (texelJitter.x / sampler->width);
     y = y + (texelJitter.y / sampler->height);
 
+    // Small textures packed in an atlas are addressed within their region of the atlas.
+    if( sampler->isAtlasTexture )
+    {
+        const float atlasLod = remapAtlasGrad( *sampler, ddx, ddy );
+        remapAtlasCoord( *sampler, x, y, atlasLod );
+    }
+
 #ifdef SPARSE_TEX_SUPPORT
     // If requestIfResident is false, use the predicated texture fetch to try and avoid requesting the footprint
     *isResident = !sampler->desc.isSparseTexture;
@@ -417,6 +467,13 @@ tex2DLod( const DeviceContext& context, unsigned int textureId, float x, float y
     x = x + (texelJitter.x / sampler->width);
     y = y + (texelJitter.y / sampler->height);
 
+    // Small textures packed in an atlas are addressed within their region of the atlas.
+    if( sampler->isAtlasTexture )
+    {
+        lod = fminf( lod, getAtlasMaxLod( *sampler ) );
+        remapAtlasCoord( *sampler, x, y, lod );
+    }
+
 #ifdef SPARSE_TEX_SUPPORT
     // If requestIfResident is false, use the predicated texture fetch to try and avoid requesting the footprint
     *isResident = false;
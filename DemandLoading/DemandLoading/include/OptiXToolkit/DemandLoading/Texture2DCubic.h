@@ -220,23 +220,34 @@ textureCubic( const DeviceContext& context, unsigned int textureId, float s, flo
     // Linear Sampling
     if( cubicBlend < 1.0f )
     {
+        // Atlas textures are only point or bilinear filtered, so they only take this path.
+        float  ls = s;
+        float  lt = t;
+        float2 lddx = ddx;
+        float2 lddy = ddy;
+        if( sampler->isAtlasTexture )
+        {
+            const float atlasLod = remapAtlasGrad( *sampler, lddx, lddy );
+            remapAtlasCoord( *sampler, ls, lt, atlasLod );
+        }
+
         // Don't do bilinear sample for result unless cubicBlend is 0.
         if( cubicBlend <= 0.0f && result )
         {
-            *result = ::tex2DGrad<TYPE>( sampler->texture, s, t, ddx, ddy );
+            *result = ::tex2DGrad<TYPE>( sampler->texture, ls, lt, lddx, lddy );
         }
 
         // Do a central difference along ddx, ddy
         if( dresultds )
         {
-            TYPE t1 = ::tex2DGrad<TYPE>( sampler->texture, s + ddx.x, t + ddx.y, ddx, ddy );
-            TYPE t2 = ::tex2DGrad<TYPE>( sampler->texture, s - ddx.x, t - ddx.y, ddx, ddy );
+            TYPE t1 = ::tex2DGrad<TYPE>( sampler->texture, ls + lddx.x, lt + lddx.y, lddx, lddy );
+            TYPE t2 = ::tex2DGrad<TYPE>( sampler->texture, ls - lddx.x, lt - lddx.y, lddx, lddy );
             *dresultds = ( t1 - t2 ) / ( 2.0f * length( ddx ) );
         }
         if( dresultdt )
         {
-            TYPE t1 = ::tex2DGrad<TYPE>( sampler->texture, s + ddy.x, t + ddy.y, ddx, ddy );
-            TYPE t2 = ::tex2DGrad<TYPE>( sampler->texture, s - ddy.x, t - ddy.y, ddx, ddy );
+            TYPE t1 = ::tex2DGrad<TYPE>( sampler->texture, ls + lddy.x, lt + lddy.y, lddx, lddy );
+            TYPE t2 = ::tex2DGrad<TYPE>( sampler->texture, ls - lddy.x, lt - lddy.y, lddx, lddy );
             *dresultdt = ( t1 - t2 ) / ( 2.0f * length( ddy ) );
         }
 
@@ -330,7 +341,14 @@ textureUdim( const DeviceContext& context, unsigned int textureId, float s, floa
             wrapAndSeparateUdimCoord( s, CU_TR_ADDRESS_MODE_WRAP, bsmp->udim, subs, sidx );
             wrapAndSeparateUdimCoord( t, CU_TR_ADDRESS_MODE_WRAP, bsmp->vdim, subt, tidx );
 
-            textureId = bsmp->udimStartPage + ( tidx * bsmp->udim + sidx ) * bsmp->numChannelTextures;
+            textureId = getUdimSubTextureId( bsmp, sidx, tidx );
+            if( textureId == UDIM_EMPTY_SLOT )
+            {
+                if( result ) *result = TYPE{};
+                if( dresultds ) *dresultds = TYPE{};
+                if( dresultdt ) *dresultdt = TYPE{};
+                return false;
+            }
             s = subs;
             t = subt;
             ddx = float2{ ddx.x * bsmp->udim, ddx.y * bsmp->vdim };
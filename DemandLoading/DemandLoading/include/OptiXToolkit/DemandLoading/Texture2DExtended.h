@@ -43,6 +43,44 @@ D_INLINE void wrapAndSeparateUdimCoord( float x, CUaddress_mode wrapMode, unsign
     newx -= floorf( newx );
 }
 
+/// Subtexture id returned by getUdimSubTextureId for an empty slot in a sparse udim grid.
+const unsigned int UDIM_EMPTY_SLOT = 0xFFFFFFFF;
+
+/// Get the id of the subtexture at grid position (xidx, yidx) of a udim texture, or UDIM_EMPTY_SLOT if the slot is empty.
+/// Sparse grids are looked up by binary search in the sorted slot index, so only populated slots consume texture ids.
+D_INLINE unsigned int getUdimSubTextureId( const TextureSampler* bsmp, unsigned int xidx, unsigned int yidx )
+{
+    const unsigned int slot = yidx * bsmp->udim + xidx;
+    if( bsmp->udimSlots == nullptr )
+        return bsmp->udimStartPage + slot * bsmp->numChannelTextures;
+
+    unsigned int lo = 0;
+    unsigned int hi = bsmp->numUdimSlots;
+    while( lo < hi )
+    {
+        const unsigned int mid = ( lo + hi ) >> 1;
+        if( bsmp->udimSlots[mid] < slot )
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    if( lo == bsmp->numUdimSlots || bsmp->udimSlots[lo] != slot )
+        return UDIM_EMPTY_SLOT;
+    return bsmp->udimStartPage + lo * bsmp->numChannelTextures;
+}
+
+/// Fetch from a udim subtexture.  An empty slot is not resident, and is not requested.
+template <class TYPE> D_INLINE TYPE
+tex2DGradUdimSubTexture( const DeviceContext& context, unsigned int subTexId, float x, float y, float2 ddx, float2 ddy, bool* isResident, float2 texelJitter )
+{
+    if( subTexId == UDIM_EMPTY_SLOT )
+    {
+        *isResident = false;
+        return TYPE{};
+    }
+    return tex2DGrad<TYPE>( context, subTexId, x, y, ddx, ddy, isResident, texelJitter );
+}
+
 
 /// Fetch from demand-loaded udim texture.  A "udim" texture is an array of texture images that are treated as a single texture
 /// object (with an optional base texture).  This entry point does not combine multiple samples to blend across subtexture boundaries.
@@ -71,10 +109,10 @@ tex2DGradUdim( const DeviceContext& context, unsigned int textureId, float x, fl
         wrapAndSeparateUdimCoord( x, CU_TR_ADDRESS_MODE_WRAP, bsmp->udim, sx, xidx );
         wrapAndSeparateUdimCoord( y, CU_TR_ADDRESS_MODE_WRAP, bsmp->vdim, sy, yidx );
 
-        unsigned int subTexId = bsmp->udimStartPage + ( yidx * bsmp->udim + xidx ) * bsmp->numChannelTextures;
+        unsigned int subTexId = getUdimSubTextureId( bsmp, xidx, yidx );
         const float2 ddx_dim = make_float2( ddx.x * bsmp->udim, ddx.y * bsmp->vdim );
         const float2 ddy_dim = make_float2( ddy.x * bsmp->udim, ddy.y * bsmp->vdim );
-        rval = tex2DGrad<TYPE>( context, subTexId, sx, sy, ddx_dim, ddy_dim, isResident, texelJitter );
+        rval = tex2DGradUdimSubTexture<TYPE>( context, subTexId, sx, sy, ddx_dim, ddy_dim, isResident, texelJitter );
 
         if( *isResident || !bsmp->desc.isUdimBaseTexture )
             return rval;
@@ -166,10 +204,10 @@ tex2DGradUdimBlend( const DeviceContext& context, unsigned int textureId, float
 
         // Try to sample up to 4 subtextures
         bool subTexResident;
-        unsigned int subTexId = bsmp->udimStartPage + ( yidx0 * udim + xidx0 ) * bsmp->numChannelTextures;
+        unsigned int subTexId = getUdimSubTextureId( bsmp, xidx0, yidx0 );
         float xoff = ( xidx != xidx0 ) ? 1.0f : 0.0f;
         float yoff = ( yidx != yidx0 ) ? 1.0f : 0.0f;
-        rval = tex2DGrad<TYPE>( context, subTexId, sx + xoff, sy + yoff, ddx_dim, ddy_dim, &subTexResident, texelJitter );
+        rval = tex2DGradUdimSubTexture<TYPE>( context, subTexId, sx + xoff, sy + yoff, ddx_dim, ddy_dim, &subTexResident, texelJitter );
         *isResident = subTexResident;
 
         // Special case for base colors - don't blend with neighbors
@@ -178,26 +216,26 @@ tex2DGradUdimBlend( const DeviceContext& context, unsigned int textureId, float
 
         if( xidx1 != xidx0 )
         {
-            subTexId = bsmp->udimStartPage + ( yidx0 * udim + xidx1 ) * bsmp->numChannelTextures;
+            subTexId = getUdimSubTextureId( bsmp, xidx1, yidx0 );
             xoff = ( xidx != xidx1 ) ? -1.0f : 0.0f;
             yoff = ( yidx != yidx0 ) ? 1.0f : 0.0f;
-            rval += tex2DGrad<TYPE>( context, subTexId, sx + xoff, sy + yoff, ddx_dim, ddy_dim, &subTexResident, texelJitter );
+            rval += tex2DGradUdimSubTexture<TYPE>( context, subTexId, sx + xoff, sy + yoff, ddx_dim, ddy_dim, &subTexResident, texelJitter );
             *isResident = *isResident && subTexResident;
         }
         if( yidx1 != yidx0 )
         {
-            subTexId = bsmp->udimStartPage + ( yidx1 * udim + xidx0 ) * bsmp->numChannelTextures;
+            subTexId = getUdimSubTextureId( bsmp, xidx0, yidx1 );
             xoff = ( xidx != xidx0 ) ? 1.0f : 0.0f;
             yoff = ( yidx != yidx1 ) ? -1.0f : 0.0f;
-            rval += tex2DGrad<TYPE>( context, subTexId, sx + xoff, sy + yoff, ddx_dim, ddy_dim, &subTexResident, texelJitter );
+            rval += tex2DGradUdimSubTexture<TYPE>( context, subTexId, sx + xoff, sy + yoff, ddx_dim, ddy_dim, &subTexResident, texelJitter );
             *isResident = *isResident && subTexResident;
         }
         if( xidx1 != xidx0 && yidx1 != yidx0 )
         {
-            subTexId = bsmp->udimStartPage + ( yidx1 * udim + xidx1 ) * bsmp->numChannelTextures;
+            subTexId = getUdimSubTextureId( bsmp, xidx1, yidx1 );
             xoff = ( xidx != xidx1 ) ? -1.0f : 0.0f;
             yoff = ( yidx != yidx1 ) ? -1.0f : 0.0f;
-            rval += tex2DGrad<TYPE>( context, subTexId, sx + xoff, sy + yoff, ddx_dim, ddy_dim, &subTexResident, texelJitter );
+            rval += tex2DGradUdimSubTexture<TYPE>( context, subTexId, sx + xoff, sy + yoff, ddx_dim, ddy_dim, &subTexResident, texelJitter );
             *isResident = *isResident && subTexResident;
         }
 
@@ -36,6 +36,25 @@ namespace demandLoading {
 
 enum FilterMode { FILTER_POINT=CU_TR_FILTER_MODE_POINT, FILTER_BILINEAR, FILTER_BICUBIC, FILTER_SMARTBICUBIC };
 
+/// Format in which texture data is stored on the device.  Float images can be stored as half or
+/// normalized 8-bit data, and half images as normalized 8-bit data.  Float, half and 8-bit images
+/// can also be block compressed on the host: BC1 (opaque) and BC7 for four channel images, BC4
+/// for one channel and BC5 for two channels.  Other combinations keep the source format.
+enum DeviceFormat
+{
+    DEVICE_FORMAT_SOURCE = 0,
+    DEVICE_FORMAT_HALF,
+    DEVICE_FORMAT_UNORM8,
+    DEVICE_FORMAT_BC1,
+    DEVICE_FORMAT_BC4,
+    DEVICE_FORMAT_BC5,
+    DEVICE_FORMAT_BC7
+};
+
+/// Speed/quality preset for block compression on the host (see DeviceFormat).  High quality
+/// encoding is several times slower than fast encoding.
+enum EncodeQuality { ENCODE_FAST = 0, ENCODE_HIGH_QUALITY };
+
 /// TextureDescriptor specifies the address mode (e.g. wrap vs. clamp), filter mode (point vs. linear), etc.
 struct TextureDescriptor
 {
@@ -53,6 +72,12 @@ struct TextureDescriptor
 
     /// CUDA texture flags.  Use 0 to enable trilinear optimization (off by default).
     unsigned int flags = CU_TRSF_DISABLE_TRILINEAR_OPTIMIZATION;
+
+    /// Device storage format (see DeviceFormat).  Data is converted when tiles are filled.
+    unsigned int deviceFormat = DEVICE_FORMAT_SOURCE;
+
+    /// Block compression preset (see EncodeQuality), used when the device format is BC1, BC4, BC5 or BC7.
+    unsigned int encodeQuality = ENCODE_FAST;
 };
 
 inline CUfilter_mode toCudaFilterMode( unsigned int mode )
@@ -67,7 +92,9 @@ inline bool operator==( const TextureDescriptor& adesc, const TextureDescriptor&
            && adesc.filterMode == bdesc.filterMode              //
            && adesc.mipmapFilterMode == bdesc.mipmapFilterMode  //
            && adesc.maxAnisotropy == bdesc.maxAnisotropy        //
-           && adesc.flags == bdesc.flags;
+           && adesc.flags == bdesc.flags                        //
+           && adesc.deviceFormat == bdesc.deviceFormat          //
+           && adesc.encodeQuality == bdesc.encodeQuality;
 }
 
 inline bool operator!=( const TextureDescriptor& lhs, const TextureDescriptor& rhs )
@@ -0,0 +1,72 @@
+//
+// Copyright (c) 2024, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#pragma once
+
+/// \file TextureResidency.h
+/// Host-side snapshot of the resident tiles of a demand-loaded texture.
+
+#include <vector>
+
+namespace demandLoading {
+
+/// The resident tiles of one mip level of a sparse texture.
+struct MipLevelResidency
+{
+    unsigned int      widthInTiles  = 0;
+    unsigned int      heightInTiles = 0;
+    std::vector<bool> residentTiles;  ///< One bit per tile, in row-major order.
+
+    /// Check whether the specified tile is resident.
+    bool isResident( unsigned int tileX, unsigned int tileY ) const { return residentTiles[tileY * widthInTiles + tileX]; }
+};
+
+/// The residency of a texture, derived from the host page table (see DemandLoader::getResidency).
+/// Pages filled since the last launchPrepare() are included, even though device code can't see them
+/// yet.
+struct TextureResidency
+{
+    bool isSamplerResident   = false;  ///< Whether the sampler is resident.  A dense texture is resident with it.
+    bool isBaseColorResident = false;  ///< Whether the base color is resident.
+    bool isSparseTexture     = false;  ///< Whether the texture is sparse.  Only sparse textures have mipLevels.
+
+    /// The levels from mipTailFirstLevel on are stored in the mip tail, a single page.  They are
+    /// reported as one tile each, which is resident if the mip tail is.  Equal to the number of mip
+    /// levels if there is no mip tail.
+    unsigned int mipTailFirstLevel = 0;
+
+    /// The resident tiles of each mip level.  Empty until the texture has been initialized (by a
+    /// sampler request or initTexture), and for dense textures.  A texture variant shares the tiles
+    /// of its master texture, and reports them once either one has been initialized.
+    std::vector<MipLevelResidency> mipLevels;
+
+    /// The number of resident tile pages, counting the mip tail once.
+    unsigned int numResidentTiles = 0;
+};
+
+}  // namespace demandLoading
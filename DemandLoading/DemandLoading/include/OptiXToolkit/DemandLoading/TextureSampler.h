@@ -88,12 +88,23 @@ struct TextureSampler
     unsigned short udim;
     unsigned short vdim;
 
+    // Sparse udim textures.  Sorted grid slots (v * udim + u) of the populated subtextures, whose ids
+    // start at udimStartPage in slot order.  Null if every slot in the grid is populated.
+    const unsigned int* udimSlots;
+    unsigned int numUdimSlots;
+
     // Cascaded textures
     unsigned int cascadeLevel : 4;
     unsigned int hasCascade   : 1;
     unsigned int filterMode   : 2;
     unsigned int numChannelTextures : 5;
-    unsigned int pad          : 20;
+    unsigned int isAtlasTexture : 1;
+    unsigned int pad          : 19;
+
+    // Atlas textures (see Options::useTextureAtlas).  The texture occupies the region of the atlas
+    // starting at atlasOffset with extent atlasScale, both in normalized atlas coordinates.
+    float2 atlasOffset;
+    float2 atlasScale;
 };
 
 // Indexing related to base colors
@@ -30,10 +30,12 @@
 
 #include "CascadeRequestFilter.h"
 #include "DemandPageLoaderImpl.h"
+#include "TextureGroupRequestFilter.h"
+#include "Textures/SparseMappingBatch.h"
+#include "TicketImpl.h"
 #include "Util/ContextSaver.h"
 #include "Util/NVTXProfiling.h"
 #include "Util/Stopwatch.h"
-#include "TicketImpl.h"
 
 #include <OptiXToolkit/DemandLoading/DeviceContext.h>
 #include <OptiXToolkit/DemandLoading/RequestProcessor.h>
@@ -45,6 +47,8 @@
 #include <cuda.h>
 
 #include <algorithm>
+#include <climits>
+#include <iterator>
 #include <memory>
 #include <set>
 
@@ -70,6 +74,26 @@ class TilePoolReturnPredicate : public PageInvalidatorPredicate
     DeviceMemoryManager* m_deviceMemoryManager;
 };
 
+// Predicate that returns pages (assumed to represent texture samplers) to the sampler pool
+class SamplerPoolReturnPredicate : public PageInvalidatorPredicate
+{
+  public:
+    SamplerPoolReturnPredicate( DeviceMemoryManager* deviceMemoryManager )
+        : m_deviceMemoryManager( deviceMemoryManager )
+    {
+    }
+    bool operator()( unsigned int /*pageId*/, unsigned long long pageVal, CUstream /*stream*/ ) override
+    {
+        // Degenerate textures have a null sampler.
+        if( pageVal != 0 )
+            m_deviceMemoryManager->freeSampler( reinterpret_cast<TextureSampler*>( pageVal ) );
+        return true;
+    }
+    ~SamplerPoolReturnPredicate() override {}
+  private:
+    DeviceMemoryManager* m_deviceMemoryManager;
+};
+
 // Predicate that migrates texture tiles from an old texture to a new larger texture.
 class MigrateTextureTilesPredicate : public PageInvalidatorPredicate
 {
@@ -115,7 +139,7 @@ class MigrateTextureTilesPredicate : public PageInvalidatorPredicate
         unsigned int newPageId = pageId - m_oldSampler.startPage + m_newTexture->getSampler().startPage;
 
         // Call addMappingBody instead of addMapping since mutex already acquired in PagingSystem::invalidatePages
-        m_demandPageLoader->getPagingSystem()->addMappingBody( newPageId, true, pageVal );
+        m_demandPageLoader->getPagingSystem()->addMappingBody( newPageId, true, pageVal, m_newTexture->getResidencyGroup() );
 
         return true;
     }
@@ -129,16 +153,22 @@ class MigrateTextureTilesPredicate : public PageInvalidatorPredicate
 
 namespace {
 
+const size_t UNLIMITED_TEXTURE_MEMORY = 0xfffffffffffffffful;
+
 std::shared_ptr<demandLoading::Options> configure( demandLoading::Options options )
 {
     // If maxTexMemPerDevice is 0, consider it to be unlimited
     if( options.maxTexMemPerDevice == 0 )
-        options.maxTexMemPerDevice = 0xfffffffffffffffful;
+        options.maxTexMemPerDevice = UNLIMITED_TEXTURE_MEMORY;
 
     // PagingSystem::pushMappings requires enough capacity to handle all the requested pages.
     if( options.maxFilledPages < options.maxRequestedPages )
         options.maxFilledPages = options.maxRequestedPages;
 
+    // The sampler and base color pages of every texture are backed by page table entries.
+    if( options.numPageTableEntries < options.maxTextures * NUM_PAGES_PER_TEXTURE )
+        options.numPageTableEntries = options.maxTextures * NUM_PAGES_PER_TEXTURE;
+
     return std::shared_ptr<Options>( new Options( options ) );
 }
 
@@ -148,7 +178,9 @@ DemandLoaderImpl::DemandLoaderImpl( const Options& options )
     : m_options( configure( options ) )
     , m_pageTableManager( std::make_shared<PageTableManager>( m_options->numPages, m_options->numPageTableEntries ) )
     , m_requestProcessor( m_pageTableManager, options )
+    , m_workerPool( options.maxThreads )
     , m_pageLoader( new DemandPageLoaderImpl( m_pageTableManager, &m_requestProcessor, m_options ) )
+    , m_textures( m_options->maxTextures )
     , m_samplerRequestHandler( this )
     , m_cascadeRequestHandler( this )
     , m_deviceTransferPool( new otk::DeviceAsyncAllocator(), new RingSuballocator(), DEFAULT_ALLOC_SIZE, options.maxPinnedMemory )
@@ -156,9 +188,18 @@ DemandLoaderImpl::DemandLoaderImpl( const Options& options )
     // The demand loader is for the current cuda context
     OTK_ERROR_CHECK( cuCtxGetCurrent( &m_cudaContext ) );
 
+    // Released page ranges are not reused while requests that might map their pages are being filled.
+    m_pageLoader->setOutstandingTicketsFunction( [this]() { return m_requestProcessor.getOutstandingTickets(); } );
+
     // Reserve pages in the sampler request handler for all possible textures.
     m_samplerRequestHandler.setPageRange( 0, m_options->numPageTableEntries );
 
+    if( !m_options->encodedTileCacheDir.empty() )
+        m_encodedTileCache.reset( new EncodedTileCache( m_options->encodedTileCacheDir ) );
+
+    if( m_options->maxRecycledSparseArrays > 0 )
+        m_sparseArrayPool = std::make_shared<SparseArrayPool>( &m_sparseArrayDriver, m_options->maxRecycledSparseArrays );
+
     unsigned int samplerStartPage = m_pageTableManager->reserveBackedPages( options.maxTextures * NUM_PAGES_PER_TEXTURE, &m_samplerRequestHandler );
     m_samplerRequestHandler.setPageRange( samplerStartPage, options.maxTextures * NUM_PAGES_PER_TEXTURE );
 
@@ -170,11 +211,25 @@ DemandLoaderImpl::DemandLoaderImpl( const Options& options )
         CascadeRequestFilter* requestFilter = new CascadeRequestFilter( cascadeStartPage, cascadeStartPage + numCascadePages, this );
         m_requestProcessor.setRequestFilter( std::shared_ptr<RequestFilter>( requestFilter ) );
     }
+
+    // Tile requests for members of texture groups are followed by speculative requests for the others.
+    m_requestProcessor.setSpeculativeRequestFilter( std::make_shared<TextureGroupRequestFilter>( options.maxTextures, this ) );
 }
 
 DemandLoaderImpl::~DemandLoaderImpl()
 {
     m_requestProcessor.stop();
+    for( PendingRelease& release : m_pendingReleases )
+    {
+        // The arrays are destroyed with the pool, once the work that might use them is done.
+        OTK_ERROR_CHECK_NOTHROW( cuEventSynchronize( release.event ) );
+        if( m_sparseArrayPool )
+        {
+            m_sparseArrayPool->recycleArrays( release.releasedArrays );
+            m_sparseArrayPool->recycleArrays( release.unmappedArrays );
+        }
+        OTK_ERROR_CHECK_NOTHROW( cuEventDestroy( release.event ) );
+    }
 }
 
 // Create a demand-loaded texture.  The image is not opened until the texture sampler is requested
@@ -186,14 +241,74 @@ const DemandTexture& DemandLoaderImpl::createTexture( std::shared_ptr<imageSourc
     OTK_ASSERT_CONTEXT_IS( m_cudaContext );
     std::unique_lock<std::mutex> lock( m_mutex );
 
-    // Add new texture to the end of the list of textures.  The texture holds a pointer to the
-    // image, from which tile data is obtained on demand.
-    unsigned int textureId = allocateTexturePages( 1 );
+    const unsigned int textureId = reserveTextureIds( 1 )[0];
+    createTextureBody( textureId, imageSource, textureDesc );
+    return *m_textures[textureId];
+}
 
-    DemandTextureImpl* tex = makeTextureOrVariant( textureId, textureDesc, imageSource );
-    m_textures.emplace( textureId, tex );
+std::vector<unsigned int> DemandLoaderImpl::createTextures( const std::vector<std::shared_ptr<imageSource::ImageSource>>& images,
+                                                            const std::vector<TextureDescriptor>& textureDescs,
+                                                            bool                                  openImages )
+{
+    SCOPED_NVTX_RANGE_FUNCTION_NAME();
+    OTK_ASSERT_CONTEXT_IS( m_cudaContext );
+    OTK_ASSERT_MSG( images.size() == textureDescs.size(), "Number of images and texture descriptors must match" );
 
-    return *m_textures[textureId];
+    // The ids of all the textures are reserved together.  Their sampler and base color pages were
+    // reserved by the constructor, and their tile pages are reserved when they are initialized.
+    std::vector<unsigned int>       textureIds;
+    std::vector<DemandTextureImpl*> textures( images.size() );
+    {
+        std::unique_lock<std::mutex> lock( m_mutex );
+        textureIds = reserveTextureIds( static_cast<unsigned int>( images.size() ) );
+        for( size_t i = 0; i < images.size(); ++i )
+        {
+            createTextureBody( textureIds[i], images[i], textureDescs[i] );
+            textures[i] = m_textures[textureIds[i]].get();
+        }
+    }
+
+    // Opening an image reads its header, which is slow for file-based images, so do it in parallel
+    // and without holding the mutex.
+    if( openImages )
+        m_workerPool.parallelFor( m_cudaContext, textures.size(), [&textures]( size_t index ) { textures[index]->open(); } );
+
+    return textureIds;
+}
+
+std::vector<unsigned int> DemandLoaderImpl::reserveTextureIds( unsigned int numTextures )
+{
+    // Mutex acquired in caller
+
+    // Reuse the ids of destroyed textures first, then allocate new ids at the end of the list of
+    // textures, which are used in order by createTextureBody.
+    std::vector<unsigned int> textureIds;
+    textureIds.reserve( numTextures );
+    while( textureIds.size() < numTextures && !m_freeTextureIds.empty() )
+    {
+        textureIds.push_back( *m_freeTextureIds.begin() );
+        m_freeTextureIds.erase( m_freeTextureIds.begin() );
+    }
+    const unsigned int numNewTextures = numTextures - static_cast<unsigned int>( textureIds.size() );
+    if( numNewTextures > 0 )
+    {
+        const unsigned int startId = allocateTexturePages( numNewTextures );
+        for( unsigned int i = 0; i < numNewTextures; ++i )
+            textureIds.push_back( startId + i );
+    }
+    return textureIds;
+}
+
+void DemandLoaderImpl::createTextureBody( unsigned int textureId, std::shared_ptr<imageSource::ImageSource> imageSource, const TextureDescriptor& textureDesc )
+{
+    // Mutex acquired in caller
+
+    // The texture holds a pointer to the image, from which tile data is obtained on demand.
+    DemandTextureImpl* tex = makeTextureOrVariant( textureId, textureDesc, imageSource );
+    if( textureId == m_textures.size() )
+        m_textures.emplace_back( tex );
+    else
+        m_textures[textureId].reset( tex );
 }
 
 // Create a demand-loaded UDIM texture.  The images are not opened until the texture samplers are requested
@@ -209,40 +324,145 @@ const DemandTexture& DemandLoaderImpl::createUdimTexture( std::vector<std::share
     OTK_ASSERT_CONTEXT_IS( m_cudaContext );
     std::unique_lock<std::mutex> lock( m_mutex );
 
-    // Allocate demand loader pages for the udim grid
+    // Find the populated slots of the udim grid.  Only these consume texture ids.
     OTK_ASSERT_MSG( udim * vdim > 0, "Udim and vdim must both be positive." );
-    unsigned int startTextureId = allocateTexturePages( udim * vdim );
+    std::vector<unsigned int> slots;
+    for( unsigned int slot = 0; slot < udim * vdim && slot < imageSources.size(); ++slot )
+    {
+        if( imageSources[slot].get() != nullptr )
+            slots.push_back( slot );
+    }
+    OTK_ASSERT_MSG( !slots.empty() || baseTextureId >= 0, "Udim texture has no subtextures and no base texture." );
+    if( slots.empty() )
+        return *m_textures[baseTextureId];
+
+    // Allocate demand loader pages for the populated slots.  A sparse grid gets a device-side
+    // index of its populated slots, so the subtexture ids can be found by searching it.
+    const unsigned int  startTextureId = allocateTexturePages( static_cast<unsigned int>( slots.size() ) );
+    const bool          isSparse       = slots.size() < udim * vdim;
+    const unsigned int* udimSlots      = isSparse ? getDeviceMemoryManager()->allocateUdimSlots( slots ) : nullptr;
+    const unsigned int  numUdimSlots   = isSparse ? static_cast<unsigned int>( slots.size() ) : 0;
 
     // Fill the textures in
-    unsigned int entryPointId = 0xFFFFFFFF;
-    for( unsigned int v=0; v<vdim; ++v )
+    for( unsigned int i = 0; i < slots.size(); ++i )
     {
-        for( unsigned int u=0; u<udim; ++u )
-        {
-            unsigned int imageIndex = v*udim + u;
-            unsigned int textureId = startTextureId + imageIndex;
-            if(imageIndex < imageSources.size() && imageSources[imageIndex].get() != nullptr )
-            {
-                // Create the texture and put it in the list of textures
-                entryPointId = std::min( textureId, entryPointId );
-                DemandTextureImpl* tex = makeTextureOrVariant( textureId, textureDescs[imageIndex], imageSources[imageIndex] );
-                m_textures.emplace( textureId, tex );
-                tex->setUdimTexture( startTextureId, udim, vdim, numChannelTextures, false );
-            }
-            else 
-            {
-                m_textures.emplace( textureId, nullptr );
-            }
-        }
+        const unsigned int imageIndex = slots[i];
+        const unsigned int textureId  = startTextureId + i;
+        DemandTextureImpl* tex = makeTextureOrVariant( textureId, textureDescs[imageIndex], imageSources[imageIndex] );
+        m_textures.emplace_back( tex );
+        tex->setUdimTexture( startTextureId, udim, vdim, numChannelTextures, false, udimSlots, numUdimSlots );
     }
 
     if( baseTextureId >= 0 )
     {
-        m_textures[baseTextureId]->setUdimTexture( startTextureId, udim, vdim, numChannelTextures, true );
+        m_textures[baseTextureId]->setUdimTexture( startTextureId, udim, vdim, numChannelTextures, true, udimSlots, numUdimSlots );
         return *m_textures[baseTextureId];
     }
 
-    return *m_textures[entryPointId];
+    return *m_textures[startTextureId];
+}
+
+void DemandLoaderImpl::destroyTexture( unsigned int textureId )
+{
+    SCOPED_NVTX_RANGE_FUNCTION_NAME();
+    OTK_ASSERT_CONTEXT_IS( m_cudaContext );
+    std::unique_lock<std::mutex> lock( m_mutex );
+
+    OTK_ASSERT_MSG( textureId < m_textures.size() && m_textures[textureId], "Cannot destroy nonexistent texture" );
+    DemandTextureImpl* texture = m_textures[textureId].get();
+
+    // Destroying a udim texture destroys its subtextures.  Its entry point is its base texture, or
+    // its first subtexture if it has no base texture.
+    std::vector<unsigned int> textureIds{ textureId };
+    if( const unsigned int numSubtextures = texture->getNumUdimSubtextures() )
+    {
+        const unsigned int startId = texture->getUdimStartId();
+        OTK_ASSERT_MSG( texture->isUdimBaseTexture() || textureId == startId,
+                        "Cannot destroy a udim subtexture (destroy the udim texture instead)" );
+        for( unsigned int id = startId; id < startId + numSubtextures; ++id )
+        {
+            if( id != textureId )
+                textureIds.push_back( id );
+        }
+    }
+
+    // Variants are created after their master textures, so later textures are destroyed first.
+    std::sort( textureIds.begin(), textureIds.end(), std::greater<unsigned int>() );
+
+    // Requests that are queued or being filled may refer to the textures, so they are reclaimed once
+    // those requests are done.
+    const std::vector<Ticket> tickets = m_requestProcessor.getOutstandingTickets();
+    for( unsigned int id : textureIds )
+        destroyTextureBody( id, tickets );
+}
+
+void DemandLoaderImpl::destroyTextureBody( unsigned int textureId, const std::vector<Ticket>& tickets )
+{
+    // Mutex acquired in caller
+    DemandTextureImpl* texture = m_textures[textureId].get();
+    OTK_ASSERT_MSG( texture->getVariantsIds().empty(), "Cannot destroy a texture that has variants" );
+
+    // Release the sampler and base color.
+    m_pageLoader->invalidatePageRange( textureId, textureId + 1, new SamplerPoolReturnPredicate( getDeviceMemoryManager() ) );
+    const unsigned int baseColorId = samplerIdToBaseColorId( textureId, getOptions().maxTextures );
+    m_pageLoader->invalidatePageRange( baseColorId, baseColorId + 1, nullptr );
+
+    if( DemandTextureImpl* masterTexture = texture->getMasterTexture() )
+    {
+        // A variant shares its tiles with the master texture, which keeps them.
+        masterTexture->removeVariantId( textureId );
+    }
+    else
+    {
+        // Return the tiles to the tile pool, then release the page range for reuse.
+        if( TextureRequestHandler* requestHandler = texture->getRequestHandler() )
+        {
+            const unsigned int startPage = requestHandler->getStartPage();
+            m_pageLoader->invalidatePageRange( startPage, startPage + requestHandler->getNumPages(),
+                                               new TilePoolReturnPredicate( getDeviceMemoryManager() ) );
+            releasePages( startPage );
+        }
+
+        // Later textures with the same image are no longer variants of this one.
+        for( auto imageIt = m_imageToTextureId.begin(); imageIt != m_imageToTextureId.end(); )
+            imageIt = ( imageIt->second == textureId ) ? m_imageToTextureId.erase( imageIt ) : std::next( imageIt );
+    }
+
+    {
+        std::unique_lock<std::mutex> groupsLock( m_textureGroupsMutex );
+        removeFromTextureGroup( textureId );
+    }
+
+    // Requests in flight may still refer to the texture, so it is deleted in launchPrepare, after
+    // the invalidations above are done and the requests have been filled.
+    m_destroyedTextures.push_back( DestroyedTexture{ std::move( m_textures[textureId] ), tickets } );
+}
+
+void DemandLoaderImpl::reclaimDestroyedTextures( std::vector<DestroyedTexture>& destroyedTextures )
+{
+    // Mutex acquired in caller
+    for( DestroyedTexture& destroyed : destroyedTextures )
+    {
+        const bool isFilled = std::all_of( destroyed.tickets.begin(), destroyed.tickets.end(),
+                                           []( const Ticket& ticket ) { return ticket.numTasksRemaining() == 0; } );
+        if( isFilled )
+        {
+            // The slot index of a sparse udim texture is shared by its subtextures and base texture.
+            // It is freed with the first subtexture, which is always destroyed with the udim texture.
+            DemandTextureImpl*  texture   = destroyed.texture.get();
+            const unsigned int* udimSlots = texture->getUdimSlots();
+            if( udimSlots && !texture->isUdimBaseTexture() && texture->getId() == texture->getUdimStartId() )
+                getDeviceMemoryManager()->freeUdimSlots( udimSlots );
+
+            m_freeTextureIds.insert( destroyed.texture->getId() );
+            destroyed.texture.reset();
+        }
+        else
+        {
+            m_destroyedTextures.push_back( std::move( destroyed ) );
+        }
+    }
+    destroyedTextures.clear();
 }
 
 DemandTextureImpl* DemandLoaderImpl::makeTextureOrVariant( unsigned int textureId, 
@@ -250,22 +470,37 @@ DemandTextureImpl* DemandLoaderImpl::makeTextureOrVariant( unsigned int textureI
                                                            std::shared_ptr<imageSource::ImageSource>& imageSource )
 {
     auto imageIt = m_imageToTextureId.find( imageSource.get() );
-    if( imageIt == m_imageToTextureId.end() ) // image was not found. Make a new texture.
+    const bool imageFound = imageIt != m_imageToTextureId.end();
+
+    // A variant shares the backing store of its master texture, so it must have the same device format
+    // (and block compression preset).
+    const TextureDescriptor* masterDesc = imageFound ? &m_textures[imageIt->second]->getDescriptor() : nullptr;
+    if( !imageFound || masterDesc->deviceFormat != textureDesc.deviceFormat || masterDesc->encodeQuality != textureDesc.encodeQuality )
     {
+        if( !imageFound )
+            m_imageToTextureId[imageSource.get()] = textureId;
+
         if( getOptions().useCascadingTextureSizes )
         {
             imageSource::CascadeImage* cascadeImg = new imageSource::CascadeImage( imageSource, CASCADE_BASE );
             std::shared_ptr<imageSource::ImageSource> cascadeImage( cascadeImg );
-            m_imageToTextureId[imageSource.get()] = textureId;
             return new DemandTextureImpl( textureId, textureDesc, cascadeImage, this );
         }
 
-        m_imageToTextureId[imageSource.get()] = textureId;
         return new DemandTextureImpl( textureId, textureDesc, imageSource, this );
     }
     else // image was found. Make a variant texture.
     {
         DemandTextureImpl* masterTexture = m_textures[imageIt->second].get();
+
+        // Requests for the variant's sampler are speculated through the master's texture group.
+        std::unique_lock<std::mutex> groupsLock( m_textureGroupsMutex );
+        if( m_textureGroups->contains( masterTexture->getId() ) )
+        {
+            std::shared_ptr<TextureGroups> groups = std::make_shared<TextureGroups>( *m_textureGroups );
+            groups->setMaster( textureId, masterTexture->getId() );
+            m_textureGroups = groups;
+        }
         return new DemandTextureImpl( textureId, masterTexture, textureDesc, this );
     }
 }
@@ -284,6 +519,12 @@ void DemandLoaderImpl::invalidatePage( unsigned int pageId )
     m_pageLoader->invalidatePageRange( pageId, pageId + 1, nullptr );
 }
 
+void DemandLoaderImpl::invalidateTilePages( unsigned int startPage, unsigned int endPage )
+{
+    std::unique_lock<std::mutex> lock( m_mutex );
+    m_pageLoader->invalidatePageRange( startPage, endPage, new TilePoolReturnPredicate( getDeviceMemoryManager() ) );
+}
+
 void DemandLoaderImpl::loadTextureTiles( CUstream stream, unsigned int textureId, bool reloadIfResident )
 {
     initTexture( stream, textureId );
@@ -321,6 +562,133 @@ void DemandLoaderImpl::unloadTextureTiles( unsigned int textureId )
     }
 }
 
+void DemandLoaderImpl::pinTexture( unsigned int textureId, unsigned int minLevel )
+{
+    OTK_ASSERT_CONTEXT_IS( m_cudaContext );
+    std::unique_lock<std::mutex> lock( m_mutex );
+
+    // Texture variants share tiles with their master texture, so pin the master.
+    DemandTextureImpl* texture = m_textures.at( textureId ).get();
+    if( texture->getMasterTexture() )
+        texture = texture->getMasterTexture();
+    texture->setPinnedMinLevel( minLevel );
+
+    // Pin the tiles that are already resident. The rest are pinned as they are filled.
+    if( texture->isOpen() && texture->getSampler().desc.isSparseTexture )
+    {
+        texture->init();
+        unsigned int startPage = texture->getSampler().startPage;
+        unsigned int endPage   = startPage + texture->getNumPagesFromLevel( minLevel );
+        getPagingSystem()->pinPages( startPage, endPage );
+    }
+}
+
+void DemandLoaderImpl::unpinTexture( unsigned int textureId )
+{
+    OTK_ASSERT_CONTEXT_IS( m_cudaContext );
+    std::unique_lock<std::mutex> lock( m_mutex );
+
+    DemandTextureImpl* texture = m_textures.at( textureId ).get();
+    if( texture->getMasterTexture() )
+        texture = texture->getMasterTexture();
+    texture->setPinnedMinLevel( UINT_MAX );
+
+    if( texture->isOpen() && texture->getSampler().desc.isSparseTexture )
+    {
+        texture->init();
+        TextureSampler sampler = texture->getSampler();
+        getPagingSystem()->unpinPages( sampler.startPage, sampler.startPage + sampler.numPages );
+    }
+}
+
+unsigned int DemandLoaderImpl::createResidencyGroup( size_t maxTexMem, bool hardQuota )
+{
+    OTK_ASSERT_CONTEXT_IS( m_cudaContext );
+    const size_t maxPages = std::min<size_t>( maxTexMem / TILE_SIZE_IN_BYTES, UINT_MAX );
+    return getPagingSystem()->createResidencyGroup( static_cast<unsigned int>( maxPages ), hardQuota );
+}
+
+void DemandLoaderImpl::setResidencyGroup( unsigned int textureId, unsigned int groupId )
+{
+    OTK_ASSERT_CONTEXT_IS( m_cudaContext );
+    std::unique_lock<std::mutex> lock( m_mutex );
+
+    // Texture variants share tiles with their master texture, so the master holds the group.
+    DemandTextureImpl* texture = m_textures.at( textureId ).get();
+    if( texture->getMasterTexture() )
+        texture = texture->getMasterTexture();
+    texture->setResidencyGroup( groupId );
+
+    // Move tiles that are already resident to the new group.
+    if( texture->isOpen() && texture->getSampler().desc.isSparseTexture )
+    {
+        texture->init();
+        TextureSampler sampler = texture->getSampler();
+        getPagingSystem()->setResidencyGroup( sampler.startPage, sampler.startPage + sampler.numPages, groupId );
+    }
+}
+
+void DemandLoaderImpl::addTextureGroup( const std::vector<unsigned int>& textureIds )
+{
+    OTK_ASSERT_CONTEXT_IS( m_cudaContext );
+
+    // Variants share the tiles of their master textures, so the masters are grouped.
+    std::unique_lock<std::mutex>    lock( m_mutex );
+    std::vector<DemandTextureImpl*> members;
+    for( unsigned int textureId : textureIds )
+    {
+        DemandTextureImpl* texture = m_textures.at( textureId ).get();
+        OTK_ASSERT_MSG( texture != nullptr, "Cannot group nonexistent texture" );
+        if( texture->getMasterTexture() )
+            texture = texture->getMasterTexture();
+        members.push_back( texture );
+    }
+
+    // The samplers are read while holding the groups mutex, so that a sampler initialized meanwhile
+    // is recorded either here or by setTextureGroupSampler.
+    std::unique_lock<std::mutex>   groupsLock( m_textureGroupsMutex );
+    std::shared_ptr<TextureGroups> groups = std::make_shared<TextureGroups>( *m_textureGroups );
+    std::vector<unsigned int>      memberIds;
+    for( DemandTextureImpl* member : members )
+        memberIds.push_back( member->getId() );
+    groups->add( memberIds );
+    for( DemandTextureImpl* member : members )
+    {
+        if( member->isSamplerReady() )
+            groups->setSampler( member->getId(), &member->getSampler() );
+        for( unsigned int variantId : member->getVariantsIds() )
+            groups->setMaster( variantId, member->getId() );
+    }
+    m_textureGroups = groups;
+}
+
+std::shared_ptr<const TextureGroups> DemandLoaderImpl::getTextureGroups()
+{
+    std::unique_lock<std::mutex> lock( m_textureGroupsMutex );
+    return m_textureGroups;
+}
+
+void DemandLoaderImpl::setTextureGroupSampler( unsigned int textureId, const TextureSampler* sampler )
+{
+    std::unique_lock<std::mutex> lock( m_textureGroupsMutex );
+    if( !m_textureGroups->contains( textureId ) )
+        return;
+    std::shared_ptr<TextureGroups> groups = std::make_shared<TextureGroups>( *m_textureGroups );
+    groups->setSampler( textureId, sampler );
+    m_textureGroups = groups;
+}
+
+void DemandLoaderImpl::removeFromTextureGroup( unsigned int textureId )
+{
+    // Texture groups mutex acquired in caller
+    if( !m_textureGroups->contains( textureId ) && m_textureGroups->getMaster( textureId ) == textureId )
+        return;
+    std::shared_ptr<TextureGroups> groups = std::make_shared<TextureGroups>( *m_textureGroups );
+    groups->remove( textureId );
+    groups->removeVariant( textureId );
+    m_textureGroups = groups;
+}
+
 void DemandLoaderImpl::migrateTextureTiles( const TextureSampler& oldSampler, DemandTextureImpl* newTexture )
 {
     // Mutex acquired in caller
@@ -380,6 +748,74 @@ void DemandLoaderImpl::replaceTexture( CUstream
     }
 }
 
+void DemandLoaderImpl::reloadTexture( CUstream stream, unsigned int textureId, std::shared_ptr<imageSource::ImageSource> image )
+{
+    OTK_ASSERT_CONTEXT_IS( m_cudaContext );
+    OTK_ASSERT_CONTEXT_MATCHES_STREAM( stream );
+
+    // Tiles can be compared only if the texture is a sparse texture whose tile hashes are recorded
+    // (not a variant, which shares the tiles of its master), and the new image has the same layout.
+    DemandTextureImpl* texture;
+    TextureDescriptor  textureDesc;
+    bool               incremental;
+    {
+        std::unique_lock<std::mutex> lock( m_mutex );
+        texture     = m_textures.at( textureId ).get();
+        textureDesc = texture->getDescriptor();
+
+        TextureRequestHandler* requestHandler = texture->getRequestHandler();
+        incremental = texture->isOpen() && texture->getSampler().desc.isSparseTexture && !texture->getMasterTexture()
+                      && requestHandler && requestHandler->hasTileHashes();
+        if( incremental )
+        {
+            imageSource::TextureInfo newInfo;
+            image->open( &newInfo );
+            incremental = newInfo == texture->getImage()->getInfo();
+        }
+    }
+    if( !incremental )
+    {
+        replaceTexture( stream, textureId, image, textureDesc, false );
+        return;
+    }
+
+    // The texture keeps its sampler and tiles, since its layout is unchanged.  Variants share the image.
+    // Fills that overlap the swap are invalidated (see TextureRequestHandler::beginReload).
+    {
+        std::unique_lock<std::mutex> lock( m_mutex );
+        texture->getRequestHandler()->beginReload();
+        texture->setImage( textureDesc, image );
+        for( unsigned int variantId : texture->getVariantsIds() )
+        {
+            DemandTextureImpl* variant = m_textures.at( variantId ).get();
+            variant->setImage( variant->getDescriptor(), image );
+        }
+        texture->getRequestHandler()->endReload();
+    }
+
+    // Hash the resident tiles of the new image without holding the lock, since that might read much of it.
+    std::vector<unsigned int> changedPages;
+    texture->getRequestHandler()->findChangedPages( stream, changedPages );
+
+    std::unique_lock<std::mutex> lock( m_mutex );
+
+    // Invalidate the changed tiles, in runs of consecutive pages, returning them to the tile pool.
+    for( size_t begin = 0; begin < changedPages.size(); )
+    {
+        size_t end = begin + 1;
+        while( end < changedPages.size() && changedPages[end] == changedPages[end - 1] + 1 )
+            ++end;
+        m_pageLoader->invalidatePageRange( changedPages[begin], changedPages[end - 1] + 1,
+                                           new TilePoolReturnPredicate( getDeviceMemoryManager() ) );
+        begin = end;
+    }
+
+    // Reload the base colors.
+    m_samplerRequestHandler.loadPage( stream, samplerIdToBaseColorId( textureId, getOptions().maxTextures ), true );
+    for( unsigned int variantId : texture->getVariantsIds() )
+        m_samplerRequestHandler.loadPage( stream, samplerIdToBaseColorId( variantId, getOptions().maxTextures ), true );
+}
+
 void DemandLoaderImpl::initTexture( CUstream stream, unsigned int textureId )
 {
     OTK_ASSERT_CONTEXT_IS( m_cudaContext );
@@ -398,15 +834,22 @@ void DemandLoaderImpl::initUdimTexture( CUstream stream, unsigned int baseTextur
     const DemandTextureImpl* baseTexture = m_textures.at( baseTextureId ).get();
     const TextureSampler& baseSampler = baseTexture->getSampler();
 
-    for( unsigned int v = 0; v < baseSampler.vdim; ++v )
+    // The subtextures have consecutive ids, one per populated slot of the udim grid.
+    const unsigned int numSubTextures =
+        baseSampler.udimSlots ? baseSampler.numUdimSlots : static_cast<unsigned int>( baseSampler.udim ) * baseSampler.vdim;
+    std::vector<unsigned int> subTextureIds;
+    subTextureIds.reserve( numSubTextures );
+    for( unsigned int i = 0; i < numSubTextures; ++i )
     {
-        for( unsigned int u = 0; u < baseSampler.udim; ++u)
-        {
-            unsigned int subTextureId = baseSampler.udimStartPage + v * baseSampler.udim + u;
-            if( subTextureId != baseTextureId )
-                initTexture( stream, subTextureId );
-        }
+        unsigned int subTextureId = baseSampler.udimStartPage + i;
+        if( subTextureId != baseTextureId )
+            subTextureIds.push_back( subTextureId );
     }
+
+    // Opening the images dominates, so initialize the subtextures in parallel.  Each one is
+    // initialized just as when its sampler is first requested on the device.
+    m_workerPool.parallelFor( m_cudaContext, subTextureIds.size(),
+                              [this, stream, &subTextureIds]( size_t index ) { initTexture( stream, subTextureIds[index] ); } );
 }
 
 unsigned int DemandLoaderImpl::getTextureTilePageId( unsigned int textureId, unsigned int mipLevel, unsigned int tileX, unsigned int tileY )
@@ -433,11 +876,214 @@ bool DemandLoaderImpl::pageResident( unsigned int pageId )
     return pagingSystem->isResident( pageId );
 }
 
+TextureResidency DemandLoaderImpl::getResidency( unsigned int textureId )
+{
+    std::unique_lock<std::mutex> lock( m_mutex );
+    return getTextureResidency( textureId );
+}
+
+std::vector<TextureResidency> DemandLoaderImpl::getResidency( const std::vector<unsigned int>& textureIds )
+{
+    std::unique_lock<std::mutex> lock( m_mutex );
+    std::vector<TextureResidency> residencies;
+    residencies.reserve( textureIds.size() );
+    for( unsigned int textureId : textureIds )
+        residencies.push_back( getTextureResidency( textureId ) );
+    return residencies;
+}
+
+TextureResidency DemandLoaderImpl::getTextureResidency( unsigned int textureId )
+{
+    // Mutex acquired in caller
+    TextureResidency   residency;
+    DemandTextureImpl* texture = m_textures.at( textureId ).get();
+    if( texture == nullptr )
+        return residency;
+
+    PagingSystem* pagingSystem    = m_pageLoader->getPagingSystem();
+    residency.isSamplerResident   = pagingSystem->isResident( textureId );
+    residency.isBaseColorResident = pagingSystem->isResident( samplerIdToBaseColorId( textureId, getOptions().maxTextures ) );
+
+    // The tile layout is known once the sampler is, and dense textures have no tiles.  Variants share
+    // the pages of their master texture, so an uninitialized variant reports the tiles of its master.
+    DemandTextureImpl* layoutTexture = texture;
+    if( !texture->isSamplerReady() && texture->getMasterTexture() )
+        layoutTexture = texture->getMasterTexture();
+    if( !layoutTexture->isSamplerReady() )
+        return residency;
+    const TextureSampler& sampler = layoutTexture->getSampler();
+    residency.isSparseTexture     = sampler.desc.isSparseTexture;
+    if( !residency.isSparseTexture )
+        return residency;
+
+    std::vector<bool> pageResident( sampler.numPages, false );
+    for( unsigned int pageId : pagingSystem->getResidentPages( sampler.startPage, sampler.startPage + sampler.numPages ) )
+        pageResident[pageId - sampler.startPage] = true;
+    residency.numResidentTiles = static_cast<unsigned int>( std::count( pageResident.begin(), pageResident.end(), true ) );
+
+    // The levels in the mip tail are all filled by the first page of the texture.
+    const unsigned int numMipLevels = sampler.desc.numMipLevels;
+    const bool         hasMipTail   = numMipLevels > 1 && sampler.mipTailFirstLevel < numMipLevels;
+    residency.mipTailFirstLevel     = hasMipTail ? sampler.mipTailFirstLevel : numMipLevels;
+    residency.mipLevels.resize( numMipLevels );
+    for( unsigned int mipLevel = 0; mipLevel < numMipLevels; ++mipLevel )
+    {
+        MipLevelResidency& level = residency.mipLevels[mipLevel];
+        if( mipLevel >= residency.mipTailFirstLevel )
+        {
+            level.widthInTiles  = 1;
+            level.heightInTiles = 1;
+            level.residentTiles.assign( 1, pageResident[0] );
+            continue;
+        }
+        const TextureSampler::MipLevelSizes& sizes = sampler.mipLevelSizes[mipLevel];
+        level.widthInTiles                         = sizes.levelWidthInTiles;
+        level.heightInTiles                        = sizes.levelHeightInTiles;
+        level.residentTiles.assign( pageResident.begin() + sizes.mipLevelStart,
+                                    pageResident.begin() + sizes.mipLevelStart + level.widthInTiles * level.heightInTiles );
+    }
+    return residency;
+}
+
 bool DemandLoaderImpl::launchPrepare( CUstream stream, DeviceContext& context )
 {
     OTK_ASSERT_CONTEXT_IS( m_cudaContext );
     OTK_ASSERT_CONTEXT_MATCHES_STREAM( stream );
-    return m_pageLoader->pushMappings( stream, context );
+    std::vector<unsigned int> evictedTextureIds;
+    if( m_options->maxUnreferencedLaunches > 0 )
+        evictUnreferencedTextures( evictedTextureIds );
+
+    // Textures destroyed, atlas slots released and sparse arrays released so far are reclaimed once
+    // their pages have been invalidated on the device.
+    std::vector<DestroyedTexture>               destroyedTextures;
+    std::vector<AtlasSlot>                      atlasSlots;
+    std::vector<SparseArrayPool::ReleasedArray> releasedArrays;
+    std::vector<Ticket>                         tickets;
+    {
+        std::unique_lock<std::mutex> lock( m_mutex );
+        destroyedTextures.swap( m_destroyedTextures );
+        atlasSlots = m_textureAtlas.takeReleasedSlots();
+        chargeAtlasMemory();
+        if( m_sparseArrayPool )
+            releasedArrays = m_sparseArrayPool->takeReleasedArrays();
+        if( !releasedArrays.empty() )
+            tickets = m_requestProcessor.getOutstandingTickets();
+    }
+
+    const bool result = m_pageLoader->pushMappings( stream, context );
+
+    std::unique_lock<std::mutex> lock( m_mutex );
+    std::vector<SparseArrayPool::ReleasedArray> unmappedArrays;
+    releaseCompletedResources( stream, unmappedArrays );
+    if( !evictedTextureIds.empty() || !destroyedTextures.empty() || !atlasSlots.empty() || !releasedArrays.empty()
+        || !unmappedArrays.empty() )
+    {
+        // Launches issued before this call may still sample the evicted and destroyed textures, the
+        // released atlas slots and the released arrays, so they are released once an event recorded
+        // after the invalidations (and the unmapping of arrays released earlier) has completed.
+        PendingRelease release;
+        OTK_ERROR_CHECK( cuEventCreate( &release.event, CU_EVENT_DISABLE_TIMING ) );
+        OTK_ERROR_CHECK( cuEventRecord( release.event, stream ) );
+        release.evictedTextureIds.swap( evictedTextureIds );
+        release.destroyedTextures.swap( destroyedTextures );
+        release.atlasSlots.swap( atlasSlots );
+        release.releasedArrays.swap( releasedArrays );
+        release.tickets.swap( tickets );
+        release.unmappedArrays.swap( unmappedArrays );
+        m_pendingReleases.push_back( std::move( release ) );
+    }
+    return result;
+}
+
+void DemandLoaderImpl::releaseCompletedResources( CUstream stream, std::vector<SparseArrayPool::ReleasedArray>& unmappedArrays )
+{
+    // Mutex acquired in caller
+    while( !m_pendingReleases.empty() )
+    {
+        PendingRelease& release = m_pendingReleases.front();
+        const CUresult  status  = cuEventQuery( release.event );
+        if( status == CUDA_ERROR_NOT_READY )
+            break;
+        OTK_ERROR_CHECK( status );
+
+        // Requests in flight might still map tiles into the released arrays (see SparseMappingBatch).
+        if( !std::all_of( release.tickets.begin(), release.tickets.end(),
+                          []( const Ticket& ticket ) { return ticket.numTasksRemaining() == 0; } ) )
+            break;
+
+        releaseEvictedTextures( release.evictedTextureIds );
+        reclaimDestroyedTextures( release.destroyedTextures );
+        m_textureAtlas.freeSlots( release.atlasSlots );
+        if( m_sparseArrayPool )
+        {
+            m_sparseArrayPool->unmapArrays( release.releasedArrays, stream );
+            unmappedArrays.insert( unmappedArrays.end(), release.releasedArrays.begin(), release.releasedArrays.end() );
+            m_sparseArrayPool->recycleArrays( release.unmappedArrays );
+        }
+        OTK_ERROR_CHECK( cuEventDestroy( release.event ) );
+        m_pendingReleases.pop_front();
+    }
+}
+
+void DemandLoaderImpl::evictUnreferencedTextures( std::vector<unsigned int>& evictedTextureIds )
+{
+    std::unique_lock<std::mutex> lock( m_mutex );
+    if( m_textures.empty() )
+        return;
+
+    // Find the textures whose samplers are resident but were not referenced recently.
+    const unsigned int        endId = static_cast<unsigned int>( m_textures.size() );
+    std::vector<unsigned int> textureIds =
+        getPagingSystem()->getUnreferencedPages( 0, endId, m_options->maxUnreferencedLaunches );
+    const std::set<unsigned int> unreferenced( textureIds.begin(), textureIds.end() );
+
+    for( unsigned int textureId : textureIds )
+    {
+        DemandTextureImpl* texture = m_textures.at( textureId ).get();
+        if( !texture )
+            continue;
+        DemandTextureImpl* masterTexture = texture->getMasterTexture() ? texture->getMasterTexture() : texture;
+        if( masterTexture->isPinned() )
+            continue;
+
+        // Variants share the array of their master texture, and fill it through the master, so a
+        // master is kept while any of its variants is resident and still referenced.
+        const std::vector<unsigned int>& variantIds = texture->getVariantsIds();
+        if( std::any_of( variantIds.begin(), variantIds.end(), [this, &unreferenced]( unsigned int id ) {
+                return unreferenced.count( id ) == 0 && getPagingSystem()->isResident( id );
+            } ) )
+            continue;
+
+        // Release the sampler and base color, which are reloaded if the texture is referenced again.
+        m_pageLoader->invalidatePageRange( textureId, textureId + 1, new SamplerPoolReturnPredicate( getDeviceMemoryManager() ) );
+        unsigned int baseColorId = samplerIdToBaseColorId( textureId, getOptions().maxTextures );
+        m_pageLoader->invalidatePageRange( baseColorId, baseColorId + 1, nullptr );
+
+        // Texture variants share tiles with their master texture, so the tiles are released with the master.
+        if( masterTexture == texture && texture->getSampler().desc.isSparseTexture )
+        {
+            const TextureSampler& sampler = texture->getSampler();
+            m_pageLoader->invalidatePageRange( sampler.startPage, sampler.startPage + sampler.numPages,
+                                               new TilePoolReturnPredicate( getDeviceMemoryManager() ) );
+        }
+
+        // Launches in flight may still sample the texture, so its device textures are released once
+        // the launches issued before the next pushMappings are done (see launchPrepare).
+        evictedTextureIds.push_back( textureId );
+        ++m_numTextureEvictions;
+    }
+}
+
+void DemandLoaderImpl::releaseEvictedTextures( const std::vector<unsigned int>& evictedTextureIds )
+{
+    // Mutex acquired in caller
+    for( unsigned int textureId : evictedTextureIds )
+    {
+        // Skip textures that were destroyed, or whose samplers were requested again since they were evicted.
+        DemandTextureImpl* texture = m_textures[textureId].get();
+        if( texture && !getPagingSystem()->isResident( textureId ) )
+            texture->releaseDeviceTextures();
+    }
 }
 
 Ticket DemandLoaderImpl::processRequests( CUstream stream, const DeviceContext& context )
@@ -462,18 +1108,17 @@ void DemandLoaderImpl::abort()
     m_requestProcessor.stop();
 }
 
-void DemandLoaderImpl::unmapTileResource( CUstream stream, unsigned int pageId )
+bool DemandLoaderImpl::unmapTileResource( CUstream stream, unsigned int pageId )
 {
-    // Ask the PageTableManager for the RequestHandler associated with the given page index.
+    // Ask the PageTableManager for the RequestHandler associated with the given page index.  The
+    // range might have been released since the page was staged, in which case there is nothing to unmap.
     OTK_ASSERT_CONTEXT_IS( m_cudaContext );
     OTK_ASSERT_CONTEXT_MATCHES_STREAM( stream );
     RequestHandler* handler = m_pageTableManager->getRequestHandler( pageId );
-    OTK_ASSERT_MSG( handler, "Page request does not correspond to a known resource." );
 
     // Make sure that the handler is a TextureRequestHandler instead of a null request handler
     TextureRequestHandler* textureRequestHandler = dynamic_cast<TextureRequestHandler*>( handler );
-    if( textureRequestHandler ) 
-        textureRequestHandler->unmapTileResource( stream, pageId );
+    return !textureRequestHandler || textureRequestHandler->unmapTileResource( stream, pageId );
 }
 
 void DemandLoaderImpl::setPageTableEntry( unsigned pageId, bool evictable, unsigned long long pageTableEntry )
@@ -486,6 +1131,13 @@ PagingSystem* DemandLoaderImpl::getPagingSystem() const
     return m_pageLoader->getPagingSystem();
 }
 
+void DemandLoaderImpl::releasePages( unsigned int startPage )
+{
+    // Tiles mapped by requests that were being filled when the range was released are returned to
+    // the tile pool before the range is reused.
+    m_pageLoader->releasePages( startPage, new TilePoolReturnPredicate( getDeviceMemoryManager() ) );
+}
+
 PageTableManager* DemandLoaderImpl::getPageTableManager()
 {
     return m_pageTableManager.get();
@@ -500,13 +1152,33 @@ void DemandLoaderImpl::freeStagedTiles( CUstream stream )
     PagingSystem* pagingSystem = getPagingSystem();
     PageMapping   mapping;
 
+    // Free the blocks of tiles that were being refilled when they were staged, once they have been
+    // remapped or unmapped.  Each tile stays in the list until it is unmapped, so the others are
+    // kept if an unmap throws.
+    for( size_t i = 0; i < m_deferredUnmaps.size(); )
+    {
+        const PageMapping deferred = m_deferredUnmaps[i];
+        if( !unmapTileResource( stream, deferred.id ) )
+        {
+            ++i;
+            continue;
+        }
+        m_deferredUnmaps[i] = m_deferredUnmaps.back();
+        m_deferredUnmaps.pop_back();
+        getDeviceMemoryManager()->freeTileBlock( deferred.page );
+    }
+
     while( getDeviceMemoryManager()->needTileBlocksFreed() )
     {
         pagingSystem->activateEviction( true );
         if( pagingSystem->freeStagedPage( &mapping ) )
         {
-            unmapTileResource( stream, mapping.id );
-            getDeviceMemoryManager()->freeTileBlock( mapping.page );
+            // A tile that is being refilled still maps its block until the refill remaps it, so the
+            // block can't be freed yet.
+            if( unmapTileResource( stream, mapping.id ) )
+                getDeviceMemoryManager()->freeTileBlock( mapping.page );
+            else
+                m_deferredUnmaps.push_back( mapping );
         }
         else 
         {
@@ -526,6 +1198,11 @@ const TransferBufferDesc DemandLoaderImpl::allocateTransferBuffer( CUmemorytype
     else if( memoryType == CU_MEMORYTYPE_DEVICE )
         memoryBlock = m_deviceTransferPool.alloc( size, alignment );
 
+    // A batched fill holds its transfer buffer until the batch is flushed, which bounds the batch size.
+    SparseMappingBatch* batch = SparseMappingBatch::getCurrent();
+    if( batch && memoryBlock.size > 0 )
+        batch->addTransferBytes( memoryBlock.size );
+
     return TransferBufferDesc{ memoryType, memoryBlock };
 }
 
@@ -547,16 +1224,32 @@ Statistics DemandLoaderImpl::getStatistics() const
 {
     std::unique_lock<std::mutex> lock( m_mutex );
 
+    size_t numDestroyedTextures = m_destroyedTextures.size();
+    for( const PendingRelease& release : m_pendingReleases )
+        numDestroyedTextures += release.destroyedTextures.size();
+
     Statistics stats{};
-    stats.numTextures           = m_textures.size();
-    stats.requestProcessingTime = m_pageLoader->getTotalProcessingTime();
-    stats.deviceMemoryUsed      = getDeviceMemoryManager()->getTotalDeviceMemory();
+    stats.numTextures              = m_textures.size() - m_freeTextureIds.size() - numDestroyedTextures;
+    stats.requestProcessingTime    = m_pageLoader->getTotalProcessingTime();
+    stats.deviceMemoryUsed         = getDeviceMemoryManager()->getTotalDeviceMemory();
+    stats.numTextureEvictions      = m_numTextureEvictions;
+    stats.numDeduplicatedTiles     = getDeviceMemoryManager()->getTileDeduplicator()->getNumDeduplicatedTiles();
+    stats.numQuotaDeferredRequests = getPagingSystem()->getNumQuotaDeferredRequests();
+
+    // Small textures packed into the texture atlas share its pages.
+    stats.deviceMemoryUsed += m_textureAtlas.getDeviceMemoryUsed();
+    stats.bytesTransferredToDevice += m_textureAtlas.getNumBytesFilled();
+    stats.numCopiesToDevice += m_textureAtlas.getNumCopies();
+
+    // Samplers are uploaded in batches.
+    stats.bytesTransferredToDevice += m_samplerRequestHandler.getNumBytesUploaded();
+    stats.numCopiesToDevice += m_samplerRequestHandler.getNumCopies();
 
     // Multiple textures can share the same ImageSource. Use a set to avoid duplicate counting.
     std::set<imageSource::ImageSource*> images;
-    for( auto texIt = m_textures.begin(); texIt != m_textures.end(); ++texIt )
+    for( unsigned int textureId = 0; textureId < m_textures.size(); ++textureId )
     {
-        DemandTextureImpl* tex = texIt->second.get();
+        DemandTextureImpl* tex = m_textures[textureId].get();
         // If the texture has a new image, add its stats
         if( tex && ( images.find( tex->getImage().get() ) == images.end() ) ) 
         {
@@ -584,7 +1277,18 @@ MemoryPool<PinnedAllocator, RingSuballocator>* DemandLoaderImpl::getPinnedMemory
 
 void DemandLoaderImpl::setMaxTextureMemory( size_t maxMem )
 {
-    m_pageLoader->setMaxTextureMemory( maxMem );
+    std::unique_lock<std::mutex> lock( m_mutex );
+    m_pageLoader->setMaxTextureMemory( maxMem, m_atlasMemoryCharged );
+}
+
+void DemandLoaderImpl::chargeAtlasMemory()
+{
+    // Mutex acquired in caller
+    const size_t atlasMemory = m_textureAtlas.getDeviceMemoryUsed();
+    if( atlasMemory == m_atlasMemoryCharged || m_options->maxTexMemPerDevice == UNLIMITED_TEXTURE_MEMORY )
+        return;
+    m_atlasMemoryCharged = atlasMemory;
+    m_pageLoader->setMaxTextureMemory( m_options->maxTexMemPerDevice, atlasMemory );
 }
 
 unsigned int DemandLoaderImpl::allocateTexturePages( unsigned int numTextures )
@@ -38,17 +38,26 @@
 #include "PagingSystem.h"
 #include "ThreadPoolRequestProcessor.h"
 #include "ResourceRequestHandler.h"
+#include "TextureGroups.h"
 #include "Textures/DemandTextureImpl.h"
+#include "Textures/EncodedTileCache.h"
 #include "Textures/SamplerRequestHandler.h"
+#include "Textures/SparseArrayPool.h"
+#include "Textures/TextureAtlas.h"
+#include "Textures/TextureTable.h"
 #include "Textures/CascadeRequestHandler.h"
 #include <OptiXToolkit/DemandLoading/TextureCascade.h>
 #include "TransferBufferDesc.h"
+#include "Util/WorkerPool.h"
 
 #include <cuda.h>
 
+#include <deque>
 #include <functional>
+#include <map>
 #include <memory>
 #include <mutex>
+#include <set>
 #include <vector>
 
 namespace imageSource {
@@ -90,6 +99,15 @@ class DemandLoaderImpl : public DemandLoader
                                             int                                                     baseTextureId,
                                             unsigned int                                            numChannelTextures = 1 ) override;
 
+    /// Create a batch of demand-loaded textures, optionally opening their images in parallel.
+    std::vector<unsigned int> createTextures( const std::vector<std::shared_ptr<imageSource::ImageSource>>& images,
+                                              const std::vector<TextureDescriptor>& textureDescs,
+                                              bool                                  openImages = false ) override;
+
+    /// Destroy a texture.  Its resources and id are reclaimed in a later launchPrepare, once the
+    /// launches issued before the next one are done.
+    void destroyTexture( unsigned int textureId ) override;
+
     /// Create an arbitrary resource with the specified number of pages.  \see ResourceCallback.
     unsigned int createResource( unsigned int numPages, ResourceCallback callback, void* callbackContext ) override;
 
@@ -102,6 +120,29 @@ class DemandLoaderImpl : public DemandLoader
     /// Schedule a list of textures to be unloaded when launchPrepare is called next.
     void unloadTextureTiles( unsigned int textureId ) override;
 
+    /// Pin the tiles of a texture in mip levels minLevel and coarser so they are never evicted.
+    void pinTexture( unsigned int textureId, unsigned int minLevel ) override;
+
+    /// Unpin the tiles of a texture, making them evictable again.
+    void unpinTexture( unsigned int textureId ) override;
+
+    /// Create a residency group with a quota of maxTexMem bytes of resident texture tiles.
+    unsigned int createResidencyGroup( size_t maxTexMem, bool hardQuota ) override;
+
+    /// Assign a texture to a residency group.
+    void setResidencyGroup( unsigned int textureId, unsigned int groupId ) override;
+
+    /// Declare a group of textures that share a texture coordinate layout.
+    void addTextureGroup( const std::vector<unsigned int>& textureIds ) override;
+
+    /// Get a snapshot of the texture groups, which is not modified when they change.  Called by the
+    /// TextureGroupRequestFilter once per batch of requests.
+    std::shared_ptr<const TextureGroups> getTextureGroups();
+
+    /// Record the sampler of a texture in the texture groups snapshot if the texture is grouped, or
+    /// forget it if sampler is null.  Called when a texture's sampler is initialized or reset.
+    void setTextureGroupSampler( unsigned int textureId, const TextureSampler* sampler );
+
     void migrateTextureTiles( const TextureSampler& oldSampler, DemandTextureImpl* newTexture );
 
     /// Replace the indicated texture, clearing out the old texture as needed
@@ -111,6 +152,9 @@ class DemandLoaderImpl : public DemandLoader
                          const TextureDescriptor&                  textureDesc,
                          bool                                      migrateTiles ) override;
 
+    /// Reload a texture from a new version of its image, invalidating only the tiles that changed.
+    void reloadTexture( CUstream stream, unsigned int textureId, std::shared_ptr<imageSource::ImageSource> image ) override;
+
     /// Pre-initialize the texture.  The caller must ensure that the current CUDA context matches the given stream.
     void initTexture( CUstream stream, unsigned int textureId ) override;
 
@@ -131,6 +175,12 @@ class DemandLoaderImpl : public DemandLoader
     /// CUDA context.
     bool pageResident( unsigned int pageId ) override;
 
+    /// Get a snapshot of the resident tiles of a texture, per mip level, from the host page table.
+    TextureResidency getResidency( unsigned int textureId ) override;
+
+    /// Get the residency of each of the given textures, under a single lock.
+    std::vector<TextureResidency> getResidency( const std::vector<unsigned int>& textureIds ) override;
+
     /// Prepare for launch.  The caller must ensure that the current CUDA context matches the given
     /// stream.  Returns false if the corresponding device does not support sparse textures.  If
     /// successful, returns a DeviceContext via result parameter, which should be copied to device
@@ -164,10 +214,13 @@ class DemandLoaderImpl : public DemandLoader
     /// Get the DeviceMemoryManager for the current CUDA context.
     DeviceMemoryManager* getDeviceMemoryManager() const;
 
+    /// Invalidate a range of texture tile pages, returning their blocks to the tile pool (thread safe).
+    void invalidateTilePages( unsigned int startPage, unsigned int endPage );
+
     /// Get the pinned memory manager.
     otk::MemoryPool<otk::PinnedAllocator, otk::RingSuballocator>* getPinnedMemoryPool();
     
-    /// Get the specified texture.
+    /// Get the specified texture.  Returns nullptr for a destroyed texture or an empty UDIM slot.
     DemandTextureImpl* getTexture( unsigned int textureId ) { return m_textures.at( textureId ).get(); }
 
     /// Get the PagingSystem for the current CUDA context.
@@ -176,6 +229,22 @@ class DemandLoaderImpl : public DemandLoader
     /// Get the PageTableManager.
     PageTableManager* getPageTableManager();
 
+    /// Get the request processor, e.g. to queue low priority requests.
+    ThreadPoolRequestProcessor* getRequestProcessor() { return &m_requestProcessor; }
+
+    /// Get the atlas into which small dense textures are packed.
+    TextureAtlas* getTextureAtlas() { return &m_textureAtlas; }
+
+    /// Get the on-disk cache of block compressed data, or null if Options::encodedTileCacheDir is empty.
+    EncodedTileCache* getEncodedTileCache() { return m_encodedTileCache.get(); }
+
+    /// Get the pool of released sparse arrays, or null if Options::maxRecycledSparseArrays is zero.
+    SparseArrayPool* getSparseArrayPool() { return m_sparseArrayPool.get(); }
+
+    /// Release the range of pages starting at the given page.  The pages are invalidated in the next
+    /// launchPrepare, and can be reserved again once the requests outstanding then are done.
+    void releasePages( unsigned int startPage );
+
     /// Free some staged tiles if there are some that are ready
     void freeStagedTiles( CUstream stream );
 
@@ -202,10 +271,37 @@ class DemandLoaderImpl : public DemandLoader
 
     std::shared_ptr<PageTableManager>     m_pageTableManager;  // Allocates ranges of virtual pages.
     ThreadPoolRequestProcessor            m_requestProcessor;  // Asynchronously processes page requests.
+    WorkerPool                            m_workerPool;  // Opens images and initializes subtextures in parallel.
     std::unique_ptr<DemandPageLoaderImpl> m_pageLoader;
+    TextureAtlas                          m_textureAtlas;  // Small dense textures (outlives m_textures).
+    std::unique_ptr<EncodedTileCache>     m_encodedTileCache;  // Data block compressed on the host.
+    CudaSparseArrayDriver                 m_sparseArrayDriver;
+    std::shared_ptr<SparseArrayPool>      m_sparseArrayPool;  // Released sparse arrays, reused by new textures.
 
-    std::map<unsigned int, std::unique_ptr<DemandTextureImpl>> m_textures; // demand-loaded textures, indexed by textureId
+    TextureTable m_textures;  // demand-loaded textures, indexed by textureId (null if destroyed)
     std::map<imageSource::ImageSource*, unsigned int> m_imageToTextureId;  // lookup from image* to textureId
+    // A destroyed texture, with the tickets of the requests that might still refer to it.
+    struct DestroyedTexture
+    {
+        std::unique_ptr<DemandTextureImpl> texture;
+        std::vector<Ticket>                tickets;
+    };
+    std::vector<DestroyedTexture> m_destroyedTextures;  // queued for release in the next launchPrepare
+    std::set<unsigned int> m_freeTextureIds;  // ids of destroyed textures, available for reuse
+    // Resources released by a launchPrepare.  Launches issued before it may still use them, so they
+    // are released once the event recorded after its pushMappings has completed.
+    struct PendingRelease
+    {
+        CUevent                                     event{};
+        std::vector<unsigned int>                   evictedTextureIds;
+        std::vector<DestroyedTexture>               destroyedTextures;  // reclaimed once their tickets are also done
+        std::vector<AtlasSlot>                      atlasSlots;
+        std::vector<SparseArrayPool::ReleasedArray> releasedArrays;  // unmapped once the tickets below are done
+        std::vector<Ticket>                         tickets;  // requests that might still map tiles into the released arrays
+        std::vector<SparseArrayPool::ReleasedArray> unmappedArrays;  // unmapped before the event was recorded
+    };
+    std::deque<PendingRelease> m_pendingReleases;  // in launchPrepare order
+    std::vector<PageMapping> m_deferredUnmaps;  // staged tiles whose blocks are freed once they are unmapped (see freeStagedTiles)
 
     SamplerRequestHandler m_samplerRequestHandler;  // Handles requests for texture samplers.
     CascadeRequestHandler m_cascadeRequestHandler;  // Handles cascading texture sizes.
@@ -214,14 +310,58 @@ class DemandLoaderImpl : public DemandLoader
 
     std::vector<std::unique_ptr<ResourceRequestHandler>> m_resourceRequestHandlers;  // Request handlers for arbitrary resources.
 
+    std::mutex                           m_textureGroupsMutex;  // Guards the texture groups pointer.
+    std::shared_ptr<const TextureGroups> m_textureGroups{ std::make_shared<const TextureGroups>() };  // Replaced on change.
+
     unsigned int m_ticketId{};
+    unsigned int m_numTextureEvictions{};  // Number of textures released by evictUnreferencedTextures
+    size_t       m_atlasMemoryCharged{};  // Atlas memory deducted from the memory available to tiles
 
-    // Unmap the backing storage associated with a texture tile or mip tail
-    void unmapTileResource( CUstream stream, unsigned int pageId );
+    // Unmap the backing storage associated with a texture tile or mip tail.  Returns false if the
+    // page is being refilled, in which case its block must not be freed yet.
+    bool unmapTileResource( CUstream stream, unsigned int pageId );
 
-    // Create a normal or variant version of a demand texture, based on the imageSource 
+    // Reserve the ids of a number of textures, reusing the ids of destroyed textures if possible.
+    // Each id must be passed to createTextureBody, in order (mutex acquired in caller)
+    std::vector<unsigned int> reserveTextureIds( unsigned int numTextures );
+
+    // Create a texture with an id from reserveTextureIds (mutex acquired in caller)
+    void createTextureBody( unsigned int textureId, std::shared_ptr<imageSource::ImageSource> imageSource, const TextureDescriptor& textureDesc );
+
+    // Create a normal or variant version of a demand texture, based on the imageSource
     DemandTextureImpl* makeTextureOrVariant( unsigned int textureId, const TextureDescriptor& textureDesc, std::shared_ptr<imageSource::ImageSource>& imageSource );
 
+    // Release the tiles and samplers of textures that have not been referenced in
+    // Options::maxUnreferencedLaunches launches.  The ids of the evicted textures are returned, so
+    // that their device textures can be released once the launches that might sample them are done.
+    void evictUnreferencedTextures( std::vector<unsigned int>& evictedTextureIds );
+
+    // Release the device textures and arrays of evicted textures that were not requested again (mutex acquired in caller)
+    void releaseEvictedTextures( const std::vector<unsigned int>& evictedTextureIds );
+
+    // Release the resources of pending releases whose events have completed.  Released sparse
+    // arrays are unmapped on the given stream, and returned in unmappedArrays so that they are
+    // recycled once the unmapping is done (mutex acquired in caller)
+    void releaseCompletedResources( CUstream stream, std::vector<SparseArrayPool::ReleasedArray>& unmappedArrays );
+
+    // Count the memory of the atlas pages against the max texture memory, by deducting it from the
+    // memory available to tiles (mutex acquired in caller)
+    void chargeAtlasMemory();
+
+    // Destroy a texture, which is reclaimed once the given tickets are done (mutex acquired in caller)
+    void destroyTextureBody( unsigned int textureId, const std::vector<Ticket>& tickets );
+
+    // Delete destroyed textures whose requests have been filled, and make their ids available for
+    // reuse.  The others are kept for a later launchPrepare (mutex acquired in caller)
+    void reclaimDestroyedTextures( std::vector<DestroyedTexture>& destroyedTextures );
+
+    // Get the residency of a texture (mutex acquired in caller)
+    TextureResidency getTextureResidency( unsigned int textureId );
+
+    // Remove a texture from its texture group, if any, replacing the texture groups (texture groups
+    // mutex acquired in caller)
+    void removeFromTextureGroup( unsigned int textureId );
+
     // Allocate pages for a number of textures (samplers and base colors)
     unsigned int allocateTexturePages( unsigned int numTextures );
 };
@@ -81,6 +81,18 @@ unsigned int DemandPageLoaderImpl::allocatePages( unsigned int numPages, bool ba
                     m_pageTableManager->reserveUnbackedPages( numPages, nullptr );
 }
 
+void DemandPageLoaderImpl::releasePages( unsigned int startPage, PageInvalidatorPredicate* predicate )
+{
+    SCOPED_NVTX_RANGE_FUNCTION_NAME();
+    std::unique_lock<std::mutex> lock( m_mutex );
+
+    // The page range is recycled by invalidatePages(), after its residual page table state has been
+    // invalidated.  Newly filled pages reset their LRU values, and reference bits are cleared on
+    // every pushMappings, so no other device state survives into the next reservation.
+    const unsigned int numPages = m_pageTableManager->releasePages( startPage );
+    m_releasedPages.push_back( InvalidationRange{startPage, startPage + numPages, predicate} );
+}
+
 void DemandPageLoaderImpl::setPageTableEntry( unsigned int pageId, bool evictable, unsigned long long pageTableEntry )
 {
     unsigned int lruVal = evictable ? 0U : NON_EVICTABLE_LRU_VAL;
@@ -92,12 +104,28 @@ bool DemandPageLoaderImpl::pushMappings( CUstream stream, DeviceContext& context
     SCOPED_NVTX_RANGE_FUNCTION_NAME();
     OTK_ASSERT_CONTEXT_MATCHES_STREAM( stream );
 
+    // Requests being filled might still map pages in the ranges released so far, so those ranges
+    // are held until the requests outstanding now are done.  Ranges released after the tickets are
+    // gathered wait for the next pushMappings.
+    size_t numReleased;
+    {
+        std::unique_lock<std::mutex> lock( m_mutex );
+        numReleased = m_releasedPages.size();
+    }
+    std::vector<Ticket> tickets;
+    if( numReleased > 0 && m_getOutstandingTickets )
+        tickets = m_getOutstandingTickets();
+
     // Get DeviceContext from pool and copy it to output parameter.
     {
         // allocate() is not thread safe
         std::unique_lock<std::mutex> lock( m_mutex );
-        context = *m_deviceMemoryManager.allocateDeviceContext();
-        invalidatePages( stream, context );
+        DeviceContext* pooledContext = m_deviceMemoryManager.allocateDeviceContext();
+
+        // Grow the device page arrays to cover the pages reserved so far.
+        m_deviceMemoryManager.reservePages( m_pageTableManager->getEndPage() );
+        context = *pooledContext;
+        invalidatePages( stream, context, numReleased, tickets );
     }
     context.requestIfResident = m_options->evictionActive;
 
@@ -105,7 +133,7 @@ bool DemandPageLoaderImpl::pushMappings( CUstream stream, DeviceContext& context
     return true;
 }
 
-void DemandPageLoaderImpl::invalidatePages( CUstream stream, DeviceContext& context )
+void DemandPageLoaderImpl::invalidatePages( CUstream stream, DeviceContext& context, size_t numReleased, const std::vector<Ticket>& tickets )
 {
     // Mutex acquired in caller
     for( InvalidationRange& ir : m_pagesToInvalidate )
@@ -114,6 +142,39 @@ void DemandPageLoaderImpl::invalidatePages( CUstream stream, DeviceContext& cont
         delete ir.predicate;
     }
     m_pagesToInvalidate.clear();
+
+    // Released page ranges are invalidated last, so that predicates queued for them (e.g. to migrate
+    // or free texture tiles) see their entries first.  Then they are held until they can be reused.
+    for( size_t i = 0; i < numReleased; ++i )
+    {
+        const InvalidationRange& ir = m_releasedPages[i];
+        m_pagingSystem.invalidatePages( ir.startPage, ir.endPage, nullptr, context, stream );
+        m_heldPages.push_back( HeldPageRange{ir, tickets} );
+    }
+    m_releasedPages.erase( m_releasedPages.begin(), m_releasedPages.begin() + numReleased );
+    recycleHeldPages( stream, context );
+}
+
+void DemandPageLoaderImpl::recycleHeldPages( CUstream stream, DeviceContext& context )
+{
+    // Mutex acquired in caller
+    for( auto it = m_heldPages.begin(); it != m_heldPages.end(); )
+    {
+        const std::vector<Ticket>& tickets = it->tickets;
+        if( std::any_of( tickets.begin(), tickets.end(), []( const Ticket& ticket ) { return ticket.numTasksRemaining() != 0; } ) )
+        {
+            ++it;
+            continue;
+        }
+
+        // Invalidate the pages mapped by requests that were filled after the range was invalidated.
+        const InvalidationRange& ir = it->range;
+        if( !tickets.empty() )
+            m_pagingSystem.invalidatePages( ir.startPage, ir.endPage, ir.predicate, context, stream );
+        delete ir.predicate;
+        m_pageTableManager->recycleReleasedPages( ir.startPage );
+        it = m_heldPages.erase( it );
+    }
 }
 
 void DemandPageLoaderImpl::pullRequests( CUstream stream, const DeviceContext& context, unsigned int id )
@@ -122,9 +183,11 @@ void DemandPageLoaderImpl::pullRequests( CUstream stream, const DeviceContext& c
     SCOPED_NVTX_RANGE_FUNCTION_NAME();
 
     // Pull requests from the device.  This launches a kernel on the given stream to scan the
-    // request bits, and copies the requested page ids to host memory asynchronously.
+    // request bits, and copies the requested page ids to host memory asynchronously.  Pages
+    // reserved since the device page arrays were last grown (in pushMappings) can't have been
+    // requested, and are beyond the end of the arrays.
     unsigned int  startPage = 0;
-    unsigned int  endPage   = m_pageTableManager->getEndPage();
+    unsigned int  endPage   = std::min( m_pageTableManager->getEndPage(), context.maxNumPages );
     m_pagingSystem.pullRequests( context, stream, id, startPage, endPage);
 
     std::unique_lock<std::mutex> lock( m_mutex );
@@ -152,16 +215,17 @@ class ResizeTilePoolPredicate : public PageInvalidatorPredicate
     unsigned int m_maxArenas;
 };
 
-void DemandPageLoaderImpl::setMaxTextureMemory( size_t maxMem )
+void DemandPageLoaderImpl::setMaxTextureMemory( size_t maxMem, size_t reservedMem )
 {
     std::unique_lock<std::mutex> lock( m_mutex );
     
     unsigned int tilesStartPage = m_options->numPageTableEntries;
     unsigned int tilesEndPage   = m_options->numPages;
-    size_t       maxArenas      = maxMem / m_deviceMemoryManager.getTilePoolArenaSize();
+    size_t       maxTileMem     = ( maxMem > reservedMem ) ? maxMem - reservedMem : 0;
+    size_t       maxArenas      = maxTileMem / m_deviceMemoryManager.getTilePoolArenaSize();
 
     // Resize, deleting tile arenas as needed
-    m_deviceMemoryManager.setMaxTextureTileMemory( maxMem );
+    m_deviceMemoryManager.setMaxTextureTileMemory( maxTileMem );
 
     // Schedule tiles from deleted arenas to be discarded
     ResizeTilePoolPredicate* predicate = new ResizeTilePoolPredicate( static_cast<unsigned int>( maxArenas ) );
@@ -74,6 +74,22 @@ class DemandPageLoaderImpl : public DemandPageLoader
     /// Allocate backed or unbacked pages
     unsigned int allocatePages( unsigned int numPages, bool backed ) override;
 
+    /// Release a range of pages.  They are invalidated in the next pushMappings, and recycled once
+    /// the requests that were outstanding then are done (see setOutstandingTicketsFunction).
+    void releasePages( unsigned int startPage ) override { releasePages( startPage, nullptr ); }
+
+    /// Release a range of pages.  When it is recycled, pages mapped by requests that were being filled
+    /// when it was released are invalidated with the given predicate, which is then deleted.
+    void releasePages( unsigned int startPage, PageInvalidatorPredicate* predicate );
+
+    /// Set a function that returns the tickets of the requests that are being filled.  Requests might
+    /// still map pages in a released range, so it is not recycled until they are done.  Without it,
+    /// released ranges are recycled in the next pushMappings.
+    void setOutstandingTicketsFunction( std::function<std::vector<Ticket>()> function )
+    {
+        m_getOutstandingTickets = std::move( function );
+    }
+
     /// Set the value of a single page table entry
     void setPageTableEntry( unsigned int pageId, bool evictable, unsigned long long pageTableEntry ) override;
 
@@ -101,7 +117,9 @@ class DemandPageLoaderImpl : public DemandPageLoader
     /// Get the PagingSystem for the current CUDA context.
     PagingSystem* getPagingSystem() { return &m_pagingSystem; };
 
-    void setMaxTextureMemory( size_t maxMem );
+    /// Set the max texture memory.  The reserved memory, which is used by textures outside the tile
+    /// pool (e.g. the texture atlas), is deducted from the memory available to tiles.
+    void setMaxTextureMemory( size_t maxMem, size_t reservedMem = 0 );
 
     void invalidatePageRange( unsigned int startPage, unsigned int endPage, PageInvalidatorPredicate* predicate );
 
@@ -121,6 +139,17 @@ class DemandPageLoaderImpl : public DemandPageLoader
         PageInvalidatorPredicate* predicate;
     };
     std::vector<InvalidationRange> m_pagesToInvalidate;
+    std::vector<InvalidationRange> m_releasedPages;
+
+    // A released page range that has been invalidated, held until the tickets of the requests that
+    // were outstanding when it was released are done.
+    struct HeldPageRange
+    {
+        InvalidationRange   range;
+        std::vector<Ticket> tickets;
+    };
+    std::vector<HeldPageRange>           m_heldPages;
+    std::function<std::vector<Ticket>()> m_getOutstandingTickets;
 
     std::shared_ptr<PageTableManager> m_pageTableManager;  // Allocates ranges of virtual pages.
     RequestProcessor*   m_requestProcessor;  // Processes page requests.
@@ -132,8 +161,12 @@ class DemandPageLoaderImpl : public DemandPageLoader
     double m_totalProcessingTime{};
 
 
-    // Invalidate the pages for current device in m_pagesToInvalidate
-    void invalidatePages( CUstream stream, DeviceContext& context );
+    // Invalidate the pages for current device in m_pagesToInvalidate, and the first numReleased
+    // ranges in m_releasedPages, holding them until the given tickets are done.
+    void invalidatePages( CUstream stream, DeviceContext& context, size_t numReleased, const std::vector<Ticket>& tickets );
+
+    // Recycle the held page ranges whose requests are done.
+    void recycleHeldPages( CUstream stream, DeviceContext& context );
 };
 
 }  // namespace demandLoading
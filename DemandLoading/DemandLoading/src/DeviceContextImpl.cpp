@@ -28,6 +28,8 @@
 
 #include "DeviceContextImpl.h"
 
+#include <algorithm>
+
 using namespace otk;
 
 namespace demandLoading {
@@ -41,6 +43,41 @@ inline Type* allocItems( MemoryPool<DeviceAllocator, HeapSuballocator>* memPool,
     return reinterpret_cast<Type*>( block.ptr );
 }
 
+// Replace the given block with a larger zeroed block, copying its contents.
+inline MemoryBlockDesc growBlock( MemoryPool<DeviceAllocator, HeapSuballocator>* memPool,
+                                  const MemoryBlockDesc&                          oldBlock,
+                                  size_t                                          oldSize,
+                                  size_t                                          newSize,
+                                  size_t                                          alignment )
+{
+    MemoryBlockDesc newBlock = memPool->alloc( newSize, alignment );
+    OTK_ERROR_CHECK( cuMemsetD8( static_cast<CUdeviceptr>( newBlock.ptr ), 0, newSize ) );
+    if( oldSize > 0 )
+    {
+        OTK_ERROR_CHECK( cuMemcpyDtoD( static_cast<CUdeviceptr>( newBlock.ptr ), static_cast<CUdeviceptr>( oldBlock.ptr ), oldSize ) );
+        memPool->free( oldBlock );
+    }
+    return newBlock;
+}
+
+inline size_t bitVectorSize( unsigned int numPages )
+{
+    return idivCeil( numPages, 32 ) * sizeof( unsigned int );
+}
+
+// Half byte per page (8 pages per int32)
+inline size_t lruTableSize( unsigned int numPages )
+{
+    return idivCeil( numPages, 8 ) * sizeof( unsigned int );
+}
+
+unsigned int DeviceContextImpl::getPageCapacity( unsigned int numPages, unsigned int currentCapacity, const Options& options )
+{
+    size_t capacity = std::max( static_cast<size_t>( std::max( numPages, 1U ) ), 2 * static_cast<size_t>( currentCapacity ) );
+    capacity        = idivCeil( capacity, PAGE_CAPACITY_CHUNK ) * PAGE_CAPACITY_CHUNK;
+    return static_cast<unsigned int>( std::min( capacity, static_cast<size_t>( options.numPages ) ) );
+}
+
 void DeviceContextImpl::allocatePerDeviceData( MemoryPool<DeviceAllocator, HeapSuballocator>* memPool, const Options& options )
 {
     // Note: We allocate only enough room in the device-side page table for the texture samplers
@@ -49,17 +86,37 @@ void DeviceContextImpl::allocatePerDeviceData( MemoryPool<DeviceAllocator, HeapS
 
     pageTable.data     = allocItems<unsigned long long>( memPool, options.numPageTableEntries );
     pageTable.capacity = options.numPageTableEntries;
-    maxNumPages        = options.numPages;
+    maxNumPages        = 0;
     maxTextures        = options.maxTextures;
 
-    const unsigned int sizeofResidenceBitsInInts = ( options.numPages + 31 ) / 32;
-    residenceBits = allocItems<unsigned int>( memPool, sizeofResidenceBitsInInts, BIT_VECTOR_ALIGNMENT );
-
-    // Allocate half byte per page (8 pages per int32)
-    const unsigned int sizeofLruTableInInts = options.useLruTable ? ( options.numPages + 7 ) / 8 : 0; 
-    lruTable = allocItems<unsigned int>( memPool, sizeofLruTableInInts );
+    // The residence bits and LRU table start with a single chunk of pages, and grow as pages are
+    // reserved.  This keeps startup fast and memory use low for small scenes.
+    growPerDeviceData( memPool, options, getPageCapacity( 0, 0, options ) );
 
     OTK_ASSERT( isAligned( pageTable.data, alignof( unsigned long long ) ) );
+}
+
+void DeviceContextImpl::growPerDeviceData( MemoryPool<DeviceAllocator, HeapSuballocator>* memPool, const Options& options, unsigned int numPages )
+{
+    if( numPages <= maxNumPages )
+        return;
+
+    m_residenceBitsBlock = growBlock( memPool, m_residenceBitsBlock, bitVectorSize( maxNumPages ),
+                                      bitVectorSize( numPages ), BIT_VECTOR_ALIGNMENT );
+    residenceBits = reinterpret_cast<unsigned int*>( m_residenceBitsBlock.ptr );
+
+    if( options.useLruTable )
+    {
+        m_lruTableBlock = growBlock( memPool, m_lruTableBlock, lruTableSize( maxNumPages ),
+                                     lruTableSize( numPages ), alignof( unsigned int ) );
+        lruTable = reinterpret_cast<unsigned int*>( m_lruTableBlock.ptr );
+    }
+    else
+    {
+        lruTable = nullptr;
+    }
+    maxNumPages = numPages;
+
     OTK_ASSERT( isAligned( residenceBits, BIT_VECTOR_ALIGNMENT ) );
     OTK_ASSERT( isAligned( lruTable, alignof( unsigned int ) ) );
 }
@@ -75,8 +132,8 @@ void DeviceContextImpl::setPerDeviceData( const DeviceContext& other )
 
 void DeviceContextImpl::allocatePerStreamData( MemoryPool<DeviceAllocator, HeapSuballocator>* memPool, const Options& options )
 {
-    const unsigned int sizeofReferenceBitsInInts = ( options.numPages + 31 ) / 32;
-    referenceBits = allocItems<unsigned int>( memPool, sizeofReferenceBitsInInts, BIT_VECTOR_ALIGNMENT );
+    // Reference bits match the capacity of the per-device data, which must already be set.
+    growPerStreamData( memPool );
 
     requestedPages.data     = allocItems<unsigned int>( memPool, options.maxRequestedPages );
     requestedPages.capacity = options.maxRequestedPages;
@@ -96,7 +153,6 @@ void DeviceContextImpl::allocatePerStreamData( MemoryPool<DeviceAllocator, HeapS
     invalidatedPages.data     = allocItems<unsigned int>( memPool, options.maxInvalidatedPages );
     invalidatedPages.capacity = options.maxInvalidatedPages;
 
-    OTK_ASSERT( isAligned( referenceBits, BIT_VECTOR_ALIGNMENT ) );
     OTK_ASSERT( isAligned( requestedPages.data, alignof( unsigned int ) ) );
     OTK_ASSERT( isAligned( stalePages.data, alignof( StalePage ) ) );
     OTK_ASSERT( isAligned( evictablePages.data, alignof( unsigned int ) ) );
@@ -105,4 +161,17 @@ void DeviceContextImpl::allocatePerStreamData( MemoryPool<DeviceAllocator, HeapS
     OTK_ASSERT( isAligned( invalidatedPages.data, alignof( unsigned int ) ) );
 }
 
+void DeviceContextImpl::growPerStreamData( MemoryPool<DeviceAllocator, HeapSuballocator>* memPool )
+{
+    if( maxNumPages <= m_referenceBitsCapacity )
+        return;
+
+    m_referenceBitsBlock = growBlock( memPool, m_referenceBitsBlock, bitVectorSize( m_referenceBitsCapacity ),
+                                      bitVectorSize( maxNumPages ), BIT_VECTOR_ALIGNMENT );
+    referenceBits           = reinterpret_cast<unsigned int*>( m_referenceBitsBlock.ptr );
+    m_referenceBitsCapacity = maxNumPages;
+
+    OTK_ASSERT( isAligned( referenceBits, BIT_VECTOR_ALIGNMENT ) );
+}
+
 }  // namespace demandLoading
@@ -30,6 +30,7 @@
 
 #include <OptiXToolkit/Memory/Allocators.h>
 #include <OptiXToolkit/Memory/HeapSuballocator.h>
+#include <OptiXToolkit/Memory/MemoryBlockDesc.h>
 #include <OptiXToolkit/Memory/MemoryPool.h>
 #include "Util/Math.h"
 
@@ -42,6 +43,8 @@ namespace demandLoading {
 /// DeviceContextImpl encapsulates per-stream device memory allocation logic.
 /// Note that the TextureSampler array and the CUtexObjectArray members of
 /// DeviceContext are pointers to device memory allocated by ExtensibleArray.
+/// The residence bits, LRU table, and reference bits start small and grow in chunks
+/// as pages are reserved (see DeviceMemoryManager::reservePages).
 class DeviceContextImpl : public DeviceContext
 {
   public:
@@ -69,8 +72,28 @@ class DeviceContextImpl : public DeviceContext
     /// Allocate memory for this context in the given BulkDeviceMemory.  Must be preceded by a matching call to reserve().
     void allocatePerStreamData( otk::MemoryPool<otk::DeviceAllocator, otk::HeapSuballocator>* memPool, const Options& options );
 
+    /// Grow the per-device residence bits and LRU table to hold the given number of pages,
+    /// preserving their contents.  The device must be idle.
+    void growPerDeviceData( otk::MemoryPool<otk::DeviceAllocator, otk::HeapSuballocator>* memPool,
+                            const Options&                                                 options,
+                            unsigned int                                                   numPages );
+
+    /// Grow the per-stream reference bits to maxNumPages, preserving their contents.  The device
+    /// must be idle.
+    void growPerStreamData( otk::MemoryPool<otk::DeviceAllocator, otk::HeapSuballocator>* memPool );
+
+    /// Return the page capacity to allocate for the given number of pages.  Capacity grows
+    /// geometrically in whole chunks, up to Options::numPages.
+    static unsigned int getPageCapacity( unsigned int numPages, unsigned int currentCapacity, const Options& options );
+
   private:
     static const unsigned int BIT_VECTOR_ALIGNMENT = 128;
+    static const unsigned int PAGE_CAPACITY_CHUNK  = 1024 * 1024;
+
+    otk::MemoryBlockDesc m_residenceBitsBlock{};
+    otk::MemoryBlockDesc m_lruTableBlock{};
+    otk::MemoryBlockDesc m_referenceBitsBlock{};
+    unsigned int         m_referenceBitsCapacity = 0;
 
     static bool isAligned( void* ptr, size_t alignment ) { return reinterpret_cast<uintptr_t>( ptr ) % alignment == 0; }
 };
@@ -39,6 +39,7 @@ DeviceMemoryManager::DeviceMemoryManager( std::shared_ptr<Options> options )
     : m_options( options )
     , m_samplerPool( new DeviceAllocator(), new FixedSuballocator( sizeof( TextureSampler ), alignof( TextureSampler ) ), SAMPLER_POOL_ALLOC_SIZE )
     , m_deviceContextMemory( new DeviceAllocator(), nullptr )
+    , m_udimSlotMemory( new DeviceAllocator(), nullptr )
     , m_tilePool( new TextureTileAllocator(),
                   new HeapSuballocator(),
                   TextureTileAllocator::getRecommendedAllocationSize(),
@@ -79,6 +80,44 @@ DeviceContext* DeviceMemoryManager::allocateDeviceContext()
     return context;
 }
 
+void DeviceMemoryManager::reservePages( unsigned int numPages )
+{
+    if( m_deviceContextPool.empty() || numPages <= m_deviceContextPool[0]->maxNumPages )
+        return;
+
+    // Kernels in flight might be using the current arrays, which are freed when they are replaced.
+    OTK_ERROR_CHECK( cuCtxSynchronize() );
+
+    DeviceContextImpl* deviceContext = static_cast<DeviceContextImpl*>( m_deviceContextPool[0] );
+    const unsigned int capacity = DeviceContextImpl::getPageCapacity( numPages, deviceContext->maxNumPages, *m_options );
+    deviceContext->growPerDeviceData( &m_deviceContextMemory, *m_options, capacity );
+
+    for( DeviceContext* context : m_deviceContextPool )
+    {
+        DeviceContextImpl* contextImpl = static_cast<DeviceContextImpl*>( context );
+        contextImpl->setPerDeviceData( *deviceContext );
+        contextImpl->growPerStreamData( &m_deviceContextMemory );
+    }
+}
+
+const unsigned int* DeviceMemoryManager::allocateUdimSlots( const std::vector<unsigned int>& slots )
+{
+    const size_t    numBytes = slots.size() * sizeof( unsigned int );
+    MemoryBlockDesc block    = m_udimSlotMemory.alloc( numBytes, alignof( unsigned int ) );
+    OTK_ERROR_CHECK( cuMemcpyHtoD( static_cast<CUdeviceptr>( block.ptr ), slots.data(), numBytes ) );
+    const unsigned int* udimSlots = reinterpret_cast<const unsigned int*>( block.ptr );
+    m_udimSlotBlocks[udimSlots]   = block;
+    return udimSlots;
+}
+
+void DeviceMemoryManager::freeUdimSlots( const unsigned int* udimSlots )
+{
+    auto it = m_udimSlotBlocks.find( udimSlots );
+    OTK_ASSERT_MSG( it != m_udimSlotBlocks.end(), "Freeing unknown udim slot index" );
+    m_udimSlotMemory.free( it->second );
+    m_udimSlotBlocks.erase( it );
+}
+
 void DeviceMemoryManager::freeDeviceContext( DeviceContext* context )
 {
     // The pool index is recorded to permit a copied DeviceContext to be returned to the pool.
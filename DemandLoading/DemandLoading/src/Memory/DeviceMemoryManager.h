@@ -29,6 +29,7 @@
 #pragma once
 
 #include <cstddef>
+#include <map>
 #include <vector>
 
 #include <OptiXToolkit/Memory/Allocators.h>
@@ -42,6 +43,8 @@
 #include <OptiXToolkit/DemandLoading/Statistics.h>
 #include <OptiXToolkit/DemandLoading/TextureSampler.h>
 
+#include "Memory/TileDeduplicator.h"
+
 #include <memory>
 
 namespace demandLoading {
@@ -57,15 +60,32 @@ class DeviceMemoryManager
     /// Free a DeviceContext for this device.
     void freeDeviceContext( DeviceContext* context );
 
+    /// Grow the page arrays of all DeviceContexts (residence bits, LRU table, and reference bits) to
+    /// hold at least the given number of pages.  Synchronizes the current CUDA context when the
+    /// arrays grow, which happens rarely since capacity grows geometrically.
+    void reservePages( unsigned int numPages );
+
     /// Allocate a Sampler for this device.
     TextureSampler* allocateSampler() { return reinterpret_cast<TextureSampler*>( m_samplerPool.allocItem() ); }
     /// Free a Sampler for this device.
     void freeSampler( TextureSampler* sampler ) { m_samplerPool.freeItem( reinterpret_cast<uint64_t>( sampler ) ); }
 
+    /// Allocate the sorted slot index of a sparse udim texture in device memory, and copy the slots to it.
+    const unsigned int* allocateUdimSlots( const std::vector<unsigned int>& slots );
+    /// Free the slot index of a sparse udim texture, once device code no longer refers to it.
+    void freeUdimSlots( const unsigned int* udimSlots );
+
     /// Allocate a TileBlock for this device.
     otk::TileBlockHandle allocateTileBlock( size_t numBytes ) { return m_tilePool.allocTextureTiles( numBytes ); }
-    /// Free a TileBlock for this device.
-    void freeTileBlock( const otk::TileBlockDesc& blockDesc ) { m_tilePool.freeTextureTiles( blockDesc ); }
+    /// Free a TileBlock for this device.  A block shared by deduplicated tiles is only returned to
+    /// the pool when its last reference is freed.
+    void freeTileBlock( const otk::TileBlockDesc& blockDesc )
+    {
+        if( m_tileDeduplicator.release( blockDesc.data ) )
+            m_tilePool.freeTextureTiles( blockDesc );
+    }
+    /// Get the table of tile blocks shared by tiles with identical contents.
+    TileDeduplicator* getTileDeduplicator() { return &m_tileDeduplicator; }
     /// Get the memory handle associated with the tileBlock.
     CUmemGenericAllocationHandle getTileBlockHandle( const otk::TileBlockDesc& bh )
     {
@@ -82,12 +102,22 @@ class DeviceMemoryManager
     /// Returns the arena size for m_tilePool.
     size_t getTilePoolArenaSize() const { return static_cast<size_t>( m_tilePool.allocationGranularity() ); }
     /// Set the max texture memory
-    void setMaxTextureTileMemory( size_t maxMemory ) { m_tilePool.setMaxSize( static_cast<uint64_t>( maxMemory ) ); }
+    void setMaxTextureTileMemory( size_t maxMemory )
+    {
+        m_tilePool.setMaxSize( static_cast<uint64_t>( maxMemory ) );
+
+        // Blocks in discarded arenas can no longer be shared, but are freed as usual when released.
+        const size_t maxArenas = maxMemory / getTilePoolArenaSize();
+        m_tileDeduplicator.unshareBlocks( [maxArenas]( unsigned long long block ) {
+            return otk::TileBlockDesc( block ).arenaId >= maxArenas;
+        } );
+    }
 
     /// Returns the amount of device memory allocated.
     size_t getTotalDeviceMemory() const
     {
-        return m_samplerPool.trackedSize() + m_deviceContextMemory.trackedSize() + m_tilePool.trackedSize();
+        return m_samplerPool.trackedSize() + m_deviceContextMemory.trackedSize() + m_udimSlotMemory.trackedSize()
+               + m_tilePool.trackedSize();
     }
 
   private:
@@ -95,7 +125,10 @@ class DeviceMemoryManager
 
     otk::MemoryPool<otk::DeviceAllocator, otk::FixedSuballocator>     m_samplerPool;
     otk::MemoryPool<otk::DeviceAllocator, otk::HeapSuballocator>      m_deviceContextMemory;
+    otk::MemoryPool<otk::DeviceAllocator, otk::HeapSuballocator>      m_udimSlotMemory;
     otk::MemoryPool<otk::TextureTileAllocator, otk::HeapSuballocator> m_tilePool;
+    TileDeduplicator                                                  m_tileDeduplicator;
+    std::map<const unsigned int*, otk::MemoryBlockDesc>               m_udimSlotBlocks;  // Blocks of udim slot indices, by address.
 
     std::vector<DeviceContext*> m_deviceContextPool;
     std::vector<DeviceContext*> m_deviceContextFreeList;
@@ -0,0 +1,193 @@
+//
+// Copyright (c) 2024, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <mutex>
+
+namespace demandLoading {
+
+/// TileDeduplicator lets texture tiles with identical contents share a tile block.  Tiles are
+/// identified by a 64-bit hash of their contents, seeded with the tile layout, and each shared
+/// block is reference counted so that it is only returned to the tile pool when the last page
+/// mapped to it is evicted.  Blocks are identified by their TileBlockDesc bits.  Thread safe.
+class TileDeduplicator
+{
+  public:
+    /// Hash the contents of a tile.  The seed should distinguish tile layouts (format, number of
+    /// channels and tile dimensions), since identical bytes in different layouts differ on the device.
+    static uint64_t hashTile( const char* data, size_t size, uint64_t seed )
+    {
+        const uint64_t k1 = 0x9E3779B97F4A7C15ULL;
+        const uint64_t k2 = 0xC2B2AE3D27D4EB4FULL;
+
+        uint64_t h = seed ^ ( size * k1 );
+        size_t   i = 0;
+        for( ; i + sizeof( uint64_t ) <= size; i += sizeof( uint64_t ) )
+        {
+            uint64_t word;
+            memcpy( &word, data + i, sizeof( uint64_t ) );
+            h ^= rotl( word * k2, 31 ) * k1;
+            h = rotl( h, 27 ) * k1 + 0x52DCE729;
+        }
+        for( ; i < size; ++i )
+            h = ( h ^ static_cast<unsigned char>( data[i] ) ) * k1;
+
+        // Final avalanche (from MurmurHash3)
+        h ^= h >> 33;
+        h *= 0xFF51AFD7ED558CCDULL;
+        h ^= h >> 33;
+        h *= 0xC4CEB9FE1A85EC53ULL;
+        h ^= h >> 33;
+        return h;
+    }
+
+    /// Hash the numRows x rowSize region of a tile whose rows are rowPitch bytes apart, ignoring the
+    /// rest of each row, which is not filled for tiles at the edges of a level.
+    static uint64_t hashRegion( const char* data, size_t rowSize, unsigned int numRows, size_t rowPitch, uint64_t seed )
+    {
+        if( rowSize == rowPitch )
+            return hashTile( data, rowSize * numRows, seed );
+
+        uint64_t h = seed;
+        for( unsigned int y = 0; y < numRows; ++y )
+            h = hashTile( data + y * rowPitch, rowSize, h );
+        return h;
+    }
+
+    /// Return true if every pixel in the width x height region of a tile equals the first pixel.
+    static bool isConstantTile( const char* data, unsigned int width, unsigned int height, size_t rowPitch, unsigned int pixelSize )
+    {
+        for( unsigned int y = 0; y < height; ++y )
+        {
+            const char* row = data + y * rowPitch;
+            for( unsigned int x = ( y == 0 ) ? 1 : 0; x < width; ++x )
+            {
+                if( memcmp( row + x * pixelSize, data, pixelSize ) != 0 )
+                    return false;
+            }
+        }
+        return true;
+    }
+
+    /// Look for a block holding a tile with the given hash.  If one is found, a reference to it is
+    /// acquired and true is returned.
+    bool acquire( uint64_t hash, unsigned long long& block )
+    {
+        std::unique_lock<std::mutex> lock( m_mutex );
+        auto it = m_hashToBlock.find( hash );
+        if( it == m_hashToBlock.end() )
+            return false;
+        block = it->second;
+        ++m_blocks[block].refCount;
+        ++m_numDeduplicatedTiles;
+        return true;
+    }
+
+    /// Record that the given newly filled block holds a tile with the given hash.  Does nothing if
+    /// another block already holds the tile (which can happen when identical tiles are filled
+    /// concurrently), in which case the block is simply not shared.
+    void insert( uint64_t hash, unsigned long long block )
+    {
+        std::unique_lock<std::mutex> lock( m_mutex );
+        if( m_hashToBlock.find( hash ) != m_hashToBlock.end() || m_blocks.find( block ) != m_blocks.end() )
+            return;
+        m_hashToBlock[hash] = block;
+        m_blocks[block]     = BlockInfo{hash, 1};
+    }
+
+    /// Return true if the block is mapped to more than one page.
+    bool isShared( unsigned long long block ) const
+    {
+        std::unique_lock<std::mutex> lock( m_mutex );
+        auto it = m_blocks.find( block );
+        return it != m_blocks.end() && it->second.refCount > 1;
+    }
+
+    /// Release a reference to a block.  Returns true if the block is no longer referenced and
+    /// should be returned to the tile pool (including blocks that were never shared).
+    bool release( unsigned long long block )
+    {
+        std::unique_lock<std::mutex> lock( m_mutex );
+        auto it = m_blocks.find( block );
+        if( it == m_blocks.end() )
+            return true;
+        if( --it->second.refCount > 0 )
+            return false;
+
+        // The hash might map to another block if this one was unshared.
+        auto hashIt = m_hashToBlock.find( it->second.hash );
+        if( hashIt != m_hashToBlock.end() && hashIt->second == block )
+            m_hashToBlock.erase( hashIt );
+        m_blocks.erase( it );
+        return true;
+    }
+
+    /// Stop sharing the blocks for which the predicate returns true, e.g. blocks in discarded arenas.
+    /// Pages already mapped to such a block keep their references, so the block is still freed only
+    /// when the last of them is released.
+    template <class Predicate>
+    void unshareBlocks( Predicate predicate )
+    {
+        std::unique_lock<std::mutex> lock( m_mutex );
+        for( auto it = m_hashToBlock.begin(); it != m_hashToBlock.end(); )
+        {
+            if( predicate( it->second ) )
+                it = m_hashToBlock.erase( it );
+            else
+                ++it;
+        }
+    }
+
+    /// Get the number of tiles that were mapped to an existing block instead of being filled.
+    size_t getNumDeduplicatedTiles() const
+    {
+        std::unique_lock<std::mutex> lock( m_mutex );
+        return m_numDeduplicatedTiles;
+    }
+
+  private:
+    struct BlockInfo
+    {
+        uint64_t     hash;
+        unsigned int refCount;
+    };
+
+    mutable std::mutex                       m_mutex;
+    std::map<uint64_t, unsigned long long>   m_hashToBlock;
+    std::map<unsigned long long, BlockInfo>  m_blocks;
+    size_t                                   m_numDeduplicatedTiles = 0;
+
+    static uint64_t rotl( uint64_t x, int r ) { return ( x << r ) | ( x >> ( 64 - r ) ); }
+};
+
+}  // namespace demandLoading
@@ -33,7 +33,12 @@
 #include <OptiXToolkit/Error/cuErrorCheck.h>
 
 #include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <iterator>
 #include <limits>
+#include <map>
+#include <memory>
 #include <mutex>
 #include <vector>
 
@@ -42,8 +47,11 @@ namespace demandLoading {
 class RequestHandler;
 
 /// The PageTableManager is used to reserve a contiguous range of page table entries.  It keeps a
-/// mapping that allows the request handler corresponding to a page table entry to be determined in
-/// log(N) time.
+/// two-level radix table that allows the request handler corresponding to a page table entry to be
+/// determined in constant time without locking.  Reservations are serialized by a mutex, and publish
+/// their changes to the radix table with release stores, so concurrent lookups always observe either
+/// the old or the new handler for a page.  Released page ranges are coalesced and reused by later
+/// reservations.
 class PageTableManager
 {
   public:
@@ -51,19 +59,23 @@ class PageTableManager
         : m_totalPages( totalPages )
         , m_backedPages( backedPages )
         , m_nextUnbackedPage( backedPages )
+        , m_numDirEntries( ( static_cast<size_t>( totalPages ) + LEAF_SIZE - 1 ) >> LEAF_BITS )
+        , m_directory( new std::atomic<std::uintptr_t>[m_numDirEntries] )
     {
+        for( size_t i = 0; i < m_numDirEntries; ++i )
+            m_directory[i].store( 0, std::memory_order_relaxed );
     }
 
     unsigned int getAvailableBackedPages() const
     {
         std::unique_lock<std::mutex> lock( m_mutex );
-        return m_backedPages - m_nextBackedPage;
+        return m_backedPages - m_nextBackedPage + m_freeBackedRanges.numPages;
     }
 
     unsigned int getAvailableUnbackedPages() const 
     {
         std::unique_lock<std::mutex> lock( m_mutex );
-        return m_totalPages - m_nextUnbackedPage;
+        return m_totalPages - m_nextUnbackedPage + m_freeUnbackedRanges.numPages;
     }
 
     /// Return the end page (one past the last used page).
@@ -78,32 +90,44 @@ class PageTableManager
     unsigned int reserveBackedPages( unsigned int numPages, RequestHandler* handler ) 
     {
         std::unique_lock<std::mutex> lock( m_mutex );
-        OTK_ASSERT_MSG( m_nextBackedPage + numPages <= m_backedPages,
-                           "Insufficient backed pages in demand loading page table" );
-
-        return insertPageMapping( m_nextBackedPage, numPages, handler );
+        unsigned int firstPage;
+        if( !m_freeBackedRanges.allocate( numPages, firstPage ) )
+        {
+            OTK_ASSERT_MSG( m_nextBackedPage + numPages <= m_backedPages,
+                               "Insufficient backed pages in demand loading page table" );
+            firstPage = m_nextBackedPage;
+            m_nextBackedPage += numPages;
+        }
+        return insertPageMapping( firstPage, numPages, handler );
     }
 
     /// Reserve unbacked pages (pages with no backing storage on the device).
     unsigned int reserveUnbackedPages( unsigned int numPages, RequestHandler* handler )
     {
         std::unique_lock<std::mutex> lock( m_mutex );
-        OTK_ASSERT_MSG( m_nextUnbackedPage + numPages <= m_totalPages, 
-                           "Insufficient unbacked pages in demand loading page table" );
-
-        return insertPageMapping( m_nextUnbackedPage, numPages, handler );
+        unsigned int firstPage;
+        if( !m_freeUnbackedRanges.allocate( numPages, firstPage ) )
+        {
+            OTK_ASSERT_MSG( m_nextUnbackedPage + numPages <= m_totalPages, 
+                               "Insufficient unbacked pages in demand loading page table" );
+            firstPage = m_nextUnbackedPage;
+            m_nextUnbackedPage += numPages;
+        }
+        return insertPageMapping( firstPage, numPages, handler );
     }
 
     /// Find the request handler associated with the specified page.  Returns nullptr if not found.
+    /// Lock-free; safe to call concurrently with reservations.
     RequestHandler* getRequestHandler( unsigned int pageId ) const
     {
-        std::unique_lock<std::mutex> lock( m_mutex );
-        // Pages are allocated in increasing order, so the array of mappings is sorted, allowing us
-        // to use binary search to find the the given page id.
-        const auto least =
-            std::lower_bound( m_mappings.cbegin(), m_mappings.cend(), pageId,
-                              []( const PageMapping& entry, unsigned int id ) { return id > entry.lastPage; } );
-        return least != m_mappings.cend() ? least->handler : nullptr;
+        if( pageId >= m_totalPages )
+            return nullptr;
+
+        const std::uintptr_t dirEntry = m_directory[pageId >> LEAF_BITS].load( std::memory_order_acquire );
+        if( dirEntry & WHOLE_LEAF_TAG )
+            return reinterpret_cast<RequestHandler*>( dirEntry & ~WHOLE_LEAF_TAG );
+        const Leaf* leaf = reinterpret_cast<const Leaf*>( dirEntry );
+        return leaf ? leaf->handlers[pageId & LEAF_MASK].load( std::memory_order_acquire ) : nullptr;
     }
 
     void removeRequestHandler( unsigned int pageId ) 
@@ -111,14 +135,57 @@ class PageTableManager
         std::unique_lock<std::mutex> lock( m_mutex );
 
         const auto least =
-            std::lower_bound( m_mappings.cbegin(), m_mappings.cend(), pageId,
+            std::lower_bound( m_mappings.begin(), m_mappings.end(), pageId,
                               []( const PageMapping& entry, unsigned int id ) { return id > entry.lastPage; } );
 
-        OTK_ASSERT_MSG( least != m_mappings.cend(), 
+        OTK_ASSERT_MSG( least != m_mappings.end() && pageId >= least->firstPage,
                            "Trying to replace nonexistent request handler" );
         
-        size_t idx = least - m_mappings.begin();
-        m_mappings[idx] = PageMapping{ least->firstPage, least->lastPage, &m_nullHandler };
+        least->handler = &m_nullHandler;
+        publishRange( least->firstPage, least->lastPage, &m_nullHandler );
+    }
+
+    /// Release the range of pages containing the specified page.  Lookups of its pages return a null
+    /// handler, so that stale requests are ignored.  The range is not reused until recycleReleasedPages() is called, which gives the
+    /// caller a chance to invalidate any residual page table state first.  Returns the number of pages
+    /// in the released range.
+    unsigned int releasePages( unsigned int pageId )
+    {
+        std::unique_lock<std::mutex> lock( m_mutex );
+
+        const auto least =
+            std::lower_bound( m_mappings.begin(), m_mappings.end(), pageId,
+                              []( const PageMapping& entry, unsigned int id ) { return id > entry.lastPage; } );
+
+        OTK_ASSERT_MSG( least != m_mappings.end() && pageId >= least->firstPage,
+                           "Trying to release nonexistent page range" );
+
+        const PageMapping mapping = *least;
+        m_mappings.erase( least );
+        publishRange( mapping.firstPage, mapping.lastPage, &m_nullHandler );
+        m_releasedRanges.push_back( mapping );
+        return mapping.lastPage - mapping.firstPage + 1;
+    }
+
+    /// Make the ranges released since the last call available for reservation again, coalescing
+    /// them with adjacent free ranges.
+    void recycleReleasedPages()
+    {
+        std::unique_lock<std::mutex> lock( m_mutex );
+        for( const PageMapping& range : m_releasedRanges )
+            recycleRange( range );
+        m_releasedRanges.clear();
+    }
+
+    /// Make the released range starting at the given page available for reservation again.
+    void recycleReleasedPages( unsigned int firstPage )
+    {
+        std::unique_lock<std::mutex> lock( m_mutex );
+        auto it = std::find_if( m_releasedRanges.begin(), m_releasedRanges.end(),
+                                [firstPage]( const PageMapping& range ) { return range.firstPage == firstPage; } );
+        OTK_ASSERT_MSG( it != m_releasedRanges.end(), "Trying to recycle a page range that was not released" );
+        recycleRange( *it );
+        m_releasedRanges.erase( it );
     }
 
   private:
@@ -129,9 +196,97 @@ class PageTableManager
         RequestHandler* handler;
     };
 
-    unsigned int insertPageMapping( unsigned int& nextPage, unsigned int numPages, RequestHandler* handler )
+    // Each directory entry covers LEAF_SIZE pages.  An entry is either zero (no pages reserved), a
+    // pointer to a Leaf holding one handler per page, or a handler pointer tagged with WHOLE_LEAF_TAG
+    // when a single range covers every page of the leaf, which keeps large reservations compact.
+    static const unsigned int   LEAF_BITS      = 12;
+    static const unsigned int   LEAF_SIZE      = 1u << LEAF_BITS;
+    static const unsigned int   LEAF_MASK      = LEAF_SIZE - 1;
+    static const std::uintptr_t WHOLE_LEAF_TAG = 1;
+
+    struct Leaf
+    {
+        std::atomic<RequestHandler*> handlers[LEAF_SIZE];
+
+        explicit Leaf( RequestHandler* handler )
+        {
+            for( std::atomic<RequestHandler*>& entry : handlers )
+                entry.store( handler, std::memory_order_relaxed );
+        }
+    };
+
+    // Free page ranges, keyed by first page and coalesced on release.
+    struct FreeRangeList
+    {
+        std::map<unsigned int, unsigned int> ranges;  // firstPage -> numPages
+        unsigned int                         numPages = 0;
+
+        // Take numPages from the smallest free range that can hold them.  Returns false if none can.
+        bool allocate( unsigned int count, unsigned int& firstPage )
+        {
+            auto best = ranges.end();
+            for( auto it = ranges.begin(); it != ranges.end(); ++it )
+            {
+                if( it->second >= count && ( best == ranges.end() || it->second < best->second ) )
+                {
+                    best = it;
+                    if( it->second == count )
+                        break;
+                }
+            }
+            if( best == ranges.end() || count == 0 )
+                return false;
+
+            firstPage = best->first;
+            if( best->second > count )
+                ranges[best->first + count] = best->second - count;
+            ranges.erase( best );
+            numPages -= count;
+            return true;
+        }
+
+        // Return pages [begin, end) to the list, merging with neighboring ranges.  A range that ends
+        // at the allocation frontier lowers the frontier instead, keeping the page space compact.
+        void release( unsigned int begin, unsigned int end, unsigned int& nextPage )
+        {
+            auto next = ranges.lower_bound( begin );
+            if( next != ranges.end() && next->first == end )
+            {
+                end = next->first + next->second;
+                numPages -= next->second;
+                next = ranges.erase( next );
+            }
+            if( next != ranges.begin() )
+            {
+                auto prev = std::prev( next );
+                if( prev->first + prev->second == begin )
+                {
+                    begin = prev->first;
+                    numPages -= prev->second;
+                    ranges.erase( prev );
+                }
+            }
+            if( end == nextPage )
+            {
+                nextPage = begin;
+                return;
+            }
+            ranges[begin] = end - begin;
+            numPages += end - begin;
+        }
+    };
+
+    // Return a released range to the free list it was reserved from.  Mutex acquired in caller.
+    void recycleRange( const PageMapping& range )
+    {
+        if( range.firstPage < m_backedPages )
+            m_freeBackedRanges.release( range.firstPage, range.lastPage + 1, m_nextBackedPage );
+        else
+            m_freeUnbackedRanges.release( range.firstPage, range.lastPage + 1, m_nextUnbackedPage );
+    }
+
+    unsigned int insertPageMapping( unsigned int firstPage, unsigned int numPages, RequestHandler* handler )
     {
-        const unsigned int firstPage = nextPage;
         const unsigned int lastPage = firstPage + numPages - 1;
         if( handler )
             handler->setPageRange( firstPage, numPages );
@@ -142,11 +297,50 @@ class PageTableManager
             std::lower_bound( m_mappings.begin(), m_mappings.end(), firstPage,
                               []( const PageMapping& entry, unsigned int id ) { return id > entry.lastPage; } );
         m_mappings.insert( least, mapping );
-
-        nextPage += numPages;
+        if( numPages > 0 )
+            publishRange( firstPage, lastPage, handler );
         return firstPage;
     }
 
+    // Associate pages [firstPage, lastPage] with the given handler in the radix table.  Called with
+    // the mutex held.  Leaves are never freed while the PageTableManager is alive, so concurrent
+    // readers holding a stale leaf pointer remain safe.
+    void publishRange( unsigned int firstPage, unsigned int lastPage, RequestHandler* handler )
+    {
+        const unsigned int firstDir = firstPage >> LEAF_BITS;
+        const unsigned int lastDir  = lastPage >> LEAF_BITS;
+        for( unsigned int dir = firstDir; dir <= lastDir; ++dir )
+        {
+            const unsigned int begin = ( dir == firstDir ) ? ( firstPage & LEAF_MASK ) : 0;
+            const unsigned int end   = ( dir == lastDir ) ? ( lastPage & LEAF_MASK ) : LEAF_MASK;
+            std::atomic<std::uintptr_t>& dirEntry = m_directory[dir];
+            const std::uintptr_t         current  = dirEntry.load( std::memory_order_relaxed );
+
+            // A range covering the whole leaf needs no per-page storage, unless a leaf was already
+            // published for it.
+            const bool wholeLeaf = ( begin == 0 && end == LEAF_MASK );
+            if( wholeLeaf && ( current == 0 || ( current & WHOLE_LEAF_TAG ) ) )
+            {
+                dirEntry.store( reinterpret_cast<std::uintptr_t>( handler ) | WHOLE_LEAF_TAG, std::memory_order_release );
+                continue;
+            }
+
+            // Otherwise fill a leaf, creating it from the current contents of the entry if needed.
+            Leaf* leaf = reinterpret_cast<Leaf*>( current );
+            if( current == 0 || ( current & WHOLE_LEAF_TAG ) )
+            {
+                m_leaves.emplace_back( new Leaf( reinterpret_cast<RequestHandler*>( current & ~WHOLE_LEAF_TAG ) ) );
+                leaf = m_leaves.back().get();
+                for( unsigned int i = begin; i <= end; ++i )
+                    leaf->handlers[i].store( handler, std::memory_order_relaxed );
+                dirEntry.store( reinterpret_cast<std::uintptr_t>( leaf ), std::memory_order_release );
+                continue;
+            }
+            for( unsigned int i = begin; i <= end; ++i )
+                leaf->handlers[i].store( handler, std::memory_order_release );
+        }
+    }
+
     unsigned int             m_totalPages;
     unsigned int             m_backedPages;
 
@@ -154,8 +348,15 @@ class PageTableManager
     unsigned int             m_nextUnbackedPage{};
 
     std::vector<PageMapping> m_mappings;
+    std::vector<PageMapping> m_releasedRanges;
+    FreeRangeList            m_freeBackedRanges;
+    FreeRangeList            m_freeUnbackedRanges;
     mutable std::mutex       m_mutex;
 
+    size_t                                         m_numDirEntries;
+    std::unique_ptr<std::atomic<std::uintptr_t>[]> m_directory;
+    std::vector<std::unique_ptr<Leaf>>             m_leaves;
+
     RequestHandler           m_nullHandler;
 };
 
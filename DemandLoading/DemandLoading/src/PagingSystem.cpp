@@ -37,7 +37,9 @@
 #include "Util/CudaCallback.h"
 #include "Util/Math.h"
 
+#include <OptiXToolkit/DemandLoading/LRU.h>
 #include <OptiXToolkit/DemandLoading/RequestProcessor.h>
+#include <OptiXToolkit/Memory/MemoryBlockDesc.h>
 
 #include <algorithm>
 #include <set>
@@ -62,6 +64,9 @@ PagingSystem::PagingSystem( std::shared_ptr<Options> options,
 
     initPageMappingsContext();
 
+    if( m_options->maxUnreferencedLaunches > 0 )
+        m_lastReferencedLaunch.resize( m_options->maxTextures, 0 );
+
     OTK_ERROR_CHECK( cuModuleLoadData( &m_pagingKernels, PagingSystemKernelsCudaText() ) );
 }
 
@@ -157,6 +162,14 @@ void PagingSystem::pullRequests( const DeviceContext& context, CUstream stream,
                                       reinterpret_cast<CUdeviceptr>( context.arrayLengths.data ),
                                       pinnedRequestContext->numArrayLengths * sizeof( unsigned int ), stream ) );
 
+    // Get the reference bits for the sampler pages, which start at page 0.
+    if( pinnedRequestContext->numSamplerReferenceWords > 0 )
+    {
+        OTK_ERROR_CHECK( cuMemcpyAsync( reinterpret_cast<CUdeviceptr>( pinnedRequestContext->samplerReferenceBits ),
+                                          reinterpret_cast<CUdeviceptr>( context.referenceBits ),
+                                          pinnedRequestContext->numSamplerReferenceWords * sizeof( unsigned int ), stream ) );
+    }
+
     // Enqueue host function call to process the page requests once the kernel launch and copies have completed.
     CudaCallback::enqueue( stream, new ProcessRequestsCallback( this, context, pinnedRequestContext, stream, id ) );
 }
@@ -184,6 +197,8 @@ void PagingSystem::processRequests( const DeviceContext& context, RequestContext
     }
     pinnedRequestContext->arrayLengths[PAGE_REQUESTS_LENGTH] = numRequestedPages;
 
+    updateLastReferencedLaunch( pinnedRequestContext );
+
     // Enqueue the requests for processing.
     // Must do this even when zero pages are requested to get proper end-to-end asynchronous communication via the Ticket mechanism.
     m_requestProcessor->addRequests( stream, id, pinnedRequestContext->requestedPages, numRequestedPages );
@@ -203,7 +218,11 @@ void PagingSystem::processRequests( const DeviceContext& context, RequestContext
             std::shuffle(pinnedRequestContext->stalePages, pinnedRequestContext->stalePages + numStalePages, m_rng);
         }
 
-        if( m_evictionActive && getNumStagedPages() < m_options->maxStagedPages )
+        // Groups over a hard quota are evicted even if eviction is not active.
+        bool overHardQuota = std::any_of( m_residencyGroups.begin(), m_residencyGroups.end(), []( const ResidencyGroup& g ) {
+            return g.hardQuota && isOverHardQuota( g );
+        } );
+        if( ( m_evictionActive || overHardQuota ) && getNumStagedPages() < m_options->maxStagedPages )
         {
             m_stagedPages.emplace_back( StagedPageList{m_pushMappingsEvent, std::deque<PageMapping>()} );
             stageStalePages( pinnedRequestContext, m_stagedPages.back().mappings );
@@ -215,10 +234,195 @@ void PagingSystem::processRequests( const DeviceContext& context, RequestContext
     m_pinnedRequestContextPool.push_back(pinnedRequestContext);
 }
 
-void PagingSystem::addMapping( unsigned int pageId, unsigned int lruVal, unsigned long long entry )
+void PagingSystem::addMapping( unsigned int pageId, unsigned int lruVal, unsigned long long entry, unsigned int group )
+{
+    std::unique_lock<std::mutex> lock( m_mutex );
+    addMappingBody( pageId, lruVal, entry, group );
+}
+
+void PagingSystem::addDependentMapping( unsigned int pageId, unsigned int lruVal, unsigned long long entry, unsigned int endPage )
+{
+    std::unique_lock<std::mutex> lock( m_mutex );
+    addMappingBody( pageId, lruVal, entry, 0, endPage );
+}
+
+bool PagingSystem::addPinnedMapping( unsigned int pageId, unsigned long long entry, unsigned int group )
+{
+    std::unique_lock<std::mutex> lock( m_mutex );
+    if( !canPinPage() )
+    {
+        addMappingBody( pageId, 0, entry, group );
+        return false;
+    }
+    addPinnedMappingBody( pageId, entry, group );
+    return true;
+}
+
+unsigned int PagingSystem::pinPages( unsigned int startId, unsigned int endId )
+{
+    std::unique_lock<std::mutex> lock( m_mutex );
+
+    unsigned int numPinned = 0;
+    for( auto p = m_pageTable.lower_bound( startId ); p != m_pageTable.end() && p->first < endId; ++p )
+    {
+        // Staged pages may have a pending invalidation on the device, so only resident pages are pinned.
+        if( p->second.pinned || !p->second.resident )
+            continue;
+        if( !canPinPage() )
+            break;
+        addPinnedMappingBody( p->first, p->second.entry, p->second.group );
+        ++numPinned;
+    }
+    return numPinned;
+}
+
+unsigned int PagingSystem::unpinPages( unsigned int startId, unsigned int endId )
+{
+    std::unique_lock<std::mutex> lock( m_mutex );
+
+    unsigned int numUnpinned = 0;
+    for( auto p = m_pageTable.lower_bound( startId ); p != m_pageTable.end() && p->first < endId; ++p )
+    {
+        if( !p->second.pinned )
+            continue;
+        addMappingBody( p->first, 0, p->second.entry, p->second.group );
+        ++numUnpinned;
+    }
+    return numUnpinned;
+}
+
+unsigned int PagingSystem::getNumPinnedPages()
 {
     std::unique_lock<std::mutex> lock( m_mutex );
-    addMappingBody( pageId, lruVal, entry );
+    return m_numPinnedPages;
+}
+
+bool PagingSystem::canPinPage() const
+{
+    // Mutex acquired in caller
+    const size_t maxPinnedMem = m_options->maxPinnedTexMemPerDevice;
+    return maxPinnedMem == 0 || ( m_numPinnedPages + 1 ) * static_cast<size_t>( TILE_SIZE_IN_BYTES ) <= maxPinnedMem;
+}
+
+void PagingSystem::addPinnedMappingBody( unsigned int pageId, unsigned long long entry, unsigned int group )
+{
+    // Mutex acquired in caller
+    addMappingBody( pageId, NON_EVICTABLE_LRU_VAL, entry, group );
+    m_pageTable[pageId].pinned = true;
+    ++m_numPinnedPages;
+}
+
+unsigned int PagingSystem::createResidencyGroup( unsigned int maxPages, bool hardQuota )
+{
+    std::unique_lock<std::mutex> lock( m_mutex );
+    m_residencyGroups.push_back( ResidencyGroup{ maxPages, hardQuota, 0, false } );
+    return static_cast<unsigned int>( m_residencyGroups.size() - 1 );
+}
+
+void PagingSystem::setResidencyGroup( unsigned int startId, unsigned int endId, unsigned int group )
+{
+    std::unique_lock<std::mutex> lock( m_mutex );
+    OTK_ASSERT_MSG( group < m_residencyGroups.size(), "Unknown residency group." );
+
+    for( auto p = m_pageTable.lower_bound( startId ); p != m_pageTable.end() && p->first < endId; ++p )
+    {
+        if( p->second.resident )
+        {
+            updateResidencyGroup( p->second.group, false );
+            updateResidencyGroup( group, true );
+        }
+        p->second.group = group;
+    }
+}
+
+bool PagingSystem::isResidencyGroupFull( unsigned int group )
+{
+    std::unique_lock<std::mutex> lock( m_mutex );
+    ResidencyGroup& g = m_residencyGroups.at( group );
+    const bool      isFull = g.hardQuota && g.numPages >= g.maxPages;
+    if( isFull )
+    {
+        g.hasDeferredRequests = true;
+        ++m_numQuotaDeferredRequests;
+    }
+    return isFull;
+}
+
+size_t PagingSystem::getNumQuotaDeferredRequests()
+{
+    std::unique_lock<std::mutex> lock( m_mutex );
+    return m_numQuotaDeferredRequests;
+}
+
+unsigned int PagingSystem::getResidencyGroupSize( unsigned int group )
+{
+    std::unique_lock<std::mutex> lock( m_mutex );
+    return m_residencyGroups.at( group ).numPages;
+}
+
+void PagingSystem::updateResidencyGroup( unsigned int group, bool resident )
+{
+    // Mutex acquired in caller
+    if( resident )
+        m_residencyGroups[group].numPages++;
+    else
+        m_residencyGroups[group].numPages--;
+}
+
+bool PagingSystem::isResidencyGroupOverQuota( unsigned int group ) const
+{
+    // Mutex acquired in caller
+    const ResidencyGroup& g = m_residencyGroups[group];
+    return g.hardQuota ? isOverHardQuota( g ) : ( g.numPages > g.maxPages && m_evictionActive );
+}
+
+bool PagingSystem::isOverHardQuota( const ResidencyGroup& g )
+{
+    // A group at its quota is evicted when requests were deferred because it is full (see
+    // isResidencyGroupFull), since otherwise they would never be filled.
+    return g.numPages > g.maxPages || ( g.numPages == g.maxPages && g.hasDeferredRequests );
+}
+
+void PagingSystem::updateLastReferencedLaunch( const RequestContext* requestContext )
+{
+    // Mutex acquired in caller (processRequests)
+    for( unsigned int wordIndex = 0; wordIndex < requestContext->numSamplerReferenceWords; ++wordIndex )
+    {
+        const unsigned int bits = requestContext->samplerReferenceBits[wordIndex];
+        for( unsigned int bitIndex = 0; bits != 0 && bitIndex < 32; ++bitIndex )
+        {
+            const unsigned int pageId = wordIndex * 32 + bitIndex;
+            if( ( bits & ( 1U << bitIndex ) ) && pageId < m_lastReferencedLaunch.size() )
+                m_lastReferencedLaunch[pageId] = m_launchNum;
+        }
+    }
+}
+
+std::vector<unsigned int> PagingSystem::getUnreferencedPages( unsigned int startId, unsigned int endId, unsigned int numLaunches )
+{
+    std::unique_lock<std::mutex> lock( m_mutex );
+    OTK_ASSERT_MSG( endId <= m_lastReferencedLaunch.size(), "Sampler references are not tracked (see Options::maxUnreferencedLaunches)." );
+
+    std::vector<unsigned int> pages;
+    for( auto p = m_pageTable.lower_bound( startId ); p != m_pageTable.end() && p->first < endId; ++p )
+    {
+        if( p->second.resident && m_launchNum - m_lastReferencedLaunch[p->first] >= numLaunches )
+            pages.push_back( p->first );
+    }
+    return pages;
+}
+
+std::vector<unsigned int> PagingSystem::getResidentPages( unsigned int startId, unsigned int endId )
+{
+    std::unique_lock<std::mutex> lock( m_mutex );
+
+    std::vector<unsigned int> pages;
+    for( auto p = m_pageTable.lower_bound( startId ); p != m_pageTable.end() && p->first < endId; ++p )
+    {
+        if( p->second.resident )
+            pages.push_back( p->first );
+    }
+    return pages;
 }
 
 bool PagingSystem::isResident( unsigned int pageId, unsigned long long* entry )
@@ -255,10 +459,21 @@ unsigned int PagingSystem::pushMappings( const DeviceContext& context, CUstream
 
     // Allocate a new PageMappingsContext for the next pushMappings cycle.
     initPageMappingsContext();
+    restoreDeferredMappings();
     
     return numFilledPages;
 }
 
+void PagingSystem::restoreDeferredMappings()
+{
+    // Mutex acquired in caller
+    while( !m_deferredMappings.empty() && m_pageMappingsContext->numFilledPages < m_pageMappingsContext->maxFilledPages )
+    {
+        m_pageMappingsContext->filledPages[m_pageMappingsContext->numFilledPages++] = m_deferredMappings.back();
+        m_deferredMappings.pop_back();
+    }
+}
+
 void PagingSystem::stageStalePages( RequestContext* requestContext, std::deque<PageMapping>& stagedMappings )
 {
     // Mutex acquired in caller (processRequests)
@@ -266,25 +481,37 @@ void PagingSystem::stageStalePages( RequestContext* requestContext, std::deque<P
     unsigned int numStalePages = requestContext->arrayLengths[STALE_PAGES_LENGTH];
     size_t       numStaged     = getNumStagedPages();
 
-    // Count backwards to stage the oldest pages first
-    for( int i = static_cast<int>( numStalePages - 1 ); i >= 0; --i )
+    // The first pass stages pages from residency groups that are over their quota.  The second
+    // pass stages any evictable page, if eviction is active.
+    const int firstPass = ( m_residencyGroups.size() > 1 ) ? 0 : 1;
+    for( int pass = firstPass; pass < 2; ++pass )
     {
-        StalePage sp = requestContext->stalePages[i];
-        if( numStaged >= m_options->maxStagedPages || m_pageMappingsContext->numInvalidatedPages >= m_options->maxInvalidatedPages - 1 )
+        if( pass == 1 && !m_evictionActive )
             break;
 
-        const auto& p = m_pageTable.find( sp.pageId );
-        if( p != m_pageTable.end() && p->second.resident == true && p->second.inStagedList == false )
+        // Count backwards to stage the oldest pages first
+        for( int i = static_cast<int>( numStalePages - 1 ); i >= 0; --i )
         {
-            // Stage the page
-            stagedMappings.emplace_back( PageMapping{sp.pageId, sp.lruVal, p->second.entry} );
-            p->second.resident     = false;
-            p->second.staged       = true;
-            p->second.inStagedList = true;
-
-            // Schedule the page mapping to be invalidated on the device
-            m_pageMappingsContext->invalidatedPages[m_pageMappingsContext->numInvalidatedPages++] = sp.pageId;
-            numStaged++;
+            StalePage sp = requestContext->stalePages[i];
+            if( numStaged >= m_options->maxStagedPages || m_pageMappingsContext->numInvalidatedPages >= m_options->maxInvalidatedPages - 1 )
+                return;
+
+            const auto& p = m_pageTable.find( sp.pageId );
+            if( p != m_pageTable.end() && p->second.resident == true && p->second.inStagedList == false && !p->second.pinned
+                && ( pass == 1 || isResidencyGroupOverQuota( p->second.group ) ) )
+            {
+                // Stage the page
+                stagedMappings.emplace_back( PageMapping{sp.pageId, sp.lruVal, p->second.entry} );
+                p->second.resident     = false;
+                p->second.staged       = true;
+                p->second.inStagedList = true;
+                updateResidencyGroup( p->second.group, false );
+                m_residencyGroups[p->second.group].hasDeferredRequests = false;
+
+                // Schedule the page mapping to be invalidated on the device
+                m_pageMappingsContext->invalidatedPages[m_pageMappingsContext->numInvalidatedPages++] = sp.pageId;
+                numStaged++;
+            }
         }
     }
 }
@@ -336,10 +563,11 @@ void PagingSystem::initPageMappingsContext()
     m_pageMappingsContext->init( *m_options );
 }
 
-void PagingSystem::addMappingBody( unsigned int pageId, unsigned int lruVal, unsigned long long entry )
+void PagingSystem::addMappingBody( unsigned int pageId, unsigned int lruVal, unsigned long long entry, unsigned int group, unsigned int endPage )
 {
     // Mutex acquired in caller
     OTK_ASSERT_MSG( pageId < m_options->numPages, "pageId outside of page table range." );
+    OTK_ASSERT_MSG( group < m_residencyGroups.size(), "Unknown residency group." );
 
     // Resize PageMappingContext if necessary.
     if( m_pageMappingsContext->numFilledPages >= m_options->maxFilledPages )
@@ -355,7 +583,23 @@ void PagingSystem::addMappingBody( unsigned int pageId, unsigned int lruVal, uns
     }
 
     m_pageMappingsContext->filledPages[m_pageMappingsContext->numFilledPages++] = PageMapping{pageId, lruVal, entry};
-    m_pageTable[pageId] = HostPageTableEntry{entry, true, false, false};
+    if( endPage > 0 )
+        m_mappingEndPages[pageId] = endPage;
+    else if( !m_mappingEndPages.empty() )
+        m_mappingEndPages.erase( pageId );
+
+    // Replacing the mapping of a pinned page unpins it (see addPinnedMappingBody).
+    HostPageTableEntry& hostEntry = m_pageTable[pageId];
+    if( hostEntry.pinned )
+        --m_numPinnedPages;
+    if( hostEntry.resident )
+        updateResidencyGroup( hostEntry.group, false );
+    hostEntry = HostPageTableEntry{entry, true, false, false, false, group};
+    updateResidencyGroup( group, true );
+
+    // A newly mapped sampler counts as referenced.
+    if( pageId < m_lastReferencedLaunch.size() )
+        m_lastReferencedLaunch[pageId] = m_launchNum;
 
     // If the buffer for page mappings is about to overflow, push the mappings to clear it.
     // This should not happen very often.  Usually, the mappings will be pushed from pushMappings.
@@ -367,6 +611,7 @@ void PagingSystem::addMappingBody( unsigned int pageId, unsigned int lruVal, uns
         pushMappingsAndInvalidations( context, stream );
         cuStreamSynchronize( stream );
         m_deviceMemoryManager->freeDeviceContext( &context );
+        restoreDeferredMappings();
     }
 }
 
@@ -379,7 +624,7 @@ bool PagingSystem::restoreMapping( unsigned int pageId )
         && m_pageMappingsContext->numFilledPages < m_pageMappingsContext->maxFilledPages )
     {
         p->second.staged = false;
-        addMappingBody( pageId, 0, p->second.entry );
+        addMappingBody( pageId, 0, p->second.entry, p->second.group );
         return true;
     }
 
@@ -398,6 +643,22 @@ void PagingSystem::pushMappingsAndInvalidations( const DeviceContext& context, C
 {
     // Mutex acquired in caller 
 
+    // Pages reserved after the device page arrays were last grown can't be mapped on the device
+    // yet, and neither can samplers that refer to them.  Hold their mappings back until the next push.
+    PageMapping* filledPages = m_pageMappingsContext->filledPages;
+    for( unsigned int i = 0; i < m_pageMappingsContext->numFilledPages; )
+    {
+        if( filledPages[i].id >= context.maxNumPages || !coversMappingEndPage( filledPages[i].id, context.maxNumPages ) )
+        {
+            m_deferredMappings.push_back( filledPages[i] );
+            filledPages[i] = filledPages[--m_pageMappingsContext->numFilledPages];
+        }
+        else
+        {
+            ++i;
+        }
+    }
+
     // First push any new mappings
     const unsigned int numFilledPages = m_pageMappingsContext->numFilledPages;
     if( numFilledPages > 0 )
@@ -427,6 +688,20 @@ void PagingSystem::pushMappingsAndInvalidations( const DeviceContext& context, C
     m_pageMappingsContext->clear();
 }
 
+bool PagingSystem::coversMappingEndPage( unsigned int pageId, unsigned int maxNumPages )
+{
+    // Mutex acquired in caller
+    if( m_mappingEndPages.empty() )
+        return true;
+    auto it = m_mappingEndPages.find( pageId );
+    if( it == m_mappingEndPages.end() )
+        return true;
+    if( it->second > maxNumPages )
+        return false;
+    m_mappingEndPages.erase( it );
+    return true;
+}
+
 void PagingSystem::invalidatePages( unsigned int              startId,
                                     unsigned int              endId,
                                     PageInvalidatorPredicate* predicate,
@@ -452,6 +727,14 @@ void PagingSystem::invalidatePages( unsigned int              startId,
             {
                 stagedInvalidatedPages.insert( pageId );
             }
+            if( p->second.pinned )
+            {
+                --m_numPinnedPages;
+            }
+            if( p->second.resident )
+            {
+                updateResidencyGroup( p->second.group, false );
+            }
             p = m_pageTable.erase(p);
 
             // If the buffer for invalidations is about to overflow, push the invalidated pages to clear it. 
@@ -460,6 +743,7 @@ void PagingSystem::invalidatePages( unsigned int              startId,
             {
                 pushMappingsAndInvalidations( context, stream );
                 cuStreamSynchronize( stream ); // wait for the stream because we will reuse the context
+                restoreDeferredMappings();
             }
         }
         else 
@@ -38,6 +38,7 @@
 
 #include <cuda.h>
 
+#include <climits>
 #include <deque>
 #include <map>
 #include <memory>
@@ -77,12 +78,61 @@ class PagingSystem
     void pullRequests( const DeviceContext& context, CUstream stream, unsigned int id, unsigned int startPage, unsigned int endPage );
 
     // Add a page mapping (thread safe). The device-side page table (etc.) is not updated until
-    /// pushMappings is called.
-    void addMapping( unsigned int pageId, unsigned int lruVal, unsigned long long entry );
+    /// pushMappings is called.  The page is counted against the quota of the given residency group.
+    void addMapping( unsigned int pageId, unsigned int lruVal, unsigned long long entry, unsigned int group = 0 );
+
+    /// Add a page mapping whose entry refers to the pages before endPage, such as the tiles of a
+    /// texture sampler (thread safe).  The mapping is held back until the device page arrays cover
+    /// those pages.
+    void addDependentMapping( unsigned int pageId, unsigned int lruVal, unsigned long long entry, unsigned int endPage );
 
     /// Add a page mapping (not thread safe). Exposed for PageInvalidatorPredicate callbacks that
-    /// need to map pages.
-    void addMappingBody( unsigned int pageId, unsigned int lruVal, unsigned long long entry );
+    /// need to map pages.  A nonzero endPage is handled as in addDependentMapping.
+    void addMappingBody( unsigned int pageId, unsigned int lruVal, unsigned long long entry, unsigned int group = 0, unsigned int endPage = 0 );
+
+    /// Add a pinned page mapping (thread safe).  The page is never staged for eviction until it is
+    /// unpinned.  If the pinned budget (Options::maxPinnedTexMemPerDevice) is exhausted, an evictable
+    /// mapping is added instead.  Returns true if the page was pinned.
+    bool addPinnedMapping( unsigned int pageId, unsigned long long entry, unsigned int group = 0 );
+
+    /// Pin the resident pages in a half open interval of page ids, as far as the pinned budget allows
+    /// (thread safe).  Returns the number of newly pinned pages.
+    unsigned int pinPages( unsigned int startId, unsigned int endId );
+
+    /// Unpin the pinned pages in a half open interval of page ids, making them evictable (thread safe).
+    /// Returns the number of unpinned pages.
+    unsigned int unpinPages( unsigned int startId, unsigned int endId );
+
+    /// Get the number of pinned pages (thread safe).
+    unsigned int getNumPinnedPages();
+
+    /// Create a residency group whose resident pages are limited to maxPages (thread safe).  Stale pages
+    /// from groups over their quota are staged for eviction first.  A group with a hard quota is evicted
+    /// even when eviction is not active, and isResidencyGroupFull() tells request handlers to defer
+    /// filling its pages.  Group 0 is the default group, which has no quota.  Returns the group id.
+    unsigned int createResidencyGroup( unsigned int maxPages, bool hardQuota );
+
+    /// Move the mapped pages in a half open interval of page ids to a residency group (thread safe).
+    void setResidencyGroup( unsigned int startId, unsigned int endId, unsigned int group );
+
+    /// Return true if the residency group has a hard quota and no room for another resident page.  The
+    /// caller is expected to defer its request, so stale pages of a full group are then evicted to
+    /// make room for it.  A group none of whose pages is stale keeps deferring its requests, so they
+    /// are counted (see getNumQuotaDeferredRequests).
+    bool isResidencyGroupFull( unsigned int group );
+
+    /// Get the number of requests deferred because their residency group was full (thread safe).
+    size_t getNumQuotaDeferredRequests();
+
+    /// Get the number of resident pages in a residency group (thread safe).
+    unsigned int getResidencyGroupSize( unsigned int group );
+
+    /// Get the resident pages in a half open interval of sampler page ids that have not been referenced
+    /// in the last numLaunches launches (thread safe).  Requires Options::maxUnreferencedLaunches > 0.
+    std::vector<unsigned int> getUnreferencedPages( unsigned int startId, unsigned int endId, unsigned int numLaunches );
+
+    /// Get the resident pages in a half open interval of page ids, in ascending order (thread safe).
+    std::vector<unsigned int> getResidentPages( unsigned int startId, unsigned int endId );
 
     /// Check whether the specified page is resident (thread safe).
     bool isResident( unsigned int pageId, unsigned long long* entry = nullptr );
@@ -110,6 +160,16 @@ class PagingSystem
         bool               resident;      // Whether a page is considered resident on the GPU
         bool               staged;        // Pages that are currently staged (and not restored by second chance).
         bool               inStagedList;  // All pages that are in the staged list, whether restored or not.
+        bool               pinned;        // Pinned pages are non-evictable and count against the pinned budget.
+        unsigned int       group;         // Residency group of the page.
+    };
+
+    struct ResidencyGroup
+    {
+        unsigned int maxPages;             // Quota of resident pages
+        bool         hardQuota;            // Whether the quota is enforced (rather than only preferred for eviction)
+        unsigned int numPages;             // Number of resident pages
+        bool         hasDeferredRequests;  // Whether requests were deferred because the group was full
     };
 
     std::shared_ptr<Options> m_options{};
@@ -118,6 +178,8 @@ class PagingSystem
 
     otk::MemoryBlockDesc m_pageMappingsContextBlock;
     PageMappingsContext* m_pageMappingsContext; 
+    std::vector<PageMapping> m_deferredMappings;  // Mappings beyond the capacity of the device page arrays
+    std::map<unsigned int, unsigned int> m_mappingEndPages;  // End of the pages referenced by each dependent mapping not yet pushed
     otk::MemoryPool<otk::PinnedAllocator, otk::RingSuballocator>* m_pinnedMemoryPool;
 
     std::map<unsigned int, HostPageTableEntry> m_pageTable;  // Host-side. Not copied to/from device. Used for eviction.
@@ -131,6 +193,16 @@ class PagingSystem
     unsigned int       m_launchNum       = 0;
     unsigned int       m_lruThreshold    = MIN_LRU_THRESHOLD;
 
+    // Number of pinned pages, bounded by Options::maxPinnedTexMemPerDevice (guarded by m_mutex)
+    unsigned int m_numPinnedPages = 0;
+
+    // Launch number of the last reference to each sampler page, if tracked (see Options::maxUnreferencedLaunches).
+    std::vector<unsigned int> m_lastReferencedLaunch;
+
+    // Residency groups, indexed by group id. Group 0 is the default group, which has no quota.
+    std::vector<ResidencyGroup> m_residencyGroups{ ResidencyGroup{ UINT_MAX, false, 0, false } };
+    size_t                      m_numQuotaDeferredRequests = 0;  // see isResidencyGroupFull
+
     // Synchronization event for pushMappings
     struct FutureEvent
     {
@@ -167,6 +239,9 @@ class PagingSystem
     // Update the lru threshold value
     void updateLruThreshold( unsigned int returnedStalePages, unsigned int requestedStalePages, unsigned int medianLruVal );
 
+    // Record the launch number for sampler pages whose reference bits are set
+    void updateLastReferencedLaunch( const RequestContext* requestContext );
+
     // Stage pages for reuse (Remove their mappings on the host, and schedule removal of thier mappings on the device
     // the next time pushMappings is called.)
     void stageStalePages( RequestContext* requestContext, std::deque<PageMapping>& stagedMappings );
@@ -180,8 +255,31 @@ class PagingSystem
     // Restore the mapping for a staged page if possible
     bool restoreMapping( unsigned int pageId );
 
+    // Return true if another page fits in the pinned budget
+    bool canPinPage() const;
+
+    // Map a page as pinned (mutex acquired in caller)
+    void addPinnedMappingBody( unsigned int pageId, unsigned long long entry, unsigned int group );
+
+    // Update the resident page count of a residency group when a page becomes resident or non-resident
+    void updateResidencyGroup( unsigned int group, bool resident );
+
+    // Return true if stale pages from the residency group should be staged before other pages
+    bool isResidencyGroupOverQuota( unsigned int group ) const;
+
+    // Return true if a group with a hard quota must be evicted, either because it is over its quota
+    // or because requests were deferred while it was at its quota.
+    static bool isOverHardQuota( const ResidencyGroup& g );
+
     // Push invalidated pages to device
     void pushMappingsAndInvalidations( const DeviceContext& context, CUstream stream );
+
+    // Return mappings deferred by pushMappingsAndInvalidations to the filled pages list
+    void restoreDeferredMappings();
+
+    // Check whether device page arrays of the given size cover the pages referenced by a mapping
+    // (see addDependentMapping), forgetting the dependency if so.
+    bool coversMappingEndPage( unsigned int pageId, unsigned int maxNumPages );
 };
 
 }  // namespace demandLoading
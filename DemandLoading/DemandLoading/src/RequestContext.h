@@ -46,13 +46,25 @@ struct RequestContext
     unsigned int*             arrayLengths;
     static const unsigned int numArrayLengths = 2;
 
-    // Get the size required for the RequestContext struct + requestedPages + stalePages + arrayLengths.
+    // Reference bits for the sampler pages, used to find unreferenced textures (see Options::maxUnreferencedLaunches).
+    unsigned int* samplerReferenceBits;
+    unsigned int  numSamplerReferenceWords;
+
+    // Get the number of words of sampler reference bits to copy from the device.
+    static unsigned int getNumSamplerReferenceWords( const Options& options )
+    {
+        return ( options.maxUnreferencedLaunches > 0 ) ? ( options.maxTextures + 31 ) / 32 : 0;
+    }
+
+    // Get the size required for the RequestContext struct + requestedPages + stalePages + arrayLengths
+    // + samplerReferenceBits.
     static uint64_t getAllocationSize( const Options& options )
     {
         uint64_t allocSize = otk::alignVal( sizeof( RequestContext ), alignof( RequestContext ) );
         allocSize += options.maxRequestedPages * sizeof( unsigned int );
         allocSize += options.maxStalePages * sizeof( StalePage );
         allocSize += numArrayLengths * sizeof( unsigned int );
+        allocSize += getNumSamplerReferenceWords( options ) * sizeof( unsigned int );
         return allocSize;
     }
 
@@ -64,12 +76,16 @@ struct RequestContext
         char* requestedPagesStart = start + otk::alignVal( sizeof( RequestContext ), sizeof( RequestContext ) );
         char* stalePagesStart     = requestedPagesStart + options.maxRequestedPages * sizeof( unsigned int );
         char* arrayLengthsStart   = stalePagesStart + options.maxStalePages * sizeof( StalePage );
+        char* samplerBitsStart    = arrayLengthsStart + numArrayLengths * sizeof( unsigned int );
 
         maxRequestedPages = options.maxRequestedPages;
         requestedPages    = reinterpret_cast<unsigned int*>( requestedPagesStart );
         maxStalePages     = options.maxStalePages;
         stalePages        = reinterpret_cast<StalePage*>( stalePagesStart );
         arrayLengths      = reinterpret_cast<unsigned int*>( arrayLengthsStart );
+
+        numSamplerReferenceWords = getNumSamplerReferenceWords( options );
+        samplerReferenceBits     = reinterpret_cast<unsigned int*>( samplerBitsStart );
     }
 };
 
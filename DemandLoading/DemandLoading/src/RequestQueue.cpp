@@ -48,11 +48,24 @@ bool RequestQueue::popOrWait( PageRequest* requestPtr )
 {
     // Wait until the queue is non-empty or destroyed.
     std::unique_lock<std::mutex> lock( m_mutex );
-    m_requestAvailable.wait( lock, [this] { return !m_requests.empty() || m_isShutDown; } );
+    m_requestAvailable.wait( lock, [this] { return !m_requests.empty() || !m_lowPriorityRequests.empty() || m_isShutDown; } );
 
     if( m_isShutDown )
         return false;
 
+    std::deque<PageRequest>& requests = m_requests.empty() ? m_lowPriorityRequests : m_requests;
+    *requestPtr = std::move( requests.front() );
+    requests.pop_front();
+
+    return true;
+}
+
+bool RequestQueue::tryPop( PageRequest* requestPtr, CUstream stream )
+{
+    std::unique_lock<std::mutex> lock( m_mutex );
+    if( m_isShutDown || m_requests.empty() || TicketImpl::getImpl( m_requests.front().ticket )->getStream() != stream )
+        return false;
+
     *requestPtr = std::move( m_requests.front() );
     m_requests.pop_front();
 
@@ -88,4 +101,27 @@ void RequestQueue::push( const unsigned int* pageIds, unsigned int numPageIds, T
     m_requestAvailable.notify_all();
 }
 
+void RequestQueue::pushLowPriority( const unsigned int* pageIds, unsigned int numPageIds, Ticket ticket )
+{
+    std::unique_lock<std::mutex> lock( m_mutex );
+
+    // Low priority requests share the capacity of the queue, but never displace other requests.
+    const size_t queueSize = m_requests.size() + m_lowPriorityRequests.size();
+    if( m_isShutDown || queueSize >= m_maxQueueSize )
+        numPageIds = 0;
+    else if( numPageIds + queueSize > m_maxQueueSize )
+        numPageIds = static_cast<unsigned int>( m_maxQueueSize - queueSize );
+
+    TicketImpl::getImpl( ticket )->update( numPageIds );
+
+    if( numPageIds == 0 )
+        return;
+
+    for( unsigned int i = 0; i < numPageIds; ++i )
+    {
+        m_lowPriorityRequests.emplace_back( pageIds[i], ticket, true );
+    }
+    m_requestAvailable.notify_all();
+}
+
 }  // namespace demandLoading
@@ -46,11 +46,13 @@ struct PageRequest
 {
     unsigned int pageId{};
     Ticket       ticket;
+    bool         isLowPriority{};
 
     // A constructor is necessary for emplace_back.
-    PageRequest( unsigned int pageId_, Ticket ticket_ )
+    PageRequest( unsigned int pageId_, Ticket ticket_, bool isLowPriority_ = false )
         : pageId( pageId_ )
         , ticket( ticket_ )
+        , isLowPriority( isLowPriority_ )
     {
     }
 
@@ -67,15 +69,26 @@ class RequestQueue
     {
     }
 
-    /// Pop a request, waiting if necessary until the queue is non-empty or shut down.  Returns
-    /// false if the queue was shut down.
+    /// Pop a request, waiting if necessary until the queue is non-empty or shut down.  Low priority
+    /// requests are popped only when no other requests are queued.  Returns false if the queue was
+    /// shut down.
     bool popOrWait( PageRequest* request );
 
+    /// Pop a request without waiting, provided the request at the front of the queue is for the
+    /// given stream.  Low priority requests are never popped, since they would delay the batch of
+    /// requests being filled.  Returns false if there is no such request or the queue was shut down.
+    bool tryPop( PageRequest* request, CUstream stream );
+
     /// Push a batch of page requests.  Notifies any threads waiting in popOrWait().  Updates the
     /// given Ticket with the number of requests, and retains it for notifications as requests are
     /// filled.
     void push( const unsigned int* pageIds, unsigned int numPageIds, Ticket ticket );
 
+    /// Push a batch of low priority (e.g. speculative) page requests, which are popped only when no
+    /// other requests are queued.  Requests that do not fit in the queue are dropped.  Updates the
+    /// given Ticket like push().
+    void pushLowPriority( const unsigned int* pageIds, unsigned int numPageIds, Ticket ticket );
+
     /// Shut down the queue, signalling any waiting threads to exit.  Clients must call shutDown()
     /// and join with any waiting threads before invoking the RequestQueue destructor.
     void shutDown();
@@ -88,6 +101,7 @@ class RequestQueue
 
   private:
     std::deque<PageRequest> m_requests;
+    std::deque<PageRequest> m_lowPriorityRequests;
     std::mutex              m_mutex;
     std::condition_variable m_requestAvailable;
     unsigned int            m_maxQueueSize;
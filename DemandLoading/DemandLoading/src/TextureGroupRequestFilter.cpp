@@ -0,0 +1,149 @@
+//
+// Copyright (c) 2024, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "TextureGroupRequestFilter.h"
+
+#include "DemandLoaderImpl.h"
+
+#include <OptiXToolkit/DemandLoading/TileIndexing.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+
+namespace demandLoading {
+
+namespace {
+
+// The most tiles of one member requested for a single tile of another.  A member without coarse
+// mip levels would otherwise request most of a level for a tile of a coarse level.
+const unsigned int MAX_MATCHING_TILES = 16;
+
+}  // namespace
+
+std::vector<unsigned int> TextureGroupRequestFilter::filter( const unsigned int* requests, unsigned int numRequests )
+{
+    // The groups, and the samplers of their members, are read from a snapshot, so that the batch is
+    // filtered without locking or reading the textures, which other threads may modify.
+    std::vector<unsigned int>            speculativeRequests;
+    std::shared_ptr<const TextureGroups> groups = m_demandLoader->getTextureGroups();
+    if( groups->empty() )
+        return speculativeRequests;
+
+    std::vector<unsigned int> members;
+    for( unsigned int i = 0; i < numRequests; ++i )
+    {
+        // Find the texture of a sampler or tile request.  Sampler pages are followed by base color
+        // pages, which are not shared by group members, and then by tiles and other resources.
+        // Variants are grouped through their master textures.
+        const unsigned int pageId         = requests[i];
+        const bool         samplerRequest = pageId < m_maxTextures;
+        unsigned int       textureId      = 0;
+        if( samplerRequest )
+            textureId = groups->getMaster( pageId );
+        else if( pageId < NUM_PAGES_PER_TEXTURE * m_maxTextures || !groups->findTileTexture( pageId, textureId ) )
+            continue;
+
+        members.clear();
+        groups->getMembers( textureId, members );
+        const TextureSampler* sampler = groups->getSampler( textureId );
+        for( unsigned int memberId : members )
+        {
+            // The tiles of a member are not known until its sampler is, so request that instead.
+            const TextureSampler* memberSampler = groups->getSampler( memberId );
+            if( samplerRequest || !memberSampler )
+                speculativeRequests.push_back( memberId );
+            else if( sampler && memberSampler->desc.isSparseTexture )
+                appendMatchingPages( *sampler, pageId, *memberSampler, speculativeRequests );
+        }
+    }
+
+    // Remove duplicates, and pages that are requested by the batch itself.
+    std::sort( speculativeRequests.begin(), speculativeRequests.end() );
+    speculativeRequests.erase( std::unique( speculativeRequests.begin(), speculativeRequests.end() ), speculativeRequests.end() );
+
+    std::vector<unsigned int> batch( requests, requests + numRequests );
+    std::sort( batch.begin(), batch.end() );
+    std::vector<unsigned int> filteredRequests;
+    std::set_difference( speculativeRequests.begin(), speculativeRequests.end(), batch.begin(), batch.end(),
+                         std::back_inserter( filteredRequests ) );
+    return filteredRequests;
+}
+
+void TextureGroupRequestFilter::appendMatchingPages( const TextureSampler& src, unsigned int pageId, const TextureSampler& dst, std::vector<unsigned int>& pages )
+{
+    // Find the texel extent of the source tile in its mip level.  The mip tail is a single tile.
+    unsigned int mipLevel;
+    unsigned int tileX;
+    unsigned int tileY;
+    unpackTileIndex( src, pageId - src.startPage, mipLevel, tileX, tileY );
+
+    const uint64_t srcWidth  = calculateLevelDim( mipLevel, src.width );
+    const uint64_t srcHeight = calculateLevelDim( mipLevel, src.height );
+    const uint64_t x0        = static_cast<uint64_t>( tileX ) << src.desc.logTileWidth;
+    const uint64_t y0        = static_cast<uint64_t>( tileY ) << src.desc.logTileHeight;
+    const uint64_t x1        = std::min<uint64_t>( x0 + ( 1ULL << src.desc.logTileWidth ), srcWidth );
+    const uint64_t y1        = std::min<uint64_t>( y0 + ( 1ULL << src.desc.logTileHeight ), srcHeight );
+
+    // Use the coarsest level of dst that is at least as fine as the source level.
+    unsigned int dstLevel = 0;
+    while( dstLevel + 1 < dst.desc.numMipLevels && calculateLevelDim( dstLevel + 1, dst.width ) >= srcWidth )
+        ++dstLevel;
+    if( dstLevel >= dst.mipTailFirstLevel )
+    {
+        pages.push_back( dst.startPage );
+        return;
+    }
+
+    // Scale the extent to the dst level, rounding outward, and find the tiles that cover it.
+    const uint64_t                       dstWidth   = calculateLevelDim( dstLevel, dst.width );
+    const uint64_t                       dstHeight  = calculateLevelDim( dstLevel, dst.height );
+    const unsigned int                   logWidth   = dst.desc.logTileWidth;
+    const unsigned int                   logHeight  = dst.desc.logTileHeight;
+    const TextureSampler::MipLevelSizes& levelSizes = dst.mipLevelSizes[dstLevel];
+
+    const unsigned int beginX = static_cast<unsigned int>( ( x0 * dstWidth / srcWidth ) >> logWidth );
+    const unsigned int beginY = static_cast<unsigned int>( ( y0 * dstHeight / srcHeight ) >> logHeight );
+    const unsigned int endX   = std::min<unsigned int>(
+        static_cast<unsigned int>( ( ( ( x1 * dstWidth + srcWidth - 1 ) / srcWidth ) + ( 1ULL << logWidth ) - 1 ) >> logWidth ),
+        levelSizes.levelWidthInTiles );
+    const unsigned int endY = std::min<unsigned int>(
+        static_cast<unsigned int>( ( ( ( y1 * dstHeight + srcHeight - 1 ) / srcHeight ) + ( 1ULL << logHeight ) - 1 ) >> logHeight ),
+        levelSizes.levelHeightInTiles );
+    if( beginX >= endX || beginY >= endY || ( endX - beginX ) * ( endY - beginY ) > MAX_MATCHING_TILES )
+        return;
+
+    for( unsigned int y = beginY; y < endY; ++y )
+    {
+        for( unsigned int x = beginX; x < endX; ++x )
+            pages.push_back( dst.startPage + levelSizes.mipLevelStart + getPageOffsetFromTileCoords( x, y, levelSizes.levelWidthInTiles ) );
+    }
+}
+
+}  // namespace demandLoading
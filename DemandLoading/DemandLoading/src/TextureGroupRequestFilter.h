@@ -0,0 +1,68 @@
+//
+// Copyright (c) 2024, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#pragma once
+
+#include <OptiXToolkit/DemandLoading/RequestFilter.h>
+#include <OptiXToolkit/DemandLoading/TextureSampler.h>
+
+#include "TextureGroups.h"
+
+#include <vector>
+
+namespace demandLoading {
+
+class DemandLoaderImpl;
+
+/// Derives speculative requests from a batch of requests, for textures that belong to a texture
+/// group (see DemandLoader::addTextureGroup).  A tile request for one member of a group yields
+/// requests for the tiles covering the same region of the other members, and a sampler request
+/// yields requests for the samplers of the other members.
+class TextureGroupRequestFilter : public RequestFilter
+{
+  public:
+    TextureGroupRequestFilter( unsigned int maxTextures, DemandLoaderImpl* demandLoader )
+        : m_maxTextures( maxTextures )
+        , m_demandLoader( demandLoader )
+    {
+    }
+
+    /// Return the speculative requests for the given batch, excluding pages in the batch itself.
+    std::vector<unsigned int> filter( const unsigned int* requests, unsigned int numRequests ) override;
+
+    /// Append the pages of the sparse texture dst whose tiles cover the same region, in normalized
+    /// texture coordinates, as the tile of sparse texture src with the given page id.  The tiles are
+    /// taken from the mip level of dst whose resolution is closest to (but not below) that of the tile.
+    static void appendMatchingPages( const TextureSampler& src, unsigned int pageId, const TextureSampler& dst, std::vector<unsigned int>& pages );
+
+  private:
+    unsigned int      m_maxTextures;
+    DemandLoaderImpl* m_demandLoader;
+};
+
+}  // namespace demandLoading
@@ -0,0 +1,188 @@
+//
+// Copyright (c) 2024, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#pragma once
+
+#include <OptiXToolkit/DemandLoading/TextureSampler.h>
+
+#include <algorithm>
+#include <map>
+#include <vector>
+
+namespace demandLoading {
+
+/// The texture groups declared with DemandLoader::addTextureGroup.  Request filtering reads a shared
+/// snapshot of them, which is replaced by a modified copy when the groups change, so that a batch
+/// of requests is filtered without locking.  The ids of groups that become empty are reused.  The
+/// snapshot also holds the samplers of the grouped textures, once they are initialized, and the
+/// master textures of their variants, so that filtering never reads the textures themselves.
+class TextureGroups
+{
+  public:
+    /// Put the given textures in a new group, removing them from their old groups.  A group of fewer
+    /// than two textures is not kept.
+    void add( std::vector<unsigned int> textureIds )
+    {
+        std::sort( textureIds.begin(), textureIds.end() );
+        textureIds.erase( std::unique( textureIds.begin(), textureIds.end() ), textureIds.end() );
+        for( unsigned int textureId : textureIds )
+            remove( textureId );
+        if( textureIds.size() < 2 )
+            return;
+
+        unsigned int groupId;
+        if( !m_freeGroupIds.empty() )
+        {
+            groupId = m_freeGroupIds.back();
+            m_freeGroupIds.pop_back();
+        }
+        else
+        {
+            groupId = static_cast<unsigned int>( m_groups.size() );
+            m_groups.emplace_back();
+        }
+        for( unsigned int textureId : textureIds )
+            m_groupIds[textureId] = groupId;
+        m_groups[groupId] = std::move( textureIds );
+    }
+
+    /// Remove a texture from its group.  Returns false if it was not in a group.
+    bool remove( unsigned int textureId )
+    {
+        auto it = m_groupIds.find( textureId );
+        if( it == m_groupIds.end() )
+            return false;
+        const unsigned int         groupId = it->second;
+        std::vector<unsigned int>& group   = m_groups[groupId];
+        group.erase( std::remove( group.begin(), group.end(), textureId ), group.end() );
+        m_groupIds.erase( it );
+        clearSampler( textureId );
+
+        // A lone texture no longer has a group.
+        if( group.size() == 1 )
+        {
+            m_groupIds.erase( group[0] );
+            clearSampler( group[0] );
+            group.clear();
+            m_freeGroupIds.push_back( groupId );
+        }
+        return true;
+    }
+
+    /// Record the sampler of a grouped texture, or forget it if sampler is null (e.g. when the
+    /// texture is reinitialized).  Ignored for textures that are not in a group.
+    void setSampler( unsigned int textureId, const TextureSampler* sampler )
+    {
+        if( !contains( textureId ) )
+            return;
+        clearSampler( textureId );
+        if( !sampler )
+            return;
+        m_samplers[textureId] = *sampler;
+        if( sampler->desc.isSparseTexture && sampler->numPages > 0 )
+            m_tileRanges[sampler->startPage] = textureId;
+    }
+
+    /// Return the sampler of a grouped texture, or null if it is not initialized.
+    const TextureSampler* getSampler( unsigned int textureId ) const
+    {
+        auto it = m_samplers.find( textureId );
+        return it != m_samplers.end() ? &it->second : nullptr;
+    }
+
+    /// Return the grouped sparse texture whose tiles include the given page, or false if there is none.
+    bool findTileTexture( unsigned int pageId, unsigned int& textureId ) const
+    {
+        auto it = m_tileRanges.upper_bound( pageId );
+        if( it == m_tileRanges.begin() )
+            return false;
+        --it;
+        const TextureSampler& sampler = m_samplers.at( it->second );
+        if( pageId >= sampler.startPage + sampler.numPages )
+            return false;
+        textureId = it->second;
+        return true;
+    }
+
+    /// Record the master texture of a variant, through which the variant is grouped.
+    void setMaster( unsigned int variantId, unsigned int masterId ) { m_masterIds[variantId] = masterId; }
+
+    /// Forget the master texture of a destroyed variant.  Returns false if it was not recorded.
+    bool removeVariant( unsigned int variantId ) { return m_masterIds.erase( variantId ) != 0; }
+
+    /// Return the id of the master texture of the given variant, or the given id if it is not a
+    /// recorded variant.
+    unsigned int getMaster( unsigned int textureId ) const
+    {
+        auto it = m_masterIds.find( textureId );
+        return it != m_masterIds.end() ? it->second : textureId;
+    }
+
+    /// Return true if the given texture is in a group.
+    bool contains( unsigned int textureId ) const { return m_groupIds.find( textureId ) != m_groupIds.end(); }
+
+    /// Return true if there are no groups.
+    bool empty() const { return m_groupIds.empty(); }
+
+    /// Return the number of group ids in use, including those of empty groups awaiting reuse.
+    size_t getNumGroupIds() const { return m_groups.size(); }
+
+    /// Append the ids of the other textures in the group of the given texture, if any.
+    void getMembers( unsigned int textureId, std::vector<unsigned int>& members ) const
+    {
+        auto it = m_groupIds.find( textureId );
+        if( it == m_groupIds.end() )
+            return;
+        for( unsigned int memberId : m_groups[it->second] )
+        {
+            if( memberId != textureId )
+                members.push_back( memberId );
+        }
+    }
+
+  private:
+    std::vector<std::vector<unsigned int>>   m_groups;        // Ids of the textures in each group (empty if unused).
+    std::map<unsigned int, unsigned int>     m_groupIds;      // lookup from textureId to its texture group
+    std::vector<unsigned int>                m_freeGroupIds;  // Ids of empty groups, reused by add().
+    std::map<unsigned int, TextureSampler>   m_samplers;      // Initialized samplers of grouped textures.
+    std::map<unsigned int, unsigned int>     m_tileRanges;    // lookup from the start page of a sparse texture to its id
+    std::map<unsigned int, unsigned int>     m_masterIds;     // lookup from variant id to master id
+
+    void clearSampler( unsigned int textureId )
+    {
+        auto it = m_samplers.find( textureId );
+        if( it == m_samplers.end() )
+            return;
+        auto rangeIt = m_tileRanges.find( it->second.startPage );
+        if( rangeIt != m_tileRanges.end() && rangeIt->second == textureId )
+            m_tileRanges.erase( rangeIt );
+        m_samplers.erase( it );
+    }
+};
+
+}  // namespace demandLoading
@@ -0,0 +1,162 @@
+//
+// Copyright (c) 2024, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#pragma once
+
+#include <OptiXToolkit/Error/cuErrorCheck.h>
+
+#include <set>
+#include <vector>
+
+namespace demandLoading {
+
+/// AtlasAllocator divides a square, power-of-two atlas into power-of-two blocks using a quadtree
+/// buddy scheme.  Each block is aligned to its own width, so the mip levels of a block line up with
+/// the mip levels of the atlas.  Freed blocks are coalesced with their siblings.
+class AtlasAllocator
+{
+  public:
+    /// Construct an allocator for an atlas of the given width, which must be a power of two.
+    explicit AtlasAllocator( unsigned int atlasWidth )
+        : m_atlasWidth( atlasWidth )
+    {
+        OTK_ASSERT_MSG( atlasWidth > 0 && ( atlasWidth & ( atlasWidth - 1 ) ) == 0, "Atlas width must be a power of two" );
+        m_freeBlocks.resize( log2Width( atlasWidth ) + 1 );
+        m_freeBlocks[0].insert( 0 );
+    }
+
+    /// Get the width of the atlas.
+    unsigned int getAtlasWidth() const { return m_atlasWidth; }
+
+    /// Get the width of the block needed for an image of the given dimensions.
+    static unsigned int getBlockWidth( unsigned int width, unsigned int height )
+    {
+        unsigned int blockWidth = 1;
+        while( blockWidth < width || blockWidth < height )
+            blockWidth <<= 1;
+        return blockWidth;
+    }
+
+    /// Allocate a block of the given width, which must be a power of two.  Returns false if there
+    /// is no room in the atlas.
+    bool allocate( unsigned int blockWidth, unsigned int& x, unsigned int& y )
+    {
+        if( blockWidth == 0 || blockWidth > m_atlasWidth )
+            return false;
+        OTK_ASSERT_MSG( ( blockWidth & ( blockWidth - 1 ) ) == 0, "Atlas block width must be a power of two" );
+
+        // Find the smallest free block that is large enough.
+        const unsigned int level     = log2Width( m_atlasWidth / blockWidth );
+        int                freeLevel = static_cast<int>( level );
+        while( freeLevel >= 0 && m_freeBlocks[freeLevel].empty() )
+            --freeLevel;
+        if( freeLevel < 0 )
+            return false;
+
+        unsigned int block = *m_freeBlocks[freeLevel].begin();
+        m_freeBlocks[freeLevel].erase( m_freeBlocks[freeLevel].begin() );
+
+        // Split it until it is the requested size, freeing the other three quadrants at each step.
+        for( unsigned int splitLevel = static_cast<unsigned int>( freeLevel ) + 1; splitLevel <= level; ++splitLevel )
+        {
+            const unsigned int width = m_atlasWidth >> splitLevel;
+            const unsigned int bx    = block % m_atlasWidth;
+            const unsigned int by    = block / m_atlasWidth;
+            m_freeBlocks[splitLevel].insert( pack( bx + width, by ) );
+            m_freeBlocks[splitLevel].insert( pack( bx, by + width ) );
+            m_freeBlocks[splitLevel].insert( pack( bx + width, by + width ) );
+        }
+
+        x = block % m_atlasWidth;
+        y = block / m_atlasWidth;
+        ++m_numAllocated;
+        return true;
+    }
+
+    /// Free a block that was returned by allocate().
+    void free( unsigned int blockWidth, unsigned int x, unsigned int y )
+    {
+        OTK_ASSERT( m_numAllocated > 0 );
+        --m_numAllocated;
+
+        // Coalesce with the sibling quadrants while they are all free.
+        unsigned int level = log2Width( m_atlasWidth / blockWidth );
+        while( level > 0 )
+        {
+            const unsigned int px = x & ~( 2 * blockWidth - 1 );
+            const unsigned int py = y & ~( 2 * blockWidth - 1 );
+            const unsigned int quadrants[4] = {pack( px, py ), pack( px + blockWidth, py ), pack( px, py + blockWidth ),
+                                               pack( px + blockWidth, py + blockWidth )};
+            std::set<unsigned int>& freeBlocks = m_freeBlocks[level];
+            bool                    allFree    = true;
+            for( unsigned int quadrant : quadrants )
+            {
+                if( quadrant != pack( x, y ) && freeBlocks.find( quadrant ) == freeBlocks.end() )
+                    allFree = false;
+            }
+            if( !allFree )
+                break;
+            for( unsigned int quadrant : quadrants )
+                freeBlocks.erase( quadrant );
+
+            x = px;
+            y = py;
+            blockWidth *= 2;
+            --level;
+        }
+        m_freeBlocks[level].insert( pack( x, y ) );
+    }
+
+    /// Get the number of allocated blocks.
+    unsigned int getNumAllocated() const { return m_numAllocated; }
+
+    /// Check whether the atlas has no allocated blocks.
+    bool empty() const { return m_numAllocated == 0; }
+
+  private:
+    unsigned int m_atlasWidth;
+    unsigned int m_numAllocated = 0;
+
+    // Free blocks for each quadtree level (level 0 is the whole atlas), packed as y * width + x.
+    std::vector<std::set<unsigned int>> m_freeBlocks;
+
+    unsigned int pack( unsigned int x, unsigned int y ) const { return y * m_atlasWidth + x; }
+
+    static unsigned int log2Width( unsigned int width )
+    {
+        unsigned int result = 0;
+        while( width > 1 )
+        {
+            width >>= 1;
+            ++result;
+        }
+        return result;
+    }
+};
+
+}  // namespace demandLoading
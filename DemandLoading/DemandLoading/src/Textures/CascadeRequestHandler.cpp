@@ -32,6 +32,7 @@
 #include "Memory/DeviceMemoryManager.h"
 #include "PagingSystem.h"
 #include "Textures/DemandTextureImpl.h"
+#include "Textures/SparseMappingBatch.h"
 #include "TransferBufferDesc.h"
 #include "Util/NVTXProfiling.h"
 
@@ -79,6 +80,12 @@ void CascadeRequestHandler::loadPage( CUstream stream, unsigned int pageId, bool
     cascadeImage->setBackingImage( std::shared_ptr<imageSource::ImageSource>(nullptr) );
     unsigned int newCascadeSize = requestCascadeSize;
     std::shared_ptr<imageSource::ImageSource> newCascadeImage( new imageSource::CascadeImage( backingImage, newCascadeSize ) );
+
+    // Resident tiles are remapped into the new texture as they are migrated, so tile mappings are
+    // not batched while the texture is replaced (see SparseMappingBatch).
+    if( SparseMappingBatch* batch = SparseMappingBatch::getCurrent() )
+        batch->flush();
+    SparseMappingBatch::Scope unbatched( nullptr );
     m_loader->replaceTexture( stream, samplerId, newCascadeImage, texture->getDescriptor(), true );
 
     // Note: updating the page table is not necessary
@@ -28,6 +28,7 @@
 
 #include "Textures/DemandTextureImpl.h"
 #include "DemandLoaderImpl.h"
+#include "Memory/TileDeduplicator.h"
 #include <OptiXToolkit/Memory/MemoryBlockDesc.h>
 #include "PageTableManager.h"
 #include "Textures/TextureRequestHandler.h"
@@ -35,6 +36,9 @@
 #include "Util/Stopwatch.h"
 
 #include <OptiXToolkit/DemandLoading/TileIndexing.h>
+#include <OptiXToolkit/ImageSource/BaseColor.h>
+#include <OptiXToolkit/ImageSource/BlockEncoder.h>
+#include <OptiXToolkit/ImageSource/FormatConversion.h>
 #include <OptiXToolkit/ImageSource/ImageSource.h>
 
 #include <cuda.h>
@@ -42,11 +46,47 @@
 #include <algorithm>
 #include <cmath>
 #include <cstring>
+#include <functional>
 
 using namespace otk;
 
 namespace demandLoading {
 
+namespace {
+
+// Get the format in which texture data is stored on the device.  This is the image format unless the
+// descriptor requests a supported down-conversion or block compression.  Only data filled from host
+// memory is converted.
+CUarray_format getDeviceFormat( const TextureDescriptor& descriptor, const imageSource::TextureInfo& info, CUmemorytype fillType )
+{
+    CUarray_format format = info.format;
+    if( descriptor.deviceFormat == DEVICE_FORMAT_HALF )
+        format = CU_AD_FORMAT_HALF;
+    else if( descriptor.deviceFormat == DEVICE_FORMAT_UNORM8 )
+        format = CU_AD_FORMAT_UNSIGNED_INT8;
+    else if( descriptor.deviceFormat == DEVICE_FORMAT_BC1 )
+        format = CU_AD_FORMAT_BC1_UNORM;
+    else if( descriptor.deviceFormat == DEVICE_FORMAT_BC4 )
+        format = CU_AD_FORMAT_BC4_UNORM;
+    else if( descriptor.deviceFormat == DEVICE_FORMAT_BC5 )
+        format = CU_AD_FORMAT_BC5_UNORM;
+    else if( descriptor.deviceFormat == DEVICE_FORMAT_BC7 )
+        format = CU_AD_FORMAT_BC7_UNORM;
+
+    if( fillType != CU_MEMORYTYPE_HOST || format == info.format )
+        return info.format;
+    if( imageSource::isBlockCompressed( format ) )
+        return imageSource::canEncodeBlocks( info.format, info.numChannels, format ) ? format : info.format;
+    return imageSource::canConvertFormat( info.format, format ) ? format : info.format;
+}
+
+// The largest scratch buffer kept for reuse by readAndConvert.  It holds the float RGBA data of a
+// BC1 tile (the format with the most texels per tile, at two per byte), so converting a tile of any
+// format reuses it.
+const size_t MAX_SCRATCH_SIZE = 2 * TILE_SIZE_IN_BYTES * 4 * sizeof( float );
+
+}  // namespace
+
 DemandTextureImpl::DemandTextureImpl( unsigned int                              id,
                                       const TextureDescriptor&                  descriptor,
                                       std::shared_ptr<imageSource::ImageSource> image,
@@ -72,6 +112,20 @@ DemandTextureImpl::DemandTextureImpl( unsigned int id, DemandTextureImpl* master
     masterTexture->addVariantId( id );
 }
 
+const std::vector<unsigned int> DemandTextureImpl::NO_VARIANTS;
+
+DemandTextureImpl::~DemandTextureImpl()
+{
+    releaseAtlasSlot();
+}
+
+void DemandTextureImpl::releaseAtlasSlot()
+{
+    if( m_atlasSlot.isValid() )
+        m_loader->getTextureAtlas()->release( m_atlasSlot );
+    m_atlasSlot = AtlasSlot();
+}
+
 void DemandTextureImpl::setImage( const TextureDescriptor& descriptor, std::shared_ptr<imageSource::ImageSource> newImage )
 {
     std::unique_lock<std::mutex> lock( m_initMutex );
@@ -88,6 +142,8 @@ void DemandTextureImpl::setImage( const TextureDescriptor& descriptor, std::shar
     imageSource::TextureInfo newInfo;
     newImage->open( &newInfo );
     OTK_ASSERT( newInfo.isValid );
+    const CUarray_format newImageFormat = newInfo.format;
+    newInfo.format = getDeviceFormat( descriptor, newInfo, newImage->getFillType() );
 
     // If the new image is a different size or format, the texture will need to be re-initialized
     // FIXME: This leaks pages in the virtual address space, but currently there is no way to reclaim them.
@@ -96,18 +152,84 @@ void DemandTextureImpl::setImage( const TextureDescriptor& descriptor, std::shar
     if( !( descriptor == m_descriptor ) || !( newInfo == m_info ) )
     {
         m_isInitialized = false;
+        m_isSamplerReady.store( false, std::memory_order_release );
+        if( m_loader )
+            m_loader->setTextureGroupSampler( m_id, nullptr );
+        releaseAtlasSlot();
         // Reset the sampler so the texture will be reinitialized, keeping only the udim info
         TextureSampler newSampler = {};
         newSampler.udimStartPage = m_sampler.udimStartPage;
         newSampler.udim = m_sampler.udim;
         newSampler.vdim = m_sampler.vdim;
+        newSampler.numChannelTextures = m_sampler.numChannelTextures;
+        newSampler.udimSlots = m_sampler.udimSlots;
+        newSampler.numUdimSlots = m_sampler.numUdimSlots;
         newSampler.desc.isUdimBaseTexture = m_sampler.desc.isUdimBaseTexture;
         m_sampler = newSampler;
     }
 
-    m_info       = newInfo;
-    m_descriptor = descriptor;
-    m_image      = newImage;
+    m_info        = newInfo;
+    m_imageFormat = newImageFormat;
+    m_descriptor  = descriptor;
+    m_image       = newImage;
+}
+
+// If the image format differs from the device format, the data is read into a scratch buffer and
+// converted (or block compressed, one level at a time) into the destination buffer.  Block compressed
+// data is kept in the on-disk cache if there is one, keyed by the uncompressed data.
+bool DemandTextureImpl::readAndConvert( char* dest, const uint2* levelDims, unsigned int numLevels, const std::function<bool( char* )>& read ) const
+{
+    if( m_imageFormat == m_info.format )
+        return read( dest );
+
+    size_t numPixels = 0;
+    for( unsigned int i = 0; i < numLevels; ++i )
+        numPixels += static_cast<size_t>( levelDims[i].x ) * levelDims[i].y;
+    const unsigned int imagePixelSize = m_info.numChannels * imageSource::getBytesPerChannel( m_imageFormat );
+
+    // The scratch buffer is reused by the request processing threads, unless it grows beyond the
+    // largest tile (see MAX_SCRATCH_SIZE).
+    static thread_local std::vector<char> scratch;
+    scratch.resize( numPixels * imagePixelSize );
+
+    const bool ok = read( scratch.data() );
+    if( ok && !imageSource::isBlockCompressed( m_info.format ) )
+    {
+        imageSource::convertFormat( scratch.data(), m_imageFormat, dest, m_info.format, numPixels * m_info.numChannels );
+    }
+    else if( ok )
+    {
+        // The key depends on the encoding and level dimensions as well as the data.
+        EncodedTileCache* cache       = m_loader ? m_loader->getEncodedTileCache() : nullptr;
+        size_t            encodedSize = 0;
+        uint64_t          seed = ( static_cast<uint64_t>( m_imageFormat ) << 32 ) | ( m_info.format << 16 ) | ( m_info.numChannels << 8 )
+                        | m_descriptor.encodeQuality;
+        for( unsigned int i = 0; i < numLevels; ++i )
+        {
+            encodedSize += imageSource::getImageSizeInBytes( m_info.format, m_info.numChannels, levelDims[i].x, levelDims[i].y );
+            seed = seed * 31 + ( ( static_cast<uint64_t>( levelDims[i].x ) << 32 ) | levelDims[i].y );
+        }
+        const uint64_t key = cache ? TileDeduplicator::hashTile( scratch.data(), scratch.size(), seed ) : 0;
+
+        if( !cache || !cache->load( key, seed, dest, encodedSize ) )
+        {
+            const char* src     = scratch.data();
+            char*       encoded = dest;
+            for( unsigned int i = 0; i < numLevels; ++i )
+            {
+                imageSource::encodeBlocks( src, m_imageFormat, m_info.numChannels, levelDims[i].x, levelDims[i].y, encoded, m_info.format,
+                                           static_cast<imageSource::EncodeQuality>( m_descriptor.encodeQuality ) );
+                src += static_cast<size_t>( levelDims[i].x ) * levelDims[i].y * imagePixelSize;
+                encoded += imageSource::getImageSizeInBytes( m_info.format, m_info.numChannels, levelDims[i].x, levelDims[i].y );
+            }
+            if( cache )
+                cache->store( key, seed, dest, encodedSize );
+        }
+    }
+
+    if( scratch.capacity() > MAX_SCRATCH_SIZE )
+        std::vector<char>().swap( scratch );
+    return ok;
 }
 
 unsigned int DemandTextureImpl::getId() const
@@ -124,75 +246,140 @@ void DemandTextureImpl::init()
     {
         // Get the master array (backing store) if there is master texture
         std::shared_ptr<SparseArray> masterArray( nullptr );
-        if( m_masterTexture && !m_masterTexture->m_sparseTexture.isInitialized() )
+        if( m_masterTexture && !( m_masterTexture->m_sparseTexture && m_masterTexture->m_sparseTexture->isInitialized() ) )
             m_masterTexture->init();
         if( m_masterTexture )
-            masterArray = m_masterTexture->m_sparseTexture.getSparseArray();
+            masterArray = m_masterTexture->m_sparseTexture->getSparseArray();
 
-        m_sparseTexture.init( m_descriptor, m_info, masterArray );
+        if( !m_sparseTexture )
+            m_sparseTexture.reset( new SparseTexture );
+        SparseArrayPool* arrayPool = m_loader ? m_loader->getSparseArrayPool() : nullptr;
+        m_sparseTexture->init( m_descriptor, m_info, masterArray, arrayPool );
 
         // Device-independent initialization.
         if( !m_isInitialized )
         {
             m_isInitialized = true;
+            if( !m_initState )
+                m_initState.reset( new InitState );
 
             // Retain various properties for subsequent use.
-            m_tileWidth         = m_sparseTexture.getTileWidth();
-            m_tileHeight        = m_sparseTexture.getTileHeight();
-            m_mipTailFirstLevel = m_sparseTexture.getMipTailFirstLevel();
-            m_mipTailSize       = m_mipTailFirstLevel < m_info.numMipLevels ? m_sparseTexture.getMipTailSize() : 0;
+            m_initState->tileWidth         = m_sparseTexture->getTileWidth();
+            m_initState->tileHeight        = m_sparseTexture->getTileHeight();
+            m_initState->mipTailFirstLevel = m_sparseTexture->getMipTailFirstLevel();
+            m_initState->mipTailSize       = m_initState->mipTailFirstLevel < m_info.numMipLevels ? m_sparseTexture->getMipTailSize() : 0;
 
             // Verify that the tile size agrees with TilePool.
-            OTK_ASSERT( m_tileWidth * m_tileHeight * imageSource::getBytesPerChannel( m_info.format ) <= TILE_SIZE_IN_BYTES );
+            OTK_ASSERT( imageSource::getImageSizeInBytes( m_info.format, m_info.numChannels, m_initState->tileWidth, m_initState->tileHeight ) <= TILE_SIZE_IN_BYTES );
+
+            // Record the dimensions of each miplevel.
+            const unsigned int numMipLevels = m_info.numMipLevels;
+            m_initState->mipLevelDims.resize( numMipLevels );
+            for( unsigned int i = 0; i < numMipLevels; ++i )
+            {
+                m_initState->mipLevelDims[i] = m_sparseTexture->getMipLevelDims( i );
+            }
+            initSampler();
+        }
+    }
+    else if( useTextureAtlas() )
+    {
+        // Small textures are packed into the texture atlas.  Variants get their own slot, since the
+        // atlas page is chosen by the filtering in the descriptor.
+        const bool needsSlot = !m_atlasSlot.isValid();
+        if( needsSlot )
+            m_atlasSlot = m_loader->getTextureAtlas()->allocate( m_descriptor, m_info );
+
+        // Device-independent initialization.
+        if( !m_isInitialized )
+        {
+            m_isInitialized = true;
+            if( !m_initState )
+                m_initState.reset( new InitState );
+
+            // Set dummy properties (not used for atlas textures)
+            m_initState->tileWidth         = 64;
+            m_initState->tileHeight        = 64;
+            m_initState->mipTailFirstLevel = 0;
+            m_initState->mipTailSize       = 0;
 
             // Record the dimensions of each miplevel.
             const unsigned int numMipLevels = m_info.numMipLevels;
-            m_mipLevelDims.resize( numMipLevels );
+            m_initState->mipLevelDims.resize( numMipLevels );
             for( unsigned int i = 0; i < numMipLevels; ++i )
             {
-                m_mipLevelDims[i] = m_sparseTexture.getMipLevelDims( i );
+                m_initState->mipLevelDims[i] = uint2{std::max( m_info.width >> i, 1U ), std::max( m_info.height >> i, 1U )};
+
+                m_initState->mipTailSize += imageSource::getImageSizeInBytes(
+                    m_info.format, m_info.numChannels, m_initState->mipLevelDims[i].x, m_initState->mipLevelDims[i].y );
             }
             initSampler();
         }
+
+        // The slot changes if the texture was released and initialized again.
+        if( needsSlot )
+            initAtlasSampler();
     }
     else // dense texture
     {
         // Get the master array (backing store) if there is master texture
         std::shared_ptr<CUmipmappedArray> masterArray( nullptr );
-        if( m_masterTexture && !m_masterTexture->m_denseTexture.isInitialized() )
+        if( m_masterTexture && !( m_masterTexture->m_denseTexture && m_masterTexture->m_denseTexture->isInitialized() ) )
             m_masterTexture->init();
         if( m_masterTexture )
-            masterArray = m_masterTexture->m_denseTexture.getDenseArray();
+            masterArray = m_masterTexture->m_denseTexture->getDenseArray();
 
-        m_denseTexture.init( m_descriptor, m_info, masterArray );
+        if( !m_denseTexture )
+            m_denseTexture.reset( new DenseTexture );
+        m_denseTexture->init( m_descriptor, m_info, masterArray );
 
         // Device-independent initialization.
         if( !m_isInitialized )
         {
             m_isInitialized = true;
+            if( !m_initState )
+                m_initState.reset( new InitState );
 
             // Set dummy properties (not used for dense textures)
-            m_tileWidth         = 64;
-            m_tileHeight        = 64;
-            m_mipTailFirstLevel = 0;
-            m_mipTailSize       = 0;
+            m_initState->tileWidth         = 64;
+            m_initState->tileHeight        = 64;
+            m_initState->mipTailFirstLevel = 0;
+            m_initState->mipTailSize       = 0;
 
             // Record the dimensions of each miplevel.
             const unsigned int numMipLevels = m_info.numMipLevels;
-            m_mipLevelDims.resize( numMipLevels );
+            m_initState->mipLevelDims.resize( numMipLevels );
             for( unsigned int i = 0; i < numMipLevels; ++i )
             {
 
-                m_mipLevelDims[i] = m_denseTexture.getMipLevelDims( i );
+                m_initState->mipLevelDims[i] = m_denseTexture->getMipLevelDims( i );
 
-                m_mipTailSize += m_mipLevelDims[i].x * m_mipLevelDims[i].y * m_info.numChannels
-                                 * imageSource::getBytesPerChannel( m_info.format );
+                m_initState->mipTailSize += imageSource::getImageSizeInBytes(
+                    m_info.format, m_info.numChannels, m_initState->mipLevelDims[i].x, m_initState->mipLevelDims[i].y );
             }
             initSampler();
         }
     }
 }
 
+void DemandTextureImpl::releaseDeviceTextures()
+{
+    std::unique_lock<std::mutex> lock( m_initMutex );
+    if( m_sparseTexture )
+        m_sparseTexture->destroy();
+    if( m_denseTexture )
+        m_denseTexture->destroy();
+    releaseAtlasSlot();
+}
+
+void DemandTextureImpl::initAtlasSampler()
+{
+    const float atlasWidth   = static_cast<float>( TextureAtlas::ATLAS_WIDTH );
+    m_sampler.isAtlasTexture = 1;
+    m_sampler.atlasOffset    = float2{m_atlasSlot.x / atlasWidth, m_atlasSlot.y / atlasWidth};
+    m_sampler.atlasScale     = float2{m_info.width / atlasWidth, m_info.height / atlasWidth};
+}
+
 void DemandTextureImpl::initSampler()
 {
     // Construct the canonical sampler for this texture, excluding the CUDA texture object
@@ -200,8 +387,8 @@ void DemandTextureImpl::initSampler()
 
     // Descriptions
     m_sampler.desc.numMipLevels     = m_info.numMipLevels;
-    m_sampler.desc.logTileWidth     = static_cast<unsigned int>( log2f( static_cast<float>( m_tileWidth ) ) );
-    m_sampler.desc.logTileHeight    = static_cast<unsigned int>( log2f( static_cast<float>( m_tileHeight ) ) );
+    m_sampler.desc.logTileWidth     = static_cast<unsigned int>( log2f( static_cast<float>( m_initState->tileWidth ) ) );
+    m_sampler.desc.logTileHeight    = static_cast<unsigned int>( log2f( static_cast<float>( m_initState->tileHeight ) ) );
     m_sampler.desc.isSparseTexture  = useSparseTexture() ? 1 : 0;
     m_sampler.desc.wrapMode0        = static_cast<int>( m_descriptor.addressMode[0] );
     m_sampler.desc.wrapMode1        = static_cast<int>( m_descriptor.addressMode[1] );
@@ -211,7 +398,7 @@ void DemandTextureImpl::initSampler()
     // Dimensions
     m_sampler.width             = m_info.width;
     m_sampler.height            = m_info.height;
-    m_sampler.mipTailFirstLevel = m_mipTailFirstLevel;
+    m_sampler.mipTailFirstLevel = m_initState->mipTailFirstLevel;
 
     // Initialize mipLevelSizes
     TextureSampler::MipLevelSizes* mls = m_sampler.mipLevelSizes;
@@ -228,9 +415,9 @@ void DemandTextureImpl::initSampler()
                 mls[mipLevel].mipLevelStart = 0;
 
             mls[mipLevel].levelWidthInTiles = static_cast<unsigned short>(
-                getLevelDimInTiles( m_sampler.width, static_cast<unsigned int>( mipLevel ), m_tileWidth ) );
+                getLevelDimInTiles( m_sampler.width, static_cast<unsigned int>( mipLevel ), m_initState->tileWidth ) );
             mls[mipLevel].levelHeightInTiles = static_cast<unsigned short>(
-                getLevelDimInTiles( m_sampler.height, static_cast<unsigned int>( mipLevel ), m_tileHeight ) );
+                getLevelDimInTiles( m_sampler.height, static_cast<unsigned int>( mipLevel ), m_initState->tileHeight ) );
         }
         m_sampler.numPages = mls[0].mipLevelStart + getNumTilesInLevel( 0 );
 
@@ -242,11 +429,11 @@ void DemandTextureImpl::initSampler()
         }
         else
         {
-            // If the texture is being resized, remove the existing request handler
-            if( m_requestHandler != nullptr )
-                m_loader->getPageTableManager()->removeRequestHandler( m_requestHandler->getStartPage() );
-            m_requestHandler.reset( new TextureRequestHandler( this, m_loader ) );
-            m_sampler.startPage = m_loader->getPageTableManager()->reserveUnbackedPages( m_sampler.numPages, m_requestHandler.get() );
+            // If the texture is being resized, release the existing page range for reuse
+            if( m_initState->requestHandler != nullptr )
+                m_loader->releasePages( m_initState->requestHandler->getStartPage() );
+            m_initState->requestHandler.reset( new TextureRequestHandler( this, m_loader ) );
+            m_sampler.startPage = m_loader->getPageTableManager()->reserveUnbackedPages( m_sampler.numPages, m_initState->requestHandler.get() );
         }
     }
     else // Dense texture 
@@ -260,6 +447,12 @@ void DemandTextureImpl::initSampler()
     m_sampler.hasCascade = m_image->hasCascade();
     m_sampler.cascadeLevel = static_cast<unsigned short>( getCascadeLevel( m_sampler.width, m_sampler.height ) );
     m_sampler.filterMode = m_descriptor.filterMode;
+
+    // Publish the sampler to readers on other threads, and to the texture groups snapshot read by
+    // request filtering.
+    m_isSamplerReady.store( true, std::memory_order_release );
+    if( m_loader )
+        m_loader->setTextureGroupSampler( m_id, &m_sampler );
 }
 
 const imageSource::TextureInfo& DemandTextureImpl::getInfo() const
@@ -282,20 +475,20 @@ const TextureDescriptor& DemandTextureImpl::getDescriptor() const
 uint2 DemandTextureImpl::getMipLevelDims( unsigned int mipLevel ) const
 {
     OTK_ASSERT( m_isInitialized );
-    OTK_ASSERT( mipLevel < m_mipLevelDims.size() );
-    return m_mipLevelDims[mipLevel];
+    OTK_ASSERT( mipLevel < m_initState->mipLevelDims.size() );
+    return m_initState->mipLevelDims[mipLevel];
 }
 
 unsigned int DemandTextureImpl::getTileWidth() const
 {
     OTK_ASSERT( m_isInitialized );
-    return m_tileWidth;
+    return m_initState->tileWidth;
 }
 
 unsigned int DemandTextureImpl::getTileHeight() const
 {
     OTK_ASSERT( m_isInitialized );
-    return m_tileHeight;
+    return m_initState->tileHeight;
 }
 
 bool DemandTextureImpl::isMipmapped() const
@@ -315,27 +508,47 @@ bool DemandTextureImpl::useSparseTexture() const
     return m_info.width * m_info.height > SPARSE_TEXTURE_THRESHOLD;
 }
 
+bool DemandTextureImpl::useTextureAtlas() const
+{
+    OTK_ASSERT( m_info.isValid );
+    return m_loader->getOptions().useTextureAtlas && !useSparseTexture() && !isDegenerate()
+           && TextureAtlas::isEligible( m_descriptor, m_info );
+}
+
 unsigned int DemandTextureImpl::getMipTailFirstLevel() const
 {
     OTK_ASSERT( m_isInitialized );
-    return m_mipTailFirstLevel;
+    return m_initState->mipTailFirstLevel;
+}
+
+unsigned int DemandTextureImpl::getNumPagesFromLevel( unsigned int mipLevel ) const
+{
+    OTK_ASSERT( m_isInitialized );
+    if( !m_sampler.desc.isSparseTexture )
+        return m_sampler.numPages;
+
+    // Tiles are numbered from the mip tail to the finest level, so coarser levels come first.
+    mipLevel = std::min( mipLevel, m_initState->mipTailFirstLevel );
+    return ( mipLevel > 0 ) ? m_sampler.mipLevelSizes[mipLevel - 1].mipLevelStart : m_sampler.numPages;
 }
 
 CUtexObject DemandTextureImpl::getTextureObject() const
 {
     OTK_ASSERT( m_isInitialized );
     if( useSparseTexture() )
-        return m_sparseTexture.getTextureObject();
-    return m_denseTexture.getTextureObject();
+        return m_sparseTexture->getTextureObject();
+    if( m_atlasSlot.isValid() )
+        return m_loader->getTextureAtlas()->getTextureObject( m_atlasSlot );
+    return m_denseTexture->getTextureObject();
 }
 
 unsigned int DemandTextureImpl::getNumTilesInLevel( unsigned int mipLevel ) const
 {
-    if( mipLevel > m_mipTailFirstLevel || mipLevel >= m_info.numMipLevels )
+    if( mipLevel > m_initState->mipTailFirstLevel || mipLevel >= m_info.numMipLevels )
         return 0;
 
-    unsigned int levelWidthInTiles  = getLevelDimInTiles( m_mipLevelDims[0].x, mipLevel, m_tileWidth );
-    unsigned int levelHeightInTiles = getLevelDimInTiles( m_mipLevelDims[0].y, mipLevel, m_tileHeight );
+    unsigned int levelWidthInTiles  = getLevelDimInTiles( m_initState->mipLevelDims[0].x, mipLevel, m_initState->tileWidth );
+    unsigned int levelHeightInTiles = getLevelDimInTiles( m_initState->mipLevelDims[0].y, mipLevel, m_initState->tileHeight );
 
     return calculateNumTilesInLevel( levelWidthInTiles, levelHeightInTiles );
 }
@@ -350,12 +563,19 @@ void DemandTextureImpl::accumulateStatistics( Statistics& stats )
     if( info.isValid )
         stats.virtualTextureBytes += getTextureSizeInBytes( info );
 
-    stats.bytesTransferredToDevice += m_sparseTexture.getNumBytesFilled();
-    stats.numEvictions += m_sparseTexture.getNumUnmappings();
-
-    stats.bytesTransferredToDevice += m_denseTexture.getNumBytesFilled();
-    if( m_denseTexture.isInitialized() && m_denseTexture.getTextureObject() != 0 )
-        stats.deviceMemoryUsed += getTextureSizeInBytes( info );
+    if( m_sparseTexture )
+    {
+        stats.bytesTransferredToDevice += m_sparseTexture->getNumBytesFilled();
+        stats.numCopiesToDevice += m_sparseTexture->getNumCopies();
+        stats.numEvictions += m_sparseTexture->getNumUnmappings();
+    }
+    if( m_denseTexture )
+    {
+        stats.bytesTransferredToDevice += m_denseTexture->getNumBytesFilled();
+        stats.numCopiesToDevice += m_denseTexture->getNumCopies();
+        if( m_denseTexture->isInitialized() && m_denseTexture->getTextureObject() != 0 )
+            stats.deviceMemoryUsed += getTextureSizeInBytes( info );
+    }
 }
 
 // Tiles can be read concurrently.
@@ -366,13 +586,31 @@ bool DemandTextureImpl::readTile( unsigned int mipLevel, unsigned int tileX, uns
     OTK_ASSERT( mipLevel < m_info.numMipLevels );
 
     // Resize buffer if necessary.
-    const unsigned int bytesPerPixel = imageSource::getBytesPerChannel( getInfo().format ) * getInfo().numChannels;
-    const unsigned int bytesPerTile  = getTileWidth() * getTileHeight() * bytesPerPixel;
+    const size_t bytesPerTile = imageSource::getImageSizeInBytes( m_info.format, m_info.numChannels, getTileWidth(), getTileHeight() );
     OTK_ASSERT_MSG( bytesPerTile <= tileBufferSize, "Maximum tile size exceeded" );
     (void)bytesPerTile;  // silence unused variable warning
     (void)tileBufferSize;
 
-    return m_image->readTile( tileBuffer, mipLevel, { tileX, tileY, getTileWidth(), getTileHeight() }, stream );
+    const imageSource::Tile tile{ tileX, tileY, getTileWidth(), getTileHeight() };
+    const uint2             tileDims{ tile.width, tile.height };
+    return readAndConvert( tileBuffer, &tileDims, 1, [&]( char* dest ) { return m_image->readTile( dest, mipLevel, tile, stream ); } );
+}
+
+bool DemandTextureImpl::computeBaseColor( float4& baseColor )
+{
+    if( !imageSource::computeBaseColor( *m_image, baseColor ) )
+        return false;
+    m_image->writeBaseColor( baseColor );
+    return true;
+}
+
+bool DemandTextureImpl::readTileHash( unsigned int mipLevel, unsigned int tileX, unsigned int tileY, uint64_t& hash ) const
+{
+    OTK_ASSERT( m_isInitialized );
+    OTK_ASSERT( mipLevel < m_info.numMipLevels );
+
+    const imageSource::Tile tile{ tileX, tileY, getTileWidth(), getTileHeight() };
+    return m_image->readTileHash( hash, mipLevel, tile );
 }
 
 // Tiles can be filled concurrently.
@@ -389,7 +627,7 @@ void DemandTextureImpl::fillTile( CUstream                     stream,
     OTK_ASSERT( mipLevel < m_info.numMipLevels );
     OTK_ASSERT( tileSize <= TILE_SIZE_IN_BYTES );
 
-    m_sparseTexture.fillTile( stream, mipLevel, tileX, tileY, tileData, tileDataType, tileSize, handle, offset );
+    m_sparseTexture->fillTile( stream, mipLevel, tileX, tileY, tileData, tileDataType, tileSize, handle, offset );
 }
 
 void DemandTextureImpl::mapTile( CUstream                     stream,
@@ -400,24 +638,27 @@ void DemandTextureImpl::mapTile( CUstream                     stream,
                                  size_t                       tileOffset ) const
 {
     OTK_ASSERT( mipLevel < m_info.numMipLevels );
-    m_sparseTexture.mapTile( stream, mipLevel, tileX, tileY, tileHandle, tileOffset );
+    m_sparseTexture->mapTile( stream, mipLevel, tileX, tileY, tileHandle, tileOffset );
 }
 
 // Tiles can be unmapped concurrently.
 void DemandTextureImpl::unmapTile( CUstream stream, unsigned int mipLevel, unsigned int tileX, unsigned int tileY ) const
 {
     OTK_ASSERT( mipLevel < m_info.numMipLevels );
-    m_sparseTexture.unmapTile( stream, mipLevel, tileX, tileY );
+    m_sparseTexture->unmapTile( stream, mipLevel, tileX, tileY );
 }
 
 bool DemandTextureImpl::readNonMipMappedData( char* buffer, size_t bufferSize, CUstream stream ) const
 {
     OTK_ASSERT( m_isInitialized );
     OTK_ASSERT( m_info.numMipLevels == 1 );
-    OTK_ASSERT_MSG( m_mipTailSize <= bufferSize, "Provided buffer is too small." );
+    OTK_ASSERT_MSG( m_initState->mipTailSize <= bufferSize, "Provided buffer is too small." );
     (void)bufferSize;  // silence unused variable warning.
 
-    return m_image->readMipLevel( buffer, 0, getInfo().width, getInfo().height, stream );
+    const uint2 levelDims{ m_info.width, m_info.height };
+    return readAndConvert( buffer, &levelDims, 1, [&]( char* dest ) {
+        return m_image->readMipLevel( dest, 0, m_info.width, m_info.height, stream );
+    } );
 }
 
 bool DemandTextureImpl::readMipTail( char* buffer, size_t bufferSize, CUstream stream ) const
@@ -430,13 +671,37 @@ bool DemandTextureImpl::readMipLevels( char* buffer, size_t bufferSize, unsigned
     OTK_ASSERT( m_isInitialized );
     OTK_ASSERT( startLevel < getInfo().numMipLevels );
 
-    const unsigned int pixelSize = getInfo().numChannels * imageSource::getBytesPerChannel( getInfo().format );
-    size_t dataSize = ( m_mipLevelDims[startLevel].x * m_mipLevelDims[startLevel].y * pixelSize * 4 ) / 3;
+    size_t dataSize = 0;
+    for( unsigned int mipLevel = startLevel; mipLevel < m_info.numMipLevels; ++mipLevel )
+    {
+        const uint2 levelDims = m_initState->mipLevelDims[mipLevel];
+        dataSize += imageSource::getImageSizeInBytes( m_info.format, m_info.numChannels, levelDims.x, levelDims.y );
+    }
     OTK_ASSERT_MSG( dataSize <= bufferSize, "Provided buffer is too small." );
     (void)dataSize;  // silence unused variable warning
     (void)bufferSize;
 
-    return m_image->readMipTail( buffer, startLevel, getInfo().numMipLevels, m_mipLevelDims.data(), pixelSize, stream );
+    // The pixel size is ignored for block compressed images.
+    const unsigned int imagePixelSize =
+        imageSource::isBlockCompressed( m_imageFormat ) ? 0 : m_info.numChannels * imageSource::getBytesPerChannel( m_imageFormat );
+    return readAndConvert( buffer, &m_initState->mipLevelDims[startLevel], m_info.numMipLevels - startLevel, [&]( char* dest ) {
+        return m_image->readMipTail( dest, startLevel, m_info.numMipLevels, m_initState->mipLevelDims.data(), imagePixelSize, stream );
+    } );
+}
+
+bool DemandTextureImpl::readMipLevel( char* buffer, size_t bufferSize, unsigned int mipLevel, CUstream stream ) const
+{
+    OTK_ASSERT( m_isInitialized );
+    OTK_ASSERT( mipLevel < getInfo().numMipLevels );
+
+    const uint2 levelDims = m_initState->mipLevelDims[mipLevel];
+    OTK_ASSERT_MSG( imageSource::getImageSizeInBytes( m_info.format, m_info.numChannels, levelDims.x, levelDims.y ) <= bufferSize,
+                    "Provided buffer is too small." );
+    (void)bufferSize;  // silence unused variable warning
+
+    return readAndConvert( buffer, &levelDims, 1, [&]( char* dest ) {
+        return m_image->readMipLevel( dest, mipLevel, levelDims.x, levelDims.y, stream );
+    } );
 }
 
 void DemandTextureImpl::fillMipTail( CUstream                     stream,
@@ -448,23 +713,42 @@ void DemandTextureImpl::fillMipTail( CUstream                     stream,
 {
     OTK_ASSERT( getMipTailFirstLevel() < m_info.numMipLevels );
 
-    m_sparseTexture.fillMipTail( stream, mipTailData, mipTailDataType, mipTailSize, handle, offset );
+    m_sparseTexture->fillMipTail( stream, mipTailData, mipTailDataType, mipTailSize, handle, offset );
 }
 
 void DemandTextureImpl::mapMipTail( CUstream stream, CUmemGenericAllocationHandle tileHandle, size_t tileOffset )
 {
-    m_sparseTexture.mapMipTail( stream, tileHandle, tileOffset );
+    m_sparseTexture->mapMipTail( stream, tileHandle, tileOffset );
 }
 
 void DemandTextureImpl::unmapMipTail( CUstream stream ) const
 {
-    m_sparseTexture.unmapMipTail( stream );
+    m_sparseTexture->unmapMipTail( stream );
 }
 
 // Fill the dense texture on the given stream.
 void DemandTextureImpl::fillDenseTexture( CUstream stream, const char* textureData, unsigned int width, unsigned int height, bool bufferPinned )
 {
-    m_denseTexture.fillTexture( stream, textureData, width, height, bufferPinned );
+    if( m_atlasSlot.isValid() )
+    {
+        OTK_ASSERT( width == m_info.width && height == m_info.height );
+        m_loader->getTextureAtlas()->fillSlot( m_atlasSlot, stream, textureData, m_info, bufferPinned );
+        return;
+    }
+    m_denseTexture->fillTexture( stream, textureData, width, height, bufferPinned );
+}
+
+// Fill some of the mip levels of the dense texture on the given stream.
+void DemandTextureImpl::fillDenseMipLevels( CUstream stream, const char* textureData, unsigned int startLevel, unsigned int endLevel, bool bufferPinned )
+{
+    // Atlas textures are small enough to be filled in one piece.
+    if( m_atlasSlot.isValid() )
+    {
+        OTK_ASSERT( startLevel == 0 && endLevel == m_info.numMipLevels );
+        m_loader->getTextureAtlas()->fillSlot( m_atlasSlot, stream, textureData, m_info, bufferPinned );
+        return;
+    }
+    m_denseTexture->fillMipLevels( stream, textureData, startLevel, endLevel, bufferPinned );
 }
 
 // Lazily open the associated image source.
@@ -480,24 +764,34 @@ void DemandTextureImpl::open()
     {
         m_image->open( &m_info );
         OTK_ASSERT( m_info.isValid );
+        m_imageFormat = m_info.format;
+        m_info.format = getDeviceFormat( m_descriptor, m_info, m_image->getFillType() );
         m_isOpen = true;
     }
 }
 
 // Set this texture as an entry point for a udim texture array.
-void DemandTextureImpl::setUdimTexture( unsigned int udimStartPage, unsigned int udim, unsigned int vdim, unsigned int numChannelTextures, bool isBaseTexture )
+void DemandTextureImpl::setUdimTexture( unsigned int        udimStartPage,
+                                        unsigned int        udim,
+                                        unsigned int        vdim,
+                                        unsigned int        numChannelTextures,
+                                        bool                isBaseTexture,
+                                        const unsigned int* udimSlots,
+                                        unsigned int        numUdimSlots )
 {
     m_sampler.desc.isUdimBaseTexture = isBaseTexture ? 1 : 0;
     m_sampler.udimStartPage          = udimStartPage;
     m_sampler.udim                   = static_cast<unsigned short>( udim );
     m_sampler.vdim                   = static_cast<unsigned short>( vdim );
     m_sampler.numChannelTextures     = numChannelTextures;
+    m_sampler.udimSlots              = udimSlots;
+    m_sampler.numUdimSlots           = numUdimSlots;
 }
 
 size_t DemandTextureImpl::getMipTailSize() 
 { 
     OTK_ASSERT( m_isInitialized );
-    return m_mipTailSize; 
+    return m_initState->mipTailSize; 
 }
 
 }  // namespace demandLoading
@@ -29,6 +29,7 @@
 
 #include "Textures/DenseTexture.h"
 #include "Textures/SparseTexture.h"
+#include "Textures/TextureAtlas.h"
 #include "Textures/TextureRequestHandler.h"
 
 #include <OptiXToolkit/DemandLoading/DemandTexture.h>
@@ -39,7 +40,10 @@
 
 #include <cuda.h>
 
+#include <algorithm>
 #include <atomic>
+#include <climits>
+#include <functional>
 #include <memory>
 #include <mutex>
 #include <set>
@@ -74,8 +78,8 @@ class DemandTextureImpl : public DemandTexture
     /// sparse texture backing store as mainTexture, so texture tiles can be shared between the textures.
     DemandTextureImpl( unsigned int id, DemandTextureImpl* masterTexture, const TextureDescriptor& descriptor, DemandLoaderImpl* loader );
 
-    /// Default destructor.
-    ~DemandTextureImpl() override = default;
+    /// Destroy the texture, releasing its slot in the texture atlas.
+    ~DemandTextureImpl() override;
 
     /// DemandTextureImpl cannot be copied because the PageTableManager holds a pointer to the
     /// RequestHandler it provides.
@@ -90,6 +94,17 @@ class DemandTextureImpl : public DemandTexture
     /// Read the base color of the associated image.
     bool readBaseColor( float4& baseColor ) const { return m_image->readBaseColor( baseColor ); }
 
+    /// Compute the base color of an image that doesn't store one by averaging its coarsest mip level,
+    /// which might be the whole image, and store it in the image (see ImageSource::writeBaseColor).
+    /// Returns false if it can't be computed on the host.  Throws an exception on error.
+    bool computeBaseColor( float4& baseColor );
+
+    /// Return true if the base color of this texture is being computed in the background.
+    bool isBaseColorPending() const { return m_isBaseColorPending.load( std::memory_order_acquire ); }
+
+    /// Mark whether the base color of this texture is being computed in the background.
+    void setBaseColorPending( bool pending ) { m_isBaseColorPending.store( pending, std::memory_order_release ); }
+
     /// Get the memory fill type for this texture.
     CUmemorytype getFillType() const { return m_image->getFillType(); }
 
@@ -136,11 +151,37 @@ class DemandTextureImpl : public DemandTexture
     /// Throws an exception if m_info has not been initialized.
     bool useSparseTexture() const;
 
+    /// Return whether a dense texture is packed into the loader's texture atlas.
+    /// Throws an exception if m_info has not been initialized.
+    bool useTextureAtlas() const;
+
     /// Get the first miplevel in the mip tail.
     unsigned int getMipTailFirstLevel() const;
 
+    /// Get the number of tile pages for mip levels mipLevel and coarser, including the mip tail.
+    /// These pages are contiguous, starting at the first page of the texture.
+    unsigned int getNumPagesFromLevel( unsigned int mipLevel ) const;
+
+    /// Pin tiles in mip levels minLevel and coarser (UINT_MAX unpins the texture).
+    void setPinnedMinLevel( unsigned int minLevel ) { m_pinnedMinLevel = minLevel; }
+
+    /// Get the finest pinned mip level (UINT_MAX if the texture is not pinned).
+    unsigned int getPinnedMinLevel() const { return m_pinnedMinLevel; }
+
+    /// Return true if the texture is pinned.  The mip tail of a pinned texture is always pinned.
+    bool isPinned() const { return m_pinnedMinLevel != UINT_MAX; }
+
+    /// Return true if tiles in the given mip level are pinned.
+    bool isPinnedLevel( unsigned int mipLevel ) const { return mipLevel >= m_pinnedMinLevel; }
+
+    /// Set the residency group of the texture tiles.
+    void setResidencyGroup( unsigned int group ) { m_residencyGroup = group; }
+
+    /// Get the residency group of the texture tiles.
+    unsigned int getResidencyGroup() const { return m_residencyGroup; }
+
     /// Get the request handler for this texture.
-    TextureRequestHandler* getRequestHandler() { return m_requestHandler.get(); }
+    TextureRequestHandler* getRequestHandler() { return m_initState ? m_initState->requestHandler.get() : nullptr; }
 
     /// Accumulate statistics for this texture.
     void accumulateStatistics( Statistics& stats );
@@ -150,6 +191,10 @@ class DemandTextureImpl : public DemandTexture
     bool readTile( unsigned int mipLevel, unsigned int tileX, unsigned int tileY, char* tileBuffer,
                    size_t tileBufferSize, CUstream stream ) const;
 
+    /// Get a hash of the stored data of the specified tile, if the image supports it (see
+    /// ImageSource::readTileHash).  Throws an exception on error.
+    bool readTileHash( unsigned int mipLevel, unsigned int tileX, unsigned int tileY, uint64_t& hash ) const;
+
     /// Fill the device tile backing storage for a texture tile and with the given data.
     void fillTile( CUstream                     stream,
                    unsigned int                 mipLevel,
@@ -168,6 +213,10 @@ class DemandTextureImpl : public DemandTexture
                   CUmemGenericAllocationHandle tileHandle,
                   size_t                       tileOffset ) const;
 
+    /// Check whether the sparse texture has an array, which it no longer does once it is released
+    /// (e.g. by eviction).
+    bool isSparseTextureInitialized() const { return m_sparseTexture && m_sparseTexture->isInitialized(); }
+
     /// Unmap backing storage for a tile
     void unmapTile( CUstream stream, unsigned int mipLevel, unsigned int tileX, unsigned int tileY ) const;
 
@@ -183,6 +232,10 @@ class DemandTextureImpl : public DemandTexture
     /// Throws an exception on error.
     bool readMipLevels( char* buffer, size_t bufferSize, unsigned int startLevel, CUstream stream ) const;
 
+    /// Read a single mip level into the given buffer.
+    /// Throws an exception on error.
+    bool readMipLevel( char* buffer, size_t bufferSize, unsigned int mipLevel, CUstream stream ) const;
+
     /// Fill the device backing storage for the mip tail with the given data.
     void fillMipTail( CUstream                     stream,
                       const char*                  mipTailData,
@@ -199,17 +252,52 @@ class DemandTextureImpl : public DemandTexture
     /// Create and fill the dense texture on the given device
     void fillDenseTexture( CUstream stream, const char* textureData, unsigned int width, unsigned int height, bool bufferPinned );
 
+    /// Fill mip levels [startLevel, endLevel) of the dense texture with textureData, which contains just those levels.
+    void fillDenseMipLevels( CUstream stream, const char* textureData, unsigned int startLevel, unsigned int endLevel, bool bufferPinned );
+
+    /// Destroy the CUDA texture object and release the texture array.  They are recreated by init()
+    /// when the sampler is requested again.
+    void releaseDeviceTextures();
+
     /// Opens the corresponding ImageSource and obtains basic information about the texture dimensions.
     void open();
 
     /// Return true if the texture is open
     bool isOpen() const { return m_isOpen; }
 
-    /// Set this texture as an entry point to a udim texture array
-    void setUdimTexture( unsigned int udimStartPage, unsigned int udim, unsigned int vdim, unsigned int numChannelTextures, bool isBaseTexture );
+    /// Return true if the sampler has been initialized.  Unlike getSampler(), this may be called while
+    /// another thread initializes the texture.
+    bool isSamplerReady() const { return m_isSamplerReady.load( std::memory_order_acquire ); }
+
+    /// Set this texture as an entry point to a udim texture array.  The udimSlots index (in device memory) lists the
+    /// populated slots of a sparse udim grid, and is null if every slot is populated.
+    void setUdimTexture( unsigned int        udimStartPage,
+                         unsigned int        udim,
+                         unsigned int        vdim,
+                         unsigned int        numChannelTextures,
+                         bool                isBaseTexture,
+                         const unsigned int* udimSlots    = nullptr,
+                         unsigned int        numUdimSlots = 0 );
 
     /// Return true if the texture is an entry point for a udim texture
     bool isUdimEntryPoint() { return ( m_sampler.udim > 0 ); }
+
+    /// Return true if the texture is the base texture of a udim texture.
+    bool isUdimBaseTexture() const { return m_sampler.desc.isUdimBaseTexture != 0; }
+
+    /// Get the id of the first subtexture of the udim texture this texture belongs to.
+    unsigned int getUdimStartId() const { return m_sampler.udimStartPage; }
+
+    /// Get the slot index of a sparse udim texture in device memory, or null if the udim grid is dense.
+    const unsigned int* getUdimSlots() const { return m_sampler.udimSlots; }
+
+    /// Get the number of subtextures of the udim texture this texture belongs to, or zero if it is not part of a udim texture.
+    unsigned int getNumUdimSubtextures() const
+    {
+        if( m_sampler.udim == 0 )
+            return 0;
+        return m_sampler.numUdimSlots > 0 ? m_sampler.numUdimSlots : m_sampler.udim * m_sampler.vdim;
+    }
     
     /// Return the size of the mip tail if the texture is initialized.
     size_t getMipTailSize(); 
@@ -218,10 +306,23 @@ class DemandTextureImpl : public DemandTexture
     DemandTextureImpl* getMasterTexture() { return m_masterTexture; }
 
     /// Add a variant id to this (assumes this is a master texture)
-    void addVariantId( unsigned int id ) { m_variantTextureIds.push_back( id ); }
+    void addVariantId( unsigned int id )
+    {
+        if( !m_variantTextureIds )
+            m_variantTextureIds.reset( new std::vector<unsigned int> );
+        m_variantTextureIds->push_back( id );
+    }
+
+    /// Remove a variant id when the variant is destroyed
+    void removeVariantId( unsigned int id )
+    {
+        if( m_variantTextureIds )
+            m_variantTextureIds->erase( std::remove( m_variantTextureIds->begin(), m_variantTextureIds->end(), id ),
+                                        m_variantTextureIds->end() );
+    }
 
     /// Return a list of all the variant ids
-    const std::vector<unsigned int>& getVariantsIds() { return m_variantTextureIds; }
+    const std::vector<unsigned int>& getVariantsIds() { return m_variantTextureIds ? *m_variantTextureIds : NO_VARIANTS; }
 
   private:
     // A mutex guards against concurrent initialization, which can arise when the sampler
@@ -239,7 +340,10 @@ class DemandTextureImpl : public DemandTexture
 
     // Master texture, if this is a texture variant (shares image backing store with master texture). 
     DemandTextureImpl* m_masterTexture;
-    std::vector<unsigned int> m_variantTextureIds;
+
+    // Ids of the variants of a master texture, created with the first variant.
+    std::unique_ptr<std::vector<unsigned int>> m_variantTextureIds;
+    static const std::vector<unsigned int>     NO_VARIANTS;
 
     // The DemandLoader provides access to the PageTableManager, etc.
     DemandLoaderImpl* const m_loader = nullptr;
@@ -250,23 +354,54 @@ class DemandTextureImpl : public DemandTexture
     // The texture is lazily initialized.  Invariant after init().
     bool m_isInitialized{};
 
+    // Set once the sampler is complete, for readers on other threads (see isSamplerReady).
+    std::atomic<bool> m_isSamplerReady{ false };
+
+    // Set while a low priority request computes the base color (see SamplerRequestHandler).
+    std::atomic<bool> m_isBaseColorPending{ false };
+
     // Image info, including dimensions and format.  Invariant after init(), and not valid before then.
     imageSource::TextureInfo m_info{};
-    TextureSampler     m_sampler{};
-    unsigned int       m_tileWidth         = 0;
-    unsigned int       m_tileHeight        = 0;
-    unsigned int       m_mipTailFirstLevel = 0;
-    size_t             m_mipTailSize       = 0;
-    std::vector<uint2> m_mipLevelDims;
 
-    // Sparse and dense textures
-    SparseTexture m_sparseTexture;
-    DenseTexture m_denseTexture;
+    // Format of the image data, which is converted to m_info.format if the descriptor specifies a device format.
+    CUarray_format m_imageFormat{};
+
+    TextureSampler m_sampler{};
+
+    // Finest mip level whose tiles are pinned.  Set by the application, read by request processing threads.
+    std::atomic<unsigned int> m_pinnedMinLevel{ UINT_MAX };
+
+    // Residency group whose quota the texture tiles count against.
+    std::atomic<unsigned int> m_residencyGroup{ 0 };
+
+    // Sparse or dense texture, created by init().  Most textures in a large scene are never sampled, so
+    // these are not part of the texture until it is first used.
+    std::unique_ptr<SparseTexture> m_sparseTexture;
+    std::unique_ptr<DenseTexture>  m_denseTexture;
+
+    // Location of the texture in the texture atlas, used instead of the dense texture for small textures.
+    AtlasSlot m_atlasSlot;
+
+    // Tile and mip level layout, and the request handler of a sparse texture.  Most textures in a large
+    // scene are never sampled, so this is created by init(), and is valid once the texture is initialized.
+    struct InitState
+    {
+        unsigned int                           tileWidth         = 0;
+        unsigned int                           tileHeight        = 0;
+        unsigned int                           mipTailFirstLevel = 0;
+        size_t                                 mipTailSize       = 0;
+        std::vector<uint2>                     mipLevelDims;
+        std::unique_ptr<TextureRequestHandler> requestHandler;
+    };
+    std::unique_ptr<InitState> m_initState;
 
-    // Request handler.
-    std::unique_ptr<TextureRequestHandler> m_requestHandler;
+    // Read image data holding the given mip levels (or a single tile), packed consecutively, with the
+    // given function, converting it to the device format if necessary.
+    bool readAndConvert( char* dest, const uint2* levelDims, unsigned int numLevels, const std::function<bool( char* )>& read ) const;
 
     void         initSampler();
+    void         initAtlasSampler();
+    void         releaseAtlasSlot();
     unsigned int getNumTilesInLevel( unsigned int mipLevel ) const;
 
     // Threshold number of pixels to switch between sparse and dense texture
@@ -109,17 +109,22 @@ uint2 DenseTexture::getMipLevelDims( unsigned int mipLevel ) const
 
 void DenseTexture::fillTexture( CUstream stream, const char* textureData, unsigned int width, unsigned int height, bool bufferPinned ) const
 {
-    OTK_ASSERT( m_isInitialized );
     OTK_ASSERT( width == m_info.width );
     OTK_ASSERT( height == m_info.height );
     (void)width; // silence unused variable warning
     (void)height;
 
-    // Fill each level.
-    size_t             offset    = 0;
-    const unsigned int pixelSize = m_info.numChannels * imageSource::getBytesPerChannel( m_info.format );
+    fillMipLevels( stream, textureData, 0, m_info.numMipLevels, bufferPinned );
+}
 
-    for( unsigned int mipLevel = 0; mipLevel < m_info.numMipLevels; ++mipLevel )
+void DenseTexture::fillMipLevels( CUstream stream, const char* textureData, unsigned int startLevel, unsigned int endLevel, bool bufferPinned ) const
+{
+    OTK_ASSERT( m_isInitialized );
+    OTK_ASSERT( startLevel < endLevel && endLevel <= m_info.numMipLevels );
+
+    // Fill each level.
+    size_t offset = 0;
+    for( unsigned int mipLevel = startLevel; mipLevel < endLevel; ++mipLevel )
     {
         CUarray mipLevelArray{};
         OTK_ERROR_CHECK( cuMipmappedArrayGetLevel( &mipLevelArray, *m_array, mipLevel ) );
@@ -129,24 +134,40 @@ void DenseTexture::fillTexture( CUstream stream, const char* textureData, unsign
         CUDA_MEMCPY2D copyArgs{};
         copyArgs.srcMemoryType = CU_MEMORYTYPE_HOST;
         copyArgs.srcHost       = textureData + offset;
-        copyArgs.srcPitch      = levelDims.x * pixelSize;
+        copyArgs.srcPitch      = imageSource::getRowSizeInBytes( m_info.format, m_info.numChannels, levelDims.x );
 
         copyArgs.dstMemoryType = CU_MEMORYTYPE_ARRAY;
         copyArgs.dstArray      = mipLevelArray;
 
-        copyArgs.WidthInBytes = levelDims.x * pixelSize;
-        copyArgs.Height       = levelDims.y;
+        // Block compressed levels are copied as rows of blocks.
+        copyArgs.WidthInBytes = copyArgs.srcPitch;
+        copyArgs.Height       = imageSource::getNumRows( m_info.format, levelDims.y );
 
         if( bufferPinned )
             OTK_ERROR_CHECK( cuMemcpy2DAsync( &copyArgs, stream ) );
         else 
             OTK_ERROR_CHECK( cuMemcpy2D( &copyArgs ) );
 
-        offset += levelDims.x * levelDims.y * pixelSize;
+        offset += copyArgs.WidthInBytes * copyArgs.Height;
         m_numBytesFilled += copyArgs.WidthInBytes * copyArgs.Height;
+        ++m_numCopies;
     }
 }
 
+void DenseTexture::destroy()
+{
+    if( !m_isInitialized )
+        return;
+
+    // m_array destroyed by shared_ptr deleter when it is no longer shared
+    m_array.reset();
+    ContextSaver contextSaver;
+    OTK_ERROR_CHECK( cuCtxSetCurrent( m_context ) );
+    OTK_ERROR_CHECK( cuTexObjectDestroy( m_texture ) );
+    m_texture       = CUtexObject{};
+    m_isInitialized = false;
+}
+
 DenseTexture::~DenseTexture()
 {
     if( m_isInitialized )
@@ -159,4 +180,23 @@ DenseTexture::~DenseTexture()
     }
 }
 
+std::vector<unsigned int> getDenseFillChunks( const std::vector<size_t>& levelSizes, size_t maxChunkSize )
+{
+    std::vector<unsigned int> chunkEnds;
+    size_t                    chunkSize = 0;
+    for( unsigned int mipLevel = 0; mipLevel < levelSizes.size(); ++mipLevel )
+    {
+        // Start a new chunk if this level would overflow the current one.
+        if( chunkSize > 0 && chunkSize + levelSizes[mipLevel] > maxChunkSize )
+        {
+            chunkEnds.push_back( mipLevel );
+            chunkSize = 0;
+        }
+        chunkSize += levelSizes[mipLevel];
+    }
+    if( !levelSizes.empty() )
+        chunkEnds.push_back( static_cast<unsigned int>( levelSizes.size() ) );
+    return chunkEnds;
+}
+
 }  // namespace demandLoading
@@ -52,6 +52,9 @@ class DenseTexture
     /// Check whether the texture has been initialized.
     bool isInitialized() const { return m_isInitialized; }
 
+    /// Destroy the texture object and release the array.  The texture can be initialized again.
+    void destroy();
+
     /// Get the dimensions of the specified miplevel.
     uint2 getMipLevelDims( unsigned int mipLevel ) const;
 
@@ -61,9 +64,15 @@ class DenseTexture
     /// Fill the texture mip levels on the device with textureData, which contains all mip levels.
     void fillTexture( CUstream stream, const char* textureData, unsigned int width, unsigned int height, bool bufferPinned ) const;
 
+    /// Fill mip levels [startLevel, endLevel) on the device with textureData, which contains just those levels.
+    void fillMipLevels( CUstream stream, const char* textureData, unsigned int startLevel, unsigned int endLevel, bool bufferPinned ) const;
+
     /// Get total number of bytes filled
     size_t getNumBytesFilled() const { return m_numBytesFilled; }
 
+    /// Get total number of copies issued to fill mip levels
+    size_t getNumCopies() const { return m_numCopies; }
+
     /// Get the mipmapped array backing store for the texture
     std::shared_ptr<CUmipmappedArray> getDenseArray() { return m_array; }
 
@@ -75,6 +84,12 @@ class DenseTexture
     CUtexObject                       m_texture{};
 
     mutable size_t m_numBytesFilled = 0;
+    mutable size_t m_numCopies = 0;
 };
 
+/// Split the mip levels of a dense texture, whose sizes in bytes are given, into consecutive ranges of at most
+/// maxChunkSize bytes so they can be filled through bounded staging buffers.  A level larger than maxChunkSize
+/// is a range of its own.  Returns the end level of each range.
+std::vector<unsigned int> getDenseFillChunks( const std::vector<size_t>& levelSizes, size_t maxChunkSize );
+
 }  // namespace demandLoading
@@ -0,0 +1,96 @@
+//
+// Copyright (c) 2024, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "Textures/EncodedTileCache.h"
+
+#include <OptiXToolkit/ImageSource/FileUtil.h>
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+namespace demandLoading {
+
+namespace {
+
+// The header at the start of each entry.
+struct EntryHeader
+{
+    char     magic[8];
+    uint32_t version;
+    uint32_t reserved;
+    uint64_t seed;
+    uint64_t size;
+};
+
+const char ENTRY_MAGIC[8] = {'O', 'T', 'K', 'B', 'C', 'T', 'C', '1'};
+
+}  // namespace
+
+std::string EncodedTileCache::getPath( uint64_t key ) const
+{
+    char name[32];
+    snprintf( name, sizeof( name ), "%016llx.bc", static_cast<unsigned long long>( key ) );
+    return m_directory + "/" + name;
+}
+
+bool EncodedTileCache::load( uint64_t key, uint64_t seed, char* dest, size_t size )
+{
+    std::ifstream file( getPath( key ), std::ios::binary | std::ios::ate );
+    EntryHeader   header{};
+    if( !file || static_cast<size_t>( file.tellg() ) != sizeof( EntryHeader ) + size || !file.seekg( 0 )
+        || !file.read( reinterpret_cast<char*>( &header ), sizeof( EntryHeader ) )
+        || memcmp( header.magic, ENTRY_MAGIC, sizeof( ENTRY_MAGIC ) ) != 0 || header.version != VERSION
+        || header.seed != seed || header.size != size || !file.read( dest, size ) )
+    {
+        ++m_numMisses;
+        return false;
+    }
+    ++m_numHits;
+    return true;
+}
+
+void EncodedTileCache::store( uint64_t key, uint64_t seed, const char* data, size_t size )
+{
+    EntryHeader header{};
+    memcpy( header.magic, ENTRY_MAGIC, sizeof( ENTRY_MAGIC ) );
+    header.version = VERSION;
+    header.seed    = seed;
+    header.size    = size;
+
+    std::vector<char> entry( sizeof( EntryHeader ) + size );
+    memcpy( entry.data(), &header, sizeof( EntryHeader ) );
+    memcpy( entry.data() + sizeof( EntryHeader ), data, size );
+
+    // Another process might store the same entry concurrently, which is harmless, since entries with
+    // the same key have the same contents.
+    imageSource::writeFileAtomically( getPath( key ), entry.data(), entry.size() );
+}
+
+}  // namespace demandLoading
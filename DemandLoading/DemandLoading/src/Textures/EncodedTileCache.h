@@ -0,0 +1,80 @@
+//
+// Copyright (c) 2024, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace demandLoading {
+
+/// EncodedTileCache keeps texture data that was block compressed on the host (see
+/// TextureDescriptor::deviceFormat) in a directory on disk, so it need not be encoded again in later
+/// runs.  Entries are keyed by a hash of the uncompressed data and the encoding parameters (see
+/// TileDeduplicator::hashTile), so they remain valid when images are reloaded or renamed, and
+/// the directory can be shared by several processes.  Each entry starts with a header holding the
+/// cache version and the seed of its key, which are checked when it is loaded, so that entries from
+/// an older encoder or with a colliding key are not used.  Errors are ignored, treating the entry as
+/// missing.  Thread safe.
+class EncodedTileCache
+{
+  public:
+    /// Construct a cache in the given directory, which must exist.
+    explicit EncodedTileCache( const std::string& directory )
+        : m_directory( directory )
+    {
+    }
+
+    /// Version of the entries, which is increased when the encoded data changes.
+    static const uint32_t VERSION = 1;
+
+    /// Read the entry with the given key into the destination buffer.  Returns false if there is no
+    /// entry of the given size whose key was hashed with the given seed by this version of the cache.
+    bool load( uint64_t key, uint64_t seed, char* dest, size_t size );
+
+    /// Write an entry with the given key, which was hashed with the given seed.  The entry is written
+    /// to a temporary file, which is then renamed, so that concurrent readers never see a partial entry.
+    void store( uint64_t key, uint64_t seed, const char* data, size_t size );
+
+    /// Get the number of entries that were loaded.
+    unsigned int getNumHits() const { return m_numHits; }
+
+    /// Get the number of loads that found no entry.
+    unsigned int getNumMisses() const { return m_numMisses; }
+
+  private:
+    std::string               m_directory;
+    std::atomic<unsigned int> m_numHits{};
+    std::atomic<unsigned int> m_numMisses{};
+
+    std::string getPath( uint64_t key ) const;
+};
+
+}  // namespace demandLoading
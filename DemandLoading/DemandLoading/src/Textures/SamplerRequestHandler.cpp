@@ -32,6 +32,10 @@
 #include "Memory/DeviceMemoryManager.h"
 #include "PagingSystem.h"
 #include "Textures/DemandTextureImpl.h"
+#include "Textures/DenseTexture.h"
+#include "Textures/SamplerUploadBatch.h"
+#include "Textures/SparseMappingBatch.h"
+#include "ThreadPoolRequestProcessor.h"
 #include "TransferBufferDesc.h"
 #include "Util/NVTXProfiling.h"
 
@@ -48,6 +52,9 @@ using namespace imageSource;
 
 namespace demandLoading {
 
+// Dense textures are filled in chunks of whole mip levels up to this size (unless a single level is larger).
+static const size_t DENSE_FILL_CHUNK_SIZE = 4 * 1024 * 1024;
+
 void SamplerRequestHandler::fillRequest( CUstream stream, unsigned int pageId )
 {
     loadPage( stream, pageId, false );
@@ -59,10 +66,23 @@ void SamplerRequestHandler::loadPage( CUstream stream, unsigned int pageId, bool
 
     // We use MutexArray to ensure mutual exclusion on a per-page basis.  This is necessary because
     // multiple streams might race to create the same sampler.
+    SparseMappingBatch* batch = SparseMappingBatch::getCurrent();
+    if( !batch )
+    {
+        MutexArrayLock lock( m_mutex.get(), pageId - m_startPage );
+        loadLockedPage( stream, pageId, reloadIfResident );
+        return;
+    }
 
-    MutexArrayLock lock( m_mutex.get(), pageId - m_startPage );
+    // When requests are batched, the sampler is uploaded when the batch is flushed, so the page stays
+    // locked until then.
+    batch->lockUntilFlushed( m_mutex.get(), pageId - m_startPage );
+    loadLockedPage( stream, pageId, reloadIfResident );
+}
 
-    if( !reloadIfResident && m_loader->getPagingSystem()->isResident( pageId ) )
+void SamplerRequestHandler::loadLockedPage( CUstream stream, unsigned int pageId, bool reloadIfResident )
+{
+    if( !reloadIfResident && m_loader->getPagingSystem()->isResident( pageId ) && !isBaseColorPending( pageId ) )
         return;
 
     // Get the texture and make sure it is open.
@@ -83,6 +103,8 @@ void SamplerRequestHandler::loadPage( CUstream stream, unsigned int pageId, bool
         }
     };
     DemandTextureImpl* texture = getTextureForSamplerId( samplerId );
+    if( texture == nullptr )
+        return;  // The texture was destroyed; ignore stale requests.
     texture->open();
 
     // Load base color if the page is for a base color
@@ -119,28 +141,81 @@ void SamplerRequestHandler::loadPage( CUstream stream, unsigned int pageId, bool
             return;
     }
 
-    // Allocate sampler buffer in pinned memory.
-    MemoryBlockDesc pinnedBlock = m_loader->getPinnedMemoryPool()->alloc( sizeof( TextureSampler ), alignof( TextureSampler ) );
-    TextureSampler* pinnedSampler = reinterpret_cast<TextureSampler*>( pinnedBlock.ptr );
-
     // Copy the canonical sampler from the DemandTexture and set its CUDA texture object, which differs per device.
-    *pinnedSampler         = texture->getSampler();
-    pinnedSampler->texture = texture->getTextureObject();
+    TextureSampler sampler = texture->getSampler();
+    sampler.texture        = texture->getTextureObject();
+    uploadSampler( stream, pageId, sampler );
+}
 
+void SamplerRequestHandler::uploadSampler( CUstream stream, unsigned int pageId, const TextureSampler& sampler )
+{
     // Allocate device memory for device-side sampler.
     TextureSampler* devSampler = m_loader->getDeviceMemoryManager()->allocateSampler();
 
-    // Copy sampler to device memory.
-    OTK_ERROR_CHECK( cuMemcpyAsync( reinterpret_cast<CUdeviceptr>( devSampler ),
-                                      reinterpret_cast<CUdeviceptr>( pinnedSampler ), sizeof( TextureSampler ), stream ) );
+    // Without a batch, the sampler is uploaded immediately.
+    SparseMappingBatch* batch = SparseMappingBatch::getCurrent();
+    if( !batch )
+    {
+        SamplerUploadBatch uploads;
+        uploads.add( pageId, sampler, devSampler );
+        uploadSamplers( stream, uploads );
+        return;
+    }
+
+    // The samplers of a batch are uploaded together when it is flushed.
+    std::unique_lock<std::mutex> lock( m_pendingSamplersMutex );
+    auto                         pending = m_pendingSamplers.find( batch );
+    if( pending == m_pendingSamplers.end() )
+    {
+        pending = m_pendingSamplers.emplace( batch, SamplerUploadBatch() ).first;
+        batch->addCompletion( [this, stream, batch] {
+            SamplerUploadBatch uploads;
+            {
+                std::unique_lock<std::mutex> completionLock( m_pendingSamplersMutex );
+                auto                         it = m_pendingSamplers.find( batch );
+                uploads                         = std::move( it->second );
+                m_pendingSamplers.erase( it );
+            }
+            uploadSamplers( stream, uploads );
+        } );
+    }
+    pending->second.add( pageId, sampler, devSampler );
+}
+
+void SamplerRequestHandler::uploadSamplers( CUstream stream, SamplerUploadBatch& uploads )
+{
+    SCOPED_NVTX_RANGE_FUNCTION_NAME();
+
+    // Stage the samplers in pinned memory, and copy each run of samplers that are adjacent in device
+    // memory with a single copy.
+    const size_t    numBytes    = uploads.size() * sizeof( TextureSampler );
+    MemoryBlockDesc pinnedBlock = m_loader->getPinnedMemoryPool()->alloc( numBytes, alignof( TextureSampler ) );
+    TextureSampler* staging     = reinterpret_cast<TextureSampler*>( pinnedBlock.ptr );
+
+    const std::vector<SamplerUploadBatch::Run> runs = uploads.pack( staging );
+    for( const SamplerUploadBatch::Run& run : runs )
+    {
+        OTK_ERROR_CHECK( cuMemcpyAsync( reinterpret_cast<CUdeviceptr>( uploads.getDeviceSampler( run.first ) ),
+                                        reinterpret_cast<CUdeviceptr>( staging + run.first ),
+                                        run.count * sizeof( TextureSampler ), stream ) );
+    }
+    m_numBytesUploaded += numBytes;
+    m_numCopies += runs.size();
 
     // Free the pinned memory buffer.  This doesn't immediately reclaim it: an event is recorded on
     // the stream, and the buffer isn't reused until all preceding operations are complete,
-    // including the asynchronous memcpy issued by fillTile().
+    // including the copies issued above.
     m_loader->getPinnedMemoryPool()->freeAsync( pinnedBlock, stream );
 
-    // Push mapping for sampler to update page table.
-    m_loader->setPageTableEntry( pageId, false, reinterpret_cast<unsigned long long>( devSampler ) );
+    // Push mappings for the samplers to update the page table.  A sampler isn't mapped until the
+    // device page arrays cover its tiles, which might have been reserved after they were last grown.
+    for( size_t i = 0; i < uploads.size(); ++i )
+    {
+        const TextureSampler& sampler = uploads.getSampler( i );
+        m_loader->getPagingSystem()->addDependentMapping( uploads.getPageId( i ), NON_EVICTABLE_LRU_VAL,
+                                                          reinterpret_cast<unsigned long long>( uploads.getDeviceSampler( i ) ),
+                                                          sampler.startPage + sampler.numPages );
+    }
 }
 
 bool SamplerRequestHandler::fillDenseTexture( CUstream stream, unsigned int pageId )
@@ -150,62 +225,93 @@ bool SamplerRequestHandler::fillDenseTexture( CUstream stream, unsigned int page
     DemandTextureImpl* texture = m_loader->getTexture( pageId );
     const imageSource::TextureInfo& info = texture->getInfo();
 
+    // Fill the texture a few mip levels at a time, staging each chunk through its own transfer buffer.
+    // The buffers are released asynchronously, so a large texture neither stalls the worker nor
+    // needs a staging buffer for its whole mip chain.
+    std::vector<size_t> levelSizes( info.numMipLevels );
+    for( unsigned int mipLevel = 0; mipLevel < info.numMipLevels; ++mipLevel )
+    {
+        const uint2 levelDims = texture->getMipLevelDims( mipLevel );
+        levelSizes[mipLevel]  = imageSource::getImageSizeInBytes( info.format, info.numChannels, levelDims.x, levelDims.y );
+    }
+
+    unsigned int startLevel = 0;
+    for( unsigned int endLevel : getDenseFillChunks( levelSizes, DENSE_FILL_CHUNK_SIZE ) )
+    {
+        if( !fillDenseMipLevels( stream, texture, startLevel, endLevel, levelSizes ) )
+            return false;
+        startLevel = endLevel;
+    }
+    return true;
+}
+
+bool SamplerRequestHandler::fillDenseMipLevels( CUstream                   stream,
+                                                DemandTextureImpl*         texture,
+                                                unsigned int               startLevel,
+                                                unsigned int               endLevel,
+                                                const std::vector<size_t>& levelSizes )
+{
+    size_t chunkSize = 0;
+    for( unsigned int mipLevel = startLevel; mipLevel < endLevel; ++mipLevel )
+        chunkSize += levelSizes[mipLevel];
+
     // Try to get transfer buffer from the demand loader. We prefer it because it allows asynchronous fill.
-    // The buffer needs to be a little larger than the texture size for some reason to prevent a crash, hence the extra 4 / 3.
-    size_t transferBufferSize = getTextureSizeInBytes( info ) * 4 / 3;
-    TransferBufferDesc transferBuffer =
-        m_loader->allocateTransferBuffer( texture->getFillType(), transferBufferSize, stream );
-    char* dataPtr = reinterpret_cast<char*>( transferBuffer.memoryBlock.ptr );
-    size_t bufferSize = transferBuffer.memoryBlock.size;
-
-    // Make a alternate buffer on the host if needed
+    TransferBufferDesc transferBuffer = m_loader->allocateTransferBuffer( texture->getFillType(), chunkSize, stream );
+    char*              dataPtr        = reinterpret_cast<char*>( transferBuffer.memoryBlock.ptr );
+    const bool         bufferPinned   = transferBuffer.memoryBlock.size > 0;
+
+    // Make a alternate buffer on the host if needed.  It is copied synchronously.
     std::vector<char> hostBuffer;
-    if( transferBuffer.memoryType == CU_MEMORYTYPE_HOST && transferBuffer.memoryBlock.size == 0 )
+    if( transferBuffer.memoryType == CU_MEMORYTYPE_HOST && !bufferPinned )
     {
-        hostBuffer.resize( transferBufferSize );
+        hostBuffer.resize( chunkSize );
         dataPtr = hostBuffer.data();
-        bufferSize = transferBufferSize;
     }
 
     // Make alternate buffer on device if needed
-    if( transferBuffer.memoryType == CU_MEMORYTYPE_DEVICE && transferBuffer.memoryBlock.size == 0 )
-    {
-        OTK_ERROR_CHECK( cuMemAlloc( reinterpret_cast<CUdeviceptr*>( &dataPtr ), transferBufferSize ) );
-        bufferSize = transferBufferSize;
-    }
+    if( transferBuffer.memoryType == CU_MEMORYTYPE_DEVICE && !bufferPinned )
+        OTK_ERROR_CHECK( cuMemAlloc( reinterpret_cast<CUdeviceptr*>( &dataPtr ), chunkSize ) );
 
     OTK_ASSERT_MSG( dataPtr != nullptr, "Unable to allocate transfer buffer for dense texture." );
 
-    // Read the texture data into the buffer (either a single mip level, or all mip levels)
-    bool satisfied;
-    if( info.numMipLevels == 1 && !texture->isDegenerate() )
-        satisfied = texture->readNonMipMappedData( dataPtr, bufferSize, stream );
-    else
-        satisfied = texture->readMipLevels( dataPtr, bufferSize, 0, stream );
+    // Read the mip levels into the buffer
+    bool   satisfied = true;
+    size_t offset    = 0;
+    for( unsigned int mipLevel = startLevel; mipLevel < endLevel && satisfied; ++mipLevel )
+    {
+        satisfied = texture->readMipLevel( dataPtr + offset, levelSizes[mipLevel], mipLevel, stream );
+        offset += levelSizes[mipLevel];
+    }
 
     // Copy texture data from the buffer to the texture array on the device
     if( satisfied )
-        texture->fillDenseTexture( stream, dataPtr, info.width, info.height, transferBuffer.memoryBlock.size > 0 );
+        texture->fillDenseMipLevels( stream, dataPtr, startLevel, endLevel, bufferPinned );
 
-    // Free the transfer buffer from the demand loader
-    if( transferBuffer.memoryBlock.size > 0 )
+    // Free the transfer buffer from the demand loader after the stream clears.
+    if( bufferPinned )
     {
         m_loader->freeTransferBuffer( transferBuffer, stream );
     }
-    else 
+    else if( transferBuffer.memoryType == CU_MEMORYTYPE_DEVICE )
     {
-        // fillDenseTexture uses an async copy, so synchronize the stream when using an alternate buffer.
+        // The device-side alternate buffer might still be written by the stream.
         OTK_ERROR_CHECK( cuStreamSynchronize( stream ) );
-
-        // Free device-side alternate buffer if one was made
-        if( transferBuffer.memoryType == CU_MEMORYTYPE_DEVICE )
-            cuMemFree( reinterpret_cast<CUdeviceptr>( dataPtr ) );
+        cuMemFree( reinterpret_cast<CUdeviceptr>( dataPtr ) );
     }
 
     return satisfied;
 }
 
-void SamplerRequestHandler::fillBaseColorRequest( CUstream /*stream*/, DemandTextureImpl* texture, unsigned int pageId )
+bool SamplerRequestHandler::isBaseColorPending( unsigned int pageId )
+{
+    const unsigned int maxTextures = m_loader->getOptions().maxTextures;
+    if( !isBaseColorId( pageId, maxTextures ) )
+        return false;
+    const DemandTextureImpl* texture = m_loader->getTexture( pageIdToSamplerId( pageId, maxTextures ) );
+    return texture != nullptr && texture->isBaseColorPending();
+}
+
+void SamplerRequestHandler::fillBaseColorRequest( CUstream stream, DemandTextureImpl* texture, unsigned int pageId )
 {
     SCOPED_NVTX_RANGE_FUNCTION_NAME();
 
@@ -214,6 +320,27 @@ void SamplerRequestHandler::fillBaseColorRequest( CUstream /*stream*/, DemandTex
     bool hasBaseColor = false;
     hasBaseColor = texture->readBaseColor( fBaseColor );
 
+    // An image without a 1x1 mip level has no stored base color (unless one was cached by an earlier
+    // run), and computing it can mean reading the whole image.  Rather than delay the sampler, the
+    // page is mapped with no base color and a low priority request computes it in the background.
+    // Device code falls through to the sampler until the base color is mapped.
+    if( !hasBaseColor && m_loader->getOptions().computeMissingBaseColors )
+    {
+        if( texture->isBaseColorPending() )
+        {
+            texture->setBaseColorPending( false );
+            hasBaseColor = texture->computeBaseColor( fBaseColor );
+            if( !hasBaseColor )
+                return;  // The page already says there's no base color.
+        }
+        else
+        {
+            texture->setBaseColorPending( true );
+            if( m_loader->getRequestProcessor()->addLowPriorityRequests( stream, &pageId, 1 ) == 0 )
+                texture->setBaseColorPending( false );
+        }
+    }
+
     // Store the base color as a half4 in the page table
     half4               baseColor = half4{fBaseColor.x, fBaseColor.y, fBaseColor.z, fBaseColor.w};
     unsigned long long* baseVal   = reinterpret_cast<unsigned long long*>( &baseColor );
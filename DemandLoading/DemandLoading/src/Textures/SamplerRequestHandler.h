@@ -29,11 +29,19 @@
 #pragma once
 
 #include "RequestHandler.h"
+#include "Textures/SamplerUploadBatch.h"
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <vector>
 
 namespace demandLoading {
 
 class DemandLoaderImpl;
 class DemandTextureImpl;
+class SparseMappingBatch;
+struct TextureSampler;
 
 class SamplerRequestHandler : public RequestHandler
 {
@@ -50,11 +58,39 @@ class SamplerRequestHandler : public RequestHandler
     /// Load or reload a page on the given stream
     void loadPage( CUstream stream, unsigned int pageId, bool reloadIfResident = true );
 
+    /// Get the number of bytes of samplers copied to the device.
+    size_t getNumBytesUploaded() const { return m_numBytesUploaded; }
+
+    /// Get the number of copies that have uploaded samplers to the device.
+    size_t getNumCopies() const { return m_numCopies; }
+
   private:
+    void loadLockedPage( CUstream stream, unsigned int pageId, bool reloadIfResident );
     bool fillDenseTexture( CUstream stream, unsigned int pageId );
+    bool fillDenseMipLevels( CUstream                   stream,
+                             DemandTextureImpl*         texture,
+                             unsigned int               startLevel,
+                             unsigned int               endLevel,
+                             const std::vector<size_t>& levelSizes );
     void fillBaseColorRequest( CUstream stream, DemandTextureImpl* texture, unsigned int pageId );
 
-    DemandLoaderImpl* m_loader;
+    // Return true if the page is the base color of a texture whose base color is being computed by a
+    // low priority request, which must be filled even though the page is resident.
+    bool isBaseColorPending( unsigned int pageId );
+
+    // Upload a sampler to the device, which is deferred until the current SparseMappingBatch is
+    // flushed if there is one, and then add its page table entry.
+    void uploadSampler( CUstream stream, unsigned int pageId, const TextureSampler& sampler );
+    void uploadSamplers( CUstream stream, SamplerUploadBatch& uploads );
+
+    DemandLoaderImpl*   m_loader;
+    std::atomic<size_t> m_numBytesUploaded{ 0 };
+    std::atomic<size_t> m_numCopies{ 0 };
+
+    // The samplers waiting to be uploaded when each SparseMappingBatch is flushed.  A batch is current
+    // on a single worker thread, so the batches of different threads don't share samplers.
+    std::mutex                                       m_pendingSamplersMutex;
+    std::map<SparseMappingBatch*, SamplerUploadBatch> m_pendingSamplers;
 };
 
 }  // namespace demandLoading
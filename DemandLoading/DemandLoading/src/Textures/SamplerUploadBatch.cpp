@@ -0,0 +1,57 @@
+//
+// Copyright (c) 2024, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "Textures/SamplerUploadBatch.h"
+
+#include <algorithm>
+
+namespace demandLoading {
+
+void SamplerUploadBatch::add( unsigned int pageId, const TextureSampler& sampler, TextureSampler* devSampler )
+{
+    m_entries.push_back( Entry{ pageId, devSampler, sampler } );
+}
+
+std::vector<SamplerUploadBatch::Run> SamplerUploadBatch::pack( TextureSampler* staging )
+{
+    std::sort( m_entries.begin(), m_entries.end(),
+               []( const Entry& a, const Entry& b ) { return a.devSampler < b.devSampler; } );
+
+    std::vector<Run> runs;
+    for( unsigned int i = 0; i < m_entries.size(); ++i )
+    {
+        staging[i] = m_entries[i].sampler;
+        if( !runs.empty() && m_entries[i - 1].devSampler + 1 == m_entries[i].devSampler )
+            ++runs.back().count;
+        else
+            runs.push_back( Run{ i, 1 } );
+    }
+    return runs;
+}
+
+}  // namespace demandLoading
@@ -0,0 +1,83 @@
+//
+// Copyright (c) 2024, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#pragma once
+
+#include <OptiXToolkit/DemandLoading/TextureSampler.h>
+
+#include <vector>
+
+namespace demandLoading {
+
+/// SamplerUploadBatch gathers the TextureSamplers created while filling a run of requests, so that
+/// they can be staged in a single buffer and copied to the device together.  The samplers are packed
+/// in order of their device addresses, so samplers that are adjacent on the device (as consecutive
+/// allocations from the sampler pool usually are) are written by a single copy.
+class SamplerUploadBatch
+{
+  public:
+    /// A run of packed samplers that are adjacent in device memory.
+    struct Run
+    {
+        unsigned int first;
+        unsigned int count;
+    };
+
+    /// Add a sampler for the given page, to be copied to the given device address.
+    void add( unsigned int pageId, const TextureSampler& sampler, TextureSampler* devSampler );
+
+    /// Get the number of samplers in the batch.
+    size_t size() const { return m_entries.size(); }
+
+    /// Check whether the batch is empty.
+    bool empty() const { return m_entries.empty(); }
+
+    /// Sort the samplers by device address and pack them into the staging buffer, which must hold
+    /// size() samplers.  Returns the runs of packed samplers that are adjacent in device memory.
+    std::vector<Run> pack( TextureSampler* staging );
+
+    /// Get the page id of the specified sampler, in packed order.
+    unsigned int getPageId( size_t index ) const { return m_entries[index].pageId; }
+
+    /// Get the specified sampler, in packed order.
+    const TextureSampler& getSampler( size_t index ) const { return m_entries[index].sampler; }
+
+    /// Get the device address of the specified sampler, in packed order.
+    TextureSampler* getDeviceSampler( size_t index ) const { return m_entries[index].devSampler; }
+
+  private:
+    struct Entry
+    {
+        unsigned int    pageId;
+        TextureSampler* devSampler;
+        TextureSampler  sampler;
+    };
+    std::vector<Entry> m_entries;
+};
+
+}  // namespace demandLoading
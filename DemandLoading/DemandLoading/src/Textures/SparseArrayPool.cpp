@@ -0,0 +1,158 @@
+//
+// Copyright (c) 2024, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "Textures/SparseArrayPool.h"
+#include "Textures/SparseTexture.h"
+
+namespace demandLoading {
+
+SparseArray* CudaSparseArrayDriver::createArray( const imageSource::TextureInfo& info )
+{
+    std::unique_ptr<SparseArray> array( new SparseArray );
+    array->init( info );
+    return array.release();
+}
+
+void CudaSparseArrayDriver::unmapArray( SparseArray* array, CUstream stream )
+{
+    array->unmapAllAsync( stream );
+}
+
+SparseArrayPool::~SparseArrayPool()
+{
+    for( auto& entry : m_freeArrays )
+    {
+        for( SparseArray* array : entry.second )
+            delete array;
+    }
+    for( const ReleasedArray& released : m_releasedArrays )
+        delete released.array;
+}
+
+SparseArrayPool::Key SparseArrayPool::makeKey( const imageSource::TextureInfo& info )
+{
+    return Key( info.format, info.numChannels, info.width, info.height, info.numMipLevels );
+}
+
+std::shared_ptr<SparseArray> SparseArrayPool::acquire( const imageSource::TextureInfo& info )
+{
+    const Key    key   = makeKey( info );
+    SparseArray* array = nullptr;
+    {
+        std::unique_lock<std::mutex> lock( m_mutex );
+        auto it = m_freeArrays.find( key );
+        if( it != m_freeArrays.end() && !it->second.empty() )
+        {
+            array = it->second.back();
+            it->second.pop_back();
+            --m_numFreeArrays;
+            ++m_numArraysReused;
+        }
+    }
+
+    // Create a new array outside the lock, since array creation is slow.
+    if( array == nullptr )
+    {
+        array = m_driver->createArray( info );
+        std::unique_lock<std::mutex> lock( m_mutex );
+        ++m_numArraysCreated;
+    }
+
+    // The array is returned to the pool when the last texture sharing it releases it, unless the
+    // pool has been destroyed.
+    std::weak_ptr<SparseArrayPool> weakPool( shared_from_this() );
+    return std::shared_ptr<SparseArray>( array, [weakPool, key]( SparseArray* releasedArray ) {
+        if( std::shared_ptr<SparseArrayPool> pool = weakPool.lock() )
+            pool->release( key, releasedArray );
+        else
+            delete releasedArray;
+    } );
+}
+
+void SparseArrayPool::release( const Key& key, SparseArray* array )
+{
+    std::unique_lock<std::mutex> lock( m_mutex );
+    m_releasedArrays.push_back( ReleasedArray{ key, array } );
+}
+
+std::vector<SparseArrayPool::ReleasedArray> SparseArrayPool::takeReleasedArrays()
+{
+    std::unique_lock<std::mutex> lock( m_mutex );
+    std::vector<ReleasedArray> arrays;
+    arrays.swap( m_releasedArrays );
+    return arrays;
+}
+
+void SparseArrayPool::unmapArrays( const std::vector<ReleasedArray>& arrays, CUstream stream )
+{
+    // Clear the mappings of the arrays, so they don't keep the old textures' tiles alive.
+    for( const ReleasedArray& released : arrays )
+        m_driver->unmapArray( released.array, stream );
+}
+
+void SparseArrayPool::recycleArrays( const std::vector<ReleasedArray>& arrays )
+{
+    std::vector<SparseArray*> destroyedArrays;
+    {
+        std::unique_lock<std::mutex> lock( m_mutex );
+        for( const ReleasedArray& released : arrays )
+        {
+            if( m_numFreeArrays < m_maxFreeArrays )
+            {
+                m_freeArrays[released.key].push_back( released.array );
+                ++m_numFreeArrays;
+            }
+            else
+            {
+                destroyedArrays.push_back( released.array );
+            }
+        }
+    }
+    for( SparseArray* array : destroyedArrays )
+        delete array;
+}
+
+size_t SparseArrayPool::getNumFreeArrays() const
+{
+    std::unique_lock<std::mutex> lock( m_mutex );
+    return m_numFreeArrays;
+}
+
+size_t SparseArrayPool::getNumArraysCreated() const
+{
+    std::unique_lock<std::mutex> lock( m_mutex );
+    return m_numArraysCreated;
+}
+
+size_t SparseArrayPool::getNumArraysReused() const
+{
+    std::unique_lock<std::mutex> lock( m_mutex );
+    return m_numArraysReused;
+}
+
+}  // namespace demandLoading
@@ -0,0 +1,142 @@
+//
+// Copyright (c) 2024, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#pragma once
+
+#include <OptiXToolkit/ImageSource/TextureInfo.h>
+
+#include <cuda.h>
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <vector>
+
+namespace demandLoading {
+
+class SparseArray;
+
+/// SparseArrayDriver creates sparse arrays and clears their mappings.  It's an interface so that
+/// SparseArrayPool can be tested without a GPU.
+class SparseArrayDriver
+{
+  public:
+    virtual ~SparseArrayDriver() = default;
+
+    /// Create a sparse array with the given dimensions, format and number of miplevels.
+    virtual SparseArray* createArray( const imageSource::TextureInfo& info ) = 0;
+
+    /// Unmap the backing storage of every tile and the mip tail of the given array on the given
+    /// stream, so that it can be reused by another texture.
+    virtual void unmapArray( SparseArray* array, CUstream stream ) = 0;
+};
+
+/// CudaSparseArrayDriver creates CUDA sparse arrays in the current context.
+class CudaSparseArrayDriver : public SparseArrayDriver
+{
+  public:
+    SparseArray* createArray( const imageSource::TextureInfo& info ) override;
+    void unmapArray( SparseArray* array, CUstream stream ) override;
+};
+
+/// SparseArrayPool recycles sparse arrays, which are expensive to create.  An array acquired from
+/// the pool is released when the last texture sharing it releases it (for example when the texture
+/// is destroyed, evicted or replaced by an image of a different size).  Launches and tile mappings
+/// in flight may still use a released array, so the owner of the pool takes the released arrays,
+/// unmaps them once that work is done, and recycles them once they are unmapped.  Later textures
+/// with the same format, number of channels, dimensions and number of miplevels reuse them.
+/// Arrays may outlive the pool, in which case they are simply destroyed.
+class SparseArrayPool : public std::enable_shared_from_this<SparseArrayPool>
+{
+  public:
+    /// Construct a pool that keeps at most maxFreeArrays released arrays.  The driver is retained.
+    SparseArrayPool( SparseArrayDriver* driver, unsigned int maxFreeArrays )
+        : m_driver( driver )
+        , m_maxFreeArrays( maxFreeArrays )
+    {
+    }
+
+    /// Destroy the released and recycled arrays.
+    ~SparseArrayPool();
+
+    /// Format, number of channels, width, height and number of miplevels.
+    using Key = std::tuple<CUarray_format, unsigned int, unsigned int, unsigned int, unsigned int>;
+
+    /// An array released by the last texture sharing it, which may still be mapped.
+    struct ReleasedArray
+    {
+        Key          key;
+        SparseArray* array;
+    };
+
+    /// Get a sparse array for the given texture info, reusing a released array if possible.  The pool
+    /// must be owned by a std::shared_ptr.
+    std::shared_ptr<SparseArray> acquire( const imageSource::TextureInfo& info );
+
+    /// Take the arrays released since the last call.
+    std::vector<ReleasedArray> takeReleasedArrays();
+
+    /// Unmap released arrays on the given stream.  They must not be recycled until the unmapping is done.
+    void unmapArrays( const std::vector<ReleasedArray>& arrays, CUstream stream );
+
+    /// Make unmapped arrays available for reuse, destroying those that don't fit in the pool.
+    void recycleArrays( const std::vector<ReleasedArray>& arrays );
+
+    /// Get the number of recycled arrays held by the pool, which are available for reuse.
+    size_t getNumFreeArrays() const;
+
+    /// Get the number of arrays created by the pool.
+    size_t getNumArraysCreated() const;
+
+    /// Get the number of times a released array was reused.
+    size_t getNumArraysReused() const;
+
+    /// Not copyable.
+    SparseArrayPool( const SparseArrayPool& ) = delete;
+
+    /// Not assignable.
+    SparseArrayPool& operator=( const SparseArrayPool& ) = delete;
+
+  private:
+    SparseArrayDriver*                       m_driver;
+    unsigned int                             m_maxFreeArrays;
+    mutable std::mutex                       m_mutex;
+    std::map<Key, std::vector<SparseArray*>> m_freeArrays;
+    std::vector<ReleasedArray>               m_releasedArrays;  // not yet taken by the owner
+    size_t                                   m_numFreeArrays{};
+    size_t                                   m_numArraysCreated{};
+    size_t                                   m_numArraysReused{};
+
+    static Key makeKey( const imageSource::TextureInfo& info );
+
+    // Take back an array that is no longer used by any texture (see takeReleasedArrays).
+    void release( const Key& key, SparseArray* array );
+};
+
+}  // namespace demandLoading
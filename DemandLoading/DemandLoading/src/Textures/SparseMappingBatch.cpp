@@ -0,0 +1,164 @@
+//
+// Copyright (c) 2024, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "Textures/SparseMappingBatch.h"
+#include "Util/MutexArray.h"
+
+#include <OptiXToolkit/Error/cuErrorCheck.h>
+
+#include <exception>
+#include <iostream>
+
+namespace demandLoading {
+
+namespace {
+
+thread_local SparseMappingBatch* g_currentBatch = nullptr;
+
+}  // namespace
+
+void CudaSparseMappingDriver::mapArrayAsync( CUarrayMapInfo* mapInfos, unsigned int count, CUstream stream )
+{
+    OTK_ERROR_CHECK( cuMemMapArrayAsync( mapInfos, count, stream ) );
+}
+
+void CudaSparseMappingDriver::copy2DAsync( const CUDA_MEMCPY2D& copyArgs, CUstream stream )
+{
+    OTK_ERROR_CHECK( cuMemcpy2DAsync( &copyArgs, stream ) );
+}
+
+void SparseMappingBatch::setStream( CUstream stream )
+{
+    if( stream != m_stream && !empty() )
+        flush();
+    m_stream = stream;
+}
+
+void SparseMappingBatch::addMapping( CUstream stream, const CUarrayMapInfo& mapInfo )
+{
+    setStream( stream );
+    m_mapInfos.push_back( mapInfo );
+}
+
+void SparseMappingBatch::addCopy( CUstream stream, const CUDA_MEMCPY2D& copyArgs )
+{
+    setStream( stream );
+    m_copies.push_back( copyArgs );
+}
+
+void SparseMappingBatch::lockUntilFlushed( MutexArray* mutex, unsigned int index )
+{
+    if( !mutex->tryLock( index ) )
+    {
+        flush();
+        mutex->lock( index );
+    }
+    m_lockedItems.push_back( std::make_pair( mutex, index ) );
+}
+
+void SparseMappingBatch::flush()
+{
+    // Take the batched work first, so that a completion can safely add to the batch.
+    std::vector<CUarrayMapInfo>                       mapInfos;
+    std::vector<CUDA_MEMCPY2D>                        copies;
+    std::vector<std::function<void()>>                completions;
+    std::vector<std::pair<MutexArray*, unsigned int>> lockedItems;
+    mapInfos.swap( m_mapInfos );
+    copies.swap( m_copies );
+    completions.swap( m_completions );
+    lockedItems.swap( m_lockedItems );
+    m_numTransferBytes = 0;
+
+    // Every tile is mapped before any tile is filled, since a copy requires its tile to be mapped.
+    // The first error is rethrown once the completions have run and the items have been unlocked, so
+    // that no page stays locked and no transfer buffer is leaked.
+    std::exception_ptr error;
+    try
+    {
+        if( !mapInfos.empty() )
+            m_driver->mapArrayAsync( mapInfos.data(), static_cast<unsigned int>( mapInfos.size() ), m_stream );
+        for( const CUDA_MEMCPY2D& copyArgs : copies )
+            m_driver->copy2DAsync( copyArgs, m_stream );
+    }
+    catch( ... )
+    {
+        error = std::current_exception();
+    }
+
+    for( std::function<void()>& completion : completions )
+    {
+        try
+        {
+            completion();
+        }
+        catch( ... )
+        {
+            if( !error )
+                error = std::current_exception();
+        }
+    }
+    for( const std::pair<MutexArray*, unsigned int>& item : lockedItems )
+        item.first->unlock( item.second );
+
+    if( error )
+        std::rethrow_exception( error );
+}
+
+SparseMappingBatch::~SparseMappingBatch()
+{
+    try
+    {
+        flush();
+    }
+    catch( const std::exception& e )
+    {
+        std::cerr << "Error: " << e.what() << std::endl;
+    }
+    catch( ... )
+    {
+        std::cerr << "Error: unknown exception flushing SparseMappingBatch" << std::endl;
+    }
+}
+
+SparseMappingBatch* SparseMappingBatch::getCurrent()
+{
+    return g_currentBatch;
+}
+
+SparseMappingBatch::Scope::Scope( SparseMappingBatch* batch )
+    : m_previous( g_currentBatch )
+{
+    g_currentBatch = batch;
+}
+
+SparseMappingBatch::Scope::~Scope()
+{
+    g_currentBatch = m_previous;
+}
+
+}  // namespace demandLoading
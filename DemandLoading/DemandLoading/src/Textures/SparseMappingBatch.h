@@ -0,0 +1,160 @@
+//
+// Copyright (c) 2024, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#pragma once
+
+#include <cuda.h>
+
+#include <functional>
+#include <utility>
+#include <vector>
+
+namespace demandLoading {
+
+class MutexArray;
+
+/// SparseMappingDriver issues the CUDA calls that map backing storage into sparse arrays and copy
+/// tile data into them.  It's an interface so that SparseMappingBatch can be tested without a GPU.
+class SparseMappingDriver
+{
+  public:
+    virtual ~SparseMappingDriver() = default;
+
+    /// Map or unmap the given array subresources, as cuMemMapArrayAsync does.
+    virtual void mapArrayAsync( CUarrayMapInfo* mapInfos, unsigned int count, CUstream stream ) = 0;
+
+    /// Perform the given 2D copy, as cuMemcpy2DAsync does.
+    virtual void copy2DAsync( const CUDA_MEMCPY2D& copyArgs, CUstream stream ) = 0;
+};
+
+/// CudaSparseMappingDriver passes mappings and copies to the CUDA driver.
+class CudaSparseMappingDriver : public SparseMappingDriver
+{
+  public:
+    void mapArrayAsync( CUarrayMapInfo* mapInfos, unsigned int count, CUstream stream ) override;
+    void copy2DAsync( const CUDA_MEMCPY2D& copyArgs, CUstream stream ) override;
+};
+
+/// SparseMappingBatch accumulates the tile mappings and copies issued while a worker thread fills a
+/// run of requests, and issues them when it is flushed: the mappings with a single call to the
+/// driver, followed by the copies.  Work that must not happen until the copies have been issued,
+/// such as adding page table mappings and freeing transfer buffers, is deferred as a completion,
+/// which is run after the flush.  Tile fills are batched only when a batch is current on the calling
+/// thread (see Scope); otherwise they are issued immediately.
+class SparseMappingBatch
+{
+  public:
+    /// Construct a batch that issues its mappings and copies with the given driver, which is retained.
+    explicit SparseMappingBatch( SparseMappingDriver* driver )
+        : m_driver( driver )
+    {
+    }
+
+    /// The destructor flushes any remaining work, so that locked items are always unlocked and
+    /// completions (which free transfer buffers, for example) always run.  Errors are reported but
+    /// not thrown.
+    ~SparseMappingBatch();
+
+    /// Add a mapping to the batch.  The batch is flushed first if its work is for a different stream.
+    void addMapping( CUstream stream, const CUarrayMapInfo& mapInfo );
+
+    /// Add a copy to the batch, to be issued after the batched mappings.  The batch is flushed first
+    /// if its work is for a different stream.
+    void addCopy( CUstream stream, const CUDA_MEMCPY2D& copyArgs );
+
+    /// Add a function to be called once the batched mappings and copies have been issued.
+    void addCompletion( std::function<void()> completion ) { m_completions.push_back( std::move( completion ) ); }
+
+    /// Lock the specified item of a MutexArray until the batch has been flushed and its completions
+    /// have run.  The batch is flushed first if the item is already locked, since it might be held by
+    /// this batch, or by the batch of another thread that is waiting for an item held by this one.
+    void lockUntilFlushed( MutexArray* mutex, unsigned int index );
+
+    /// Issue the batched mappings and copies, run the completions in the order they were added, and
+    /// then unlock the items locked by lockUntilFlushed().  If issuing the work throws an exception,
+    /// the completions still run and the items are still unlocked before it is rethrown.
+    void flush();
+
+    /// Check whether the batch holds no work.
+    bool empty() const { return m_mapInfos.empty() && m_copies.empty() && m_completions.empty() && m_lockedItems.empty(); }
+
+    /// Get the number of mappings in the batch.
+    size_t getNumMappings() const { return m_mapInfos.size(); }
+
+    /// Get the number of copies in the batch.
+    size_t getNumCopies() const { return m_copies.size(); }
+
+    /// Record the size of a transfer buffer that is held until the batch is flushed.
+    void addTransferBytes( size_t numBytes ) { m_numTransferBytes += numBytes; }
+
+    /// Get the total size of the transfer buffers held until the batch is flushed.
+    size_t getNumTransferBytes() const { return m_numTransferBytes; }
+
+    /// Get the batch that is current on the calling thread, or null if there is none.
+    static SparseMappingBatch* getCurrent();
+
+    /// Scope makes a batch current on the calling thread for its lifetime.  The batch is not flushed
+    /// when the scope ends.
+    class Scope
+    {
+      public:
+        explicit Scope( SparseMappingBatch* batch );
+        ~Scope();
+
+        /// Not copyable.
+        Scope( const Scope& ) = delete;
+
+        /// Not assignable.
+        Scope& operator=( const Scope& ) = delete;
+
+      private:
+        SparseMappingBatch* m_previous;
+    };
+
+    /// Not copyable.
+    SparseMappingBatch( const SparseMappingBatch& ) = delete;
+
+    /// Not assignable.
+    SparseMappingBatch& operator=( const SparseMappingBatch& ) = delete;
+
+  private:
+    SparseMappingDriver*               m_driver;
+    CUstream                           m_stream{};
+    std::vector<CUarrayMapInfo>        m_mapInfos;
+    std::vector<CUDA_MEMCPY2D>         m_copies;
+    std::vector<std::function<void()>> m_completions;
+    size_t                             m_numTransferBytes = 0;
+
+    std::vector<std::pair<MutexArray*, unsigned int>> m_lockedItems;
+
+    // Flush the batch if it holds work for a stream other than the given one, and make the given
+    // stream the batch's stream.
+    void setStream( CUstream stream );
+};
+
+}  // namespace demandLoading
@@ -27,6 +27,8 @@
 //
 
 #include "Textures/SparseTexture.h"
+#include "Textures/SparseArrayPool.h"
+#include "Textures/SparseMappingBatch.h"
 #include "Util/ContextSaver.h"
 
 #include <OptiXToolkit/Error/cuErrorCheck.h>
@@ -39,6 +41,29 @@
 
 namespace demandLoading {
 
+namespace {
+
+// Map backing storage into a sparse array, batching the mapping if a SparseMappingBatch is current
+// on this thread.  Unmappings are never batched, so that a block is unmapped before it is reused.
+void mapArrayAsync( CUarrayMapInfo& mapInfo, CUstream stream )
+{
+    if( SparseMappingBatch* batch = SparseMappingBatch::getCurrent() )
+        batch->addMapping( stream, mapInfo );
+    else
+        OTK_ERROR_CHECK( cuMemMapArrayAsync( &mapInfo, 1, stream ) );
+}
+
+// Copy data into a sparse array, batching the copy if a SparseMappingBatch is current on this thread.
+void copy2DAsync( const CUDA_MEMCPY2D& copyArgs, CUstream stream )
+{
+    if( SparseMappingBatch* batch = SparseMappingBatch::getCurrent() )
+        batch->addCopy( stream, copyArgs );
+    else
+        OTK_ERROR_CHECK( cuMemcpy2DAsync( &copyArgs, stream ) );
+}
+
+}  // namespace
+
 SparseArray::~SparseArray()
 {
     if( m_initialized )
@@ -132,7 +157,7 @@ void SparseArray::mapTileAsync( CUstream stream, unsigned int mipLevel, uint2 le
     mapInfo.offset              = offset;
     mapInfo.deviceBitMask       = 1U << m_deviceIndex;
 
-    OTK_ERROR_CHECK( cuMemMapArrayAsync( &mapInfo, 1, stream ) );
+    mapArrayAsync( mapInfo, stream );
 }
 
 void SparseArray::unmapTileAsync( CUstream stream, unsigned int mipLevel, uint2 levelOffset, uint2 levelExtent ) const
@@ -180,7 +205,7 @@ void SparseArray::mapMipTailAsync( CUstream stream, size_t mipTailSize, CUmemGen
     mapInfo.offset              = offset;
     mapInfo.deviceBitMask       = 1U << m_deviceIndex;
 
-    OTK_ERROR_CHECK( cuMemMapArrayAsync( &mapInfo, 1, stream ) );
+    mapArrayAsync( mapInfo, stream );
 }
 
 void SparseArray::unmapMipTailAsync( CUstream stream, size_t mipTailSize ) const
@@ -204,19 +229,71 @@ void SparseArray::unmapMipTailAsync( CUstream stream, size_t mipTailSize ) const
     OTK_ERROR_CHECK( cuMemMapArrayAsync( &mapInfo, 1, stream ) );
 }
 
-void SparseTexture::init( const TextureDescriptor& descriptor, const imageSource::TextureInfo& info, std::shared_ptr<SparseArray> masterArray )
+void SparseArray::unmapAllAsync( CUstream stream ) const
+{
+    OTK_ASSERT( m_initialized );
+
+    // Unmap each tiled miplevel in its entirety, followed by the mip tail.
+    const unsigned int numTiledLevels = std::min( m_info.numMipLevels, getMipTailFirstLevel() );
+    std::vector<CUarrayMapInfo> mapInfos( numTiledLevels + ( numTiledLevels < m_info.numMipLevels ? 1 : 0 ) );
+    for( unsigned int mipLevel = 0; mipLevel < mapInfos.size(); ++mipLevel )
+    {
+        CUarrayMapInfo& mapInfo = mapInfos[mipLevel];
+        mapInfo.resourceType    = CU_RESOURCE_TYPE_MIPMAPPED_ARRAY;
+        mapInfo.resource.mipmap = m_array;
+
+        if( mipLevel < numTiledLevels )
+        {
+            mapInfo.subresourceType                      = CU_ARRAY_SPARSE_SUBRESOURCE_TYPE_SPARSE_LEVEL;
+            mapInfo.subresource.sparseLevel.level        = mipLevel;
+            mapInfo.subresource.sparseLevel.extentWidth  = m_mipLevelDims[mipLevel].x;
+            mapInfo.subresource.sparseLevel.extentHeight = m_mipLevelDims[mipLevel].y;
+            mapInfo.subresource.sparseLevel.extentDepth  = 1;
+        }
+        else
+        {
+            mapInfo.subresourceType            = CU_ARRAY_SPARSE_SUBRESOURCE_TYPE_MIPTAIL;
+            mapInfo.subresource.miptail.offset = 0;
+            mapInfo.subresource.miptail.size   = getMipTailSize();
+        }
+
+        mapInfo.memOperationType    = CU_MEM_OPERATION_TYPE_UNMAP;
+        mapInfo.memHandleType       = CU_MEM_HANDLE_TYPE_GENERIC;
+        mapInfo.memHandle.memHandle = 0ULL;
+        mapInfo.offset              = 0ULL;
+        mapInfo.deviceBitMask       = 1U << m_deviceIndex;
+    }
+
+    // The array may be released by a thread on which its context is not current.
+    ContextSaver contextSaver;
+    OTK_ERROR_CHECK( cuCtxSetCurrent( m_context ) );
+    OTK_ERROR_CHECK( cuMemMapArrayAsync( mapInfos.data(), static_cast<unsigned int>( mapInfos.size() ), stream ) );
+}
+
+void SparseTexture::init( const TextureDescriptor&       descriptor,
+                          const imageSource::TextureInfo& info,
+                          std::shared_ptr<SparseArray>    masterArray,
+                          SparseArrayPool*                arrayPool )
 {
     // Redundant initialization can occur because requests from multiple streams are not yet deduplicated.
     if( m_isInitialized && info == m_info )
         return;
 
+    // A texture that is reinitialized with a different size or format (e.g. when its image is
+    // replaced) releases its texture object and array first.
+    destroy();
+
     // Record current CUDA context.
     m_info = info;
     OTK_ERROR_CHECK( cuCtxGetCurrent( &m_context ) );
 
-    // Set the array to a new array, or the master array if one was passed in
+    // Set the array to the master array if one was passed in, or to a recycled or new array.
     m_array = masterArray;
-    if( m_array.get() == nullptr )
+    if( m_array.get() == nullptr && arrayPool != nullptr )
+    {
+        m_array = arrayPool->acquire( m_info );
+    }
+    else if( m_array.get() == nullptr )
     {
         m_array.reset( new SparseArray() );
         m_array->init( m_info );
@@ -292,26 +369,28 @@ void SparseTexture::fillTile( CUstream                     stream,
     // Get CUDA array for the specified miplevel.
     CUarray mipLevelArray = m_array->getLevel( mipLevel );
 
-    // Copy tile data into CUDA array
-    const unsigned int pixelSize = m_info.numChannels * imageSource::getBytesPerChannel( m_info.format );
+    // Copy tile data into CUDA array.  Block compressed tiles are copied as rows of blocks.
+    const CUarray_format format      = m_info.format;
+    const size_t         tileRowSize = imageSource::getRowSizeInBytes( format, m_info.numChannels, getTileWidth() );
 
     CUDA_MEMCPY2D copyArgs{};
     copyArgs.srcMemoryType = tileMemoryType;
     copyArgs.srcHost       = ( tileMemoryType == CU_MEMORYTYPE_HOST ) ? tileData : nullptr;
     copyArgs.srcDevice     = ( tileMemoryType == CU_MEMORYTYPE_DEVICE ) ? reinterpret_cast<CUdeviceptr>( tileData ) : 0;
-    copyArgs.srcPitch      = getTileWidth() * pixelSize;
+    copyArgs.srcPitch      = tileRowSize;
 
-    copyArgs.dstXInBytes = tileX * getTileWidth() * pixelSize;
-    copyArgs.dstY        = tileY * getTileHeight();
+    copyArgs.dstXInBytes = tileX * tileRowSize;
+    copyArgs.dstY        = tileY * imageSource::getNumRows( format, getTileHeight() );
 
     copyArgs.dstMemoryType = CU_MEMORYTYPE_ARRAY;
     copyArgs.dstArray      = mipLevelArray;
 
-    copyArgs.WidthInBytes = tileDims.x * pixelSize;
-    copyArgs.Height       = tileDims.y;
+    copyArgs.WidthInBytes = imageSource::getRowSizeInBytes( format, m_info.numChannels, tileDims.x );
+    copyArgs.Height       = imageSource::getNumRows( format, tileDims.y );
 
-    OTK_ERROR_CHECK( cuMemcpy2DAsync( &copyArgs, stream ) );
-    m_numBytesFilled += getTileWidth() * getTileHeight() * pixelSize;
+    copy2DAsync( copyArgs, stream );
+    m_numBytesFilled += tileRowSize * imageSource::getNumRows( format, getTileHeight() );
+    ++m_numCopies;
 }
 
 
@@ -347,8 +426,7 @@ void SparseTexture::fillMipTail( CUstream                     stream,
     m_array->mapMipTailAsync(stream, getMipTailSize(), tileHandle, tileOffset);
 
     // Fill each level in the mip tail.
-    size_t             offset    = 0;
-    const unsigned int pixelSize = m_info.numChannels * imageSource::getBytesPerChannel( m_info.format );
+    size_t offset = 0;
     for( unsigned int mipLevel = getMipTailFirstLevel(); mipLevel < m_info.numMipLevels; ++mipLevel )
     {
         CUarray mipLevelArray = m_array->getLevel( mipLevel );
@@ -358,17 +436,18 @@ void SparseTexture::fillMipTail( CUstream                     stream,
         copyArgs.srcMemoryType = mipTailMemoryType;
         copyArgs.srcHost       = ( mipTailMemoryType == CU_MEMORYTYPE_HOST ) ? mipTailData + offset : nullptr;
         copyArgs.srcDevice     = ( mipTailMemoryType == CU_MEMORYTYPE_DEVICE ) ? reinterpret_cast<CUdeviceptr>( mipTailData + offset ) : 0;
-        copyArgs.srcPitch      = levelDims.x * pixelSize;
+        copyArgs.srcPitch      = imageSource::getRowSizeInBytes( m_info.format, m_info.numChannels, levelDims.x );
 
         copyArgs.dstMemoryType = CU_MEMORYTYPE_ARRAY;
         copyArgs.dstArray      = mipLevelArray;
 
-        copyArgs.WidthInBytes = levelDims.x * pixelSize;
-        copyArgs.Height       = levelDims.y;
+        copyArgs.WidthInBytes = copyArgs.srcPitch;
+        copyArgs.Height       = imageSource::getNumRows( m_info.format, levelDims.y );
 
-        OTK_ERROR_CHECK( cuMemcpy2DAsync( &copyArgs, stream ) );
+        copy2DAsync( copyArgs, stream );
+        ++m_numCopies;
 
-        offset += levelDims.x * levelDims.y * pixelSize;
+        offset += copyArgs.WidthInBytes * copyArgs.Height;
     }
 
     m_numBytesFilled += getMipTailSize();
@@ -383,6 +462,20 @@ void SparseTexture::unmapMipTail( CUstream stream ) const
 }
 
 
+void SparseTexture::destroy()
+{
+    if( !m_isInitialized )
+        return;
+
+    // The array is destroyed when the last texture sharing it is destroyed.
+    ContextSaver contextSaver;
+    OTK_ERROR_CHECK( cuCtxSetCurrent( m_context ) );
+    OTK_ERROR_CHECK( cuTexObjectDestroy( m_texture ) );
+    m_texture = CUtexObject{};
+    m_array.reset();
+    m_isInitialized = false;
+}
+
 SparseTexture::~SparseTexture()
 {
     if( m_isInitialized )
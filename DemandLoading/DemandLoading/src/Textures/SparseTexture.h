@@ -39,6 +39,8 @@
 
 namespace demandLoading {
 
+class SparseArrayPool;
+
 class SparseArray
 {
 public:
@@ -76,6 +78,9 @@ public:
     void mapMipTailAsync( CUstream stream, size_t mipTailSize, CUmemGenericAllocationHandle memHandle, size_t offset ) const;
     void unmapMipTailAsync( CUstream stream, size_t mipTailSize ) const;
 
+    /// Unmap every tile and the mip tail, so the array can be reused by another texture.
+    void unmapAllAsync( CUstream stream ) const;
+
 private:
     // Get the dimensions of the specified miplevel by querying its CUDA array descriptor.
     uint2 queryMipLevelDims( unsigned int mipLevel ) const;
@@ -98,11 +103,19 @@ class SparseTexture
 
     /// Initialize sparse texture from the given descriptor (which specifies clamping/wrapping and
     /// filtering) and the given texture info (which describes the dimensions, format, etc.)
-    void init( const TextureDescriptor& descriptor, const imageSource::TextureInfo& info, std::shared_ptr<SparseArray> masterArray );
+    /// The texture shares the array of its master texture, if any.  Otherwise it acquires an array
+    /// from the given pool, or creates its own if the pool is null.
+    void init( const TextureDescriptor&       descriptor,
+               const imageSource::TextureInfo& info,
+               std::shared_ptr<SparseArray>    masterArray,
+               SparseArrayPool*                arrayPool = nullptr );
 
     /// Check whether the texture has been initialized.
     bool isInitialized() const { return m_isInitialized; }
 
+    /// Destroy the texture object and release the sparse array.  The texture can be initialized again.
+    void destroy();
+
     /// Get the dimensions of the specified miplevel.
     uint2 getMipLevelDims( unsigned int mipLevel ) const
     {
@@ -167,6 +180,9 @@ class SparseTexture
     /// Get total number of bytes filled
     size_t getNumBytesFilled() const { return m_numBytesFilled; }
 
+    /// Get total number of copies issued to fill tiles and mip tails
+    size_t getNumCopies() const { return m_numCopies; }
+
     /// Get the SparseArray backing store for the texture
     std::shared_ptr<SparseArray> getSparseArray() { return m_array; }
 
@@ -183,6 +199,7 @@ class SparseTexture
     // Stats
     mutable unsigned int m_numUnmappings = 0;
     mutable size_t m_numBytesFilled = 0;
+    mutable size_t m_numCopies = 0;
 };
 
 }  // namespace demandLoading
@@ -0,0 +1,260 @@
+//
+// Copyright (c) 2024, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "Textures/TextureAtlas.h"
+#include "Util/ContextSaver.h"
+
+#include <OptiXToolkit/Error/cuErrorCheck.h>
+#include <OptiXToolkit/ImageSource/ImageSource.h>
+
+#include <algorithm>
+
+namespace demandLoading {
+
+namespace {
+
+bool isPowerOfTwo( unsigned int x )
+{
+    return x > 0 && ( x & ( x - 1 ) ) == 0;
+}
+
+unsigned int getNumAtlasMipLevels()
+{
+    unsigned int numLevels = 1;
+    for( unsigned int width = TextureAtlas::ATLAS_WIDTH; width > 1; width >>= 1 )
+        ++numLevels;
+    return numLevels;
+}
+
+}  // namespace
+
+TextureAtlas::Page::Page( CUarray_format format, unsigned int numChannels, CUfilter_mode filterMode, const TextureDescriptor& descriptor )
+    : format( format )
+    , numChannels( numChannels )
+    , filterMode( filterMode )
+    , mipmapFilterMode( descriptor.mipmapFilterMode )
+    , maxAnisotropy( descriptor.maxAnisotropy )
+    , flags( descriptor.flags )
+{
+    OTK_ERROR_CHECK( cuCtxGetCurrent( &context ) );
+
+    CUDA_ARRAY3D_DESCRIPTOR ad{};
+    ad.Width       = ATLAS_WIDTH;
+    ad.Height      = ATLAS_WIDTH;
+    ad.Format      = format;
+    ad.NumChannels = numChannels;
+    OTK_ERROR_CHECK( cuMipmappedArrayCreate( &array, &ad, getNumAtlasMipLevels() ) );
+
+    // The atlas clamps, since the wrap mode of each texture is applied by the sampling code.
+    CUDA_TEXTURE_DESC td{};
+    td.addressMode[0]      = CU_TR_ADDRESS_MODE_CLAMP;
+    td.addressMode[1]      = CU_TR_ADDRESS_MODE_CLAMP;
+    td.filterMode          = filterMode;
+    td.flags               = CU_TRSF_NORMALIZED_COORDINATES | descriptor.flags;
+    td.maxAnisotropy       = descriptor.maxAnisotropy;
+    td.mipmapFilterMode    = descriptor.mipmapFilterMode;
+    td.maxMipmapLevelClamp = float( getNumAtlasMipLevels() - 1 );
+    td.minMipmapLevelClamp = 0.f;
+
+    CUDA_RESOURCE_DESC rd{};
+    rd.resType                    = CU_RESOURCE_TYPE_MIPMAPPED_ARRAY;
+    rd.res.mipmap.hMipmappedArray = array;
+    OTK_ERROR_CHECK( cuTexObjectCreate( &texture, &rd, &td, nullptr ) );
+}
+
+TextureAtlas::Page::~Page()
+{
+    ContextSaver contextSaver;
+    OTK_ERROR_CHECK_NOTHROW( cuCtxSetCurrent( context ) );
+    OTK_ERROR_CHECK_NOTHROW( cuTexObjectDestroy( texture ) );
+    OTK_ERROR_CHECK_NOTHROW( cuMipmappedArrayDestroy( array ) );
+}
+
+bool TextureAtlas::Page::matches( CUarray_format format_, unsigned int numChannels_, CUfilter_mode filterMode_, const TextureDescriptor& descriptor ) const
+{
+    return format == format_ && numChannels == numChannels_ && filterMode == filterMode_
+           && mipmapFilterMode == descriptor.mipmapFilterMode && maxAnisotropy == descriptor.maxAnisotropy
+           && flags == descriptor.flags;
+}
+
+TextureAtlas::~TextureAtlas()
+{
+    m_pages.clear();
+}
+
+bool TextureAtlas::isEligible( const TextureDescriptor& descriptor, const imageSource::TextureInfo& info )
+{
+    // Cubic filtering reads texels directly, which the atlas does not support.
+    if( descriptor.filterMode != FILTER_POINT && descriptor.filterMode != FILTER_BILINEAR )
+        return false;
+    if( descriptor.addressMode[0] == CU_TR_ADDRESS_MODE_BORDER || descriptor.addressMode[1] == CU_TR_ADDRESS_MODE_BORDER )
+        return false;
+    // The coarse levels of a slot are not aligned to 4x4 blocks.
+    if( info.isValid && imageSource::isBlockCompressed( info.format ) )
+        return false;
+    return info.isValid && isPowerOfTwo( info.width ) && isPowerOfTwo( info.height )
+           && info.width <= MAX_TEXTURE_WIDTH && info.height <= MAX_TEXTURE_WIDTH;
+}
+
+AtlasSlot TextureAtlas::allocate( const TextureDescriptor& descriptor, const imageSource::TextureInfo& info )
+{
+    OTK_ASSERT( isEligible( descriptor, info ) );
+    const CUfilter_mode filterMode = toCudaFilterMode( descriptor.filterMode );
+
+    std::unique_lock<std::mutex> lock( m_mutex );
+
+    AtlasSlot slot;
+    slot.blockWidth = AtlasAllocator::getBlockWidth( info.width, info.height );
+
+    // Try the existing pages with the same format and filtering.
+    for( unsigned int i = 0; i < m_pages.size(); ++i )
+    {
+        Page* page = m_pages[i].get();
+        if( page && page->matches( info.format, info.numChannels, filterMode, descriptor )
+            && page->allocator.allocate( slot.blockWidth, slot.x, slot.y ) )
+        {
+            slot.page = i;
+            return slot;
+        }
+    }
+
+    // Make a new page, reusing the entry of a destroyed page if possible.
+    auto it = std::find( m_pages.begin(), m_pages.end(), nullptr );
+    if( it == m_pages.end() )
+        it = m_pages.insert( m_pages.end(), nullptr );
+    it->reset( new Page( info.format, info.numChannels, filterMode, descriptor ) );
+
+    const bool allocated = ( *it )->allocator.allocate( slot.blockWidth, slot.x, slot.y );
+    OTK_ASSERT( allocated );
+    (void)allocated;  // silence unused variable warning
+    slot.page = static_cast<unsigned int>( it - m_pages.begin() );
+    return slot;
+}
+
+void TextureAtlas::release( const AtlasSlot& slot )
+{
+    if( !slot.isValid() )
+        return;
+
+    std::unique_lock<std::mutex> lock( m_mutex );
+    OTK_ASSERT( slot.page < m_pages.size() && m_pages[slot.page] );
+    m_releasedSlots.push_back( slot );
+}
+
+std::vector<AtlasSlot> TextureAtlas::takeReleasedSlots()
+{
+    std::unique_lock<std::mutex> lock( m_mutex );
+    std::vector<AtlasSlot> slots;
+    slots.swap( m_releasedSlots );
+    return slots;
+}
+
+void TextureAtlas::freeSlots( const std::vector<AtlasSlot>& slots )
+{
+    std::unique_lock<std::mutex> lock( m_mutex );
+    for( const AtlasSlot& slot : slots )
+    {
+        OTK_ASSERT( slot.page < m_pages.size() && m_pages[slot.page] );
+        AtlasAllocator& allocator = m_pages[slot.page]->allocator;
+        allocator.free( slot.blockWidth, slot.x, slot.y );
+        if( allocator.empty() )
+            m_pages[slot.page].reset();
+    }
+}
+
+CUtexObject TextureAtlas::getTextureObject( const AtlasSlot& slot ) const
+{
+    std::unique_lock<std::mutex> lock( m_mutex );
+    OTK_ASSERT( slot.page < m_pages.size() && m_pages[slot.page] );
+    return m_pages[slot.page]->texture;
+}
+
+void TextureAtlas::fillSlot( const AtlasSlot& slot, CUstream stream, const char* textureData, const imageSource::TextureInfo& info, bool bufferPinned )
+{
+    CUmipmappedArray atlasArray;
+    {
+        std::unique_lock<std::mutex> lock( m_mutex );
+        OTK_ASSERT( slot.page < m_pages.size() && m_pages[slot.page] );
+        atlasArray = m_pages[slot.page]->array;
+    }
+
+    // Atlas mip level N holds mip level N of the texture at the slot position shifted by N.
+    size_t             offset    = 0;
+    size_t             numBytes  = 0;
+    const unsigned int pixelSize = info.numChannels * imageSource::getBytesPerChannel( info.format );
+    for( unsigned int mipLevel = 0; mipLevel < info.numMipLevels; ++mipLevel )
+    {
+        CUarray mipLevelArray{};
+        OTK_ERROR_CHECK( cuMipmappedArrayGetLevel( &mipLevelArray, atlasArray, mipLevel ) );
+
+        const unsigned int levelWidth  = std::max( info.width >> mipLevel, 1U );
+        const unsigned int levelHeight = std::max( info.height >> mipLevel, 1U );
+
+        CUDA_MEMCPY2D copyArgs{};
+        copyArgs.srcMemoryType = CU_MEMORYTYPE_HOST;
+        copyArgs.srcHost       = textureData + offset;
+        copyArgs.srcPitch      = levelWidth * pixelSize;
+
+        copyArgs.dstMemoryType = CU_MEMORYTYPE_ARRAY;
+        copyArgs.dstArray      = mipLevelArray;
+        copyArgs.dstXInBytes   = ( slot.x >> mipLevel ) * pixelSize;
+        copyArgs.dstY          = slot.y >> mipLevel;
+
+        copyArgs.WidthInBytes = levelWidth * pixelSize;
+        copyArgs.Height       = levelHeight;
+
+        if( bufferPinned )
+            OTK_ERROR_CHECK( cuMemcpy2DAsync( &copyArgs, stream ) );
+        else
+            OTK_ERROR_CHECK( cuMemcpy2D( &copyArgs ) );
+
+        offset += levelWidth * levelHeight * pixelSize;
+        numBytes += copyArgs.WidthInBytes * copyArgs.Height;
+    }
+
+    std::unique_lock<std::mutex> lock( m_mutex );
+    m_numBytesFilled += numBytes;
+    m_numCopies += info.numMipLevels;
+}
+
+size_t TextureAtlas::getDeviceMemoryUsed() const
+{
+    std::unique_lock<std::mutex> lock( m_mutex );
+    size_t total = 0;
+    for( const std::unique_ptr<Page>& page : m_pages )
+    {
+        if( !page )
+            continue;
+        // The mip chain adds a third to the size of the base level.
+        const size_t pixelSize = page->numChannels * imageSource::getBytesPerChannel( page->format );
+        total += ATLAS_WIDTH * ATLAS_WIDTH * pixelSize * 4 / 3;
+    }
+    return total;
+}
+
+}  // namespace demandLoading
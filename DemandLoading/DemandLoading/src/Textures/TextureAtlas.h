@@ -0,0 +1,130 @@
+//
+// Copyright (c) 2024, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+#pragma once
+
+#include "Textures/AtlasAllocator.h"
+
+#include <OptiXToolkit/DemandLoading/TextureDescriptor.h>
+#include <OptiXToolkit/ImageSource/TextureInfo.h>
+
+#include <cuda.h>
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace demandLoading {
+
+/// The placement of a texture in a TextureAtlas.
+struct AtlasSlot
+{
+    unsigned int page = ~0U;
+    unsigned int x{};
+    unsigned int y{};
+    unsigned int blockWidth{};
+
+    bool isValid() const { return page != ~0U; }
+};
+
+/// TextureAtlas packs small dense textures, including their mip chains, into shared mipmapped CUDA
+/// arrays ("atlas pages").  Each texture is placed in a block aligned to its own width, so atlas
+/// mip level N holds mip level N of every texture in the page.  Textures in a page share a CUDA
+/// texture object, so a page is only shared by textures with the same format and filtering.  The
+/// wrap mode is applied by the device-side sampling code.
+class TextureAtlas
+{
+  public:
+    /// Width of an atlas page in texels.
+    static const unsigned int ATLAS_WIDTH = 256;
+
+    /// The largest texture dimension that is packed into an atlas.
+    static const unsigned int MAX_TEXTURE_WIDTH = 32;
+
+    /// Destroy the atlas, reclaiming its pages.
+    ~TextureAtlas();
+
+    /// Check whether a texture with the given descriptor and info can be packed into an atlas.
+    static bool isEligible( const TextureDescriptor& descriptor, const imageSource::TextureInfo& info );
+
+    /// Allocate a slot for a texture, creating an atlas page if necessary.  Thread safe.
+    AtlasSlot allocate( const TextureDescriptor& descriptor, const imageSource::TextureInfo& info );
+
+    /// Release a slot.  Launches in flight may still sample it, so it is not reused until it is
+    /// returned by takeReleasedSlots and passed to freeSlots.  Thread safe.
+    void release( const AtlasSlot& slot );
+
+    /// Take the slots released since the last call.  Thread safe.
+    std::vector<AtlasSlot> takeReleasedSlots();
+
+    /// Free slots returned by takeReleasedSlots.  An atlas page is destroyed when its last slot is
+    /// freed.  Thread safe.
+    void freeSlots( const std::vector<AtlasSlot>& slots );
+
+    /// Get the CUDA texture object for the atlas page containing the given slot.
+    CUtexObject getTextureObject( const AtlasSlot& slot ) const;
+
+    /// Fill the mip levels of a slot from textureData, which contains all the mip levels of the texture.
+    void fillSlot( const AtlasSlot& slot, CUstream stream, const char* textureData, const imageSource::TextureInfo& info, bool bufferPinned );
+
+    /// Get the total number of bytes filled.
+    size_t getNumBytesFilled() const { return m_numBytesFilled; }
+
+    /// Get the total number of copies issued to fill slots.
+    size_t getNumCopies() const { return m_numCopies; }
+
+    /// Get the device memory used by the atlas pages.
+    size_t getDeviceMemoryUsed() const;
+
+  private:
+    struct Page
+    {
+        Page( CUarray_format format, unsigned int numChannels, CUfilter_mode filterMode, const TextureDescriptor& descriptor );
+        ~Page();
+
+        bool matches( CUarray_format format, unsigned int numChannels, CUfilter_mode filterMode, const TextureDescriptor& descriptor ) const;
+
+        CUarray_format   format;
+        unsigned int     numChannels;
+        CUfilter_mode    filterMode;
+        CUfilter_mode    mipmapFilterMode;
+        unsigned int     maxAnisotropy;
+        unsigned int     flags;
+        CUcontext        context{};
+        CUmipmappedArray array{};
+        CUtexObject      texture{};
+        AtlasAllocator   allocator{ ATLAS_WIDTH };
+    };
+
+    mutable std::mutex                 m_mutex;
+    std::vector<std::unique_ptr<Page>> m_pages;  // destroyed pages leave a null entry for reuse
+    std::vector<AtlasSlot>             m_releasedSlots;  // released, but not yet free for reuse
+    size_t                             m_numBytesFilled = 0;
+    size_t                             m_numCopies      = 0;
+};
+
+}  // namespace demandLoading
@@ -28,18 +28,54 @@
 
 #include "Textures/TextureRequestHandler.h"
 #include "DemandLoaderImpl.h"
+#include "Memory/DeviceMemoryManager.h"
+#include "Memory/TileDeduplicator.h"
 #include <OptiXToolkit/Memory/MemoryBlockDesc.h>
 #include "PagingSystem.h"
 #include "Textures/DemandTextureImpl.h"
+#include "Textures/SparseMappingBatch.h"
 #include "TransferBufferDesc.h"
 #include "Util/NVTXProfiling.h"
 
 #include <OptiXToolkit/DemandLoading/TileIndexing.h>
 
+#include <algorithm>
+#include <functional>
+
 using namespace otk;
 
 namespace demandLoading {
 
+namespace {
+
+// Run the given function once the tile mappings and copies requested so far have reached CUDA, which
+// is when the current SparseMappingBatch is flushed, if there is one.
+void afterFill( std::function<void()> func )
+{
+    if( SparseMappingBatch* batch = SparseMappingBatch::getCurrent() )
+        batch->addCompletion( std::move( func ) );
+    else
+        func();
+}
+
+// Get the size of the elements that tiles are made of: pixels, or 4x4 blocks for block compressed formats.
+unsigned int getElementSize( const imageSource::TextureInfo& info )
+{
+    if( imageSource::isBlockCompressed( info.format ) )
+        return imageSource::getBytesPerBlock( info.format );
+    return info.numChannels * imageSource::getBytesPerChannel( info.format );
+}
+
+}  // namespace
+
+TextureRequestHandler::TextureRequestHandler( DemandTextureImpl* texture, DemandLoaderImpl* loader )
+    : m_texture( texture )
+    , m_loader( loader )
+{
+    if( loader != nullptr && loader->getOptions().useIncrementalReload )
+        m_tileHashes.resize( texture->getSampler().numPages );
+}
+
 void TextureRequestHandler::fillRequest( CUstream stream, unsigned int pageId )
 {
    loadPage( stream, pageId, false );
@@ -52,15 +88,34 @@ void TextureRequestHandler::loadPage( CUstream stream, unsigned int pageId, bool
 
     // We use MutexArray to ensure mutual exclusion on a per-page basis.  This is necessary because
     // multiple streams might race to fill the same tile (or the mip tail).
-    unsigned int index = pageId - m_startPage;
-    MutexArrayLock lock( m_mutex.get(), index);
+    unsigned int        index = pageId - m_startPage;
+    SparseMappingBatch* batch = SparseMappingBatch::getCurrent();
+    if( !batch )
+    {
+        MutexArrayLock lock( m_mutex.get(), index );
+        loadLockedPage( stream, pageId, reloadIfResident );
+        return;
+    }
+
+    // When tile fills are batched, the page stays locked until the batch is flushed, since it does
+    // not become resident until then.
+    batch->lockUntilFlushed( m_mutex.get(), index );
+    loadLockedPage( stream, pageId, reloadIfResident );
+}
 
+void TextureRequestHandler::loadLockedPage( CUstream stream, unsigned int pageId, bool reloadIfResident )
+{
     // Do nothing if the page is resident and the flag says not to reload it.
     unsigned long long pageEntry;
     bool resident =  m_loader->getPagingSystem()->isResident( pageId, &pageEntry );
     if( resident && !reloadIfResident )
         return;
 
+    // Defer the request if the texture's residency group is at its hard quota. It will be requested
+    // again once pages from the group have been evicted.
+    if( !resident && m_loader->getPagingSystem()->isResidencyGroupFull( m_texture->getResidencyGroup() ) )
+        return;
+
     // Get the TileBlockHandle from the page table if the page is resident
     TileBlockHandle bh{ 0, 0 };
     if( resident )
@@ -80,6 +135,9 @@ void TextureRequestHandler::fillTileRequest( CUstream stream, unsigned int pageI
 {
     SCOPED_NVTX_RANGE_FUNCTION_NAME();
 
+    // Note the reload generation before the image is read (see beginReload).
+    const unsigned int generation = m_reloadGeneration.load();
+
     // Get the texture sampler.  This is thread safe because the sampler is invariant once it's created,
     // and tile requests never occur before the sampler is created.
     const TextureSampler& sampler = m_texture->getSampler();
@@ -91,11 +149,22 @@ void TextureRequestHandler::fillTileRequest( CUstream stream, unsigned int pageI
     unsigned int       tileY;
     unpackTileIndex( sampler, tileIndex, mipLevel, tileX, tileY );
 
+    // A block shared by identical tiles is never overwritten, so reloading a shared tile gives it a
+    // block of its own.  The reference to the shared block is released once the tile is remapped.
+    DeviceMemoryManager* deviceMemoryManager = m_loader->getDeviceMemoryManager();
+    TileDeduplicator*    deduplicator        = deviceMemoryManager->getTileDeduplicator();
+    TileBlockDesc        sharedBlock( 0ULL );
+    if( !bh.block.isBad() && deduplicator->isShared( bh.block.data ) )
+    {
+        sharedBlock = bh.block;
+        bh          = TileBlockHandle{ 0, 0 };
+    }
+
     // Make sure to have device memory for the tile
     bool useNewBlock = bh.block.isBad();
     if( useNewBlock )
     {
-        bh = m_loader->getDeviceMemoryManager()->allocateTileBlock( TILE_SIZE_IN_BYTES );
+        bh = deviceMemoryManager->allocateTileBlock( TILE_SIZE_IN_BYTES );
         if( bh.block.isBad() )
             return;
     }
@@ -104,7 +173,8 @@ void TextureRequestHandler::fillTileRequest( CUstream stream, unsigned int pageI
     TransferBufferDesc transferBuffer = m_loader->allocateTransferBuffer( m_texture->getFillType(), TILE_SIZE_IN_BYTES, stream );
     if( transferBuffer.memoryBlock.size == 0 )
     {
-        m_loader->getDeviceMemoryManager()->freeTileBlock( bh.block );
+        if( useNewBlock )
+            deviceMemoryManager->freeTileBlock( bh.block );
         return;
     }
 
@@ -124,28 +194,89 @@ void TextureRequestHandler::fillTileRequest( CUstream stream, unsigned int pageI
 
     if( satisfied )
     {
-        // Copy data from transfer buffer to the sparse texture on the device
-        m_texture->fillTile( stream,
-                             mipLevel, tileX, tileY,                                     // Tile to fill
-                             reinterpret_cast<char*>( transferBuffer.memoryBlock.ptr ),  // Src buffer
-                             transferBuffer.memoryType, TILE_SIZE_IN_BYTES,              // Src type and size
-                             bh.handle, bh.block.offset()                                // Dest
-                             );
-
-        // Add a mapping for the tile, which will be sent to the device in pushMappings().
-        if( useNewBlock )
+        // Hash tiles read into host memory, so that a tile identical to a resident one can share its
+        // block.  Uniform tiles are keyed by their value alone, which is much cheaper than hashing.
+        const char*    tileData     = reinterpret_cast<const char*>( transferBuffer.memoryBlock.ptr );
+        const Options& options      = m_loader->getOptions();
+        const bool     hostTile     = useNewBlock && transferBuffer.memoryType == CU_MEMORYTYPE_HOST;
+        const bool     constantTile = hostTile && options.useConstantTiles && isConstantTile( tileData, mipLevel, tileX, tileY );
+        const bool     deduplicate  = constantTile || ( hostTile && options.useTileDeduplication );
+
+        // Record the tile's hash, so that reloadTexture can tell whether it has changed.
+        const bool hostData = transferBuffer.memoryType == CU_MEMORYTYPE_HOST;
+        recordPageHash( tileIndex, generation, [=] {
+            return getTileHash( mipLevel, tileX, tileY, [=] { return hostData ? tileData : nullptr; } );
+        } );
+
+        uint64_t           tileHash = 0;
+        unsigned long long sharedData;
+        if( deduplicate )
+            tileHash = hashTile( tileData, mipLevel, tileX, tileY, constantTile );
+
+        bool insertTile = false;
+        if( deduplicate && deduplicator->acquire( tileHash, sharedData ) )
         {
-            m_loader->setPageTableEntry( pageId, true, static_cast<unsigned long long>( bh.block.data ) );
+            // Map the existing block instead of filling the new one.
+            deviceMemoryManager->freeTileBlock( bh.block );
+            bh.block  = TileBlockDesc( sharedData );
+            bh.handle = deviceMemoryManager->getTileBlockHandle( bh.block );
+            m_texture->mapTile( stream, mipLevel, tileX, tileY, bh.handle, bh.block.offset() );
         }
+        else
+        {
+            // Copy data from transfer buffer to the sparse texture on the device
+            m_texture->fillTile( stream,
+                                 mipLevel, tileX, tileY,                                     // Tile to fill
+                                 reinterpret_cast<char*>( transferBuffer.memoryBlock.ptr ),  // Src buffer
+                                 transferBuffer.memoryType, TILE_SIZE_IN_BYTES,              // Src type and size
+                                 bh.handle, bh.block.offset()                                // Dest
+                                 );
+            insertTile = deduplicate;
+        }
+
+        // The tile must not be shared or made resident until its mapping and copy have been issued.
+        PagingSystem*      pagingSystem = m_loader->getPagingSystem();
+        const unsigned int group        = m_texture->getResidencyGroup();
+        const bool         pinned       = m_texture->isPinnedLevel( mipLevel );
+        const bool         releaseBlock = !sharedBlock.isBad();
+        afterFill( [=] {
+            if( insertTile )
+                deduplicator->insert( tileHash, bh.block.data );
+
+            // Add a mapping for the tile, which will be sent to the device in pushMappings().
+            if( useNewBlock && pinned )
+            {
+                pagingSystem->addPinnedMapping( pageId, static_cast<unsigned long long>( bh.block.data ), group );
+            }
+            else if( useNewBlock )
+            {
+                pagingSystem->addMapping( pageId, 0, static_cast<unsigned long long>( bh.block.data ), group );
+            }
+
+            // Release the block the tile shared before it was reloaded.
+            if( releaseBlock )
+                deviceMemoryManager->freeTileBlock( sharedBlock );
+
+            invalidateIfReloaded( pageId, generation );
+        } );
+    }
+    else if( !sharedBlock.isBad() )
+    {
+        // The tile keeps its shared block.
+        deviceMemoryManager->freeTileBlock( bh.block );
     }
 
-    m_loader->freeTransferBuffer( transferBuffer, stream );
+    DemandLoaderImpl* loader = m_loader;
+    afterFill( [loader, transferBuffer, stream] { loader->freeTransferBuffer( transferBuffer, stream ); } );
 }
 
 void TextureRequestHandler::fillMipTailRequest( CUstream stream, unsigned int pageId, TileBlockHandle bh )
 {
     SCOPED_NVTX_RANGE_FUNCTION_NAME();
 
+    // Note the reload generation before the image is read (see beginReload).
+    const unsigned int generation = m_reloadGeneration.load();
+
     const size_t mipTailSize  = m_texture->getMipTailSize();
 
     // Allocate device texture memory for mip tail.
@@ -183,6 +314,11 @@ void TextureRequestHandler::fillMipTailRequest( CUstream stream, unsigned int pa
 
     if( satisfied )
     {
+        // Record the mip tail's hash, so that reloadTexture can tell whether it has changed.
+        const bool  hostData    = transferBuffer.memoryType == CU_MEMORYTYPE_HOST;
+        const char* mipTailData = reinterpret_cast<const char*>( transferBuffer.memoryBlock.ptr );
+        recordPageHash( 0, generation, [=] { return hostData ? getMipTailHash( mipTailData ) : 0; } );
+
         // Copy data from the transfer buffer to the sparse texture on the device
         m_texture->fillMipTail( stream,
                                 reinterpret_cast<char*>( transferBuffer.memoryBlock.ptr ),  // Src buffer
@@ -191,30 +327,50 @@ void TextureRequestHandler::fillMipTailRequest( CUstream stream, unsigned int pa
                                 );
 
         // Add a mapping for the mip tail, which will be sent to the device in pushMappings().
-
-        if( useNewBlock )
-        {
-            m_loader->setPageTableEntry( pageId, true, static_cast<unsigned long long>( bh.block.data ) );
-        }
+        PagingSystem*      pagingSystem = m_loader->getPagingSystem();
+        const unsigned int group        = m_texture->getResidencyGroup();
+        const bool         pinned       = m_texture->isPinned();
+        afterFill( [=] {
+            if( useNewBlock && pinned )
+            {
+                pagingSystem->addPinnedMapping( pageId, static_cast<unsigned long long>( bh.block.data ), group );
+            }
+            else if( useNewBlock )
+            {
+                pagingSystem->addMapping( pageId, 0, static_cast<unsigned long long>( bh.block.data ), group );
+            }
+
+            invalidateIfReloaded( pageId, generation );
+        } );
     }
 
-    m_loader->freeTransferBuffer( transferBuffer, stream );
+    DemandLoaderImpl* loader = m_loader;
+    afterFill( [loader, transferBuffer, stream] { loader->freeTransferBuffer( transferBuffer, stream ); } );
 }
 
-void TextureRequestHandler::unmapTileResource( CUstream stream, unsigned int pageId )
+bool TextureRequestHandler::unmapTileResource( CUstream stream, unsigned int pageId )
 {
     // We use MutexArray to ensure mutual exclusion on a per-page basis.  This is necessary because
     // multiple streams might race to fill the same tile (or the mip tail).
+    // A page that is already locked is being refilled, and still maps its old block until it is
+    // remapped.  Waiting for it could deadlock with a thread whose batch holds the page (see
+    // SparseMappingBatch), so the caller retries later.
     unsigned int tileIndex = pageId - m_startPage;
-    MutexArrayLock lock( m_mutex.get(), tileIndex );
+    if( !m_mutex->tryLock( tileIndex ) )
+        return false;
+    MutexArrayLock lock( m_mutex.get(), tileIndex, std::adopt_lock );
 
     // If the page has already been remapped, don't unmap it
     PagingSystem* pagingSystem = m_loader->getPagingSystem();
     if( pagingSystem->isResident( pageId ) )
-        return;
+        return true;
 
+    // The sparse texture might have been released since the page was staged, e.g. when the texture
+    // was evicted, in which case its array is gone and only the block needs to be freed.
     DemandTextureImpl* texture = getTexture();
-    
+    if( !texture->isSparseTextureInitialized() )
+        return true;
+
     // Unmap the tile or mip tail
     if( tileIndex == 0 )
     {
@@ -228,6 +384,51 @@ void TextureRequestHandler::unmapTileResource( CUstream stream, unsigned int pag
         unpackTileIndex( texture->getSampler(), tileIndex, mipLevel, tileX, tileY );
         texture->unmapTile( stream, mipLevel, tileX, tileY );
     }
+    return true;
+}
+
+uint2 TextureRequestHandler::getFilledTileDims( unsigned int mipLevel, unsigned int tileX, unsigned int tileY ) const
+{
+    // Tiles at the right and bottom edges of a level are only partially filled.
+    const uint2        levelDims  = m_texture->getMipLevelDims( mipLevel );
+    const unsigned int tileWidth  = m_texture->getTileWidth();
+    const unsigned int tileHeight = m_texture->getTileHeight();
+    return uint2{std::min( tileWidth, levelDims.x - tileX * tileWidth ), std::min( tileHeight, levelDims.y - tileY * tileHeight )};
+}
+
+bool TextureRequestHandler::isConstantTile( const char* tileData, unsigned int mipLevel, unsigned int tileX, unsigned int tileY ) const
+{
+    const imageSource::TextureInfo& info        = m_texture->getInfo();
+    const unsigned int              elementSize = getElementSize( info );
+    const uint2                     tileDims    = getFilledTileDims( mipLevel, tileX, tileY );
+
+    // Block compressed tiles are compared block by block.
+    const size_t rowSize  = imageSource::getRowSizeInBytes( info.format, info.numChannels, tileDims.x );
+    const size_t rowPitch = imageSource::getRowSizeInBytes( info.format, info.numChannels, m_texture->getTileWidth() );
+    return TileDeduplicator::isConstantTile( tileData, static_cast<unsigned int>( rowSize / elementSize ),
+                                             imageSource::getNumRows( info.format, tileDims.y ), rowPitch, elementSize );
+}
+
+uint64_t TextureRequestHandler::hashTile( const char* tileData, unsigned int mipLevel, unsigned int tileX, unsigned int tileY, bool isConstant ) const
+{
+    // Identical bytes only make identical tiles if the tile layout is the same.  Partial tiles only
+    // fill part of their block, so they are only shared with tiles of the same extent.
+    const imageSource::TextureInfo& info        = m_texture->getInfo();
+    const unsigned int              elementSize = getElementSize( info );
+    const uint2                     tileDims    = getFilledTileDims( mipLevel, tileX, tileY );
+
+    uint64_t seed = static_cast<uint64_t>( info.format ) * 31 + info.numChannels;
+    seed          = ( seed * 31 + m_texture->getTileWidth() ) * 31 + m_texture->getTileHeight();
+    seed          = ( seed * 31 + tileDims.x ) * 31 + tileDims.y;
+
+    // A constant tile is identified by its first pixel (or block), using a distinct seed.
+    if( isConstant )
+        return TileDeduplicator::hashTile( tileData, elementSize, ~seed );
+
+    // Only the filled part of an edge tile is hashed, since the rest of the buffer holds stale data.
+    const size_t rowSize  = imageSource::getRowSizeInBytes( info.format, info.numChannels, tileDims.x );
+    const size_t rowPitch = imageSource::getRowSizeInBytes( info.format, info.numChannels, m_texture->getTileWidth() );
+    return TileDeduplicator::hashRegion( tileData, rowSize, imageSource::getNumRows( info.format, tileDims.y ), rowPitch, seed );
 }
 
 unsigned int TextureRequestHandler::getTextureTilePageId( unsigned int mipLevel, unsigned int tileX, unsigned int tileY )
@@ -238,4 +439,71 @@ unsigned int TextureRequestHandler::getTextureTilePageId( unsigned int mipLevel,
     return pageId;
 }
 
+uint64_t TextureRequestHandler::getTileHash( unsigned int mipLevel, unsigned int tileX, unsigned int tileY, const std::function<const char*()>& getTileData ) const
+{
+    // Zero means the hash is unknown, so valid hashes have their low bit set.
+    uint64_t hash;
+    if( m_texture->readTileHash( mipLevel, tileX, tileY, hash ) )
+        return hash | 1;
+    const char* tileData = getTileData();
+    return tileData ? hashTile( tileData, mipLevel, tileX, tileY, false ) | 1 : 0;
+}
+
+uint64_t TextureRequestHandler::getMipTailHash( const char* mipTailData ) const
+{
+    return TileDeduplicator::hashTile( mipTailData, m_texture->getMipTailSize(), m_texture->getInfo().format ) | 1;
+}
+
+void TextureRequestHandler::recordPageHash( unsigned int index, unsigned int generation, const std::function<uint64_t()>& getHash )
+{
+    if( !m_tileHashes.empty() )
+        m_tileHashes[index] = ( generation % 2 == 0 ) ? getHash() : 0;
+}
+
+void TextureRequestHandler::invalidateIfReloaded( unsigned int pageId, unsigned int generation )
+{
+    if( m_reloadGeneration.load() == generation )
+        return;
+    if( !m_tileHashes.empty() )
+        m_tileHashes[pageId - m_startPage] = 0;
+    m_loader->invalidateTilePages( pageId, pageId + 1 );
+}
+
+void TextureRequestHandler::findChangedPages( CUstream stream, std::vector<unsigned int>& changedPages )
+{
+    PagingSystem*     pagingSystem = m_loader->getPagingSystem();
+    const bool        hostData     = m_texture->getFillType() == CU_MEMORYTYPE_HOST;
+    const size_t      bufferSize   = std::max<size_t>( TILE_SIZE_IN_BYTES, m_texture->getMipTailSize() );
+    std::vector<char> buffer( hostData ? bufferSize : 0 );
+
+    for( unsigned int index = 0; index < m_numPages; ++index )
+    {
+        const unsigned int pageId = m_startPage + index;
+        if( !pagingSystem->isResident( pageId ) )
+            continue;
+
+        // Hold the page while it's hashed, so that it isn't refilled concurrently.
+        MutexArrayLock lock( m_mutex.get(), index );
+        uint64_t       hash = 0;
+        if( index == 0 && m_texture->isMipmapped() )
+        {
+            if( hostData && m_texture->readMipTail( buffer.data(), m_texture->getMipTailSize(), stream ) )
+                hash = getMipTailHash( buffer.data() );
+        }
+        else
+        {
+            unsigned int mipLevel;
+            unsigned int tileX;
+            unsigned int tileY;
+            unpackTileIndex( m_texture->getSampler(), index, mipLevel, tileX, tileY );
+            hash = getTileHash( mipLevel, tileX, tileY, [&]() -> const char* {
+                return hostData && m_texture->readTile( mipLevel, tileX, tileY, buffer.data(), buffer.size(), stream ) ? buffer.data() : nullptr;
+            } );
+        }
+
+        if( hash == 0 || hash != m_tileHashes[index] )
+            changedPages.push_back( pageId );
+    }
+}
+
 }  // namespace demandLoading
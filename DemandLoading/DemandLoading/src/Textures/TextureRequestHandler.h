@@ -31,7 +31,12 @@
 #include "RequestHandler.h"
 #include <OptiXToolkit/Memory/MemoryBlockDesc.h>
 
+#include <vector_types.h>
+
 #include <atomic>
+#include <cstdint>
+#include <functional>
+#include <vector>
 
 namespace demandLoading {
 
@@ -44,12 +49,9 @@ class TextureRequestHandler : public RequestHandler
     /// Default constructor.
     TextureRequestHandler() {}
 
-    /// Construct TextureRequestHandler, which shares state with the DemandLoader.
-    TextureRequestHandler( DemandTextureImpl* texture, DemandLoaderImpl* loader )
-        : m_texture( texture )
-        , m_loader( loader )
-    {
-    }
+    /// Construct TextureRequestHandler, which shares state with the DemandLoader.  The texture sampler
+    /// must have been initialized.
+    TextureRequestHandler( DemandTextureImpl* texture, DemandLoaderImpl* loader );
 
     /// Fill a request for the specified page using the given stream.  
     void fillRequest( CUstream stream, unsigned int pageId ) override;
@@ -60,18 +62,65 @@ class TextureRequestHandler : public RequestHandler
     /// Get the associated texture.
     DemandTextureImpl* getTexture() const { return m_texture; }
 
-    /// Unmap the backing storage associated with a texture tile or mip tail
-    void unmapTileResource( CUstream stream, unsigned int pageId );
+    /// Unmap the backing storage associated with a texture tile or mip tail.  Returns false if the
+    /// page is locked because it is being refilled, in which case it is left mapped, and true if it
+    /// was unmapped or has already been remapped.
+    bool unmapTileResource( CUstream stream, unsigned int pageId );
 
     /// Get the pageId for a tile
     unsigned int getTextureTilePageId( unsigned int mipLevel, unsigned int tileX, unsigned int tileY );
 
+    /// Check whether the hash of each page is recorded when it is filled (see Options::useIncrementalReload).
+    bool hasTileHashes() const { return !m_tileHashes.empty(); }
+
+    /// Find the resident pages whose contents in the texture's current image differ from when they
+    /// were filled, according to their hashes.  Pages whose hash is unknown are considered changed.
+    void findChangedPages( CUstream stream, std::vector<unsigned int>& changedPages );
+
+    /// Call before and after reloadTexture swaps in a new image.  A fill that overlaps the swap might
+    /// mix data and hashes of the old and new images, so its page is invalidated when its mapping is
+    /// added, and its hash is unknown if it becomes resident before findChangedPages is called.
+    void beginReload() { ++m_reloadGeneration; }
+    void endReload() { ++m_reloadGeneration; }
+
   private:
     DemandTextureImpl* m_texture = nullptr;
     DemandLoaderImpl*  m_loader = nullptr;
 
+    // Hash of each page when it was filled, or zero if unknown.  Empty unless Options::useIncrementalReload is set.
+    std::vector<uint64_t> m_tileHashes;
+
+    // Incremented before and after each reload swaps the image, so it is odd while a reload is in progress.
+    std::atomic<unsigned int> m_reloadGeneration{ 0 };
+
+    // Record the hash of a page filled in the given reload generation, which is unknown if a reload was in progress.
+    void recordPageHash( unsigned int index, unsigned int generation, const std::function<uint64_t()>& getHash );
+
+    // Invalidate a page whose fill overlapped a reload (called when its mapping is added).
+    void invalidateIfReloaded( unsigned int pageId, unsigned int generation );
+
+    // Load or reload a page, which has been locked by the caller.
+    void loadLockedPage( CUstream stream, unsigned int pageId, bool reloadIfResident );
+
     void fillTileRequest( CUstream stream, unsigned int pageId, otk::TileBlockHandle bh );
     void fillMipTailRequest( CUstream stream, unsigned int pageId, otk::TileBlockHandle bh );
+
+    // Get the dimensions of the part of a tile that lies within its mip level.
+    uint2 getFilledTileDims( unsigned int mipLevel, unsigned int tileX, unsigned int tileY ) const;
+
+    // Return true if every pixel of a tile has the same value.
+    bool isConstantTile( const char* tileData, unsigned int mipLevel, unsigned int tileX, unsigned int tileY ) const;
+
+    // Hash the contents of a tile for deduplication (only the first pixel of a constant tile).
+    uint64_t hashTile( const char* tileData, unsigned int mipLevel, unsigned int tileX, unsigned int tileY, bool isConstant ) const;
+
+    // Get the hash of a tile that is recorded in m_tileHashes.  The image hashes its stored data if it
+    // can (see ImageSource::readTileHash).  Otherwise the tile data is hashed, if it's on the host.
+    // Returns zero if neither is possible.
+    uint64_t getTileHash( unsigned int mipLevel, unsigned int tileX, unsigned int tileY, const std::function<const char*()>& getTileData ) const;
+
+    // Get the hash of the mip tail that is recorded in m_tileHashes.
+    uint64_t getMipTailHash( const char* mipTailData ) const;
 };
 
 }  // namespace demandLoading
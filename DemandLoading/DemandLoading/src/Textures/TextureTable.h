@@ -0,0 +1,104 @@
+//
+// Copyright (c) 2024, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#pragma once
+
+#include "Textures/DemandTextureImpl.h"
+
+#include <OptiXToolkit/Error/cuErrorCheck.h>
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace demandLoading {
+
+/// The demand-loaded textures, indexed by texture id.  The table is divided into chunks of textures,
+/// which are allocated as texture ids reach them, so that the cost of the table follows the number
+/// of textures rather than Options::maxTextures.  Textures are never moved, so request processing
+/// threads can look up textures while others are created.
+class TextureTable
+{
+  public:
+    /// Construct a table for at most maxTextures textures.
+    explicit TextureTable( unsigned int maxTextures )
+        : m_chunks( ( maxTextures + CHUNK_SIZE - 1 ) / CHUNK_SIZE )
+    {
+    }
+
+    /// Return the number of texture ids in use, including those of destroyed textures.
+    unsigned int size() const { return m_size; }
+
+    /// Return true if no texture has been added.
+    bool empty() const { return m_size == 0; }
+
+    /// Add a texture with the next texture id.
+    void emplace_back( DemandTextureImpl* texture )
+    {
+        OTK_ASSERT_MSG( m_size / CHUNK_SIZE < m_chunks.size(), "Too many textures defined." );
+        std::unique_ptr<Chunk>& chunk = m_chunks[m_size / CHUNK_SIZE];
+        if( !chunk )
+            chunk.reset( new Chunk );
+        chunk->textures[m_size % CHUNK_SIZE].reset( texture );
+        ++m_size;
+    }
+
+    /// Get the entry for the given texture id, which must be in use.
+    std::unique_ptr<DemandTextureImpl>& operator[]( unsigned int textureId )
+    {
+        return m_chunks[textureId / CHUNK_SIZE]->textures[textureId % CHUNK_SIZE];
+    }
+    const std::unique_ptr<DemandTextureImpl>& operator[]( unsigned int textureId ) const
+    {
+        return m_chunks[textureId / CHUNK_SIZE]->textures[textureId % CHUNK_SIZE];
+    }
+
+    /// Get the entry for the given texture id, which is null if no texture has that id.  Throws
+    /// std::out_of_range if the id is beyond the chunks allocated so far.
+    std::unique_ptr<DemandTextureImpl>& at( unsigned int textureId )
+    {
+        // The chunk, rather than the size, is checked, since request processing threads call this
+        // while textures are created.
+        if( textureId / CHUNK_SIZE >= m_chunks.size() || !m_chunks[textureId / CHUNK_SIZE] )
+            throw std::out_of_range( "Invalid texture id " + std::to_string( textureId ) );
+        return ( *this )[textureId];
+    }
+
+  private:
+    static const unsigned int CHUNK_SIZE = 4096;
+    struct Chunk
+    {
+        std::unique_ptr<DemandTextureImpl> textures[CHUNK_SIZE];
+    };
+
+    std::vector<std::unique_ptr<Chunk>> m_chunks;  // null until a texture id reaches the chunk
+    unsigned int                        m_size = 0;
+};
+
+}  // namespace demandLoading
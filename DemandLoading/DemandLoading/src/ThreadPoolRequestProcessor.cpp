@@ -30,10 +30,21 @@
 
 #include "DemandLoaderImpl.h"
 #include "RequestHandler.h"
+#include "Textures/SparseMappingBatch.h"
 #include "TicketImpl.h"
 
+#include <algorithm>
+#include <iostream>
+
 namespace demandLoading {
 
+namespace {
+
+// The maximum number of requests whose tile mappings and copies are batched together.
+const unsigned int MAX_BATCHED_REQUESTS = 64;
+
+}  // namespace
+
 ThreadPoolRequestProcessor::ThreadPoolRequestProcessor( std::shared_ptr<PageTableManager> pageTableManager, const Options& options )
     : m_pageTableManager( std::move( pageTableManager ) )
     , m_options( options )
@@ -51,6 +62,10 @@ void ThreadPoolRequestProcessor::start()
     if( maxThreads == 0 )
         maxThreads = std::thread::hardware_concurrency();
     m_threads.reserve( maxThreads );
+
+    // The transfer buffers held by batches are limited to half of the pinned memory, split among the
+    // workers, so that batching never starves the fills themselves.
+    m_maxBatchTransferBytes = std::max<size_t>( m_options.maxPinnedMemory / ( 2 * maxThreads ), 1 );
     for( unsigned int i = 0; i < maxThreads; ++i )
     {
         m_threads.emplace_back( &ThreadPoolRequestProcessor::worker, this );
@@ -77,7 +92,7 @@ void ThreadPoolRequestProcessor::stop()
     m_started = false;
 }
 
-void ThreadPoolRequestProcessor::addRequests( CUstream /*stream*/, unsigned int id, const unsigned int* pageIds, unsigned int numPageIds )
+void ThreadPoolRequestProcessor::addRequests( CUstream stream, unsigned int id, const unsigned int* pageIds, unsigned int numPageIds )
 {
     std::unique_lock<std::mutex> lock( m_ticketsMutex );
     start();
@@ -89,17 +104,43 @@ void ThreadPoolRequestProcessor::addRequests( CUstream /*stream*/, unsigned int
     m_tickets.erase( it );
 
     // Filter the batch of requests, and add it to the main request list with the ticket to track their progress
+    std::vector<unsigned int> filteredRequests;
     if( numPageIds > 0 && m_requestFilter )
     {
-        std::vector<unsigned int> filteredRequests = m_requestFilter->filter( pageIds, numPageIds );
-        m_requests->push( &filteredRequests[0], static_cast<unsigned int>( filteredRequests.size() ), ticket );
+        filteredRequests = m_requestFilter->filter( pageIds, numPageIds );
+        pageIds          = filteredRequests.data();
+        numPageIds       = static_cast<unsigned int>( filteredRequests.size() );
     }
-    else
+    m_requests->push( pageIds, numPageIds, ticket );
+    addQueuedTicket( ticket );
+
+    // Queue the speculative requests derived from the batch behind it.  The caller's ticket does not
+    // wait for them.
+    if( numPageIds > 0 && m_speculativeRequestFilter )
     {
-        m_requests->push( pageIds, numPageIds, ticket );
+        std::vector<unsigned int> speculativeRequests = m_speculativeRequestFilter->filter( pageIds, numPageIds );
+        if( !speculativeRequests.empty() )
+        {
+            Ticket speculativeTicket = TicketImpl::create( stream );
+            m_requests->pushLowPriority( speculativeRequests.data(), static_cast<unsigned int>( speculativeRequests.size() ),
+                                         speculativeTicket );
+            addQueuedTicket( speculativeTicket );
+        }
     }
 }
 
+unsigned int ThreadPoolRequestProcessor::addLowPriorityRequests( CUstream stream, const unsigned int* pageIds, unsigned int numPageIds )
+{
+    // This is called from worker threads, so it can't take m_ticketsMutex, which stop() holds while
+    // joining them.  The queue outlives the workers.
+    if( !m_requests || numPageIds == 0 )
+        return 0;
+    Ticket ticket = TicketImpl::create( stream );
+    m_requests->pushLowPriority( pageIds, numPageIds, ticket );
+    addQueuedTicket( ticket );
+    return static_cast<unsigned int>( ticket.numTasksTotal() );
+}
+
 void ThreadPoolRequestProcessor::setTicket( unsigned int id, Ticket ticket )
 {
     std::unique_lock<std::mutex> lock( m_ticketsMutex );
@@ -107,10 +148,44 @@ void ThreadPoolRequestProcessor::setTicket( unsigned int id, Ticket ticket )
     m_tickets[id] = ticket;
 }
 
+void ThreadPoolRequestProcessor::addQueuedTicket( const Ticket& ticket )
+{
+    // Tickets are pruned here as well as in getOutstandingTickets, so that the list stays short.
+    std::unique_lock<std::mutex> lock( m_queuedTicketsMutex );
+    m_queuedTickets.erase( std::remove_if( m_queuedTickets.begin(), m_queuedTickets.end(),
+                                           []( const Ticket& queued ) { return queued.numTasksRemaining() == 0; } ),
+                           m_queuedTickets.end() );
+    if( ticket.numTasksRemaining() != 0 )
+        m_queuedTickets.push_back( ticket );
+}
+
+std::vector<Ticket> ThreadPoolRequestProcessor::getOutstandingTickets()
+{
+    std::vector<Ticket> tickets;
+    std::unique_lock<std::mutex> lock( m_ticketsMutex );
+    for( const auto& entry : m_tickets )
+        tickets.push_back( entry.second );
+
+    std::unique_lock<std::mutex> queuedLock( m_queuedTicketsMutex );
+    for( const Ticket& ticket : m_queuedTickets )
+    {
+        if( ticket.numTasksRemaining() != 0 )
+            tickets.push_back( ticket );
+    }
+    return tickets;
+}
+
 void ThreadPoolRequestProcessor::worker()
 {
     try
     {
+        // The tile mappings and copies of a run of requests are issued together, before the
+        // requests' tickets are notified (see SparseMappingBatch).
+        CudaSparseMappingDriver   driver;
+        SparseMappingBatch        batch( &driver );
+        SparseMappingBatch::Scope batchScope( &batch );
+        std::vector<Ticket>       filledTickets;
+
         PageRequest request;
         while( true )
         {
@@ -118,23 +193,50 @@ void ThreadPoolRequestProcessor::worker()
             if( !m_requests->popOrWait( &request ) )
                 return;  // Exit thread when queue is shut down.
 
-            // Ask the PageTableManager for the request handler associated with the range of pages in
-            // which the request occurred.
-            RequestHandler* handler = m_pageTableManager->getRequestHandler( request.pageId );
-            OTK_ASSERT_MSG( handler != nullptr, "Invalid page requested (no associated handler)" );
-
             // Use the CUDA context associated with the stream in the ticket.
-            std::shared_ptr<TicketImpl>& ticket = TicketImpl::getImpl( request.ticket );
-            CUcontext                    context;
-            OTK_ERROR_CHECK( cuStreamGetCtx( ticket->getStream(), &context ) );
+            CUstream  stream = TicketImpl::getImpl( request.ticket )->getStream();
+            CUcontext context;
+            OTK_ERROR_CHECK( cuStreamGetCtx( stream, &context ) );
             OTK_ERROR_CHECK( cuCtxSetCurrent( context ) );
 
-            // Process the request.  Page table updates are accumulated in the PagingSystem.
-            handler->fillRequest( ticket->getStream(), request.pageId );
-
-            // Notify the associated Ticket that the request has been filled.
-            ticket->notify();
-            ticket.reset();
+            // Fill the request, followed by any queued requests on the same stream, up to the maximum
+            // batch size.  Page table updates are accumulated in the PagingSystem.  A low priority
+            // request is filled by itself, so that it never delays other requests.
+            do
+            {
+                // Ask the PageTableManager for the request handler associated with the range of pages in
+                // which the request occurred.
+                // A request that fails is reported and counted as filled, so that its ticket is
+                // notified and the rest of the batch is still issued.
+                try
+                {
+                    RequestHandler* handler = m_pageTableManager->getRequestHandler( request.pageId );
+                    OTK_ASSERT_MSG( handler != nullptr, "Invalid page requested (no associated handler)" );
+
+                    handler->fillRequest( stream, request.pageId );
+                }
+                catch( const std::exception& e )
+                {
+                    std::cerr << "Error: " << e.what() << std::endl;
+                }
+                filledTickets.push_back( request.ticket );
+            } while( !request.isLowPriority && filledTickets.size() < MAX_BATCHED_REQUESTS
+                     && batch.getNumTransferBytes() < m_maxBatchTransferBytes && m_requests->tryPop( &request, stream ) );
+
+            // Issue the batched work, and then notify the associated Tickets that the requests have
+            // been filled.  The batch unlocks its pages and runs its completions even if issuing fails.
+            try
+            {
+                batch.flush();
+            }
+            catch( const std::exception& e )
+            {
+                std::cerr << "Error: " << e.what() << std::endl;
+            }
+            for( Ticket& ticket : filledTickets )
+                TicketImpl::getImpl( ticket )->notify();
+            filledTickets.clear();
+            request.ticket = Ticket();
         }
     }
     catch( const std::exception& e )
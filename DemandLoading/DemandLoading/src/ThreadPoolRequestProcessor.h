@@ -62,22 +62,43 @@ class ThreadPoolRequestProcessor : public RequestProcessor
     /// Add a request filter to preprocess batches of requests
     void setRequestFilter( std::shared_ptr<RequestFilter> requestFilter ) { m_requestFilter = requestFilter; }
 
+    /// Add a filter that derives speculative requests from each (filtered) batch of requests.  The
+    /// speculative requests are queued at low priority, tracked by a ticket of their own.
+    void setSpeculativeRequestFilter( std::shared_ptr<RequestFilter> filter ) { m_speculativeRequestFilter = filter; }
+
+    /// Queue page requests at low priority, behind the requests from device code, e.g. requests made
+    /// by request handlers for background work.  They are tracked by a ticket of their own, and are
+    /// dropped if the queue is full.  Returns the number of requests queued.
+    unsigned int addLowPriorityRequests( CUstream stream, const unsigned int* pageIds, unsigned int numPageIds );
+
     /// Set the ticket that will track requests with the given ticket id
     void setTicket( unsigned int id, Ticket ticket );
 
+    /// Get the tickets of requests that have not been filled yet, including requests that have not
+    /// been pulled from the device yet.  Once they are done, no request made before this call is
+    /// still being filled.
+    std::vector<Ticket> getOutstandingTickets();
+
 private:
     std::shared_ptr<PageTableManager> m_pageTableManager;
     std::unique_ptr<RequestQueue>     m_requests;
     std::vector<std::thread>          m_threads;
     std::map<unsigned int, Ticket>    m_tickets;
     std::mutex                        m_ticketsMutex;
+    std::vector<Ticket>               m_queuedTickets;  // Tickets of queued requests, pruned as they are done.
+    std::mutex                        m_queuedTicketsMutex;  // Guards m_queuedTickets (taken after m_ticketsMutex).
     Options                           m_options;
     bool                              m_started = false;
+    size_t                            m_maxBatchTransferBytes = 0;  // Bound on the transfer buffers held by each worker's batch.
     std::shared_ptr<RequestFilter>    m_requestFilter;
+    std::shared_ptr<RequestFilter>    m_speculativeRequestFilter;
 
     /// Start processing requests.
     void start();
 
+    /// Record the ticket of a batch of queued requests (see getOutstandingTickets).
+    void addQueuedTicket( const Ticket& ticket );
+
     // Per-thread worker function.
     void worker();
 };
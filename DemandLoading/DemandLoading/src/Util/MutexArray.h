@@ -61,6 +61,18 @@ class MutexArray
         m_excluded[index] = true;
     }
 
+    /// Lock the item represented by the specified index if it is not already locked, without
+    /// waiting.  Returns true if the item was locked.
+    bool tryLock( unsigned int index )
+    {
+        OTK_ASSERT( index < m_excluded.size() );
+        std::unique_lock<std::mutex> lock( m_mutex );
+        if( m_excluded[index] )
+            return false;
+        m_excluded[index] = true;
+        return true;
+    }
+
     /// Unlock the item represented by the specified index.
     void unlock( unsigned int index )
     {
@@ -100,6 +112,13 @@ class MutexArrayLock
         mutex->lock( index );
     }
 
+    /// Take ownership of the specified index of the given MutexArray, which the caller has locked.
+    MutexArrayLock( MutexArray* mutex, unsigned int index, std::adopt_lock_t )
+        : m_mutex( mutex )
+        , m_index( index )
+    {
+    }
+
     /// Unlock the MutexArray wrapped by this lock.
     ~MutexArrayLock() { m_mutex->unlock( m_index ); }
 
@@ -42,9 +42,14 @@ enum RecordType
 {
     OPTIONS,
     TEXTURE,
-    REQUESTS
+    REQUESTS,
+    VERSION
 };
 
+// The version of the trace file format, which is recorded first.  Files without a version record
+// are version 1.  Version 2 adds TextureDescriptor::deviceFormat and encodeQuality.
+const unsigned int TRACE_FILE_VERSION = 2;
+
 // Check that the current CUDA context matches the one associated with the given stream
 // and return the associated device index.
 static unsigned int getDeviceIndex( CUstream /*stream*/ )
@@ -65,6 +70,8 @@ static unsigned int getDeviceIndex( CUstream /*stream*/ )
 TraceFileWriter::TraceFileWriter( const char* filename )
     : m_file( filename, std::ios::out | std::ios::binary )
 {
+    write( VERSION );
+    write( TRACE_FILE_VERSION );
 }
 
 TraceFileWriter::~TraceFileWriter()
@@ -118,6 +125,8 @@ void TraceFileWriter::recordTexture( std::shared_ptr<imageSource::ImageSource> i
     write( desc.mipmapFilterMode );
     write( desc.maxAnisotropy );
     write( desc.flags );
+    write( desc.deviceFormat );
+    write( desc.encodeQuality );
 }
 
 // CUDA streams are assigned integer identifiers as they are encountered.
@@ -159,6 +168,13 @@ class TraceFileReader
     {
         RecordType recordType;
         read( &recordType );
+        if( recordType == VERSION )
+        {
+            read( &m_version );
+            if( m_version > TRACE_FILE_VERSION )
+                throw std::runtime_error( "Unsupported trace file version" );
+            read( &recordType );
+        }
         assert( recordType == OPTIONS );
 
         Options options;
@@ -219,6 +235,7 @@ class TraceFileReader
 
   private:
     std::ifstream          m_file;
+    unsigned int           m_version = 1;
     std::vector<CUcontext> m_contexts;
     std::vector<CUstream>  m_streams;
 
@@ -272,6 +289,11 @@ class TraceFileReader
         read( &desc.mipmapFilterMode );
         read( &desc.maxAnisotropy );
         read( &desc.flags );
+        if( m_version >= 2 )
+        {
+            read( &desc.deviceFormat );
+            read( &desc.encodeQuality );
+        }
 
         OTK_ERROR_CHECK( cuCtxSetCurrent( m_contexts[deviceIndex] ) );
         loaders[deviceIndex]->createTexture( imageSource, desc );
@@ -0,0 +1,194 @@
+//
+// Copyright (c) 2024, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#pragma once
+
+#include "Util/ContextSaver.h"
+
+#include <OptiXToolkit/Error/cuErrorCheck.h>
+
+#include <cuda.h>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace demandLoading {
+
+/// WorkerPool runs loops in parallel on a set of persistent threads, which are started as needed
+/// and joined when the pool is destroyed.  The calling thread works on its own loop as well, so a
+/// loop always makes progress, even when it is started from a task of another loop.
+class WorkerPool
+{
+  public:
+    /// Construct a pool of at most the specified number of threads, including the calling thread.
+    /// Zero selects the number of hardware threads.
+    WorkerPool( unsigned int maxThreads )
+        : m_maxThreads( maxThreads ? maxThreads : std::max( 1U, std::thread::hardware_concurrency() ) )
+    {
+    }
+
+    /// Join the worker threads.
+    ~WorkerPool()
+    {
+        {
+            std::unique_lock<std::mutex> lock( m_mutex );
+            m_shutDown = true;
+        }
+        m_workAvailable.notify_all();
+        for( std::thread& thread : m_threads )
+            thread.join();
+    }
+
+    /// Call func( index ) for each index in [0, count) with the given CUDA context current.  The
+    /// first exception thrown by func is rethrown once all the indices have been processed.
+    void parallelFor( CUcontext context, size_t count, const std::function<void( size_t )>& func )
+    {
+        if( count == 0 )
+            return;
+
+        std::shared_ptr<Job> job( new Job( context, count, func ) );
+        {
+            std::unique_lock<std::mutex> lock( m_mutex );
+            const size_t numHelpers = std::min<size_t>( m_maxThreads, count ) - 1;
+            while( m_threads.size() < numHelpers )
+                m_threads.emplace_back( &WorkerPool::worker, this );
+            m_jobs.push_back( job );
+        }
+        m_workAvailable.notify_all();
+
+        {
+            ContextSaver contextSaver;
+            runJob( *job );
+        }
+
+        std::unique_lock<std::mutex> lock( m_mutex );
+        m_jobDone.wait( lock, [&job] { return job->numDone == job->count; } );
+        if( job->exception )
+            std::rethrow_exception( job->exception );
+    }
+
+    /// Not copyable.
+    WorkerPool( const WorkerPool& ) = delete;
+
+    /// Not assignable.
+    WorkerPool& operator=( const WorkerPool& ) = delete;
+
+  private:
+    struct Job
+    {
+        Job( CUcontext context, size_t count, const std::function<void( size_t )>& func )
+            : context( context )
+            , count( count )
+            , func( func )
+        {
+        }
+
+        CUcontext                            context;
+        size_t                               count;
+        const std::function<void( size_t )>& func;
+        std::atomic<size_t>                  nextIndex{ 0 };
+        size_t                               numDone = 0;  // Guarded by m_mutex.
+        std::exception_ptr                   exception;    // Guarded by m_mutex.
+    };
+
+    unsigned int                     m_maxThreads;
+    std::vector<std::thread>         m_threads;
+    std::deque<std::shared_ptr<Job>> m_jobs;  // Jobs with indices that have not been claimed yet.
+    std::mutex                       m_mutex;
+    std::condition_variable          m_workAvailable;
+    std::condition_variable          m_jobDone;
+    bool                             m_shutDown = false;
+
+    // Claim indices of the job until none are left, then record how many were processed.
+    void runJob( Job& job )
+    {
+        size_t             numRun = 0;
+        std::exception_ptr exception;
+        bool               hasContext = false;
+        try
+        {
+            OTK_ERROR_CHECK( cuCtxSetCurrent( job.context ) );
+            hasContext = true;
+        }
+        catch( ... )
+        {
+            exception = std::current_exception();
+        }
+        for( size_t index = job.nextIndex++; index < job.count; index = job.nextIndex++ )
+        {
+            try
+            {
+                if( hasContext )
+                    job.func( index );
+            }
+            catch( ... )
+            {
+                if( !exception )
+                    exception = std::current_exception();
+            }
+            ++numRun;
+        }
+
+        std::unique_lock<std::mutex> lock( m_mutex );
+        auto it = std::find_if( m_jobs.begin(), m_jobs.end(), [&job]( const std::shared_ptr<Job>& queued ) { return queued.get() == &job; } );
+        if( it != m_jobs.end() )
+            m_jobs.erase( it );
+        if( exception && !job.exception )
+            job.exception = exception;
+        job.numDone += numRun;
+        if( numRun != 0 && job.numDone == job.count )
+            m_jobDone.notify_all();
+    }
+
+    // Per-thread worker function.
+    void worker()
+    {
+        while( true )
+        {
+            std::shared_ptr<Job> job;
+            {
+                std::unique_lock<std::mutex> lock( m_mutex );
+                m_workAvailable.wait( lock, [this] { return m_shutDown || !m_jobs.empty(); } );
+                if( m_shutDown )
+                    return;
+                job = m_jobs.front();
+            }
+            runJob( *job );
+        }
+    }
+};
+
+}  // namespace demandLoading
@@ -91,6 +91,7 @@ class MockImageSource : public imageSource::ImageSource
     MOCK_METHOD( const imageSource::TextureInfo&, getInfo, (), ( const override ) );
     MOCK_METHOD( CUmemorytype, getFillType, (), ( const override ) );
     MOCK_METHOD( bool, readTile, ( char* dest, unsigned int mipLevel, const imageSource::Tile& tile, CUstream stream ), ( override ) );
+    MOCK_METHOD( bool, readTileHash, ( uint64_t & hash, unsigned int mipLevel, const imageSource::Tile& tile ), ( override ) );
     MOCK_METHOD( bool,
                  readMipLevel,
                  ( char* dest, unsigned int mipLevel, unsigned int expectedWidth, unsigned int expectedHeight, CUstream stream ),
@@ -100,6 +101,7 @@ class MockImageSource : public imageSource::ImageSource
                  ( char* dest, unsigned int mipTailFirstLevel, unsigned int numMipLevels, const uint2* mipLevelDims, unsigned int pixelSizeInBytes, CUstream stream ),
                  ( override ) );
     MOCK_METHOD( bool, readBaseColor, ( float4 & dest ), ( override ) );
+    MOCK_METHOD( void, writeBaseColor, ( const float4& baseColor ), ( override ) );
     MOCK_METHOD( unsigned int, getTileWidth, (), ( const override ) );
     MOCK_METHOD( unsigned int, getTileHeight, (), ( const override ) );
     MOCK_METHOD( unsigned long long, getNumTilesRead, (), ( const override ) );
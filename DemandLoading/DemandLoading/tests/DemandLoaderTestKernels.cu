@@ -72,3 +72,15 @@ __host__ void launchPageBatchRequester( CUstream stream, const DeviceContext& co
     // The DeviceContext is passed by value to the kernel, so it is copied to device memory when the kernel is launched.
     pageBatchRequester<<<numBlocks, threadsPerBlock, 0U, stream>>>( context, pageBegin, pageEnd, pageTableEntries );
 }
+
+__global__ static void textureSampler( DeviceContext context, unsigned int textureId, float s, float t, float lod, float4* texel, bool* isResident )
+{
+    *texel = tex2DLod<float4>( context, textureId, s, t, lod, isResident );
+}
+
+__host__ void launchTextureSampler( CUstream stream, const DeviceContext& context, unsigned int textureId, float s, float t, float lod, float4* devTexel, bool* devIsResident )
+{
+    textureSampler<<<1, 1, 0U, stream>>>( context, textureId, s, t, lod, devTexel, devIsResident );
+    OTK_ERROR_CHECK( cudaStreamSynchronize( stream ) );
+    OTK_ERROR_CHECK( cudaGetLastError() );
+}
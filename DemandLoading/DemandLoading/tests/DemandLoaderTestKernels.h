@@ -29,6 +29,7 @@
 #pragma once
 
 #include <cuda.h>
+#include <vector_types.h>
 
 namespace demandLoading {
 struct DeviceContext;
@@ -47,3 +48,12 @@ void launchPageBatchRequester( CUstream                            stream,
                                unsigned int                        pageBegin,
                                unsigned int                        pageEnd,
                                PageTableEntry*                     pageTableEntries );
+
+void launchTextureSampler( CUstream                            stream,
+                           const demandLoading::DeviceContext& context,
+                           unsigned int                        textureId,
+                           float                               s,
+                           float                               t,
+                           float                               lod,
+                           float4*                             devTexel,
+                           bool*                               devIsResident );
@@ -0,0 +1,131 @@
+//
+// Copyright (c) 2024, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "Textures/AtlasAllocator.h"
+
+#include <gtest/gtest.h>
+
+#include <set>
+#include <utility>
+#include <vector>
+
+using namespace demandLoading;
+
+namespace {
+
+struct Block
+{
+    unsigned int width;
+    unsigned int x;
+    unsigned int y;
+};
+
+bool overlaps( const Block& a, const Block& b )
+{
+    return a.x < b.x + b.width && b.x < a.x + a.width && a.y < b.y + b.width && b.y < a.y + a.width;
+}
+
+}  // namespace
+
+TEST( TestAtlasAllocator, TestBlockWidth )
+{
+    EXPECT_EQ( 1U, AtlasAllocator::getBlockWidth( 1, 1 ) );
+    EXPECT_EQ( 16U, AtlasAllocator::getBlockWidth( 16, 16 ) );
+    EXPECT_EQ( 32U, AtlasAllocator::getBlockWidth( 32, 4 ) );
+    EXPECT_EQ( 8U, AtlasAllocator::getBlockWidth( 2, 8 ) );
+}
+
+TEST( TestAtlasAllocator, TestFillAtlas )
+{
+    AtlasAllocator allocator( 64 );
+
+    // Sixteen 16x16 blocks fill a 64x64 atlas.
+    std::set<std::pair<unsigned int, unsigned int>> positions;
+    for( int i = 0; i < 16; ++i )
+    {
+        unsigned int x, y;
+        ASSERT_TRUE( allocator.allocate( 16, x, y ) );
+        EXPECT_EQ( 0U, x % 16 );
+        EXPECT_EQ( 0U, y % 16 );
+        EXPECT_TRUE( positions.insert( std::make_pair( x, y ) ).second );
+    }
+    unsigned int x, y;
+    EXPECT_FALSE( allocator.allocate( 1, x, y ) );
+    EXPECT_EQ( 16U, allocator.getNumAllocated() );
+}
+
+TEST( TestAtlasAllocator, TestMixedSizesDoNotOverlap )
+{
+    AtlasAllocator     allocator( 256 );
+    std::vector<Block> blocks;
+    const unsigned int widths[] = {32, 4, 16, 1, 8, 32, 2, 16};
+    for( int i = 0; i < 64; ++i )
+    {
+        Block block{widths[i % 8], 0, 0};
+        ASSERT_TRUE( allocator.allocate( block.width, block.x, block.y ) );
+        EXPECT_EQ( 0U, block.x % block.width );
+        EXPECT_EQ( 0U, block.y % block.width );
+        EXPECT_LE( block.x + block.width, 256U );
+        EXPECT_LE( block.y + block.width, 256U );
+        for( const Block& other : blocks )
+            EXPECT_FALSE( overlaps( block, other ) );
+        blocks.push_back( block );
+    }
+}
+
+TEST( TestAtlasAllocator, TestFreeCoalesces )
+{
+    AtlasAllocator     allocator( 64 );
+    std::vector<Block> blocks;
+    for( int i = 0; i < 64; ++i )
+    {
+        Block block{8, 0, 0};
+        if( !allocator.allocate( block.width, block.x, block.y ) )
+            break;
+        blocks.push_back( block );
+    }
+    EXPECT_EQ( 64U, blocks.size() );
+
+    for( const Block& block : blocks )
+        allocator.free( block.width, block.x, block.y );
+    EXPECT_TRUE( allocator.empty() );
+
+    // After freeing everything, the whole atlas can be allocated again.
+    unsigned int x, y;
+    EXPECT_TRUE( allocator.allocate( 64, x, y ) );
+    EXPECT_EQ( 0U, x );
+    EXPECT_EQ( 0U, y );
+}
+
+TEST( TestAtlasAllocator, TestTooLarge )
+{
+    AtlasAllocator allocator( 32 );
+    unsigned int   x, y;
+    EXPECT_FALSE( allocator.allocate( 64, x, y ) );
+    EXPECT_TRUE( allocator.empty() );
+}
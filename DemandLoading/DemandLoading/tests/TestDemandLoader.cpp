@@ -32,12 +32,16 @@
 
 #include <OptiXToolkit/DemandLoading/SparseTextureDevices.h>
 #include <OptiXToolkit/ImageSource/CheckerBoardImage.h>
+#include <OptiXToolkit/ImageSource/TextureInfo.h>
+#include <OptiXToolkit/ImageSource/WrappedImageSource.h>
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
 #include <cuda_runtime.h>
 
+#include <algorithm>
+#include <cstring>
 #include <functional>
 
 using namespace demandLoading;
@@ -126,6 +130,141 @@ TEST_F( TestDemandLoader, TestCreateTexture )
     // The texture is opaque, so we can't really validate it.
 }
 
+TEST_F( TestDemandLoader, TestCreateTextures )
+{
+    OTK_ERROR_CHECK( cudaSetDevice( 0 ) );
+    DemandLoaderImpl* loader = m_loaders[0];
+
+    std::vector<std::shared_ptr<ImageSource>> images;
+    for( int i = 0; i < 8; ++i )
+        images.emplace_back( new CheckerBoardImage( 256 << ( i % 4 ), 256, 8 /*squaresPerSide*/, true /*useMipmaps*/ ) );
+    images.push_back( images[0] );  // a variant of the first texture
+    const std::vector<TextureDescriptor> descriptors( images.size(), m_descriptor );
+
+    const std::vector<unsigned int> textureIds = loader->createTextures( images, descriptors, true /*openImages*/ );
+
+    ASSERT_EQ( images.size(), textureIds.size() );
+    for( size_t i = 0; i < textureIds.size(); ++i )
+    {
+        DemandTextureImpl* texture = loader->getTexture( textureIds[i] );
+        EXPECT_EQ( textureIds[i], texture->getId() );
+        EXPECT_TRUE( texture->isOpen() );
+        EXPECT_EQ( images[i]->getInfo().width, texture->getInfo().width );
+        if( i > 0 )
+            EXPECT_GT( textureIds[i], textureIds[i - 1] );
+    }
+    EXPECT_EQ( loader->getTexture( textureIds[0] ), loader->getTexture( textureIds.back() )->getMasterTexture() );
+}
+
+TEST_F( TestDemandLoader, TestCreateManyTextures )
+{
+    OTK_ERROR_CHECK( cudaSetDevice( 0 ) );
+
+    // A million textures need two million sampler and base color page table entries.
+    Options options;
+    options.maxTextures      = 1024 * 1024;
+    DemandLoaderImpl* loader = dynamic_cast<DemandLoaderImpl*>( createDemandLoader( options ) );
+    EXPECT_EQ( options.maxTextures * NUM_PAGES_PER_TEXTURE, loader->getOptions().numPageTableEntries );
+
+    // Exceed the default texture limit of 256K.
+    const size_t numTextures = 300 * 1024;
+    std::vector<std::shared_ptr<ImageSource>> images;
+    images.reserve( numTextures );
+    for( size_t i = 0; i < numTextures; ++i )
+        images.emplace_back( new CheckerBoardImage( 64, 64, 8 /*squaresPerSide*/, false /*useMipmaps*/ ) );
+    const std::vector<TextureDescriptor> descriptors( images.size(), m_descriptor );
+
+    // Textures are not opened, so no device memory is allocated for them, and their mip level layout,
+    // request handler and variant list are not allocated either.
+    size_t freeBefore;
+    size_t freeAfter;
+    size_t total;
+    OTK_ERROR_CHECK( cudaMemGetInfo( &freeBefore, &total ) );
+    const size_t deviceMemoryUsed = loader->getStatistics().deviceMemoryUsed;
+    const std::vector<unsigned int> textureIds = loader->createTextures( images, descriptors, false /*openImages*/ );
+    OTK_ERROR_CHECK( cudaMemGetInfo( &freeAfter, &total ) );
+
+    ASSERT_EQ( numTextures, textureIds.size() );
+    EXPECT_LT( textureIds.back(), loader->getOptions().maxTextures );
+    EXPECT_EQ( textureIds.back(), loader->getTexture( textureIds.back() )->getId() );
+    EXPECT_FALSE( loader->getTexture( textureIds.back() )->isOpen() );
+    EXPECT_EQ( nullptr, loader->getTexture( textureIds.back() )->getRequestHandler() );
+    EXPECT_EQ( freeBefore, freeAfter );
+    EXPECT_EQ( deviceMemoryUsed, loader->getStatistics().deviceMemoryUsed );
+    EXPECT_LE( sizeof( DemandTextureImpl ), 384U );
+
+    destroyDemandLoader( loader );
+}
+
+TEST_F( TestDemandLoader, TestSparseUdimTexture )
+{
+    OTK_ERROR_CHECK( cudaSetDevice( 0 ) );
+    DemandLoaderImpl* loader = m_loaders[0];
+
+    // Populate three slots of a 100x100 udim grid.
+    const unsigned int udim = 100;
+    const unsigned int vdim = 100;
+    std::vector<std::shared_ptr<ImageSource>> images( udim * vdim );
+    images[5]    = m_imageSource;
+    images[1234] = m_imageSource;
+    images[9999] = m_imageSource;
+    std::vector<TextureDescriptor> descriptors( images.size(), m_descriptor );
+
+    const DemandTexture& entryPoint = loader->createUdimTexture( images, descriptors, udim, vdim, -1 );
+    const unsigned int   startId    = entryPoint.getId();
+
+    // Only the populated slots consume texture ids.
+    for( unsigned int i = 0; i < 3; ++i )
+        EXPECT_NE( nullptr, loader->getTexture( startId + i ) );
+    const unsigned int nextId = loader->createTexture( m_imageSource, m_descriptor ).getId();
+    EXPECT_EQ( startId + 3, nextId );
+}
+
+TEST_F( TestDemandLoader, TestDestroyUdimTexture )
+{
+    OTK_ERROR_CHECK( cudaSetDevice( 0 ) );
+    DemandLoaderImpl* loader = m_loaders[0];
+
+    // Make a base texture and a 2x2 udim grid.
+    const unsigned int baseTextureId = loader->createTexture( m_imageSource, m_descriptor ).getId();
+    std::vector<std::shared_ptr<ImageSource>> images;
+    for( unsigned int i = 0; i < 4; ++i )
+        images.emplace_back( new CheckerBoardImage( 256, 256, 8 /*squaresPerSide*/, true /*useMipmaps*/ ) );
+    std::vector<TextureDescriptor> descriptors( images.size(), m_descriptor );
+    loader->createUdimTexture( images, descriptors, 2, 2, baseTextureId );
+
+    // Destroying the udim texture destroys the base texture and its subtextures.
+    loader->destroyTexture( baseTextureId );
+    for( unsigned int i = 0; i < 5; ++i )
+        EXPECT_EQ( nullptr, loader->getTexture( baseTextureId + i ) );
+}
+
+TEST_F( TestDemandLoader, TestInitUdimTexture )
+{
+    OTK_ERROR_CHECK( cudaSetDevice( 0 ) );
+    DemandLoaderImpl* loader = m_loaders[0];
+
+    // Make a base texture and a 4x4 udim grid with one empty slot.
+    const unsigned int baseTextureId = loader->createTexture( m_imageSource, m_descriptor ).getId();
+    const unsigned int udim = 4;
+    const unsigned int vdim = 4;
+    std::vector<std::shared_ptr<ImageSource>> images;
+    for( unsigned int i = 0; i < udim * vdim; ++i )
+        images.emplace_back( i == 6 ? nullptr : new CheckerBoardImage( 256, 256, 8 /*squaresPerSide*/, true /*useMipmaps*/ ) );
+    std::vector<TextureDescriptor> descriptors( images.size(), m_descriptor );
+    loader->createUdimTexture( images, descriptors, udim, vdim, baseTextureId );
+
+    // Every subtexture is opened by the (parallel) eager initialization.
+    loader->initUdimTexture( m_streams[0], baseTextureId );
+    OTK_ERROR_CHECK( cuStreamSynchronize( m_streams[0] ) );
+    for( unsigned int i = 1; i < udim * vdim; ++i )
+    {
+        DemandTextureImpl* subTexture = loader->getTexture( baseTextureId + i );
+        ASSERT_NE( nullptr, subTexture );
+        EXPECT_TRUE( subTexture->isOpen() );
+    }
+}
+
 class TestDemandLoaderResident : public TestDemandLoader
 {
   public:
@@ -343,6 +482,309 @@ TEST_F( TestDemandLoaderResident, TestResourceResident )
 }
 
 
+TEST_F( TestDemandLoaderResident, TestEvictUnreferencedTexture )
+{
+    const std::vector<unsigned int> devices = getSparseTextureDevices();
+    if( devices.empty() )
+        return;
+    const unsigned int deviceIndex = devices[0];
+    OTK_ERROR_CHECK( cudaSetDevice( deviceIndex ) );
+
+    // Replace the loader with one that evicts textures that have not been referenced in two launches.
+    Options options;
+    options.maxUnreferencedLaunches = 2;
+    destroyDemandLoader( m_loaders[deviceIndex] );
+    m_loaders[deviceIndex] = dynamic_cast<DemandLoaderImpl*>( createDemandLoader( options ) );
+
+    const ResourceCallback callback = []( CUstream /*stream*/, unsigned int /*pageIndex*/, void* /*context*/,
+                                          void** /*pageTableEntry*/ ) { return true; };
+    const unsigned int samplerId = m_loaders[deviceIndex]->createTexture( m_imageSource, m_descriptor ).getId();
+    const unsigned int otherPageId = m_loaders[deviceIndex]->createResource( 1, callback, nullptr );
+
+    // Load the sampler.
+    bool isResident{};
+    launchKernelAndSynchronize( deviceIndex, samplerId, &isResident );
+    launchKernelAndSynchronize( deviceIndex, samplerId, &isResident );
+    EXPECT_TRUE( isResident );
+
+    // Reference a different page until the texture is evicted.
+    for( int i = 0; i < 4; ++i )
+        launchKernelAndSynchronize( deviceIndex, otherPageId, &isResident );
+    EXPECT_FALSE( m_loaders[deviceIndex]->pageResident( samplerId ) );
+    EXPECT_EQ( 1U, m_loaders[deviceIndex]->getStatistics().numTextureEvictions );
+
+    // The texture is reloaded when it is referenced again.
+    launchKernelAndSynchronize( deviceIndex, samplerId, &isResident );
+    launchKernelAndSynchronize( deviceIndex, samplerId, &isResident );
+    EXPECT_TRUE( isResident );
+}
+
+TEST_F( TestDemandLoaderResident, TestKeepMasterOfReferencedVariant )
+{
+    const std::vector<unsigned int> devices = getSparseTextureDevices();
+    if( devices.empty() )
+        return;
+    const unsigned int deviceIndex = devices[0];
+    OTK_ERROR_CHECK( cudaSetDevice( deviceIndex ) );
+
+    Options options;
+    options.maxUnreferencedLaunches = 2;
+    destroyDemandLoader( m_loaders[deviceIndex] );
+    m_loaders[deviceIndex] = dynamic_cast<DemandLoaderImpl*>( createDemandLoader( options ) );
+
+    // A second texture with the same image is a variant of the first.
+    const unsigned int masterId  = m_loaders[deviceIndex]->createTexture( m_imageSource, m_descriptor ).getId();
+    const unsigned int variantId = m_loaders[deviceIndex]->createTexture( m_imageSource, m_descriptor ).getId();
+
+    // Load both samplers.
+    bool isResident{};
+    for( unsigned int samplerId : { masterId, variantId } )
+    {
+        launchKernelAndSynchronize( deviceIndex, samplerId, &isResident );
+        launchKernelAndSynchronize( deviceIndex, samplerId, &isResident );
+        EXPECT_TRUE( isResident );
+    }
+
+    // The master is not evicted while its variant is referenced.
+    for( int i = 0; i < 4; ++i )
+        launchKernelAndSynchronize( deviceIndex, variantId, &isResident );
+    EXPECT_TRUE( isResident );
+    EXPECT_TRUE( m_loaders[deviceIndex]->pageResident( masterId ) );
+    EXPECT_EQ( 0U, m_loaders[deviceIndex]->getStatistics().numTextureEvictions );
+}
+
+TEST_F( TestDemandLoaderResident, TestDestroyTexture )
+{
+    const std::vector<unsigned int> devices = getSparseTextureDevices();
+    if( devices.empty() )
+        return;
+    const unsigned int deviceIndex = devices[0];
+    OTK_ERROR_CHECK( cudaSetDevice( deviceIndex ) );
+    DemandLoaderImpl* loader = m_loaders[deviceIndex];
+
+    const ResourceCallback callback = []( CUstream /*stream*/, unsigned int /*pageIndex*/, void* /*context*/,
+                                          void** /*pageTableEntry*/ ) { return true; };
+    const unsigned int samplerId   = loader->createTexture( m_imageSource, m_descriptor ).getId();
+    const unsigned int otherPageId = loader->createResource( 1, callback, nullptr );
+
+    // Load the sampler.
+    bool isResident{};
+    launchKernelAndSynchronize( deviceIndex, samplerId, &isResident );
+    launchKernelAndSynchronize( deviceIndex, samplerId, &isResident );
+    EXPECT_TRUE( isResident );
+    const size_t numTextures = loader->getStatistics().numTextures;
+
+    // Destroying the texture invalidates its sampler in the next launch.
+    loader->destroyTexture( samplerId );
+    launchKernelAndSynchronize( deviceIndex, otherPageId, &isResident );
+    EXPECT_FALSE( loader->pageResident( samplerId ) );
+    EXPECT_EQ( numTextures - 1, loader->getStatistics().numTextures );
+
+    // The texture is reclaimed in the next launch, since the launches that might sample it are done.
+    launchKernelAndSynchronize( deviceIndex, otherPageId, &isResident );
+    EXPECT_EQ( numTextures - 1, loader->getStatistics().numTextures );
+
+    // The texture id is reused, and the new texture is not a variant of the destroyed one.
+    const unsigned int newSamplerId = loader->createTexture( m_imageSource, m_descriptor ).getId();
+    EXPECT_EQ( samplerId, newSamplerId );
+    EXPECT_EQ( nullptr, loader->getTexture( newSamplerId )->getMasterTexture() );
+    launchKernelAndSynchronize( deviceIndex, newSamplerId, &isResident );
+    launchKernelAndSynchronize( deviceIndex, newSamplerId, &isResident );
+    EXPECT_TRUE( isResident );
+}
+
+TEST_F( TestDemandLoaderResident, TestGetResidency )
+{
+    const std::vector<unsigned int> devices = getSparseTextureDevices();
+    if( devices.empty() )
+        return;
+    const unsigned int deviceIndex = devices[0];
+    OTK_ERROR_CHECK( cudaSetDevice( deviceIndex ) );
+    DemandLoaderImpl* loader = m_loaders[deviceIndex];
+    CUstream          stream = m_streams[deviceIndex];
+
+    std::shared_ptr<ImageSource> otherImage( new CheckerBoardImage( 2048, 2048, 32 /*squaresPerSide*/, true /*useMipmaps*/ ) );
+    TextureDescriptor            variantDesc = m_descriptor;
+    variantDesc.filterMode                   = CU_TR_FILTER_MODE_POINT;
+    const unsigned int textureId             = loader->createTexture( m_imageSource, m_descriptor ).getId();
+    const unsigned int otherTextureId        = loader->createTexture( otherImage, m_descriptor ).getId();
+    const unsigned int variantTextureId      = loader->createTexture( m_imageSource, variantDesc ).getId();
+
+    // Nothing is resident before the texture is initialized, and the tile layout is unknown.
+    TextureResidency residency = loader->getResidency( textureId );
+    EXPECT_FALSE( residency.isSamplerResident );
+    EXPECT_TRUE( residency.mipLevels.empty() );
+
+    // Initialize the texture and load a tile of the finest level and the mip tail.
+    loader->initTexture( stream, textureId );
+    loader->loadTextureTile( stream, textureId, 0, 1, 2 );
+    const unsigned int mipTailFirstLevel = loader->getMipTailFirstLevel( textureId );
+    loader->loadTextureTile( stream, textureId, mipTailFirstLevel, 0, 0 );
+    OTK_ERROR_CHECK( cuStreamSynchronize( stream ) );
+
+    residency = loader->getResidency( textureId );
+    EXPECT_TRUE( residency.isSamplerResident );
+    EXPECT_TRUE( residency.isSparseTexture );
+    EXPECT_EQ( mipTailFirstLevel, residency.mipTailFirstLevel );
+    ASSERT_EQ( m_imageSource->getInfo().numMipLevels, residency.mipLevels.size() );
+    EXPECT_EQ( 2U, residency.numResidentTiles );
+
+    const MipLevelResidency& finestLevel = residency.mipLevels[0];
+    EXPECT_EQ( 2048U / loader->getTexture( textureId )->getTileWidth(), finestLevel.widthInTiles );
+    EXPECT_TRUE( finestLevel.isResident( 1, 2 ) );
+    EXPECT_FALSE( finestLevel.isResident( 2, 1 ) );
+    EXPECT_EQ( 1, std::count( finestLevel.residentTiles.begin(), finestLevel.residentTiles.end(), true ) );
+    EXPECT_FALSE( residency.mipLevels[1].isResident( 0, 0 ) );
+    for( unsigned int mipLevel = mipTailFirstLevel; mipLevel < residency.mipLevels.size(); ++mipLevel )
+        EXPECT_TRUE( residency.mipLevels[mipLevel].isResident( 0, 0 ) );
+
+    // The bulk query reports each texture.
+    const std::vector<TextureResidency> residencies = loader->getResidency( std::vector<unsigned int>{ textureId, otherTextureId } );
+    ASSERT_EQ( 2U, residencies.size() );
+    EXPECT_EQ( 2U, residencies[0].numResidentTiles );
+    EXPECT_FALSE( residencies[1].isSamplerResident );
+    EXPECT_EQ( 0U, residencies[1].numResidentTiles );
+
+    // An uninitialized variant reports the tiles of its master texture, but not its own sampler.
+    residency = loader->getResidency( variantTextureId );
+    EXPECT_FALSE( residency.isSamplerResident );
+    EXPECT_EQ( 2U, residency.numResidentTiles );
+    ASSERT_FALSE( residency.mipLevels.empty() );
+    EXPECT_TRUE( residency.mipLevels[0].isResident( 1, 2 ) );
+}
+
+// An image that differs from the wrapped image only in one tile of the finest level, which is black.
+class EditedTileImage : public WrappedImageSource
+{
+  public:
+    EditedTileImage( std::shared_ptr<ImageSource> imageSource, unsigned int tileX, unsigned int tileY )
+        : WrappedImageSource( std::move( imageSource ) )
+        , m_tileX( tileX )
+        , m_tileY( tileY )
+    {
+    }
+
+    bool readTile( char* dest, unsigned int mipLevel, const Tile& tile, CUstream stream ) override
+    {
+        if( mipLevel != 0 || tile.x != m_tileX || tile.y != m_tileY )
+            return WrappedImageSource::readTile( dest, mipLevel, tile, stream );
+        const TextureInfo& info = getInfo();
+        memset( dest, 0, getImageSizeInBytes( info.format, info.numChannels, tile.width, tile.height ) );
+        return true;
+    }
+
+  private:
+    unsigned int m_tileX;
+    unsigned int m_tileY;
+};
+
+TEST_F( TestDemandLoaderResident, TestIncrementalReload )
+{
+    const std::vector<unsigned int> devices = getSparseTextureDevices();
+    if( devices.empty() )
+        return;
+    const unsigned int deviceIndex = devices[0];
+    OTK_ERROR_CHECK( cudaSetDevice( deviceIndex ) );
+
+    Options options;
+    options.useIncrementalReload = true;
+    destroyDemandLoader( m_loaders[deviceIndex] );
+    m_loaders[deviceIndex] = dynamic_cast<DemandLoaderImpl*>( createDemandLoader( options ) );
+    DemandLoaderImpl* loader = m_loaders[deviceIndex];
+    CUstream          stream = m_streams[deviceIndex];
+
+    const ResourceCallback callback = []( CUstream /*stream*/, unsigned int /*pageIndex*/, void* /*context*/,
+                                          void** /*pageTableEntry*/ ) { return true; };
+    const unsigned int textureId   = loader->createTexture( m_imageSource, m_descriptor ).getId();
+    const unsigned int otherPageId = loader->createResource( 1, callback, nullptr );
+
+    // Load three tiles of the finest level.
+    loader->initTexture( stream, textureId );
+    for( unsigned int tileX = 0; tileX < 3; ++tileX )
+        loader->loadTextureTile( stream, textureId, 0, tileX, 0 );
+    OTK_ERROR_CHECK( cuStreamSynchronize( stream ) );
+    EXPECT_EQ( 3U, loader->getResidency( textureId ).numResidentTiles );
+
+    // Reload an image in which only the middle tile changed.  The change is applied in the next launch.
+    std::shared_ptr<ImageSource> newImage( new EditedTileImage(
+        std::make_shared<CheckerBoardImage>( 2048, 2048, 32 /*squaresPerSide*/, true /*useMipmaps*/ ), 1, 0 ) );
+    loader->reloadTexture( stream, textureId, newImage );
+    bool isResident{};
+    launchKernelAndSynchronize( deviceIndex, otherPageId, &isResident );
+
+    // Only the changed tile is invalidated.
+    const TextureResidency residency = loader->getResidency( textureId );
+    EXPECT_TRUE( residency.isSamplerResident );
+    EXPECT_EQ( 2U, residency.numResidentTiles );
+    EXPECT_TRUE( residency.mipLevels[0].isResident( 0, 0 ) );
+    EXPECT_FALSE( residency.mipLevels[0].isResident( 1, 0 ) );
+    EXPECT_TRUE( residency.mipLevels[0].isResident( 2, 0 ) );
+}
+
+TEST_F( TestDemandLoader, TestSampleAtlasTexture )
+{
+    OTK_ERROR_CHECK( cudaSetDevice( 0 ) );
+    CUstream stream = m_streams[0];
+
+    // Load a small texture into the atlas, and the same texture as a standalone dense texture.
+    Options options;
+    options.useSparseTextures = false;
+    DemandLoaderImpl* denseLoader = dynamic_cast<DemandLoaderImpl*>( createDemandLoader( options ) );
+    options.useTextureAtlas = true;
+    DemandLoaderImpl* atlasLoader = dynamic_cast<DemandLoaderImpl*>( createDemandLoader( options ) );
+
+    std::shared_ptr<ImageSource> image( new CheckerBoardImage( 16, 16, 4 /*squaresPerSide*/, true /*useMipmaps*/ ) );
+    TextureDescriptor            desc = m_descriptor;
+    desc.filterMode                   = FILTER_POINT;
+    desc.mipmapFilterMode             = CU_TR_FILTER_MODE_POINT;
+    const unsigned int denseId        = denseLoader->createTexture( image, desc ).getId();
+    const unsigned int atlasId        = atlasLoader->createTexture( image, desc ).getId();
+
+    float4* devTexel{};
+    bool*   devIsResident{};
+    OTK_ERROR_CHECK( cuMemAlloc( reinterpret_cast<CUdeviceptr*>( &devTexel ), sizeof( float4 ) ) );
+    OTK_ERROR_CHECK( cuMemAlloc( reinterpret_cast<CUdeviceptr*>( &devIsResident ), sizeof( bool ) ) );
+    auto sample = [this, stream, devTexel, devIsResident]( DemandLoaderImpl* loader, unsigned int textureId, float s, float t, float lod ) {
+        float4 texel{};
+        bool   isResident{};
+        for( int i = 0; i < 4 && !isResident; ++i )
+        {
+            launchKernel( loader, stream, [=]( const DeviceContext& context ) {
+                launchTextureSampler( stream, context, textureId, s, t, lod, devTexel, devIsResident );
+            } );
+            OTK_ERROR_CHECK( cudaMemcpy( &isResident, devIsResident, sizeof( bool ), cudaMemcpyDeviceToHost ) );
+        }
+        EXPECT_TRUE( isResident );
+        OTK_ERROR_CHECK( cudaMemcpy( &texel, devTexel, sizeof( float4 ), cudaMemcpyDeviceToHost ) );
+        return texel;
+    };
+
+    // Point samples of the atlas texture match the dense texture at each of its mip levels, at its
+    // edges, and across the wrap.
+    const float coords[] = { 0.5f / 16, 7.5f / 16, 15.5f / 16, 1.0f + 3.5f / 16, -0.5f / 16 };
+    for( float lod : { 0.0f, 1.0f, 2.0f, 3.0f } )
+    {
+        for( float s : coords )
+        {
+            for( float t : coords )
+            {
+                const float4 expected = sample( denseLoader, denseId, s, t, lod );
+                const float4 actual   = sample( atlasLoader, atlasId, s, t, lod );
+                EXPECT_EQ( expected.x, actual.x ) << "s=" << s << " t=" << t << " lod=" << lod;
+                EXPECT_EQ( expected.y, actual.y ) << "s=" << s << " t=" << t << " lod=" << lod;
+                EXPECT_EQ( expected.z, actual.z ) << "s=" << s << " t=" << t << " lod=" << lod;
+                EXPECT_EQ( expected.w, actual.w ) << "s=" << s << " t=" << t << " lod=" << lod;
+            }
+        }
+    }
+    EXPECT_TRUE( atlasLoader->getTexture( atlasId )->getSampler().isAtlasTexture );
+
+    OTK_ERROR_CHECK( cuMemFree( reinterpret_cast<CUdeviceptr>( devTexel ) ) );
+    OTK_ERROR_CHECK( cuMemFree( reinterpret_cast<CUdeviceptr>( devIsResident ) ) );
+    destroyDemandLoader( atlasLoader );
+    destroyDemandLoader( denseLoader );
+}
+
 TEST_F( TestDemandLoader, TestTextureVariants )
 {
     OTK_ERROR_CHECK( cudaSetDevice( 0 ) );
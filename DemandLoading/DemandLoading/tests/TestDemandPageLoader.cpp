@@ -144,3 +144,44 @@ TEST_F( DemandPageLoaderTest, request_resident_page )
     EXPECT_TRUE( getIsResident() );
     EXPECT_EQ( requestedPage, actualRequestedPage );
 }
+
+TEST_F( DemandPageLoaderTest, released_pages_are_invalidated_and_reused )
+{
+    EXPECT_CALL( m_processor, addRequests( m_stream, 0, NotNull(), 0 ) );
+    unsigned int actualRequestedPage{};
+    EXPECT_CALL( m_processor, addRequests( m_stream, 1, NotNull(), 1 ) ).WillOnce( SaveArgPointee<2>( &actualRequestedPage ) );
+    const unsigned int NUM_PAGES     = 10;
+    const unsigned int startPage     = m_loader->allocatePages( NUM_PAGES, true );
+    const unsigned int requestedPage = startPage + NUM_PAGES / 2;
+    m_loader->setPageTableEntry( requestedPage, true, 0ULL );
+    launchAndRequestPage( requestedPage );
+    EXPECT_TRUE( getIsResident() );
+
+    // The released range is invalidated by the next launch, and only then reused.
+    m_loader->releasePages( startPage );
+    launchAndRequestPage( requestedPage );
+
+    EXPECT_FALSE( getIsResident() );
+    EXPECT_EQ( requestedPage, actualRequestedPage );
+    EXPECT_EQ( startPage, m_loader->allocatePages( NUM_PAGES, true ) );
+}
+
+TEST_F( DemandPageLoaderTest, pages_reserved_after_push_are_not_scanned )
+{
+    unsigned int actualRequestedPage{};
+    EXPECT_CALL( m_processor, addRequests( m_stream, _, NotNull(), 1 ) ).WillOnce( SaveArgPointee<2>( &actualRequestedPage ) );
+    const unsigned int NUM_PAGES     = 10;
+    const unsigned int startPage     = m_loader->allocatePages( NUM_PAGES, true );
+    const unsigned int requestedPage = startPage + NUM_PAGES / 2;
+    m_loader->pushMappings( m_stream, m_context );
+
+    // Reserve more pages than the device page arrays hold.  They are not grown until the next
+    // push, so the request kernel must stop at the end of the arrays.
+    m_loader->allocatePages( m_context.maxNumPages, false );
+    launchPageRequester( m_stream, m_context, requestedPage, static_cast<bool*>( m_devIsResident ),
+                         static_cast<unsigned long long*>( m_devPageTableEntry ) );
+    m_loader->pullRequests( m_stream, m_context, m_pullId++ );
+    OTK_ERROR_CHECK( cuStreamSynchronize( m_stream ) );
+
+    EXPECT_EQ( requestedPage, actualRequestedPage );
+}
@@ -80,4 +80,23 @@ TEST_F( TestDenseTexture, TestInit )
     }
 }
 
+TEST( TestDenseFillChunks, TestSmallTextureIsOneChunk )
+{
+    const std::vector<size_t> levelSizes{ 4096, 1024, 256, 64, 16, 4 };
+    EXPECT_EQ( std::vector<unsigned int>{ 6 }, getDenseFillChunks( levelSizes, 1 << 20 ) );
+}
+
+TEST( TestDenseFillChunks, TestLargeLevelsGetTheirOwnChunks )
+{
+    // Levels larger than the chunk size are filled alone, and the remaining levels are grouped.
+    const std::vector<size_t> levelSizes{ 64 << 20, 16 << 20, 4 << 20, 1 << 20, 256 << 10, 64 << 10 };
+    EXPECT_EQ( ( std::vector<unsigned int>{ 1, 2, 3, 6 } ), getDenseFillChunks( levelSizes, 4 << 20 ) );
+}
+
+TEST( TestDenseFillChunks, TestChunksAreBounded )
+{
+    const std::vector<size_t> levelSizes{ 3, 3, 3, 3, 1 };
+    EXPECT_EQ( ( std::vector<unsigned int>{ 2, 4, 5 } ), getDenseFillChunks( levelSizes, 6 ) );
+}
+
 // Note: the FillTile and FillMipTail methods are covered by TestDemandTexture.
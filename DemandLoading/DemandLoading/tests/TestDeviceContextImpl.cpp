@@ -69,3 +69,33 @@ TEST_F( TestDeviceContextImpl, TestConstructor )
     context.allocatePerDeviceData( &memPool, m_options );
     context.allocatePerStreamData( &memPool, m_options );
 }
+
+TEST_F( TestDeviceContextImpl, TestGrowPreservesContents )
+{
+    m_options.numPages = 8 * 1024 * 1024;
+    MemoryPool<DeviceAllocator, HeapSuballocator> memPool( new DeviceAllocator(), nullptr );
+    DeviceContextImpl context{};
+
+    // The page arrays start with a single chunk, not the whole page space.
+    context.allocatePerDeviceData( &memPool, m_options );
+    context.allocatePerStreamData( &memPool, m_options );
+    const unsigned int initialCapacity = context.maxNumPages;
+    EXPECT_LT( initialCapacity, m_options.numPages );
+
+    const unsigned int residenceWord = 0x12345678;
+    OTK_ERROR_CHECK( cudaMemcpy( context.residenceBits, &residenceWord, sizeof( unsigned int ), cudaMemcpyHostToDevice ) );
+
+    const unsigned int capacity = DeviceContextImpl::getPageCapacity( initialCapacity + 1, initialCapacity, m_options );
+    EXPECT_GT( capacity, initialCapacity );
+    EXPECT_LE( capacity, m_options.numPages );
+    context.growPerDeviceData( &memPool, m_options, capacity );
+    context.growPerStreamData( &memPool );
+    EXPECT_EQ( capacity, context.maxNumPages );
+
+    // Existing bits are preserved, and the new tail is zeroed.
+    unsigned int words[2];
+    OTK_ERROR_CHECK( cudaMemcpy( &words[0], context.residenceBits, sizeof( unsigned int ), cudaMemcpyDeviceToHost ) );
+    OTK_ERROR_CHECK( cudaMemcpy( &words[1], context.residenceBits + ( capacity / 32 - 1 ), sizeof( unsigned int ), cudaMemcpyDeviceToHost ) );
+    EXPECT_EQ( residenceWord, words[0] );
+    EXPECT_EQ( 0U, words[1] );
+}
@@ -0,0 +1,131 @@
+//
+// Copyright (c) 2024, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "Textures/EncodedTileCache.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace demandLoading;
+
+class TestEncodedTileCache : public testing::Test
+{
+  public:
+    TestEncodedTileCache()
+        : m_directory( testing::TempDir() )
+        , m_cache( m_directory )
+        , m_data( 4096 )
+    {
+        for( size_t i = 0; i < m_data.size(); ++i )
+            m_data[i] = static_cast<char>( i * 7 );
+    }
+
+    ~TestEncodedTileCache() override
+    {
+        for( uint64_t key : { KEY, OTHER_KEY } )
+        {
+            char name[32];
+            snprintf( name, sizeof( name ), "/%016llx.bc", static_cast<unsigned long long>( key ) );
+            std::remove( ( m_directory + name ).c_str() );
+        }
+    }
+
+  protected:
+    const uint64_t    KEY       = 0x0123456789ABCDEFULL;
+    const uint64_t    OTHER_KEY = 0xFEDCBA9876543210ULL;
+    const uint64_t    SEED      = 42;
+    std::string       m_directory;
+    EncodedTileCache  m_cache;
+    std::vector<char> m_data;
+};
+
+TEST_F( TestEncodedTileCache, TestMissingEntry )
+{
+    std::vector<char> result( m_data.size() );
+    EXPECT_FALSE( m_cache.load( OTHER_KEY, SEED, result.data(), result.size() ) );
+    EXPECT_EQ( 1U, m_cache.getNumMisses() );
+    EXPECT_EQ( 0U, m_cache.getNumHits() );
+}
+
+TEST_F( TestEncodedTileCache, TestStoreAndLoad )
+{
+    m_cache.store( KEY, SEED, m_data.data(), m_data.size() );
+
+    std::vector<char> result( m_data.size() );
+    ASSERT_TRUE( m_cache.load( KEY, SEED, result.data(), result.size() ) );
+    EXPECT_EQ( m_data, result );
+    EXPECT_EQ( 1U, m_cache.getNumHits() );
+
+    // Another cache in the same directory (e.g. in a later run) sees the entry.
+    EncodedTileCache  other( m_directory );
+    std::vector<char> otherResult( m_data.size() );
+    ASSERT_TRUE( other.load( KEY, SEED, otherResult.data(), otherResult.size() ) );
+    EXPECT_EQ( m_data, otherResult );
+}
+
+TEST_F( TestEncodedTileCache, TestSizeMismatchIsMiss )
+{
+    m_cache.store( KEY, SEED, m_data.data(), m_data.size() );
+    std::vector<char> result( m_data.size() / 2 );
+    EXPECT_FALSE( m_cache.load( KEY, SEED, result.data(), result.size() ) );
+}
+
+TEST_F( TestEncodedTileCache, TestMissingDirectoryIsIgnored )
+{
+    EncodedTileCache cache( m_directory + "/no/such/directory" );
+    cache.store( KEY, SEED, m_data.data(), m_data.size() );
+    std::vector<char> result( m_data.size() );
+    EXPECT_FALSE( cache.load( KEY, SEED, result.data(), result.size() ) );
+}
+
+TEST_F( TestEncodedTileCache, TestSeedMismatchIsMiss )
+{
+    // An entry whose key was hashed with another seed is not used, even if the key collides.
+    m_cache.store( KEY, SEED, m_data.data(), m_data.size() );
+    std::vector<char> result( m_data.size() );
+    EXPECT_FALSE( m_cache.load( KEY, SEED + 1, result.data(), result.size() ) );
+    EXPECT_TRUE( m_cache.load( KEY, SEED, result.data(), result.size() ) );
+}
+
+TEST_F( TestEncodedTileCache, TestEntryWithoutHeaderIsMiss )
+{
+    // An entry written by an older version of the cache (with no header) is not used.
+    char name[32];
+    snprintf( name, sizeof( name ), "/%016llx.bc", static_cast<unsigned long long>( KEY ) );
+    FILE* file = fopen( ( m_directory + name ).c_str(), "wb" );
+    ASSERT_NE( nullptr, file );
+    fwrite( m_data.data(), 1, m_data.size(), file );
+    fclose( file );
+
+    std::vector<char> result( m_data.size() );
+    EXPECT_FALSE( m_cache.load( KEY, SEED, result.data(), result.size() ) );
+    EXPECT_EQ( 1U, m_cache.getNumMisses() );
+}
@@ -71,6 +71,18 @@ TEST_F( TestMutexArray, LockUnlockMulti )
     mutex.unlock( 1 );
 }
 
+TEST_F( TestMutexArray, TryLock )
+{
+    MutexArray mutex( 2 );
+    EXPECT_TRUE( mutex.tryLock( 0 ) );
+    EXPECT_FALSE( mutex.tryLock( 0 ) );
+    EXPECT_TRUE( mutex.tryLock( 1 ) );
+    mutex.unlock( 0 );
+    EXPECT_TRUE( mutex.tryLock( 0 ) );
+    mutex.unlock( 0 );
+    mutex.unlock( 1 );
+}
+
 TEST_F( TestMutexArray, MutexArrayLock )
 {
     MutexArray mutex( 1 );
@@ -27,9 +27,14 @@
 //
 
 #include "PageTableManager.h"
+#include "Util/Stopwatch.h"
 
 #include <gtest/gtest.h>
 
+#include <atomic>
+#include <string>
+#include <thread>
+
 using namespace demandLoading;
 
 class DummyRequestHandler : public RequestHandler
@@ -134,3 +139,206 @@ TEST_F( TestPageTableManager, TestMappingOrderPreserved )
     EXPECT_EQ( &handler2, mgr.getRequestHandler( pageId2 ) );
     EXPECT_EQ( &handler3, mgr.getRequestHandler( pageId3 ) );
 }
+
+TEST_F( TestPageTableManager, TestFindAcrossLeaves )
+{
+    // Reserve ranges that straddle, fill, and partially overlap leaves of the radix table.
+    DummyRequestHandler handler1;
+    DummyRequestHandler handler2;
+    DummyRequestHandler handler3;
+    const unsigned int  pageId1 = mgr.reserveUnbackedPages( 100, &handler1 );
+    const unsigned int  pageId2 = mgr.reserveUnbackedPages( 20000, &handler2 );
+    const unsigned int  pageId3 = mgr.reserveUnbackedPages( 5, &handler3 );
+
+    EXPECT_EQ( &handler1, mgr.getRequestHandler( pageId1 + 99 ) );
+    for( unsigned int pageId = pageId2; pageId < pageId2 + 20000; pageId += 97 )
+        EXPECT_EQ( &handler2, mgr.getRequestHandler( pageId ) );
+    EXPECT_EQ( &handler2, mgr.getRequestHandler( pageId2 + 19999 ) );
+    EXPECT_EQ( &handler3, mgr.getRequestHandler( pageId3 ) );
+    EXPECT_EQ( nullptr, mgr.getRequestHandler( pageId3 + 5 ) );
+}
+
+TEST_F( TestPageTableManager, TestOutOfRangeNotFound )
+{
+    mgr.reserveUnbackedPages( 1000, &handler );
+    EXPECT_EQ( nullptr, mgr.getRequestHandler( 1024u * 1024u ) );
+    EXPECT_EQ( nullptr, mgr.getRequestHandler( 0xFFFFFFFFu ) );
+}
+
+TEST_F( TestPageTableManager, TestRemoveRequestHandler )
+{
+    DummyRequestHandler handler1;
+    const unsigned int  pageId  = mgr.reserveUnbackedPages( 10000, &handler );
+    const unsigned int  pageId1 = mgr.reserveUnbackedPages( 10, &handler1 );
+
+    mgr.removeRequestHandler( pageId + 5 );
+    EXPECT_NE( &handler, mgr.getRequestHandler( pageId ) );
+    EXPECT_NE( &handler, mgr.getRequestHandler( pageId + 9999 ) );
+    EXPECT_NE( nullptr, mgr.getRequestHandler( pageId + 9999 ) );
+    EXPECT_EQ( &handler1, mgr.getRequestHandler( pageId1 ) );
+}
+
+TEST_F( TestPageTableManager, TestConcurrentReserveAndLookup )
+{
+    // Readers look up pages while a writer reserves new ranges.  Every reserved page must resolve to
+    // its handler once the reservation returns, and no lookup may observe a foreign handler.
+    const unsigned int               count = 1000;
+    std::vector<DummyRequestHandler> handlers( count );
+    std::vector<std::atomic<unsigned int>> firstPages( count );
+    std::atomic<unsigned int>        numReserved( 0 );
+    std::atomic<bool>                failed( false );
+
+    std::vector<std::thread> readers;
+    for( unsigned int t = 0; t < 4; ++t )
+    {
+        readers.emplace_back( [&] {
+            while( numReserved.load() < count )
+            {
+                const unsigned int n = numReserved.load();
+                for( unsigned int i = 0; i < n; ++i )
+                {
+                    const unsigned int firstPage = firstPages[i].load();
+                    if( mgr.getRequestHandler( firstPage ) != &handlers[i]
+                        || mgr.getRequestHandler( firstPage + i ) != &handlers[i] )
+                        failed = true;
+                }
+            }
+        } );
+    }
+
+    for( unsigned int i = 0; i < count; ++i )
+    {
+        firstPages[i] = mgr.reserveUnbackedPages( i + 1, &handlers[i] );
+        ++numReserved;
+    }
+    for( std::thread& reader : readers )
+        reader.join();
+
+    EXPECT_FALSE( failed.load() );
+}
+
+TEST_F( TestPageTableManager, TestReleasedPagesNotReusedBeforeRecycle )
+{
+    DummyRequestHandler handler1;
+    const unsigned int  pageId  = mgr.reserveUnbackedPages( 10, &handler );
+    mgr.reserveUnbackedPages( 10, &handler1 );
+    const unsigned int  available = mgr.getAvailableUnbackedPages();
+
+    EXPECT_EQ( 10u, mgr.releasePages( pageId + 3 ) );
+    EXPECT_NE( &handler, mgr.getRequestHandler( pageId ) );
+    EXPECT_EQ( available, mgr.getAvailableUnbackedPages() );
+    DummyRequestHandler handler2;
+    EXPECT_NE( pageId, mgr.reserveUnbackedPages( 10, &handler2 ) );
+}
+
+TEST_F( TestPageTableManager, TestRecycleReleasedPages )
+{
+    DummyRequestHandler handler1;
+    DummyRequestHandler handler2;
+    const unsigned int  pageId  = mgr.reserveBackedPages( 10, &handler );
+    const unsigned int  pageId1 = mgr.reserveBackedPages( 10, &handler1 );
+    const unsigned int  available = mgr.getAvailableBackedPages();
+
+    mgr.releasePages( pageId );
+    mgr.recycleReleasedPages();
+    EXPECT_EQ( available + 10, mgr.getAvailableBackedPages() );
+
+    // A smaller reservation reuses the front of the released range.
+    DummyRequestHandler handler3;
+    EXPECT_EQ( pageId, mgr.reserveBackedPages( 4, &handler3 ) );
+    EXPECT_EQ( &handler3, mgr.getRequestHandler( pageId + 3 ) );
+    EXPECT_EQ( &handler1, mgr.getRequestHandler( pageId1 ) );
+    EXPECT_EQ( pageId + 4, mgr.reserveBackedPages( 6, &handler2 ) );
+    EXPECT_EQ( available, mgr.getAvailableBackedPages() );
+}
+
+TEST_F( TestPageTableManager, TestRecycleOneReleasedRange )
+{
+    DummyRequestHandler handler1;
+    const unsigned int  pageId    = mgr.reserveBackedPages( 10, &handler );
+    const unsigned int  pageId1   = mgr.reserveBackedPages( 10, &handler1 );
+    const unsigned int  available = mgr.getAvailableBackedPages();
+
+    // Only the given range is recycled; the other stays released until it is recycled too.
+    mgr.releasePages( pageId );
+    mgr.releasePages( pageId1 );
+    mgr.recycleReleasedPages( pageId );
+    EXPECT_EQ( available + 10, mgr.getAvailableBackedPages() );
+    mgr.recycleReleasedPages();
+    EXPECT_EQ( available + 20, mgr.getAvailableBackedPages() );
+}
+
+TEST_F( TestPageTableManager, TestCoalesceReleasedPages )
+{
+    std::vector<DummyRequestHandler> handlers( 4 );
+    std::vector<unsigned int>        pageIds;
+    for( DummyRequestHandler& h : handlers )
+        pageIds.push_back( mgr.reserveUnbackedPages( 100, &h ) );
+    const unsigned int endPage = mgr.getEndPage();
+
+    // Release two adjacent ranges; a reservation spanning both fits in the coalesced range.
+    mgr.releasePages( pageIds[1] );
+    mgr.releasePages( pageIds[2] );
+    mgr.recycleReleasedPages();
+    DummyRequestHandler handler1;
+    EXPECT_EQ( pageIds[1], mgr.reserveUnbackedPages( 200, &handler1 ) );
+    EXPECT_EQ( endPage, mgr.getEndPage() );
+}
+
+TEST_F( TestPageTableManager, TestReleaseLastRangeShrinksEndPage )
+{
+    DummyRequestHandler handler1;
+    DummyRequestHandler handler2;
+    const unsigned int  pageId  = mgr.reserveUnbackedPages( 100, &handler );
+    const unsigned int  pageId1 = mgr.reserveUnbackedPages( 100, &handler1 );
+    const unsigned int  pageId2 = mgr.reserveUnbackedPages( 100, &handler2 );
+
+    mgr.releasePages( pageId1 );
+    mgr.recycleReleasedPages();
+    mgr.releasePages( pageId2 );
+    mgr.recycleReleasedPages();
+    EXPECT_EQ( pageId + 100, mgr.getEndPage() );
+    DummyRequestHandler handler3;
+    EXPECT_EQ( pageId1, mgr.reserveUnbackedPages( 150, &handler3 ) );
+}
+
+// Not a correctness test: measures lookup throughput under contention, which is what the request
+// processor's worker threads do for every page request.  Disabled by default; run it with
+// --gtest_also_run_disabled_tests, and find the results in the test properties (e.g. --gtest_output=xml).
+TEST_F( TestPageTableManager, DISABLED_BenchmarkConcurrentLookup )
+{
+    const unsigned int               numHandlers = 4096;
+    std::vector<DummyRequestHandler> handlers( numHandlers );
+    for( unsigned int i = 0; i < numHandlers; ++i )
+        mgr.reserveUnbackedPages( 1 + i % 200, &handlers[i] );
+    const unsigned int endPage = mgr.getEndPage();
+
+    const unsigned int lookupsPerThread = 1000000;
+    const unsigned int maxThreads       = std::max( 1u, std::thread::hardware_concurrency() );
+    for( unsigned int numThreads = 1; numThreads <= maxThreads; numThreads *= 2 )
+    {
+        std::atomic<unsigned int> numMisses( 0 );
+        Stopwatch                 stopwatch;
+        std::vector<std::thread>  threads;
+        for( unsigned int t = 0; t < numThreads; ++t )
+        {
+            threads.emplace_back( [&, t] {
+                unsigned int pageId = 1024 + t * 7919;
+                unsigned int misses = 0;
+                for( unsigned int i = 0; i < lookupsPerThread; ++i )
+                {
+                    pageId = 1024 + ( pageId * 1103515245u + 12345u ) % ( endPage - 1024 );
+                    misses += mgr.getRequestHandler( pageId ) == nullptr;
+                }
+                numMisses += misses;
+            } );
+        }
+        for( std::thread& thread : threads )
+            thread.join();
+        const double seconds = stopwatch.elapsed();
+
+        EXPECT_EQ( 0u, numMisses.load() );
+        RecordProperty( "lookupsPerSecond" + std::to_string( numThreads ),
+                        std::to_string( static_cast<long long>( numThreads * lookupsPerThread / seconds ) ) );
+    }
+}
@@ -241,3 +241,88 @@ TEST_F( TestPagingSystem, TestPageMappingOverflow )
         device->pushMappings();
     }
 }
+
+TEST_F( TestPagingSystem, TestPinnedPages )
+{
+    // Allow two pinned pages.
+    m_options->maxPinnedTexMemPerDevice = 2 * TILE_SIZE_IN_BYTES;
+
+    for( auto& device : m_devices )
+    {
+        OTK_ERROR_CHECK( cudaSetDevice( device->m_deviceIndex ) );
+
+        const unsigned int startPage = m_options->numPageTableEntries;
+        EXPECT_TRUE( device->m_paging.addPinnedMapping( startPage, 42ULL ) );
+        device->m_paging.addMapping( startPage + 1, 0, 43ULL );
+        device->m_paging.addMapping( startPage + 2, 0, 44ULL );
+
+        // Only one more page fits in the pinned budget.
+        EXPECT_EQ( 1U, device->m_paging.pinPages( startPage, startPage + 3 ) );
+        EXPECT_EQ( 2U, device->m_paging.getNumPinnedPages() );
+
+        // Over budget, the mapping is added as evictable.
+        EXPECT_FALSE( device->m_paging.addPinnedMapping( startPage + 3, 45ULL ) );
+        EXPECT_TRUE( device->m_paging.isResident( startPage + 3 ) );
+
+        EXPECT_EQ( 2U, device->m_paging.unpinPages( startPage, startPage + 4 ) );
+        EXPECT_EQ( 0U, device->m_paging.getNumPinnedPages() );
+        device->pushMappings();
+    }
+}
+
+TEST_F( TestPagingSystem, TestResidencyGroups )
+{
+    for( auto& device : m_devices )
+    {
+        OTK_ERROR_CHECK( cudaSetDevice( device->m_deviceIndex ) );
+
+        const unsigned int group     = device->m_paging.createResidencyGroup( 2, true /*hardQuota*/ );
+        const unsigned int startPage = m_options->numPageTableEntries;
+        EXPECT_NE( 0U, group );
+
+        device->m_paging.addMapping( startPage, 0, 42ULL, group );
+        EXPECT_FALSE( device->m_paging.isResidencyGroupFull( group ) );
+        device->m_paging.addMapping( startPage + 1, 0, 43ULL, group );
+        EXPECT_EQ( 0U, device->m_paging.getNumQuotaDeferredRequests() );
+        EXPECT_TRUE( device->m_paging.isResidencyGroupFull( group ) );
+        EXPECT_EQ( 2U, device->m_paging.getResidencyGroupSize( group ) );
+
+        // Remapping a page does not count it twice.
+        device->m_paging.addMapping( startPage + 1, 0, 44ULL, group );
+        EXPECT_EQ( 2U, device->m_paging.getResidencyGroupSize( group ) );
+
+        // Move the pages to the default group, which has no quota.
+        device->m_paging.setResidencyGroup( startPage, startPage + 2, 0 );
+        EXPECT_EQ( 0U, device->m_paging.getResidencyGroupSize( group ) );
+        EXPECT_FALSE( device->m_paging.isResidencyGroupFull( group ) );
+
+        // Only the request made while the group was full was deferred.
+        EXPECT_EQ( 1U, device->m_paging.getNumQuotaDeferredRequests() );
+        device->pushMappings();
+    }
+}
+
+TEST_F( TestPagingSystem, TestDependentMapping )
+{
+    for( auto& device : m_devices )
+    {
+        OTK_ERROR_CHECK( cudaSetDevice( device->m_deviceIndex ) );
+
+        // Map a page whose entry refers to pages beyond the end of the device page arrays.
+        DeviceContext*     context = device->m_deviceMemoryManager.allocateDeviceContext();
+        const unsigned int endPage = context->maxNumPages + 1;
+        device->m_deviceMemoryManager.freeDeviceContext( context );
+        const unsigned int pageId = 0;
+        device->m_paging.addDependentMapping( pageId, 0, 42ULL, endPage );
+        device->pushMappings();
+
+        // The mapping is held back until the arrays have grown to cover the pages.
+        std::vector<unsigned long long> pages = device->requestPages( std::vector<unsigned int>{ pageId } );
+        EXPECT_FALSE( device->m_pagesResident[0] );
+        device->m_deviceMemoryManager.reservePages( endPage );
+        device->pushMappings();
+        pages = device->requestPages( std::vector<unsigned int>{ pageId } );
+        EXPECT_TRUE( device->m_pagesResident[0] );
+        EXPECT_EQ( 42ULL, pages[0] );
+    }
+}
@@ -0,0 +1,105 @@
+//
+// Copyright (c) 2024, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "RequestQueue.h"
+#include "TicketImpl.h"
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+using namespace demandLoading;
+
+class TestRequestQueue : public testing::Test
+{
+  public:
+    RequestQueue m_queue{ 4 };
+};
+
+TEST_F( TestRequestQueue, LowPriorityRequestsArePoppedLast )
+{
+    const std::vector<unsigned int> lowPriorityPages{ 10, 11 };
+    const std::vector<unsigned int> pages{ 1, 2 };
+    Ticket lowPriorityTicket = TicketImpl::create( CUstream{} );
+    Ticket ticket            = TicketImpl::create( CUstream{} );
+    m_queue.pushLowPriority( lowPriorityPages.data(), 2, lowPriorityTicket );
+    m_queue.push( pages.data(), 2, ticket );
+    EXPECT_EQ( 2, lowPriorityTicket.numTasksTotal() );
+    EXPECT_EQ( 2, ticket.numTasksTotal() );
+
+    std::vector<unsigned int> popped;
+    PageRequest               request;
+    for( int i = 0; i < 4; ++i )
+    {
+        ASSERT_TRUE( m_queue.popOrWait( &request ) );
+        EXPECT_EQ( request.pageId >= 10, request.isLowPriority );
+        popped.push_back( request.pageId );
+    }
+
+    EXPECT_EQ( ( std::vector<unsigned int>{ 1, 2, 10, 11 } ), popped );
+}
+
+TEST_F( TestRequestQueue, TryPopSkipsLowPriorityRequests )
+{
+    const std::vector<unsigned int> pages{ 1 };
+    const std::vector<unsigned int> lowPriorityPages{ 10 };
+    Ticket ticket            = TicketImpl::create( CUstream{} );
+    Ticket lowPriorityTicket = TicketImpl::create( CUstream{} );
+    m_queue.push( pages.data(), 1, ticket );
+    m_queue.pushLowPriority( lowPriorityPages.data(), 1, lowPriorityTicket );
+
+    PageRequest request;
+    ASSERT_TRUE( m_queue.tryPop( &request, CUstream{} ) );
+    EXPECT_EQ( 1U, request.pageId );
+    EXPECT_FALSE( m_queue.tryPop( &request, CUstream{} ) );
+
+    ASSERT_TRUE( m_queue.popOrWait( &request ) );
+    EXPECT_EQ( 10U, request.pageId );
+    EXPECT_TRUE( request.isLowPriority );
+}
+
+TEST_F( TestRequestQueue, LowPriorityRequestsDoNotDisplaceOthers )
+{
+    const std::vector<unsigned int> pages{ 1, 2, 3 };
+    const std::vector<unsigned int> lowPriorityPages{ 10, 11 };
+    Ticket ticket            = TicketImpl::create( CUstream{} );
+    Ticket lowPriorityTicket = TicketImpl::create( CUstream{} );
+    m_queue.push( pages.data(), 3, ticket );
+    m_queue.pushLowPriority( lowPriorityPages.data(), 2, lowPriorityTicket );
+
+    // Only one low priority request fits in the queue.
+    EXPECT_EQ( 3, ticket.numTasksTotal() );
+    EXPECT_EQ( 1, lowPriorityTicket.numTasksTotal() );
+
+    PageRequest request;
+    for( unsigned int pageId : { 1, 2, 3, 10 } )
+    {
+        ASSERT_TRUE( m_queue.popOrWait( &request ) );
+        EXPECT_EQ( pageId, request.pageId );
+    }
+}
@@ -0,0 +1,101 @@
+//
+// Copyright (c) 2024, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "Textures/SamplerUploadBatch.h"
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+using namespace demandLoading;
+
+class TestSamplerUploadBatch : public testing::Test
+{
+  protected:
+    // Stands in for device memory; the batch never dereferences the device addresses.
+    std::vector<TextureSampler> m_device = std::vector<TextureSampler>( 16 );
+
+    TextureSampler makeSampler( unsigned int startPage )
+    {
+        TextureSampler sampler{};
+        sampler.startPage = startPage;
+        return sampler;
+    }
+};
+
+TEST_F( TestSamplerUploadBatch, Empty )
+{
+    SamplerUploadBatch batch;
+    EXPECT_TRUE( batch.empty() );
+    EXPECT_TRUE( batch.pack( nullptr ).empty() );
+}
+
+TEST_F( TestSamplerUploadBatch, AdjacentSamplersShareRun )
+{
+    SamplerUploadBatch batch;
+    for( unsigned int i = 0; i < 4; ++i )
+        batch.add( i, makeSampler( 100 + i ), &m_device[i] );
+
+    std::vector<TextureSampler>          staging( batch.size() );
+    std::vector<SamplerUploadBatch::Run> runs = batch.pack( staging.data() );
+    ASSERT_EQ( 1U, runs.size() );
+    EXPECT_EQ( 0U, runs[0].first );
+    EXPECT_EQ( 4U, runs[0].count );
+    for( unsigned int i = 0; i < 4; ++i )
+    {
+        EXPECT_EQ( 100 + i, staging[i].startPage );
+        EXPECT_EQ( i, batch.getPageId( i ) );
+        EXPECT_EQ( &m_device[i], batch.getDeviceSampler( i ) );
+    }
+}
+
+TEST_F( TestSamplerUploadBatch, PackedInDeviceOrder )
+{
+    // Samplers added out of order, with a gap between slots 2 and 5.
+    SamplerUploadBatch batch;
+    batch.add( 5, makeSampler( 5 ), &m_device[5] );
+    batch.add( 1, makeSampler( 1 ), &m_device[1] );
+    batch.add( 6, makeSampler( 6 ), &m_device[6] );
+    batch.add( 2, makeSampler( 2 ), &m_device[2] );
+
+    std::vector<TextureSampler>          staging( batch.size() );
+    std::vector<SamplerUploadBatch::Run> runs = batch.pack( staging.data() );
+    ASSERT_EQ( 2U, runs.size() );
+    EXPECT_EQ( 0U, runs[0].first );
+    EXPECT_EQ( 2U, runs[0].count );
+    EXPECT_EQ( 2U, runs[1].first );
+    EXPECT_EQ( 2U, runs[1].count );
+
+    const unsigned int expected[] = { 1, 2, 5, 6 };
+    for( unsigned int i = 0; i < 4; ++i )
+    {
+        EXPECT_EQ( expected[i], staging[i].startPage );
+        EXPECT_EQ( expected[i], batch.getPageId( i ) );
+        EXPECT_EQ( &m_device[expected[i]], batch.getDeviceSampler( i ) );
+    }
+}
@@ -0,0 +1,187 @@
+//
+// Copyright (c) 2024, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "Textures/SparseArrayPool.h"
+#include "Textures/SparseTexture.h"
+
+#include <OptiXToolkit/ImageSource/ImageSource.h>
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+using namespace demandLoading;
+
+namespace {
+
+// Creates uninitialized sparse arrays (which own no CUDA resources) and records the calls that
+// would have been made to the CUDA driver.
+class MockSparseArrayDriver : public SparseArrayDriver
+{
+  public:
+    SparseArray* createArray( const imageSource::TextureInfo& /*info*/ ) override
+    {
+        SparseArray* array = new SparseArray;
+        m_created.push_back( array );
+        return array;
+    }
+
+    void unmapArray( SparseArray* array, CUstream /*stream*/ ) override { m_unmapped.push_back( array ); }
+
+    std::vector<SparseArray*> m_created;
+    std::vector<SparseArray*> m_unmapped;
+};
+
+imageSource::TextureInfo makeInfo( unsigned int width, unsigned int height, CUarray_format format = CU_AD_FORMAT_UNSIGNED_INT8 )
+{
+    imageSource::TextureInfo info{};
+    info.width        = width;
+    info.height       = height;
+    info.format       = format;
+    info.numChannels  = 4;
+    info.numMipLevels = imageSource::calculateNumMipLevels( width, height );
+    info.isValid      = true;
+    info.isTiled      = true;
+    return info;
+}
+
+}  // namespace
+
+class TestSparseArrayPool : public testing::Test
+{
+  protected:
+    MockSparseArrayDriver            m_driver;
+    std::shared_ptr<SparseArrayPool> m_pool{ std::make_shared<SparseArrayPool>( &m_driver, 4 ) };
+
+    // Unmap and recycle the released arrays, as the demand loader does once the work that might
+    // use them is done.  Returns the number of released arrays.
+    size_t recycleReleasedArrays()
+    {
+        const std::vector<SparseArrayPool::ReleasedArray> arrays = m_pool->takeReleasedArrays();
+        m_pool->unmapArrays( arrays, CUstream{} );
+        m_pool->recycleArrays( arrays );
+        return arrays.size();
+    }
+};
+
+TEST_F( TestSparseArrayPool, CreatesArray )
+{
+    std::shared_ptr<SparseArray> array = m_pool->acquire( makeInfo( 1024, 1024 ) );
+    ASSERT_EQ( 1U, m_driver.m_created.size() );
+    EXPECT_EQ( m_driver.m_created[0], array.get() );
+    EXPECT_EQ( 1U, m_pool->getNumArraysCreated() );
+    EXPECT_EQ( 0U, m_pool->getNumFreeArrays() );
+}
+
+TEST_F( TestSparseArrayPool, ReleasedArrayIsUnmappedAndReused )
+{
+    SparseArray* first = m_pool->acquire( makeInfo( 1024, 1024 ) ).get();
+
+    // A released array is neither unmapped nor reused until the loader recycles it.
+    EXPECT_TRUE( m_driver.m_unmapped.empty() );
+    EXPECT_EQ( 0U, m_pool->getNumFreeArrays() );
+    EXPECT_EQ( 1U, recycleReleasedArrays() );
+    ASSERT_EQ( 1U, m_driver.m_unmapped.size() );
+    EXPECT_EQ( first, m_driver.m_unmapped[0] );
+    EXPECT_EQ( 1U, m_pool->getNumFreeArrays() );
+
+    std::shared_ptr<SparseArray> second = m_pool->acquire( makeInfo( 1024, 1024 ) );
+    EXPECT_EQ( first, second.get() );
+    EXPECT_EQ( 1U, m_driver.m_created.size() );
+    EXPECT_EQ( 1U, m_pool->getNumArraysReused() );
+    EXPECT_EQ( 0U, m_pool->getNumFreeArrays() );
+}
+
+TEST_F( TestSparseArrayPool, KeyedByLayout )
+{
+    m_pool->acquire( makeInfo( 1024, 1024 ) );
+    recycleReleasedArrays();
+
+    // A different size, format, channel count or number of miplevels needs a new array.
+    imageSource::TextureInfo fewerChannels = makeInfo( 1024, 1024 );
+    fewerChannels.numChannels              = 2;
+    imageSource::TextureInfo fewerLevels   = makeInfo( 1024, 1024 );
+    fewerLevels.numMipLevels               = 1;
+    m_pool->acquire( makeInfo( 1024, 512 ) );
+    m_pool->acquire( makeInfo( 1024, 1024, CU_AD_FORMAT_FLOAT ) );
+    m_pool->acquire( fewerChannels );
+    m_pool->acquire( fewerLevels );
+    recycleReleasedArrays();
+    EXPECT_EQ( 5U, m_pool->getNumArraysCreated() );
+    EXPECT_EQ( 0U, m_pool->getNumArraysReused() );
+
+    // Fields that don't affect the array layout are ignored.
+    imageSource::TextureInfo untiled = makeInfo( 1024, 1024 );
+    untiled.isTiled                  = false;
+    m_pool->acquire( untiled );
+    EXPECT_EQ( 5U, m_pool->getNumArraysCreated() );
+    EXPECT_EQ( 1U, m_pool->getNumArraysReused() );
+}
+
+TEST_F( TestSparseArrayPool, SharedArrayReleasedByLastOwner )
+{
+    std::shared_ptr<SparseArray> master  = m_pool->acquire( makeInfo( 256, 256 ) );
+    std::shared_ptr<SparseArray> variant = master;
+    master.reset();
+    EXPECT_EQ( 0U, recycleReleasedArrays() );
+    variant.reset();
+    EXPECT_EQ( 1U, recycleReleasedArrays() );
+    EXPECT_EQ( 1U, m_pool->getNumFreeArrays() );
+}
+
+TEST_F( TestSparseArrayPool, LimitsFreeArrays )
+{
+    std::vector<std::shared_ptr<SparseArray>> arrays;
+    for( int i = 0; i < 6; ++i )
+        arrays.push_back( m_pool->acquire( makeInfo( 512, 512 ) ) );
+    arrays.clear();
+    EXPECT_EQ( 6U, recycleReleasedArrays() );
+
+    // Only four recycled arrays are kept.  The others are destroyed.
+    EXPECT_EQ( 4U, m_pool->getNumFreeArrays() );
+
+    for( int i = 0; i < 6; ++i )
+        arrays.push_back( m_pool->acquire( makeInfo( 512, 512 ) ) );
+    EXPECT_EQ( 4U, m_pool->getNumArraysReused() );
+    EXPECT_EQ( 8U, m_pool->getNumArraysCreated() );
+}
+
+TEST_F( TestSparseArrayPool, ArrayOutlivesPool )
+{
+    std::shared_ptr<SparseArray> array = m_pool->acquire( makeInfo( 256, 256 ) );
+    m_pool.reset();
+    array.reset();
+    EXPECT_TRUE( m_driver.m_unmapped.empty() );
+}
+
+TEST_F( TestSparseArrayPool, ReleasedArraysDestroyedWithPool )
+{
+    m_pool->acquire( makeInfo( 256, 256 ) );
+    m_pool.reset();
+    EXPECT_TRUE( m_driver.m_unmapped.empty() );
+}
@@ -0,0 +1,276 @@
+//
+// Copyright (c) 2024, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "Textures/SparseMappingBatch.h"
+#include "Util/MutexArray.h"
+
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+#include <vector>
+
+using namespace demandLoading;
+
+namespace {
+
+// Records the calls that would have been made to the CUDA driver.
+class MockSparseMappingDriver : public SparseMappingDriver
+{
+  public:
+    struct Call
+    {
+        bool         isMapping;
+        unsigned int count;
+        CUstream     stream;
+    };
+
+    void mapArrayAsync( CUarrayMapInfo* mapInfos, unsigned int count, CUstream stream ) override
+    {
+        if( m_fail )
+            throw std::runtime_error( "mapArrayAsync failed" );
+        m_calls.push_back( Call{ true, count, stream } );
+        m_mapInfos.insert( m_mapInfos.end(), mapInfos, mapInfos + count );
+    }
+
+    void copy2DAsync( const CUDA_MEMCPY2D& copyArgs, CUstream stream ) override
+    {
+        m_calls.push_back( Call{ false, 1, stream } );
+        m_copies.push_back( copyArgs );
+    }
+
+    bool                        m_fail = false;
+    std::vector<Call>           m_calls;
+    std::vector<CUarrayMapInfo> m_mapInfos;
+    std::vector<CUDA_MEMCPY2D>  m_copies;
+};
+
+CUarrayMapInfo makeMapInfo( unsigned int level )
+{
+    CUarrayMapInfo mapInfo{};
+    mapInfo.memOperationType              = CU_MEM_OPERATION_TYPE_MAP;
+    mapInfo.subresource.sparseLevel.level = level;
+    return mapInfo;
+}
+
+CUDA_MEMCPY2D makeCopy( size_t dstY )
+{
+    CUDA_MEMCPY2D copyArgs{};
+    copyArgs.dstY = dstY;
+    return copyArgs;
+}
+
+CUstream makeStream( size_t value )
+{
+    return reinterpret_cast<CUstream>( value );
+}
+
+}  // namespace
+
+class TestSparseMappingBatch : public testing::Test
+{
+  protected:
+    MockSparseMappingDriver m_driver;
+    SparseMappingBatch      m_batch{ &m_driver };
+};
+
+TEST_F( TestSparseMappingBatch, EmptyFlush )
+{
+    EXPECT_TRUE( m_batch.empty() );
+    m_batch.flush();
+    EXPECT_TRUE( m_driver.m_calls.empty() );
+}
+
+TEST_F( TestSparseMappingBatch, SingleMapCall )
+{
+    const CUstream stream = makeStream( 1 );
+    for( unsigned int i = 0; i < 8; ++i )
+        m_batch.addMapping( stream, makeMapInfo( i ) );
+    EXPECT_EQ( 8U, m_batch.getNumMappings() );
+    EXPECT_TRUE( m_driver.m_calls.empty() );
+
+    m_batch.flush();
+    ASSERT_EQ( 1U, m_driver.m_calls.size() );
+    EXPECT_TRUE( m_driver.m_calls[0].isMapping );
+    EXPECT_EQ( 8U, m_driver.m_calls[0].count );
+    EXPECT_EQ( stream, m_driver.m_calls[0].stream );
+    for( unsigned int i = 0; i < 8; ++i )
+        EXPECT_EQ( i, m_driver.m_mapInfos[i].subresource.sparseLevel.level );
+    EXPECT_TRUE( m_batch.empty() );
+}
+
+TEST_F( TestSparseMappingBatch, MappingsPrecedeCopies )
+{
+    const CUstream stream = makeStream( 1 );
+    for( unsigned int i = 0; i < 3; ++i )
+    {
+        m_batch.addMapping( stream, makeMapInfo( i ) );
+        m_batch.addCopy( stream, makeCopy( i ) );
+    }
+    m_batch.flush();
+
+    ASSERT_EQ( 4U, m_driver.m_calls.size() );
+    EXPECT_TRUE( m_driver.m_calls[0].isMapping );
+    EXPECT_EQ( 3U, m_driver.m_calls[0].count );
+    for( unsigned int i = 0; i < 3; ++i )
+    {
+        EXPECT_FALSE( m_driver.m_calls[i + 1].isMapping );
+        EXPECT_EQ( i, m_driver.m_copies[i].dstY );
+    }
+}
+
+TEST_F( TestSparseMappingBatch, CompletionsFollowCopies )
+{
+    const CUstream      stream = makeStream( 1 );
+    std::vector<size_t> numCallsAtCompletion;
+    m_batch.addMapping( stream, makeMapInfo( 0 ) );
+    m_batch.addCopy( stream, makeCopy( 0 ) );
+    m_batch.addCompletion( [this, &numCallsAtCompletion] { numCallsAtCompletion.push_back( m_driver.m_calls.size() ); } );
+    m_batch.addCompletion( [this, &numCallsAtCompletion] { numCallsAtCompletion.push_back( m_driver.m_calls.size() ); } );
+    EXPECT_TRUE( numCallsAtCompletion.empty() );
+
+    m_batch.flush();
+    EXPECT_EQ( std::vector<size_t>( { 2, 2 } ), numCallsAtCompletion );
+    EXPECT_TRUE( m_batch.empty() );
+}
+
+TEST_F( TestSparseMappingBatch, CompletionOnly )
+{
+    bool completed = false;
+    m_batch.addCompletion( [&completed] { completed = true; } );
+    EXPECT_FALSE( m_batch.empty() );
+
+    m_batch.flush();
+    EXPECT_TRUE( completed );
+    EXPECT_TRUE( m_driver.m_calls.empty() );
+}
+
+TEST_F( TestSparseMappingBatch, StreamChangeFlushes )
+{
+    const CUstream stream1 = makeStream( 1 );
+    const CUstream stream2 = makeStream( 2 );
+    m_batch.addMapping( stream1, makeMapInfo( 0 ) );
+    m_batch.addMapping( stream1, makeMapInfo( 1 ) );
+    m_batch.addMapping( stream2, makeMapInfo( 2 ) );
+    ASSERT_EQ( 1U, m_driver.m_calls.size() );
+    EXPECT_EQ( 2U, m_driver.m_calls[0].count );
+    EXPECT_EQ( stream1, m_driver.m_calls[0].stream );
+
+    m_batch.flush();
+    ASSERT_EQ( 2U, m_driver.m_calls.size() );
+    EXPECT_EQ( 1U, m_driver.m_calls[1].count );
+    EXPECT_EQ( stream2, m_driver.m_calls[1].stream );
+}
+
+TEST_F( TestSparseMappingBatch, LockUntilFlushed )
+{
+    MutexArray mutex( 2 );
+    bool       lockedAtCompletion = false;
+    m_batch.lockUntilFlushed( &mutex, 0 );
+    m_batch.addCompletion( [&mutex, &lockedAtCompletion] { lockedAtCompletion = !mutex.tryLock( 0 ); } );
+    EXPECT_FALSE( mutex.tryLock( 0 ) );
+
+    m_batch.flush();
+    EXPECT_TRUE( lockedAtCompletion );
+    EXPECT_TRUE( mutex.tryLock( 0 ) );
+    mutex.unlock( 0 );
+}
+
+TEST_F( TestSparseMappingBatch, RelockFlushes )
+{
+    MutexArray mutex( 1 );
+    bool       completed = false;
+    m_batch.lockUntilFlushed( &mutex, 0 );
+    m_batch.addCompletion( [&completed] { completed = true; } );
+
+    // Locking an item held by the batch flushes it, which releases the item.
+    m_batch.lockUntilFlushed( &mutex, 0 );
+    EXPECT_TRUE( completed );
+    EXPECT_FALSE( mutex.tryLock( 0 ) );
+
+    m_batch.flush();
+    EXPECT_TRUE( m_batch.empty() );
+    EXPECT_TRUE( mutex.tryLock( 0 ) );
+    mutex.unlock( 0 );
+}
+
+TEST_F( TestSparseMappingBatch, FailedFlushUnlocksAndCompletes )
+{
+    MutexArray mutex( 1 );
+    bool       completed = false;
+    m_batch.lockUntilFlushed( &mutex, 0 );
+    m_batch.addMapping( makeStream( 1 ), makeMapInfo( 0 ) );
+    m_batch.addCompletion( [&completed] { completed = true; } );
+    m_driver.m_fail = true;
+
+    EXPECT_THROW( m_batch.flush(), std::runtime_error );
+    EXPECT_TRUE( completed );
+    EXPECT_TRUE( m_batch.empty() );
+    EXPECT_TRUE( mutex.tryLock( 0 ) );
+    mutex.unlock( 0 );
+}
+
+TEST_F( TestSparseMappingBatch, DestructorFlushes )
+{
+    MutexArray mutex( 1 );
+    bool       completed = false;
+    {
+        SparseMappingBatch batch( &m_driver );
+        batch.lockUntilFlushed( &mutex, 0 );
+        batch.addMapping( makeStream( 1 ), makeMapInfo( 0 ) );
+        batch.addCompletion( [&completed] { completed = true; } );
+    }
+    EXPECT_TRUE( completed );
+    EXPECT_EQ( 1U, m_driver.m_calls.size() );
+    EXPECT_TRUE( mutex.tryLock( 0 ) );
+    mutex.unlock( 0 );
+}
+
+TEST_F( TestSparseMappingBatch, TransferBytesResetOnFlush )
+{
+    m_batch.addTransferBytes( 65536 );
+    m_batch.addTransferBytes( 1024 );
+    EXPECT_EQ( 66560U, m_batch.getNumTransferBytes() );
+
+    m_batch.flush();
+    EXPECT_EQ( 0U, m_batch.getNumTransferBytes() );
+}
+
+TEST_F( TestSparseMappingBatch, CurrentBatch )
+{
+    EXPECT_EQ( nullptr, SparseMappingBatch::getCurrent() );
+    {
+        SparseMappingBatch::Scope scope( &m_batch );
+        EXPECT_EQ( &m_batch, SparseMappingBatch::getCurrent() );
+        {
+            SparseMappingBatch::Scope unbatched( nullptr );
+            EXPECT_EQ( nullptr, SparseMappingBatch::getCurrent() );
+        }
+        EXPECT_EQ( &m_batch, SparseMappingBatch::getCurrent() );
+    }
+    EXPECT_EQ( nullptr, SparseMappingBatch::getCurrent() );
+}
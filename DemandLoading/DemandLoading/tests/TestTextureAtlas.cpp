@@ -0,0 +1,120 @@
+//
+// Copyright (c) 2024, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "Textures/TextureAtlas.h"
+#include <OptiXToolkit/Error/cudaErrorCheck.h>
+
+#include <gtest/gtest.h>
+
+#include <cuda.h>
+
+using namespace demandLoading;
+using namespace imageSource;
+
+class TestTextureAtlas : public testing::Test
+{
+  protected:
+    unsigned int      m_deviceIndex = 0;
+    TextureDescriptor m_desc;
+    TextureInfo       m_info;
+
+  public:
+    void SetUp() override
+    {
+        OTK_ERROR_CHECK( cudaSetDevice( m_deviceIndex ) );
+        OTK_ERROR_CHECK( cudaFree( nullptr ) );
+
+        m_desc.addressMode[0]   = CU_TR_ADDRESS_MODE_WRAP;
+        m_desc.addressMode[1]   = CU_TR_ADDRESS_MODE_WRAP;
+        m_desc.filterMode       = FILTER_POINT;
+        m_desc.mipmapFilterMode = CU_TR_FILTER_MODE_POINT;
+        m_desc.maxAnisotropy    = 16;
+
+        m_info.width        = 16;
+        m_info.height       = 16;
+        m_info.format       = CU_AD_FORMAT_FLOAT;
+        m_info.numChannels  = 4;
+        m_info.numMipLevels = 5;
+        m_info.isValid      = true;
+        m_info.isTiled      = false;
+    }
+};
+
+namespace {
+
+bool samePlace( const AtlasSlot& a, const AtlasSlot& b )
+{
+    return a.page == b.page && a.x == b.x && a.y == b.y;
+}
+
+}  // namespace
+
+TEST_F( TestTextureAtlas, TestReleasedSlotIsReusedOnceFreed )
+{
+    TextureAtlas atlas;
+    const AtlasSlot first  = atlas.allocate( m_desc, m_info );
+    const AtlasSlot second = atlas.allocate( m_desc, m_info );
+    ASSERT_TRUE( first.isValid() && second.isValid() );
+    EXPECT_FALSE( samePlace( first, second ) );
+
+    // A released slot is not reused until it is freed, since launches in flight may still sample it.
+    atlas.release( first );
+    const AtlasSlot third = atlas.allocate( m_desc, m_info );
+    EXPECT_FALSE( samePlace( first, third ) );
+    EXPECT_FALSE( samePlace( second, third ) );
+
+    const std::vector<AtlasSlot> released = atlas.takeReleasedSlots();
+    ASSERT_EQ( 1U, released.size() );
+    EXPECT_TRUE( samePlace( first, released[0] ) );
+    EXPECT_TRUE( atlas.takeReleasedSlots().empty() );
+    atlas.freeSlots( released );
+
+    const AtlasSlot fourth = atlas.allocate( m_desc, m_info );
+    EXPECT_TRUE( samePlace( first, fourth ) );
+}
+
+TEST_F( TestTextureAtlas, TestPageIsDestroyedWithLastSlot )
+{
+    TextureAtlas atlas;
+    const AtlasSlot slot = atlas.allocate( m_desc, m_info );
+    ASSERT_TRUE( slot.isValid() );
+    EXPECT_NE( 0ULL, atlas.getTextureObject( slot ) );
+    const size_t pageMemory = atlas.getDeviceMemoryUsed();
+    EXPECT_LT( 0U, pageMemory );
+
+    // The page is kept while its released slot has not been freed.
+    atlas.release( slot );
+    EXPECT_EQ( pageMemory, atlas.getDeviceMemoryUsed() );
+    atlas.freeSlots( atlas.takeReleasedSlots() );
+    EXPECT_EQ( 0U, atlas.getDeviceMemoryUsed() );
+
+    // A new page is made for the next slot.
+    const AtlasSlot newSlot = atlas.allocate( m_desc, m_info );
+    EXPECT_TRUE( newSlot.isValid() );
+    EXPECT_EQ( pageMemory, atlas.getDeviceMemoryUsed() );
+}
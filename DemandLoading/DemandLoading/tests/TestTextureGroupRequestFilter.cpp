@@ -0,0 +1,214 @@
+//
+// Copyright (c) 2024, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "TextureGroupRequestFilter.h"
+
+#include <OptiXToolkit/DemandLoading/TileIndexing.h>
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+using namespace demandLoading;
+
+namespace {
+
+// Make a sparse texture sampler with the given layout, as DemandTextureImpl::initSampler does.
+TextureSampler makeSampler( unsigned int startPage,
+                            unsigned int width,
+                            unsigned int height,
+                            unsigned int logTileSize,
+                            unsigned int numMipLevels,
+                            unsigned int mipTailFirstLevel )
+{
+    TextureSampler sampler{};
+    sampler.desc.numMipLevels    = numMipLevels;
+    sampler.desc.logTileWidth    = logTileSize;
+    sampler.desc.logTileHeight   = logTileSize;
+    sampler.desc.isSparseTexture = 1;
+    sampler.width                = width;
+    sampler.height               = height;
+    sampler.mipTailFirstLevel    = mipTailFirstLevel;
+    sampler.startPage            = startPage;
+
+    TextureSampler::MipLevelSizes* mls = sampler.mipLevelSizes;
+    for( int mipLevel = static_cast<int>( mipTailFirstLevel ); mipLevel >= 0; --mipLevel )
+    {
+        if( mipLevel < static_cast<int>( mipTailFirstLevel ) )
+            mls[mipLevel].mipLevelStart = mls[mipLevel + 1].mipLevelStart
+                                          + calculateNumTilesInLevel( mls[mipLevel + 1].levelWidthInTiles, mls[mipLevel + 1].levelHeightInTiles );
+        mls[mipLevel].levelWidthInTiles  = static_cast<unsigned short>( getLevelDimInTiles( width, mipLevel, 1U << logTileSize ) );
+        mls[mipLevel].levelHeightInTiles = static_cast<unsigned short>( getLevelDimInTiles( height, mipLevel, 1U << logTileSize ) );
+    }
+    sampler.numPages = mls[0].mipLevelStart + calculateNumTilesInLevel( mls[0].levelWidthInTiles, mls[0].levelHeightInTiles );
+    return sampler;
+}
+
+unsigned int getPageId( const TextureSampler& sampler, unsigned int mipLevel, unsigned int tileX, unsigned int tileY )
+{
+    const TextureSampler::MipLevelSizes& levelSizes = sampler.mipLevelSizes[mipLevel];
+    return sampler.startPage + levelSizes.mipLevelStart + getPageOffsetFromTileCoords( tileX, tileY, levelSizes.levelWidthInTiles );
+}
+
+}  // namespace
+
+class TestTextureGroupRequestFilter : public testing::Test
+{
+  public:
+    // 1024x1024 with 64x64 tiles.  Levels 5 and coarser are in the mip tail.
+    TextureSampler m_src = makeSampler( 1000, 1024, 1024, 6, 11, 5 );
+};
+
+TEST_F( TestTextureGroupRequestFilter, SameLayout )
+{
+    const TextureSampler dst = makeSampler( 5000, 1024, 1024, 6, 11, 5 );
+
+    std::vector<unsigned int> pages;
+    TextureGroupRequestFilter::appendMatchingPages( m_src, getPageId( m_src, 0, 3, 2 ), dst, pages );
+    TextureGroupRequestFilter::appendMatchingPages( m_src, getPageId( m_src, 2, 1, 3 ), dst, pages );
+
+    EXPECT_EQ( ( std::vector<unsigned int>{ getPageId( dst, 0, 3, 2 ), getPageId( dst, 2, 1, 3 ) } ), pages );
+}
+
+TEST_F( TestTextureGroupRequestFilter, MipTail )
+{
+    const TextureSampler dst = makeSampler( 5000, 512, 512, 6, 10, 4 );
+
+    std::vector<unsigned int> pages;
+    TextureGroupRequestFilter::appendMatchingPages( m_src, m_src.startPage, dst, pages );
+
+    EXPECT_EQ( std::vector<unsigned int>{ dst.startPage }, pages );
+}
+
+TEST_F( TestTextureGroupRequestFilter, LowerResolution )
+{
+    const TextureSampler dst = makeSampler( 5000, 512, 512, 6, 10, 4 );
+
+    // A tile of level 0 is covered by a quarter of a tile in level 0 of dst.
+    std::vector<unsigned int> pages;
+    TextureGroupRequestFilter::appendMatchingPages( m_src, getPageId( m_src, 0, 3, 2 ), dst, pages );
+    EXPECT_EQ( std::vector<unsigned int>{ getPageId( dst, 0, 1, 1 ) }, pages );
+
+    // Level 1 has the same resolution as level 0 of dst.
+    pages.clear();
+    TextureGroupRequestFilter::appendMatchingPages( m_src, getPageId( m_src, 1, 3, 2 ), dst, pages );
+    EXPECT_EQ( std::vector<unsigned int>{ getPageId( dst, 0, 3, 2 ) }, pages );
+}
+
+TEST_F( TestTextureGroupRequestFilter, SmallerTiles )
+{
+    // 32x32 tiles, as for a format with more bytes per texel.
+    const TextureSampler dst = makeSampler( 5000, 1024, 1024, 5, 11, 6 );
+
+    std::vector<unsigned int> pages;
+    TextureGroupRequestFilter::appendMatchingPages( m_src, getPageId( m_src, 0, 3, 2 ), dst, pages );
+
+    const std::vector<unsigned int> expected{ getPageId( dst, 0, 6, 4 ), getPageId( dst, 0, 7, 4 ),  //
+                                              getPageId( dst, 0, 6, 5 ), getPageId( dst, 0, 7, 5 ) };
+    EXPECT_EQ( expected, pages );
+}
+
+TEST_F( TestTextureGroupRequestFilter, TooManyTiles )
+{
+    // Without mip levels, the region of the mip tail covers the whole texture.
+    const TextureSampler dst = makeSampler( 5000, 4096, 4096, 6, 1, 1 );
+
+    std::vector<unsigned int> pages;
+    TextureGroupRequestFilter::appendMatchingPages( m_src, m_src.startPage, dst, pages );
+
+    EXPECT_TRUE( pages.empty() );
+}
+
+TEST( TestTextureGroups, AddAndRemove )
+{
+    TextureGroups groups;
+    EXPECT_TRUE( groups.empty() );
+    groups.add( { 3, 1, 2, 1 } );
+
+    std::vector<unsigned int> members;
+    groups.getMembers( 2, members );
+    EXPECT_EQ( ( std::vector<unsigned int>{ 1, 3 } ), members );
+
+    // A texture moves to a new group, and a lone texture has no group.
+    groups.add( { 3, 4 } );
+    EXPECT_TRUE( groups.remove( 1 ) );
+    EXPECT_FALSE( groups.contains( 2 ) );
+    EXPECT_FALSE( groups.remove( 2 ) );
+    EXPECT_TRUE( groups.contains( 4 ) );
+}
+
+TEST( TestTextureGroups, ReuseEmptyGroups )
+{
+    TextureGroups groups;
+    for( unsigned int i = 0; i < 10; ++i )
+    {
+        groups.add( { 2 * i, 2 * i + 1 } );
+        groups.remove( 2 * i );
+    }
+    EXPECT_TRUE( groups.empty() );
+    EXPECT_EQ( 1U, groups.getNumGroupIds() );
+
+    // A group that is never added is not kept.
+    groups.add( { 5 } );
+    EXPECT_TRUE( groups.empty() );
+}
+
+TEST( TestTextureGroups, SamplersAndVariants )
+{
+    TextureGroups        groups;
+    const TextureSampler sampler = makeSampler( 1000, 1024, 1024, 6, 11, 5 );
+
+    // Samplers of textures that are not grouped are ignored.
+    groups.setSampler( 1, &sampler );
+    EXPECT_EQ( nullptr, groups.getSampler( 1 ) );
+
+    groups.add( { 1, 2 } );
+    groups.setSampler( 1, &sampler );
+    ASSERT_NE( nullptr, groups.getSampler( 1 ) );
+    EXPECT_EQ( sampler.startPage, groups.getSampler( 1 )->startPage );
+
+    unsigned int textureId = 0;
+    EXPECT_TRUE( groups.findTileTexture( sampler.startPage + sampler.numPages - 1, textureId ) );
+    EXPECT_EQ( 1U, textureId );
+    EXPECT_FALSE( groups.findTileTexture( sampler.startPage - 1, textureId ) );
+    EXPECT_FALSE( groups.findTileTexture( sampler.startPage + sampler.numPages, textureId ) );
+
+    // A reset sampler is forgotten, as is the sampler of a texture that leaves its group.
+    groups.setSampler( 1, nullptr );
+    EXPECT_FALSE( groups.findTileTexture( sampler.startPage, textureId ) );
+    groups.setSampler( 1, &sampler );
+    groups.remove( 2 );
+    EXPECT_EQ( nullptr, groups.getSampler( 1 ) );
+    EXPECT_FALSE( groups.findTileTexture( sampler.startPage, textureId ) );
+
+    groups.setMaster( 7, 1 );
+    EXPECT_EQ( 1U, groups.getMaster( 7 ) );
+    EXPECT_EQ( 8U, groups.getMaster( 8 ) );
+    EXPECT_TRUE( groups.removeVariant( 7 ) );
+    EXPECT_EQ( 7U, groups.getMaster( 7 ) );
+}
@@ -0,0 +1,171 @@
+//
+// Copyright (c) 2024, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "Memory/TileDeduplicator.h"
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+using namespace demandLoading;
+
+class TestTileDeduplicator : public testing::Test
+{
+  public:
+    TestTileDeduplicator()
+        : m_tile( 64 * 1024, 7 )
+    {
+    }
+
+  protected:
+    TileDeduplicator  m_dedup;
+    std::vector<char> m_tile;
+};
+
+TEST_F( TestTileDeduplicator, TestHashDistinguishesContentsAndLayout )
+{
+    const uint64_t hash = TileDeduplicator::hashTile( m_tile.data(), m_tile.size(), 1 );
+    EXPECT_EQ( hash, TileDeduplicator::hashTile( m_tile.data(), m_tile.size(), 1 ) );
+    EXPECT_NE( hash, TileDeduplicator::hashTile( m_tile.data(), m_tile.size(), 2 ) );
+
+    std::vector<char> other( m_tile );
+    other[other.size() / 2] = 8;
+    EXPECT_NE( hash, TileDeduplicator::hashTile( other.data(), other.size(), 1 ) );
+}
+
+TEST_F( TestTileDeduplicator, TestHashRegionIgnoresUnfilledBytes )
+{
+    // A 50x40 region of 4-byte pixels in a tile with a 256-byte row pitch.
+    const size_t   rowPitch = 64 * 4;
+    const size_t   rowSize  = 50 * 4;
+    const uint64_t hash     = TileDeduplicator::hashRegion( m_tile.data(), rowSize, 40, rowPitch, 1 );
+
+    // Stale bytes past the end of each row, or below the last row, don't change the hash.
+    std::vector<char> stale( m_tile );
+    stale[10 * rowPitch + rowSize] = 8;
+    stale[40 * rowPitch]           = 8;
+    EXPECT_EQ( hash, TileDeduplicator::hashRegion( stale.data(), rowSize, 40, rowPitch, 1 ) );
+
+    stale[39 * rowPitch + rowSize - 1] = 8;
+    EXPECT_NE( hash, TileDeduplicator::hashRegion( stale.data(), rowSize, 40, rowPitch, 1 ) );
+
+    // A full region is hashed like a whole tile.
+    EXPECT_EQ( TileDeduplicator::hashTile( m_tile.data(), rowPitch * 64, 1 ),
+               TileDeduplicator::hashRegion( m_tile.data(), rowPitch, 64, rowPitch, 1 ) );
+}
+
+TEST_F( TestTileDeduplicator, TestConstantTile )
+{
+    // 4-byte pixels in a 64x64 tile with a 256-byte row pitch.
+    const unsigned int pixelSize = 4;
+    const size_t       rowPitch  = 64 * pixelSize;
+    EXPECT_TRUE( TileDeduplicator::isConstantTile( m_tile.data(), 64, 64, rowPitch, pixelSize ) );
+
+    // Pixels outside the filled region are ignored.
+    m_tile[40 * rowPitch + 50 * pixelSize] = 0;
+    EXPECT_FALSE( TileDeduplicator::isConstantTile( m_tile.data(), 64, 64, rowPitch, pixelSize ) );
+    EXPECT_TRUE( TileDeduplicator::isConstantTile( m_tile.data(), 50, 64, rowPitch, pixelSize ) );
+    EXPECT_TRUE( TileDeduplicator::isConstantTile( m_tile.data(), 64, 40, rowPitch, pixelSize ) );
+
+    // A difference in any byte of a pixel counts.
+    m_tile[1] = 0;
+    EXPECT_FALSE( TileDeduplicator::isConstantTile( m_tile.data(), 64, 40, rowPitch, pixelSize ) );
+}
+
+TEST_F( TestTileDeduplicator, TestAcquireSharesBlock )
+{
+    const uint64_t     hash = TileDeduplicator::hashTile( m_tile.data(), m_tile.size(), 0 );
+    unsigned long long block;
+    EXPECT_FALSE( m_dedup.acquire( hash, block ) );
+
+    m_dedup.insert( hash, 1234 );
+    EXPECT_FALSE( m_dedup.isShared( 1234 ) );
+    ASSERT_TRUE( m_dedup.acquire( hash, block ) );
+    EXPECT_EQ( 1234ULL, block );
+    EXPECT_TRUE( m_dedup.isShared( 1234 ) );
+    EXPECT_EQ( 1U, m_dedup.getNumDeduplicatedTiles() );
+}
+
+TEST_F( TestTileDeduplicator, TestReleaseFreesLastReference )
+{
+    unsigned long long block;
+    m_dedup.insert( 42, 1234 );
+    ASSERT_TRUE( m_dedup.acquire( 42, block ) );
+    ASSERT_TRUE( m_dedup.acquire( 42, block ) );
+
+    EXPECT_FALSE( m_dedup.release( 1234 ) );
+    EXPECT_FALSE( m_dedup.release( 1234 ) );
+    EXPECT_TRUE( m_dedup.release( 1234 ) );
+
+    // The block is forgotten once it is freed.
+    EXPECT_FALSE( m_dedup.acquire( 42, block ) );
+}
+
+TEST_F( TestTileDeduplicator, TestUnsharedBlocksAreFreed )
+{
+    EXPECT_TRUE( m_dedup.release( 5678 ) );
+}
+
+TEST_F( TestTileDeduplicator, TestDuplicateInsertIgnored )
+{
+    unsigned long long block;
+    m_dedup.insert( 42, 1234 );
+    m_dedup.insert( 42, 5678 );
+    ASSERT_TRUE( m_dedup.acquire( 42, block ) );
+    EXPECT_EQ( 1234ULL, block );
+    EXPECT_TRUE( m_dedup.release( 5678 ) );
+}
+
+TEST_F( TestTileDeduplicator, TestUnshareBlocks )
+{
+    unsigned long long block;
+    m_dedup.insert( 1, 100 );
+    m_dedup.insert( 2, 200 );
+    ASSERT_TRUE( m_dedup.acquire( 2, block ) );
+    m_dedup.unshareBlocks( []( unsigned long long b ) { return b >= 200; } );
+    EXPECT_TRUE( m_dedup.acquire( 1, block ) );
+    EXPECT_FALSE( m_dedup.acquire( 2, block ) );
+
+    // An unshared block keeps its references, and is freed when the last one is released.
+    EXPECT_TRUE( m_dedup.isShared( 200 ) );
+    EXPECT_FALSE( m_dedup.release( 200 ) );
+    EXPECT_TRUE( m_dedup.release( 200 ) );
+}
+
+TEST_F( TestTileDeduplicator, TestReleaseUnsharedBlockKeepsNewBlock )
+{
+    unsigned long long block;
+    m_dedup.insert( 1, 100 );
+    m_dedup.unshareBlocks( []( unsigned long long b ) { return b == 100; } );
+    m_dedup.insert( 1, 300 );
+
+    // Releasing the old block does not forget the new block with the same hash.
+    EXPECT_TRUE( m_dedup.release( 100 ) );
+    ASSERT_TRUE( m_dedup.acquire( 1, block ) );
+    EXPECT_EQ( 300ULL, block );
+}
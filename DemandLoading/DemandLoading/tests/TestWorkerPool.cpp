@@ -0,0 +1,142 @@
+//
+// Copyright (c) 2024, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "Util/WorkerPool.h"
+
+#include <gtest/gtest.h>
+
+#include <cuda.h>
+
+#include <atomic>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace demandLoading;
+
+class TestWorkerPool : public testing::Test
+{
+  public:
+    void SetUp() override
+    {
+        // Initialize CUDA and create context.
+        cuInit( 0 );
+        OTK_ERROR_CHECK( cuDeviceGet( &m_device, m_deviceIndex ) );
+        OTK_ERROR_CHECK( cuCtxCreate( &m_context, 0, m_device ) );
+    }
+
+    void TearDown() override { OTK_ERROR_CHECK( cuCtxDestroy( m_context ) ); }
+
+  protected:
+    unsigned int m_deviceIndex = 0;
+    CUdevice     m_device;
+    CUcontext    m_context;
+};
+
+TEST_F( TestWorkerPool, ProcessesEachIndexOnce )
+{
+    WorkerPool                    pool( 4 );
+    std::vector<std::atomic<int>> counts( 1000 );
+    std::atomic<int>              numWrongContexts( 0 );
+    for( std::atomic<int>& count : counts )
+        count = 0;
+
+    pool.parallelFor( m_context, counts.size(), [this, &counts, &numWrongContexts]( size_t index ) {
+        CUcontext current;
+        OTK_ERROR_CHECK( cuCtxGetCurrent( &current ) );
+        if( current != m_context )
+            ++numWrongContexts;
+        ++counts[index];
+    } );
+
+    for( const std::atomic<int>& count : counts )
+        EXPECT_EQ( 1, count.load() );
+    EXPECT_EQ( 0, numWrongContexts.load() );
+}
+
+TEST_F( TestWorkerPool, ReusesThreads )
+{
+    WorkerPool                pool( 4 );
+    std::mutex                mutex;
+    std::set<std::thread::id> threadIds;
+    for( int i = 0; i < 10; ++i )
+    {
+        pool.parallelFor( m_context, 100, [&mutex, &threadIds]( size_t ) {
+            std::unique_lock<std::mutex> lock( mutex );
+            threadIds.insert( std::this_thread::get_id() );
+        } );
+    }
+
+    // The pool's three threads and the calling thread.
+    EXPECT_LE( threadIds.size(), 4U );
+}
+
+TEST_F( TestWorkerPool, RestoresCallerContext )
+{
+    WorkerPool pool( 2 );
+    OTK_ERROR_CHECK( cuCtxSetCurrent( nullptr ) );
+    pool.parallelFor( m_context, 10, []( size_t ) {} );
+
+    CUcontext current;
+    OTK_ERROR_CHECK( cuCtxGetCurrent( &current ) );
+    EXPECT_EQ( nullptr, current );
+}
+
+TEST_F( TestWorkerPool, RethrowsException )
+{
+    WorkerPool       pool( 4 );
+    std::atomic<int> numProcessed( 0 );
+    EXPECT_THROW( pool.parallelFor( m_context, 100,
+                                    [&numProcessed]( size_t index ) {
+                                        ++numProcessed;
+                                        if( index == 50 )
+                                            throw std::runtime_error( "failed" );
+                                    } ),
+                  std::runtime_error );
+
+    // The other indices are still processed.
+    EXPECT_EQ( 100, numProcessed.load() );
+
+    // The pool is still usable.
+    numProcessed = 0;
+    pool.parallelFor( m_context, 100, [&numProcessed]( size_t ) { ++numProcessed; } );
+    EXPECT_EQ( 100, numProcessed.load() );
+}
+
+TEST_F( TestWorkerPool, NestedLoops )
+{
+    // The inner loops run on the pool's only worker or on the thread running the outer task.
+    WorkerPool       pool( 2 );
+    std::atomic<int> numProcessed( 0 );
+    pool.parallelFor( m_context, 4, [this, &pool, &numProcessed]( size_t ) {
+        pool.parallelFor( m_context, 4, [&numProcessed]( size_t ) { ++numProcessed; } );
+    } );
+    EXPECT_EQ( 16, numProcessed.load() );
+}
@@ -0,0 +1,59 @@
+//
+// Copyright (c) 2024, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#pragma once
+
+/// \file BaseColor.h
+/// Computing and caching the base color of images that do not store a 1x1 mip level.
+
+#include <vector_types.h>
+
+#include <string>
+
+namespace imageSource {
+
+class ImageSource;
+
+/// Compute the base color of an open image, the average of its texels, by reading and reducing its
+/// coarsest mip level.  For an image without mip levels that means reading the whole image, so this
+/// is best done in the background.  Tiled images are reduced a tile at a time, while untiled images
+/// are read a whole mip level at a time.  Integer channels are normalized, as when the texture is
+/// sampled, except for 32-bit channels.  Returns false for block compressed images and images that
+/// are filled on the device.  Throws an exception on error.
+bool computeBaseColor( ImageSource& image, float4& baseColor );
+
+/// Read the base color cached alongside the given image file by writeBaseColorFile.  Returns false
+/// if there is none, or if the image file has changed since it was cached.
+bool readBaseColorFile( const std::string& imageFilename, float4& baseColor );
+
+/// Cache the base color of the given image file in a file alongside it, named by appending
+/// ".basecolor", along with the size and modification time of the image file.  Errors are ignored,
+/// since the cache is only an optimization (the directory might be read only, for example).
+void writeBaseColorFile( const std::string& imageFilename, const float4& baseColor );
+
+}  // namespace imageSource
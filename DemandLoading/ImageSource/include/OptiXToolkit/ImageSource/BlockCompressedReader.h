@@ -0,0 +1,117 @@
+//
+// Copyright (c) 2024, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#pragma once
+
+#include <OptiXToolkit/ImageSource/FileUtil.h>
+#include <OptiXToolkit/ImageSource/ImageSource.h>
+#include <OptiXToolkit/ImageSource/TextureInfo.h>
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace imageSource {
+
+/// Reader for pre-compressed (BC1 through BC7) images in DDS or KTX2 files.  The image data is
+/// returned as rows of 4x4 blocks (see getImageSizeInBytes), and tiles are read from the file one
+/// row of blocks at a time, so only the requested part of a mip level is read.  Each row is read at
+/// its own offset, so tiles can be read by several threads at once.  DDS files may use
+/// either the legacy FourCC codes (DXT1, DXT3, DXT5, ATI1, ATI2, etc.) or the DX10 header.  KTX2
+/// files must not use supercompression.
+class BlockCompressedReader : public ImageSourceBase
+{
+  public:
+    /// The constructor copies the given filename.  The file is not opened until open() is called.
+    explicit BlockCompressedReader( const std::string& filename );
+
+    /// Destructor
+    ~BlockCompressedReader() override;
+
+    /// Open the image and read header info, including dimensions and format.  Throws an exception on error.
+    void open( TextureInfo* info ) override;
+
+    /// Close the image.
+    void close() override;
+
+    /// Check if image is currently open.
+    bool isOpen() const override { return m_file.isOpen(); }
+
+    /// Get the image info.  Valid only after calling open().
+    const TextureInfo& getInfo() const override { return m_info; }
+
+    /// Return the mode in which the image fills part of itself
+    CUmemorytype getFillType() const override { return CU_MEMORYTYPE_HOST; }
+
+    /// Read the specified tile as rows of blocks.  The tile dimensions must be multiples of four.
+    /// Blocks outside the bounds of the mip level are zero.  Throws an exception on error.
+    bool readTile( char* dest, unsigned int mipLevel, const Tile& tile, CUstream stream ) override;
+
+    /// Read the specified mipLevel as rows of blocks. Throws an exception on error.
+    bool readMipLevel( char* dest, unsigned int mipLevel, unsigned int expectedWidth, unsigned int expectedHeight,
+                       CUstream stream ) override;
+
+    /// Read the base color of the image, which is the color of the 1x1 mip level.  Returns false
+    /// for BC6H and BC7 images, whose blocks are not decoded, or if the image is not mipmapped.
+    bool readBaseColor( float4& dest ) override;
+
+    /// Returns the number of tiles that have been read.
+    unsigned long long getNumTilesRead() const override { return m_numTilesRead; }
+
+    /// Returns the number of bytes that have been read.
+    unsigned long long getNumBytesRead() const override { return m_numBytesRead; }
+
+    /// Returns the time in seconds spent reading image data.
+    double getTotalReadTime() const override { return m_totalReadTime; }
+
+  private:
+    std::string                     m_filename;
+    PositionalFile                  m_file;
+    TextureInfo                     m_info{};
+    std::vector<size_t>             m_levelOffsets;  // file offset of each mip level
+    float4                          m_baseColor{};
+    bool                            m_baseColorWasRead = false;
+    std::mutex                      m_initMutex;
+    std::mutex                      m_statsMutex;  // guards m_numTilesRead and m_totalReadTime
+    unsigned long long              m_numTilesRead = 0;
+    std::atomic<unsigned long long> m_numBytesRead{ 0 };
+    double                          m_totalReadTime = 0.0;
+
+    void readHeaderDDS();
+    void readHeaderKTX2();
+    void readBytes( char* dest, size_t offset, size_t size );
+    void readBlocks( char* dest, size_t rowPitch, unsigned int mipLevel, unsigned int blockX, unsigned int blockY,
+                     unsigned int numBlocksX, unsigned int numBlocksY );
+};
+
+/// Decode the first texel of a 4x4 block of the given format.  Returns false for BC6H and BC7
+/// formats, which are not supported.
+bool decodeFirstTexel( const char* block, CUarray_format format, float4& dest );
+
+}  // namespace imageSource
@@ -0,0 +1,74 @@
+//
+// Copyright (c) 2024, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#pragma once
+
+/// \file BlockEncoder.h
+/// Encoding of uncompressed pixel data into BC1, BC4, BC5 and BC7 blocks on the host.
+
+#include <cuda.h>
+
+#include <cstdint>
+
+namespace imageSource {
+
+/// Encoder presets.  Fast encoding fits the endpoints of each block to the bounding box of its
+/// colors.  High quality encoding also tries the principal axis of the colors and refines the
+/// endpoints by least squares, which is several times slower.
+enum EncodeQuality { ENCODE_FAST = 0, ENCODE_HIGH_QUALITY };
+
+/// Check whether encodeBlocks() can encode images with the given source format and channel count
+/// in the given block compressed format.  Unsigned 8-bit, half and float sources are supported.
+/// BC1 and BC7 require four channels, BC4 one channel, and BC5 two channels.
+bool canEncodeBlocks( CUarray_format srcFormat, unsigned int numChannels, CUarray_format dstFormat );
+
+/// Encode a width x height image in the given block compressed format (see canEncodeBlocks).  The
+/// destination holds rows of 4x4 blocks (see getImageSizeInBytes).  Partial blocks at the right and
+/// bottom edges are padded by replicating the last column and row.  Half and float values are
+/// clamped to [0,1].
+void encodeBlocks( const char*    src,
+                   CUarray_format srcFormat,
+                   unsigned int   numChannels,
+                   unsigned int   width,
+                   unsigned int   height,
+                   char*          dst,
+                   CUarray_format dstFormat,
+                   EncodeQuality  quality );
+
+/// Encode 16 RGBA pixels (four rows of four) as an opaque 8-byte BC1 block.  Alpha is ignored.
+void encodeBC1Block( const uint8_t* rgba, uint8_t* dst, EncodeQuality quality );
+
+/// Encode 16 single channel values as an 8-byte BC4 block.  A BC5 block is a BC4 block of red
+/// values followed by a BC4 block of green values.
+void encodeBC4Block( const uint8_t* values, uint8_t* dst, EncodeQuality quality );
+
+/// Encode 16 RGBA pixels as a 16-byte BC7 block, using mode 6 (one subset with 7-bit endpoints and
+/// 4-bit indices).
+void encodeBC7Block( const uint8_t* rgba, uint8_t* dst, EncodeQuality quality );
+
+}  // namespace imageSource
@@ -88,6 +88,13 @@ class CascadeImage : public ImageSourceBase
         return m_backingImage ? m_backingImage->readBaseColor( dest ) : false;
     }
 
+    /// Store a computed base color in the backing image.
+    void writeBaseColor( const float4& baseColor ) override
+    {
+        if( m_backingImage )
+            m_backingImage->writeBaseColor( baseColor );
+    }
+
     // Get the backing image
     std::shared_ptr<ImageSource> getBackingImage() { return m_backingImage; }
 
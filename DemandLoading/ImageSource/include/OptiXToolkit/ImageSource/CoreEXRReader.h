@@ -74,6 +74,10 @@ class CoreEXRReader : public ImageSourceBase
     /// Throws an exception on error.
     bool readTile( char* dest, unsigned int mipLevel, const Tile& tile, CUstream stream ) override;
 
+    /// Hash the compressed chunks of the EXR tiles that make up the specified tile, without decoding them.
+    /// Returns false for scanline images.
+    bool readTileHash( uint64_t& hash, unsigned int mipLevel, const Tile& tile ) override;
+
     /// Read the specified mipLevel. Throws an exception on error.
     bool readMipLevel( char* dest, unsigned int mipLevel, unsigned int expectedWidth, unsigned int expectedHeight,
                        CUstream stream ) override;
@@ -81,6 +85,9 @@ class CoreEXRReader : public ImageSourceBase
     /// Read the base color of the image (1x1 mip level) as an array of floats. Returns true on success.
     bool readBaseColor( float4& dest ) override;
 
+    /// Store a computed base color, and cache it in a file alongside the image (see writeBaseColorFile).
+    void writeBaseColor( const float4& baseColor ) override;
+
     /// Get tile width (used only for testing).
     unsigned int getTileWidth() const { return m_tileWidth; }
 
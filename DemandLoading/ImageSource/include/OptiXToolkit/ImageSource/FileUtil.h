@@ -0,0 +1,85 @@
+//
+// Copyright (c) 2024, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#pragma once
+
+/// \file FileUtil.h
+/// Helpers for files that are shared by several threads or processes, such as on-disk caches.
+
+#include <cstddef>
+#include <string>
+
+namespace imageSource {
+
+/// Write a file by writing a temporary file alongside it and renaming it, so that concurrent readers
+/// never see a partial file.  An existing file is replaced.  Returns false on error, in which case
+/// the temporary file is removed.
+bool writeFileAtomically( const std::string& path, const char* data, size_t size );
+
+/// A read-only file in which each read gives its own offset (like pread), so several threads can
+/// read the file at once without sharing a file position or taking a lock.
+class PositionalFile
+{
+  public:
+    /// The file is not opened until open() is called.
+    PositionalFile() = default;
+
+    /// The destructor closes the file.
+    ~PositionalFile() { close(); }
+
+    /// Open the specified file for reading, closing any file that is open.  Returns false on error.
+    bool open( const std::string& path );
+
+    /// Close the file, if it is open.
+    void close();
+
+    /// Check whether the file is open.
+    bool isOpen() const;
+
+    /// Get the size of the file in bytes.
+    size_t getSize() const;
+
+    /// Read up to size bytes at the given offset.  Returns the number of bytes read, which is less
+    /// than size at the end of the file or on error.
+    size_t read( char* dest, size_t offset, size_t size ) const;
+
+    /// Not copyable.
+    PositionalFile( const PositionalFile& ) = delete;
+
+    /// Not assignable.
+    PositionalFile& operator=( const PositionalFile& ) = delete;
+
+  private:
+#ifdef _WIN32
+    void* m_handle = nullptr;
+#else
+    int m_fd = -1;
+#endif
+};
+
+}  // namespace imageSource
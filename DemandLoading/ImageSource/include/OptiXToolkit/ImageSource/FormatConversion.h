@@ -0,0 +1,63 @@
+//
+// Copyright (c) 2024, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#pragma once
+
+/// \file FormatConversion.h
+/// Bulk conversion of pixel data between channel formats on the host.
+
+#include <cuda.h>
+
+#include <cstddef>
+#include <cstdint>
+
+namespace imageSource {
+
+/// Check whether convertFormat() supports converting channel values from srcFormat to dstFormat.
+/// Float values can be converted to half or unsigned 8-bit, and half values to unsigned 8-bit.
+/// Any format can be "converted" to itself.
+bool canConvertFormat( CUarray_format srcFormat, CUarray_format dstFormat );
+
+/// Convert numValues channel values from srcFormat to dstFormat (see canConvertFormat).  Unsigned
+/// 8-bit values are normalized: [0,1] maps to [0,255], and values outside that range are clamped.
+/// The source and destination buffers must not overlap.
+void convertFormat( const char* src, CUarray_format srcFormat, char* dst, CUarray_format dstFormat, size_t numValues );
+
+/// Convert floats to half precision (stored as 16-bit integers), rounding to nearest even.
+void convertFloatToHalf( const float* src, uint16_t* dst, size_t count );
+
+/// Convert half precision values (stored as 16-bit integers) to floats.
+void convertHalfToFloat( const uint16_t* src, float* dst, size_t count );
+
+/// Convert floats to normalized unsigned 8-bit values, clamping to [0,1].
+void convertFloatToUnorm8( const float* src, uint8_t* dst, size_t count );
+
+/// Convert half precision values to normalized unsigned 8-bit values, clamping to [0,1].
+void convertHalfToUnorm8( const uint16_t* src, uint8_t* dst, size_t count );
+
+}  // namespace imageSource
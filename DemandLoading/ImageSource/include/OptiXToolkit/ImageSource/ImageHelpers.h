@@ -84,6 +84,7 @@ INLINE unsigned int toUInt( half value )
     return static_cast<unsigned int>( value );
 }
 
+// Per-pixel conversions, usable on host and device.  See FormatConversion.h for bulk conversion on the host.
 // clang-format off
 INLINE void convertType( const float4& a, float4& b )           { b = a; }
 INLINE void convertType( const float4& a, float2& b )           { b = float2{ a.x, a.y }; }
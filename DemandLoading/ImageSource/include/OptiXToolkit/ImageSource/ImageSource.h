@@ -35,6 +35,7 @@
 #include <vector_types.h>
 
 #include <cmath>
+#include <cstdint>
 #include <memory>
 #include <string>
 
@@ -90,17 +91,25 @@ class ImageSource
     /// Read the specified tile or mip level, returning the data in dest.
     /// dest must be large enough to hold the tile.  Pixels outside
     /// the bounds of the mip level will be filled in with black.
+    /// Block compressed data is returned as rows of 4x4 blocks.
     /// Throws an exception on error.
     /// Returns true if the request was satisfied and data was copied into dest.
     virtual bool readTile( char* dest, unsigned int mipLevel, const Tile& tile, CUstream stream ) = 0;
 
+    /// Get a hash of the stored data of the specified tile, computed without decoding it, for formats
+    /// that store tiles in separately addressable chunks.  The hash changes whenever the tile data does.
+    /// Returns false if the format does not support it, in which case the caller can hash the data
+    /// returned by readTile, which is the default.  Throws an exception on error.
+    virtual bool readTileHash( uint64_t& /*hash*/, unsigned int /*mipLevel*/, const Tile& /*tile*/ ) { return false; }
+
     /// Read the specified mipLevel. Throws an exception on error.
     /// Returns true if the request was satisfied and data was copied into dest.
     virtual bool readMipLevel( char* dest, unsigned int mipLevel, unsigned int expectedWidth, unsigned int expectedHeight, CUstream stream ) = 0;
 
     /// Read the mip tail into the given buffer, starting with the specified level.  An array
     /// containing the expected dimensions of all the miplevels is provided (starting from miplevel
-    /// zero), along with the pixel size.
+    /// zero), along with the pixel size.  Block compressed levels are stored as rows of 4x4 blocks
+    /// (see getImageSizeInBytes), and the pixel size is ignored.
     /// Throws an exception on error.
     /// Returns true if the request was satisfied and data was copied into dest.
     virtual bool readMipTail( char*        dest,
@@ -113,10 +122,15 @@ class ImageSource
     /// Read the base color of the image (1x1 mip level) as a float4. Returns true on success.
     virtual bool readBaseColor( float4& dest ) = 0;
 
-    /// Get tile width (used only for testing).
+    /// Store a base color computed by the caller (see computeBaseColor), for an image that does not
+    /// have a 1x1 mip level.  Subsequent calls to readBaseColor return it, and readers of image files
+    /// may cache it alongside the file for later runs.
+    virtual void writeBaseColor( const float4& baseColor ) = 0;
+
+    /// Get tile width, or zero if the image is not tiled (used for testing and by computeBaseColor).
     virtual unsigned int getTileWidth() const = 0;
 
-    /// Get tile height (used only for testing).
+    /// Get tile height, or zero if the image is not tiled (used for testing and by computeBaseColor).
     virtual unsigned int getTileHeight() const = 0;
 
     /// Returns the number of tiles that have been read.
@@ -146,6 +160,8 @@ class ImageSourceBase : public ImageSource
                       unsigned int pixelSizeInBytes,
                       CUstream     stream ) override;
 
+    void writeBaseColor( const float4& /*baseColor*/ ) override {}
+
     unsigned int getTileWidth() const override { return 0u; }
 
     unsigned int getTileHeight() const override { return 0u; }
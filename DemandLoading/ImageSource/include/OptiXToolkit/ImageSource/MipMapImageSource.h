@@ -50,6 +50,8 @@ class MipMapImageSource : public WrappedImageSource
 
     bool readTile( char* dest, unsigned int mipLevel, const Tile& tile, CUstream stream ) override;
 
+    bool readTileHash( uint64_t& hash, unsigned int mipLevel, const Tile& tile ) override;
+
     bool readMipLevel( char* dest, unsigned int mipLevel, unsigned int expectedWidth, unsigned int expectedHeight, CUstream stream ) override;
 
     bool readMipTail( char*        dest,
@@ -85,6 +85,9 @@ class OIIOReader : public ImageSourceBase
     /// Read the base color of the image (1x1 mip level) as a float4. Returns true on success.
     bool readBaseColor( float4& dest ) override;
 
+    /// Store a computed base color, and cache it in a file alongside the image (see writeBaseColorFile).
+    void writeBaseColor( const float4& baseColor ) override;
+
     /// Get tile width (used only for testing).
     unsigned int getTileWidth() const override { return m_tileWidth; }
 
@@ -46,6 +46,22 @@ struct TextureInfo
 /// Get the channel size in bytes.
 unsigned int getBytesPerChannel( CUarray_format format );
 
+/// Check whether the format is block compressed (BC1 through BC7).  Block compressed data is
+/// stored as rows of 4x4 pixel blocks.
+bool isBlockCompressed( CUarray_format format );
+
+/// Get the size in bytes of a 4x4 pixel block of a block compressed format.
+unsigned int getBytesPerBlock( CUarray_format format );
+
+/// Get the size in bytes of a row of pixels, which is a row of blocks for block compressed formats.
+size_t getRowSizeInBytes( CUarray_format format, unsigned int numChannels, unsigned int width );
+
+/// Get the number of rows in the given height, which is the number of block rows for block compressed formats.
+unsigned int getNumRows( CUarray_format format, unsigned int height );
+
+/// Get the size in bytes of width x height pixels.
+size_t getImageSizeInBytes( CUarray_format format, unsigned int numChannels, unsigned int width, unsigned int height );
+
 /// Get total texture size
 size_t getTextureSizeInBytes( const TextureInfo& info );
 
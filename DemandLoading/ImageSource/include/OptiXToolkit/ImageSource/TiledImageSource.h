@@ -54,6 +54,8 @@ class TiledImageSource : public WrappedImageSource
 
     bool readTile( char* dest, unsigned int mipLevel, const Tile& tile, CUstream stream ) override;
 
+    bool readTileHash( uint64_t& hash, unsigned int mipLevel, const Tile& tile ) override;
+
     bool readMipTail( char*        dest,
                       unsigned int mipTailFirstLevel,
                       unsigned int numMipLevels,
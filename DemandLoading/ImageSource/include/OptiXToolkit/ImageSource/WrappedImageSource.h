@@ -71,6 +71,12 @@ class WrappedImageSource : public ImageSource
         return m_imageSource->readTile( dest, mipLevel, tile, stream);
     }
 
+    /// Delegates to the wrapped ImageSource.
+    bool readTileHash( uint64_t& hash, unsigned int mipLevel, const Tile& tile ) override
+    {
+        return m_imageSource->readTileHash( hash, mipLevel, tile );
+    }
+
     /// Delegates to the wrapped ImageSource.
     bool readMipLevel( char* dest, unsigned int mipLevel, unsigned int expectedWidth, unsigned int expectedHeight, CUstream stream ) override
     {
@@ -91,6 +97,8 @@ class WrappedImageSource : public ImageSource
     /// Delegates to the wrapped ImageSource.
     bool readBaseColor( float4& dest ) override { return m_imageSource->readBaseColor( dest ); }
 
+    void writeBaseColor( const float4& baseColor ) override { m_imageSource->writeBaseColor( baseColor ); }
+
     /// Delegates to the wrapped ImageSource.
     unsigned int getTileWidth() const override { return m_imageSource->getTileWidth(); }
 
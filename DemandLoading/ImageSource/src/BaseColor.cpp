@@ -0,0 +1,211 @@
+//
+// Copyright (c) 2024, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <OptiXToolkit/ImageSource/BaseColor.h>
+
+#include <OptiXToolkit/ImageSource/FileUtil.h>
+#include <OptiXToolkit/ImageSource/FormatConversion.h>
+#include <OptiXToolkit/ImageSource/ImageSource.h>
+#include <OptiXToolkit/ImageSource/TextureInfo.h>
+
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+namespace imageSource {
+
+namespace {
+
+const char BASE_COLOR_FILE_MAGIC[8] = { 'O', 'T', 'K', 'B', 'C', 'L', 'R', '2' };
+
+// Contents of a base color file.  The size and modification time (in nanoseconds) identify the
+// version of the image.
+struct BaseColorFile
+{
+    char     magic[8];
+    uint64_t imageSize;
+    int64_t  imageTime;
+    float    baseColor[4];
+};
+
+std::string getBaseColorPath( const std::string& imageFilename )
+{
+    return imageFilename + ".basecolor";
+}
+
+bool getFileVersion( const std::string& filename, uint64_t& size, int64_t& time )
+{
+    struct stat status;
+    if( stat( filename.c_str(), &status ) != 0 )
+        return false;
+    // The modification time has nanosecond resolution where available, so that an image rewritten
+    // within a second of caching its base color (with the same size) is detected.
+#if defined( __APPLE__ )
+    const int64_t nanoseconds = status.st_mtimespec.tv_nsec;
+#elif defined( _WIN32 )
+    const int64_t nanoseconds = 0;
+#else
+    const int64_t nanoseconds = status.st_mtim.tv_nsec;
+#endif
+    size = static_cast<uint64_t>( status.st_size );
+    time = static_cast<int64_t>( status.st_mtime ) * 1000000000 + nanoseconds;
+    return true;
+}
+
+// Convert a channel value to float, normalizing 8 and 16-bit integers.
+float channelToFloat( const char* src, CUarray_format format )
+{
+    switch( format )
+    {
+        case CU_AD_FORMAT_UNSIGNED_INT8:
+            return *reinterpret_cast<const uint8_t*>( src ) / 255.0f;
+        case CU_AD_FORMAT_SIGNED_INT8:
+            return std::max( *reinterpret_cast<const int8_t*>( src ) / 127.0f, -1.0f );
+        case CU_AD_FORMAT_UNSIGNED_INT16:
+            return *reinterpret_cast<const uint16_t*>( src ) / 65535.0f;
+        case CU_AD_FORMAT_SIGNED_INT16:
+            return std::max( *reinterpret_cast<const int16_t*>( src ) / 32767.0f, -1.0f );
+        case CU_AD_FORMAT_UNSIGNED_INT32:
+            return static_cast<float>( *reinterpret_cast<const uint32_t*>( src ) );
+        case CU_AD_FORMAT_SIGNED_INT32:
+            return static_cast<float>( *reinterpret_cast<const int32_t*>( src ) );
+        default:
+            return *reinterpret_cast<const float*>( src );
+    }
+}
+
+// Add the channels of a width x height region of texels, with the given row pitch, to the per channel
+// sums.  Sums are accumulated in double precision, so that large images are averaged accurately.
+void sumTexels( const char* texels, unsigned int width, unsigned int height, size_t rowPitch, const TextureInfo& info, double sums[4] )
+{
+    // Half values are converted to float a row at a time.
+    const size_t       rowValues       = static_cast<size_t>( width ) * info.numChannels;
+    const unsigned int bytesPerChannel = getBytesPerChannel( info.format );
+    std::vector<float> floatRow( info.format == CU_AD_FORMAT_HALF ? rowValues : 0 );
+    for( unsigned int y = 0; y < height; ++y )
+    {
+        const char*    row    = texels + y * rowPitch;
+        CUarray_format format = info.format;
+        if( format == CU_AD_FORMAT_HALF )
+        {
+            convertHalfToFloat( reinterpret_cast<const uint16_t*>( row ), floatRow.data(), rowValues );
+            row    = reinterpret_cast<const char*>( floatRow.data() );
+            format = CU_AD_FORMAT_FLOAT;
+        }
+        const unsigned int stride = format == CU_AD_FORMAT_FLOAT ? sizeof( float ) : bytesPerChannel;
+        for( size_t i = 0; i < rowValues; ++i )
+            sums[i % info.numChannels] += channelToFloat( row + i * stride, format );
+    }
+}
+
+}  // namespace
+
+bool computeBaseColor( ImageSource& image, float4& baseColor )
+{
+    const TextureInfo& info = image.getInfo();
+    if( !info.isValid || isBlockCompressed( info.format ) || image.getFillType() != CU_MEMORYTYPE_HOST )
+        return false;
+
+    const unsigned int mipLevel      = info.numMipLevels - 1;
+    const unsigned int width         = std::max( info.width >> mipLevel, 1U );
+    const unsigned int height        = std::max( info.height >> mipLevel, 1U );
+    const size_t       bytesPerPixel = static_cast<size_t>( getBytesPerChannel( info.format ) ) * info.numChannels;
+    double             sums[4]       = {};
+
+    // A tiled image is read and reduced a tile at a time, which bounds the memory used for large images.
+    // Other images can only be read a whole mip level at a time.
+    const unsigned int tileWidth  = image.getTileWidth();
+    const unsigned int tileHeight = image.getTileHeight();
+    if( info.isTiled && tileWidth > 0 && tileHeight > 0 && ( tileWidth < width || tileHeight < height ) )
+    {
+        std::vector<char> texels( tileWidth * tileHeight * bytesPerPixel );
+        for( unsigned int tileY = 0; tileY * tileHeight < height; ++tileY )
+        {
+            for( unsigned int tileX = 0; tileX * tileWidth < width; ++tileX )
+            {
+                if( !image.readTile( texels.data(), mipLevel, Tile{ tileX, tileY, tileWidth, tileHeight }, CUstream{} ) )
+                    return false;
+                // Only the part of an edge tile within the mip level is summed.
+                const unsigned int regionWidth  = std::min( tileWidth, width - tileX * tileWidth );
+                const unsigned int regionHeight = std::min( tileHeight, height - tileY * tileHeight );
+                sumTexels( texels.data(), regionWidth, regionHeight, tileWidth * bytesPerPixel, info, sums );
+            }
+        }
+    }
+    else
+    {
+        std::vector<char> texels( getImageSizeInBytes( info.format, info.numChannels, width, height ) );
+        if( !image.readMipLevel( texels.data(), mipLevel, width, height, CUstream{} ) )
+            return false;
+        sumTexels( texels.data(), width, height, width * bytesPerPixel, info, sums );
+    }
+
+    const double numTexels = static_cast<double>( width ) * height;
+    baseColor              = float4{ static_cast<float>( sums[0] / numTexels ), static_cast<float>( sums[1] / numTexels ),
+                        static_cast<float>( sums[2] / numTexels ), static_cast<float>( sums[3] / numTexels ) };
+    return true;
+}
+
+bool readBaseColorFile( const std::string& imageFilename, float4& baseColor )
+{
+    uint64_t imageSize;
+    int64_t  imageTime;
+    if( !getFileVersion( imageFilename, imageSize, imageTime ) )
+        return false;
+
+    BaseColorFile contents;
+    std::ifstream file( getBaseColorPath( imageFilename ), std::ios::binary );
+    if( !file || !file.read( reinterpret_cast<char*>( &contents ), sizeof( contents ) ) )
+        return false;
+    if( memcmp( contents.magic, BASE_COLOR_FILE_MAGIC, sizeof( BASE_COLOR_FILE_MAGIC ) ) != 0
+        || contents.imageSize != imageSize || contents.imageTime != imageTime )
+        return false;
+
+    baseColor = float4{ contents.baseColor[0], contents.baseColor[1], contents.baseColor[2], contents.baseColor[3] };
+    return true;
+}
+
+void writeBaseColorFile( const std::string& imageFilename, const float4& baseColor )
+{
+    BaseColorFile contents{};
+    memcpy( contents.magic, BASE_COLOR_FILE_MAGIC, sizeof( BASE_COLOR_FILE_MAGIC ) );
+    if( !getFileVersion( imageFilename, contents.imageSize, contents.imageTime ) )
+        return;
+    contents.baseColor[0] = baseColor.x;
+    contents.baseColor[1] = baseColor.y;
+    contents.baseColor[2] = baseColor.z;
+    contents.baseColor[3] = baseColor.w;
+
+    writeFileAtomically( getBaseColorPath( imageFilename ), reinterpret_cast<const char*>( &contents ), sizeof( contents ) );
+}
+
+}  // namespace imageSource
@@ -0,0 +1,463 @@
+//
+// Copyright (c) 2024, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <OptiXToolkit/ImageSource/BlockCompressedReader.h>
+
+#include "Stopwatch.h"
+
+#include <OptiXToolkit/Error/cuErrorCheck.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+namespace imageSource {
+
+namespace {
+
+// DDS header constants (see the DirectX documentation of DDS_HEADER and DDS_HEADER_DXT10).
+const uint32_t DDS_MAGIC             = 0x20534444;  // "DDS "
+const size_t   DDS_HEADER_SIZE       = 124;
+const size_t   DDS_DX10_HEADER_SIZE  = 20;
+const uint32_t DDS_FLAGS_MIPMAPCOUNT = 0x20000;
+const uint32_t DDS_PIXELFORMAT_FOURCC = 0x4;
+
+// KTX2 file identifier and header size, not including the level index.
+const unsigned char KTX2_IDENTIFIER[12] = {0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A};
+const size_t        KTX2_HEADER_SIZE    = 80;
+
+uint32_t makeFourCC( const char* code )
+{
+    return static_cast<uint32_t>( code[0] ) | ( static_cast<uint32_t>( code[1] ) << 8 )
+           | ( static_cast<uint32_t>( code[2] ) << 16 ) | ( static_cast<uint32_t>( code[3] ) << 24 );
+}
+
+template <typename T>
+T readValue( const char* data, size_t offset )
+{
+    T value;
+    std::memcpy( &value, data + offset, sizeof( T ) );
+    return value;
+}
+
+bool fourCCToArrayFormat( uint32_t fourCC, CUarray_format& format )
+{
+    if( fourCC == makeFourCC( "DXT1" ) )
+        format = CU_AD_FORMAT_BC1_UNORM;
+    else if( fourCC == makeFourCC( "DXT2" ) || fourCC == makeFourCC( "DXT3" ) )
+        format = CU_AD_FORMAT_BC2_UNORM;
+    else if( fourCC == makeFourCC( "DXT4" ) || fourCC == makeFourCC( "DXT5" ) )
+        format = CU_AD_FORMAT_BC3_UNORM;
+    else if( fourCC == makeFourCC( "ATI1" ) || fourCC == makeFourCC( "BC4U" ) )
+        format = CU_AD_FORMAT_BC4_UNORM;
+    else if( fourCC == makeFourCC( "BC4S" ) )
+        format = CU_AD_FORMAT_BC4_SNORM;
+    else if( fourCC == makeFourCC( "ATI2" ) || fourCC == makeFourCC( "BC5U" ) )
+        format = CU_AD_FORMAT_BC5_UNORM;
+    else if( fourCC == makeFourCC( "BC5S" ) )
+        format = CU_AD_FORMAT_BC5_SNORM;
+    else
+        return false;
+    return true;
+}
+
+// Map a DXGI_FORMAT value from a DDS DX10 header.  Typeless formats are read as UNORM.
+bool dxgiToArrayFormat( uint32_t dxgiFormat, CUarray_format& format )
+{
+    switch( dxgiFormat )
+    {
+        case 70: case 71: format = CU_AD_FORMAT_BC1_UNORM; return true;
+        case 72: format = CU_AD_FORMAT_BC1_UNORM_SRGB; return true;
+        case 73: case 74: format = CU_AD_FORMAT_BC2_UNORM; return true;
+        case 75: format = CU_AD_FORMAT_BC2_UNORM_SRGB; return true;
+        case 76: case 77: format = CU_AD_FORMAT_BC3_UNORM; return true;
+        case 78: format = CU_AD_FORMAT_BC3_UNORM_SRGB; return true;
+        case 79: case 80: format = CU_AD_FORMAT_BC4_UNORM; return true;
+        case 81: format = CU_AD_FORMAT_BC4_SNORM; return true;
+        case 82: case 83: format = CU_AD_FORMAT_BC5_UNORM; return true;
+        case 84: format = CU_AD_FORMAT_BC5_SNORM; return true;
+        case 94: case 95: format = CU_AD_FORMAT_BC6H_UF16; return true;
+        case 96: format = CU_AD_FORMAT_BC6H_SF16; return true;
+        case 97: case 98: format = CU_AD_FORMAT_BC7_UNORM; return true;
+        case 99: format = CU_AD_FORMAT_BC7_UNORM_SRGB; return true;
+        default: return false;
+    }
+}
+
+// Map a VkFormat value from a KTX2 header.
+bool vkToArrayFormat( uint32_t vkFormat, CUarray_format& format )
+{
+    switch( vkFormat )
+    {
+        case 131: case 133: format = CU_AD_FORMAT_BC1_UNORM; return true;
+        case 132: case 134: format = CU_AD_FORMAT_BC1_UNORM_SRGB; return true;
+        case 135: format = CU_AD_FORMAT_BC2_UNORM; return true;
+        case 136: format = CU_AD_FORMAT_BC2_UNORM_SRGB; return true;
+        case 137: format = CU_AD_FORMAT_BC3_UNORM; return true;
+        case 138: format = CU_AD_FORMAT_BC3_UNORM_SRGB; return true;
+        case 139: format = CU_AD_FORMAT_BC4_UNORM; return true;
+        case 140: format = CU_AD_FORMAT_BC4_SNORM; return true;
+        case 141: format = CU_AD_FORMAT_BC5_UNORM; return true;
+        case 142: format = CU_AD_FORMAT_BC5_SNORM; return true;
+        case 143: format = CU_AD_FORMAT_BC6H_UF16; return true;
+        case 144: format = CU_AD_FORMAT_BC6H_SF16; return true;
+        case 145: format = CU_AD_FORMAT_BC7_UNORM; return true;
+        case 146: format = CU_AD_FORMAT_BC7_UNORM_SRGB; return true;
+        default: return false;
+    }
+}
+
+// CUDA requires these channel counts for block compressed arrays.
+unsigned int getNumChannels( CUarray_format format )
+{
+    switch( format )
+    {
+        case CU_AD_FORMAT_BC4_UNORM:
+        case CU_AD_FORMAT_BC4_SNORM:
+            return 1;
+        case CU_AD_FORMAT_BC5_UNORM:
+        case CU_AD_FORMAT_BC5_SNORM:
+            return 2;
+        case CU_AD_FORMAT_BC6H_UF16:
+        case CU_AD_FORMAT_BC6H_SF16:
+            return 3;
+        default:
+            return 4;
+    }
+}
+
+// Decode the first texel of a BC1 color block.  BC2 and BC3 color blocks always use four colors.
+float4 decodeColorTexel( const unsigned char* block, bool allowPunchThrough )
+{
+    const uint16_t c0    = readValue<uint16_t>( reinterpret_cast<const char*>( block ), 0 );
+    const uint16_t c1    = readValue<uint16_t>( reinterpret_cast<const char*>( block ), 2 );
+    const unsigned index = block[4] & 0x3;
+
+    const float r0 = ( c0 >> 11 ) / 31.f, g0 = ( ( c0 >> 5 ) & 0x3F ) / 63.f, b0 = ( c0 & 0x1F ) / 31.f;
+    const float r1 = ( c1 >> 11 ) / 31.f, g1 = ( ( c1 >> 5 ) & 0x3F ) / 63.f, b1 = ( c1 & 0x1F ) / 31.f;
+
+    const bool fourColors = !allowPunchThrough || c0 > c1;
+    switch( index )
+    {
+        case 0:
+            return float4{r0, g0, b0, 1.f};
+        case 1:
+            return float4{r1, g1, b1, 1.f};
+        case 2:
+            if( fourColors )
+                return float4{( 2.f * r0 + r1 ) / 3.f, ( 2.f * g0 + g1 ) / 3.f, ( 2.f * b0 + b1 ) / 3.f, 1.f};
+            return float4{( r0 + r1 ) / 2.f, ( g0 + g1 ) / 2.f, ( b0 + b1 ) / 2.f, 1.f};
+        default:
+            if( fourColors )
+                return float4{( r0 + 2.f * r1 ) / 3.f, ( g0 + 2.f * g1 ) / 3.f, ( b0 + 2.f * b1 ) / 3.f, 1.f};
+            return float4{0.f, 0.f, 0.f, 0.f};
+    }
+}
+
+// Decode the first texel of a BC4 block, which is also the alpha block of BC3 and each channel of BC5.
+float decodeAlphaTexel( const unsigned char* block, bool isSigned )
+{
+    const float a0 = isSigned ? std::max( static_cast<signed char>( block[0] ) / 127.f, -1.f ) : block[0] / 255.f;
+    const float a1 = isSigned ? std::max( static_cast<signed char>( block[1] ) / 127.f, -1.f ) : block[1] / 255.f;
+    const bool  eightValues = isSigned ? static_cast<signed char>( block[0] ) > static_cast<signed char>( block[1] ) : block[0] > block[1];
+    const unsigned index = block[2] & 0x7;
+
+    if( index == 0 )
+        return a0;
+    if( index == 1 )
+        return a1;
+    if( eightValues )
+        return ( ( 8 - index ) * a0 + ( index - 1 ) * a1 ) / 7.f;
+    if( index <= 5 )
+        return ( ( 6 - index ) * a0 + ( index - 1 ) * a1 ) / 5.f;
+    return ( index == 6 ) ? ( isSigned ? -1.f : 0.f ) : 1.f;
+}
+
+}  // namespace
+
+bool decodeFirstTexel( const char* data, CUarray_format format, float4& dest )
+{
+    const unsigned char* block = reinterpret_cast<const unsigned char*>( data );
+    switch( format )
+    {
+        case CU_AD_FORMAT_BC1_UNORM:
+        case CU_AD_FORMAT_BC1_UNORM_SRGB:
+            dest = decodeColorTexel( block, true );
+            return true;
+
+        case CU_AD_FORMAT_BC2_UNORM:
+        case CU_AD_FORMAT_BC2_UNORM_SRGB:
+            dest   = decodeColorTexel( block + 8, false );
+            dest.w = ( block[0] & 0xF ) / 15.f;
+            return true;
+
+        case CU_AD_FORMAT_BC3_UNORM:
+        case CU_AD_FORMAT_BC3_UNORM_SRGB:
+            dest   = decodeColorTexel( block + 8, false );
+            dest.w = decodeAlphaTexel( block, false );
+            return true;
+
+        case CU_AD_FORMAT_BC4_UNORM:
+        case CU_AD_FORMAT_BC4_SNORM:
+        {
+            const float value = decodeAlphaTexel( block, format == CU_AD_FORMAT_BC4_SNORM );
+            dest              = float4{value, value, value, 1.f};
+            return true;
+        }
+
+        case CU_AD_FORMAT_BC5_UNORM:
+        case CU_AD_FORMAT_BC5_SNORM:
+        {
+            const bool isSigned = format == CU_AD_FORMAT_BC5_SNORM;
+            dest = float4{decodeAlphaTexel( block, isSigned ), decodeAlphaTexel( block + 8, isSigned ), 0.f, 1.f};
+            return true;
+        }
+
+        default:
+            return false;
+    }
+}
+
+BlockCompressedReader::BlockCompressedReader( const std::string& filename )
+    : m_filename( filename )
+{
+}
+
+BlockCompressedReader::~BlockCompressedReader()
+{
+    close();
+}
+
+void BlockCompressedReader::open( TextureInfo* info )
+{
+    std::unique_lock<std::mutex> lock( m_initMutex );
+    if( !m_file.isOpen() )
+    {
+        m_info.isValid = false;
+        if( !m_file.open( m_filename ) )
+            throw std::runtime_error( "Cannot open image file: " + m_filename );
+
+        char identifier[sizeof( KTX2_IDENTIFIER )]{};
+        m_file.read( identifier, 0, sizeof( identifier ) );
+        if( readValue<uint32_t>( identifier, 0 ) == DDS_MAGIC )
+            readHeaderDDS();
+        else if( std::memcmp( identifier, KTX2_IDENTIFIER, sizeof( KTX2_IDENTIFIER ) ) == 0 )
+            readHeaderKTX2();
+        else
+            throw std::runtime_error( "Expected DDS or KTX2 file: " + m_filename );
+
+        // Check that the last level is within the file.
+        const size_t fileSize = m_file.getSize();
+        const unsigned int lastLevel = m_info.numMipLevels - 1;
+        const size_t lastLevelSize = getImageSizeInBytes( m_info.format, m_info.numChannels, std::max( m_info.width >> lastLevel, 1U ),
+                                                          std::max( m_info.height >> lastLevel, 1U ) );
+        if( m_levelOffsets[lastLevel] + lastLevelSize > fileSize )
+            throw std::runtime_error( "Truncated image file: " + m_filename );
+
+        m_info.isTiled = true;
+        m_info.isValid = true;
+
+        // The base color is the color of the 1x1 level.
+        if( std::max( m_info.width >> lastLevel, 1U ) == 1 && std::max( m_info.height >> lastLevel, 1U ) == 1 )
+        {
+            char block[16];
+            readBytes( block, m_levelOffsets[lastLevel], getBytesPerBlock( m_info.format ) );
+            m_baseColorWasRead = decodeFirstTexel( block, m_info.format, m_baseColor );
+        }
+    }
+
+    if( info != nullptr )
+        *info = m_info;
+}
+
+void BlockCompressedReader::readHeaderDDS()
+{
+    char header[sizeof( uint32_t ) + DDS_HEADER_SIZE + DDS_DX10_HEADER_SIZE]{};
+    m_file.read( header, 0, sizeof( header ) );
+
+    const char* dds = header + sizeof( uint32_t );
+    OTK_ASSERT_MSG( readValue<uint32_t>( dds, 0 ) == DDS_HEADER_SIZE, "Invalid DDS header" );
+    const uint32_t flags       = readValue<uint32_t>( dds, 4 );
+    m_info.height              = readValue<uint32_t>( dds, 8 );
+    m_info.width               = readValue<uint32_t>( dds, 12 );
+    const uint32_t mipMapCount = readValue<uint32_t>( dds, 24 );
+    m_info.numMipLevels        = ( flags & DDS_FLAGS_MIPMAPCOUNT ) && mipMapCount > 0 ? mipMapCount : 1;
+
+    // The pixel format starts at offset 72 of the header.
+    const uint32_t pixelFormatFlags = readValue<uint32_t>( dds, 76 );
+    const uint32_t fourCC           = readValue<uint32_t>( dds, 80 );
+    if( !( pixelFormatFlags & DDS_PIXELFORMAT_FOURCC ) )
+        throw std::runtime_error( "DDS file is not block compressed: " + m_filename );
+
+    size_t dataOffset = sizeof( uint32_t ) + DDS_HEADER_SIZE;
+    bool   supported  = false;
+    if( fourCC == makeFourCC( "DX10" ) )
+    {
+        const char* dx10 = dds + DDS_HEADER_SIZE;
+        supported        = dxgiToArrayFormat( readValue<uint32_t>( dx10, 0 ), m_info.format );
+        OTK_ASSERT_MSG( readValue<uint32_t>( dx10, 12 ) <= 1, "DDS texture arrays are not supported" );
+        dataOffset += DDS_DX10_HEADER_SIZE;
+    }
+    else
+    {
+        supported = fourCCToArrayFormat( fourCC, m_info.format );
+    }
+    if( !supported )
+        throw std::runtime_error( "Unsupported DDS pixel format: " + m_filename );
+    m_info.numChannels = getNumChannels( m_info.format );
+    OTK_ASSERT_MSG( m_info.numMipLevels <= calculateNumMipLevels( m_info.width, m_info.height ), "Invalid DDS mip level count" );
+
+    // The levels are stored consecutively, starting with the finest.
+    m_levelOffsets.resize( m_info.numMipLevels );
+    for( unsigned int mipLevel = 0; mipLevel < m_info.numMipLevels; ++mipLevel )
+    {
+        m_levelOffsets[mipLevel] = dataOffset;
+        dataOffset += getImageSizeInBytes( m_info.format, m_info.numChannels, std::max( m_info.width >> mipLevel, 1U ),
+                                           std::max( m_info.height >> mipLevel, 1U ) );
+    }
+}
+
+void BlockCompressedReader::readHeaderKTX2()
+{
+    char header[KTX2_HEADER_SIZE]{};
+    m_file.read( header, 0, sizeof( header ) );
+
+    const uint32_t vkFormat       = readValue<uint32_t>( header, 12 );
+    m_info.width                  = readValue<uint32_t>( header, 20 );
+    m_info.height                 = readValue<uint32_t>( header, 24 );
+    const uint32_t depth          = readValue<uint32_t>( header, 28 );
+    const uint32_t layerCount     = readValue<uint32_t>( header, 32 );
+    const uint32_t faceCount      = readValue<uint32_t>( header, 36 );
+    const uint32_t levelCount     = readValue<uint32_t>( header, 40 );
+    const uint32_t supercompression = readValue<uint32_t>( header, 44 );
+
+    if( !vkToArrayFormat( vkFormat, m_info.format ) )
+        throw std::runtime_error( "Unsupported KTX2 format: " + m_filename );
+    if( depth > 1 || layerCount > 1 || faceCount != 1 )
+        throw std::runtime_error( "Only 2D KTX2 textures are supported: " + m_filename );
+    if( supercompression != 0 )
+        throw std::runtime_error( "Supercompressed KTX2 files are not supported: " + m_filename );
+    m_info.numChannels  = getNumChannels( m_info.format );
+    m_info.numMipLevels = std::max( levelCount, 1U );
+    OTK_ASSERT_MSG( m_info.numMipLevels <= calculateNumMipLevels( m_info.width, m_info.height ), "Invalid KTX2 level count" );
+
+    // The level index follows the header, with the byte offset and length of each level.
+    std::vector<uint64_t> levelIndex( 3 * m_info.numMipLevels );
+    const size_t          levelIndexSize = levelIndex.size() * sizeof( uint64_t );
+    if( m_file.read( reinterpret_cast<char*>( levelIndex.data() ), KTX2_HEADER_SIZE, levelIndexSize ) != levelIndexSize )
+        throw std::runtime_error( "Truncated KTX2 level index: " + m_filename );
+
+    m_levelOffsets.resize( m_info.numMipLevels );
+    for( unsigned int mipLevel = 0; mipLevel < m_info.numMipLevels; ++mipLevel )
+        m_levelOffsets[mipLevel] = static_cast<size_t>( levelIndex[3 * mipLevel] );
+}
+
+void BlockCompressedReader::close()
+{
+    std::unique_lock<std::mutex> lock( m_initMutex );
+    m_file.close();
+}
+
+void BlockCompressedReader::readBytes( char* dest, size_t offset, size_t size )
+{
+    // Positional reads don't share a file position, so no lock is needed.
+    if( m_file.read( dest, offset, size ) != size )
+        throw std::runtime_error( "Error reading image file: " + m_filename );
+    m_numBytesRead += size;
+}
+
+void BlockCompressedReader::readBlocks( char*        dest,
+                                        size_t       rowPitch,
+                                        unsigned int mipLevel,
+                                        unsigned int blockX,
+                                        unsigned int blockY,
+                                        unsigned int numBlocksX,
+                                        unsigned int numBlocksY )
+{
+    const unsigned int levelWidth  = std::max( m_info.width >> mipLevel, 1U );
+    const unsigned int levelHeight = std::max( m_info.height >> mipLevel, 1U );
+    const size_t       levelPitch  = getRowSizeInBytes( m_info.format, m_info.numChannels, levelWidth );
+    const unsigned int levelRows   = getNumRows( m_info.format, levelHeight );
+    const size_t       blockSize   = getBytesPerBlock( m_info.format );
+
+    // Blocks outside the level are zero.
+    const size_t rowSize  = numBlocksX * blockSize;
+    const size_t readSize = blockX * blockSize < levelPitch ? std::min( rowSize, levelPitch - blockX * blockSize ) : 0;
+    for( unsigned int row = 0; row < numBlocksY; ++row )
+    {
+        char* rowDest = dest + row * rowPitch;
+        const bool inLevel = blockY + row < levelRows && readSize > 0;
+        if( inLevel )
+            readBytes( rowDest, m_levelOffsets[mipLevel] + ( blockY + row ) * levelPitch + blockX * blockSize, readSize );
+        std::memset( rowDest + ( inLevel ? readSize : 0 ), 0, rowSize - ( inLevel ? readSize : 0 ) );
+    }
+}
+
+bool BlockCompressedReader::readTile( char* dest, unsigned int mipLevel, const Tile& tile, CUstream /*stream*/ )
+{
+    OTK_ASSERT_MSG( isOpen(), "Attempting to read from image that isn't open." );
+    OTK_ASSERT_MSG( mipLevel < m_info.numMipLevels, "Attempt to read from non-existent mip-level." );
+    OTK_ASSERT_MSG( tile.width % 4 == 0 && tile.height % 4 == 0, "Block compressed tiles must be multiples of 4x4 pixels." );
+
+    Stopwatch stopwatch;
+
+    const unsigned int numBlocksX = tile.width / 4;
+    const unsigned int numBlocksY = tile.height / 4;
+    readBlocks( dest, numBlocksX * getBytesPerBlock( m_info.format ), mipLevel, tile.x * numBlocksX, tile.y * numBlocksY,
+                numBlocksX, numBlocksY );
+
+    std::unique_lock<std::mutex> lock( m_statsMutex );
+    ++m_numTilesRead;
+    m_totalReadTime += stopwatch.elapsed();
+    return true;
+}
+
+bool BlockCompressedReader::readMipLevel( char* dest, unsigned int mipLevel, unsigned int expectedWidth, unsigned int expectedHeight, CUstream /*stream*/ )
+{
+    OTK_ASSERT_MSG( isOpen(), "Attempting to read from image that isn't open." );
+    OTK_ASSERT_MSG( mipLevel < m_info.numMipLevels, "Attempt to read from non-existent mip-level." );
+    OTK_ASSERT( expectedWidth == std::max( m_info.width >> mipLevel, 1U ) && expectedHeight == std::max( m_info.height >> mipLevel, 1U ) );
+
+    Stopwatch stopwatch;
+
+    // Levels are stored contiguously, so a whole level is read at once.
+    readBytes( dest, m_levelOffsets[mipLevel], getImageSizeInBytes( m_info.format, m_info.numChannels, expectedWidth, expectedHeight ) );
+
+    std::unique_lock<std::mutex> lock( m_statsMutex );
+    m_totalReadTime += stopwatch.elapsed();
+    return true;
+}
+
+bool BlockCompressedReader::readBaseColor( float4& dest )
+{
+    dest = m_baseColor;
+    return m_baseColorWasRead;
+}
+
+}  // namespace imageSource
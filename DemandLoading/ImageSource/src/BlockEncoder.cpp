@@ -0,0 +1,619 @@
+//
+// Copyright (c) 2024, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <OptiXToolkit/ImageSource/BlockEncoder.h>
+#include <OptiXToolkit/ImageSource/FormatConversion.h>
+#include <OptiXToolkit/ImageSource/TextureInfo.h>
+
+#include <OptiXToolkit/Error/cuErrorCheck.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace imageSource {
+
+namespace {
+
+const unsigned int BLOCK_PIXELS = 16;
+
+// Fit endpoints a and b to the diagonal of the bounding box of the pixels.  The direction of the
+// diagonal in each channel follows the sign of its covariance with the widest channel.
+template <int C>
+void fitBoundingBox( const float ( *pixels )[C], float* a, float* b )
+{
+    float lo[C], hi[C], mean[C];
+    for( int c = 0; c < C; ++c )
+    {
+        lo[c] = hi[c] = pixels[0][c];
+        mean[c] = 0.f;
+        for( unsigned int i = 0; i < BLOCK_PIXELS; ++i )
+        {
+            lo[c] = std::min( lo[c], pixels[i][c] );
+            hi[c] = std::max( hi[c], pixels[i][c] );
+            mean[c] += pixels[i][c] / BLOCK_PIXELS;
+        }
+    }
+
+    int widest = 0;
+    for( int c = 1; c < C; ++c )
+    {
+        if( hi[c] - lo[c] > hi[widest] - lo[widest] )
+            widest = c;
+    }
+
+    for( int c = 0; c < C; ++c )
+    {
+        float covariance = 0.f;
+        for( unsigned int i = 0; i < BLOCK_PIXELS; ++i )
+            covariance += ( pixels[i][c] - mean[c] ) * ( pixels[i][widest] - mean[widest] );
+        a[c] = ( covariance < 0.f ) ? hi[c] : lo[c];
+        b[c] = ( covariance < 0.f ) ? lo[c] : hi[c];
+    }
+}
+
+// Fit endpoints a and b to the extent of the pixels along their principal axis, which is found by
+// power iteration on the covariance matrix.
+template <int C>
+void fitPrincipalAxis( const float ( *pixels )[C], float* a, float* b )
+{
+    float mean[C] = {};
+    for( unsigned int i = 0; i < BLOCK_PIXELS; ++i )
+        for( int c = 0; c < C; ++c )
+            mean[c] += pixels[i][c] / BLOCK_PIXELS;
+
+    float covariance[C][C] = {};
+    for( unsigned int i = 0; i < BLOCK_PIXELS; ++i )
+        for( int r = 0; r < C; ++r )
+            for( int c = 0; c < C; ++c )
+                covariance[r][c] += ( pixels[i][r] - mean[r] ) * ( pixels[i][c] - mean[c] );
+
+    // Start from the bounding box diagonal, which is usually close to the principal axis.
+    float axis[C];
+    fitBoundingBox<C>( pixels, a, b );
+    for( int c = 0; c < C; ++c )
+        axis[c] = b[c] - a[c] + 1e-3f;
+    for( int iteration = 0; iteration < 8; ++iteration )
+    {
+        float next[C] = {};
+        float length  = 0.f;
+        for( int r = 0; r < C; ++r )
+        {
+            for( int c = 0; c < C; ++c )
+                next[r] += covariance[r][c] * axis[c];
+            length = std::max( length, std::fabs( next[r] ) );
+        }
+        if( length < 1e-6f )
+            return;  // The pixels are (nearly) uniform; keep the bounding box.
+        for( int c = 0; c < C; ++c )
+            axis[c] = next[c] / length;
+    }
+
+    float tMin = std::numeric_limits<float>::max();
+    float tMax = -tMin;
+    float axisLength2 = 0.f;
+    for( int c = 0; c < C; ++c )
+        axisLength2 += axis[c] * axis[c];
+    for( unsigned int i = 0; i < BLOCK_PIXELS; ++i )
+    {
+        float t = 0.f;
+        for( int c = 0; c < C; ++c )
+            t += ( pixels[i][c] - mean[c] ) * axis[c];
+        tMin = std::min( tMin, t / axisLength2 );
+        tMax = std::max( tMax, t / axisLength2 );
+    }
+    for( int c = 0; c < C; ++c )
+    {
+        a[c] = std::min( std::max( mean[c] + tMin * axis[c], 0.f ), 255.f );
+        b[c] = std::min( std::max( mean[c] + tMax * axis[c], 0.f ), 255.f );
+    }
+}
+
+// Solve for the endpoints a and b that minimize the squared error of the pixels, given the
+// interpolation weight t (from a to b) of each pixel.  Returns false if the system is singular,
+// e.g. when every pixel has the same weight.
+template <int C>
+bool fitLeastSquares( const float ( *pixels )[C], const float* t, float* a, float* b )
+{
+    float aa = 0.f, ab = 0.f, bb = 0.f;
+    float ax[C] = {}, bx[C] = {};
+    for( unsigned int i = 0; i < BLOCK_PIXELS; ++i )
+    {
+        const float s = 1.f - t[i];
+        aa += s * s;
+        ab += s * t[i];
+        bb += t[i] * t[i];
+        for( int c = 0; c < C; ++c )
+        {
+            ax[c] += s * pixels[i][c];
+            bx[c] += t[i] * pixels[i][c];
+        }
+    }
+    const float determinant = aa * bb - ab * ab;
+    if( std::fabs( determinant ) < 1e-6f )
+        return false;
+    for( int c = 0; c < C; ++c )
+    {
+        a[c] = std::min( std::max( ( ax[c] * bb - bx[c] * ab ) / determinant, 0.f ), 255.f );
+        b[c] = std::min( std::max( ( bx[c] * aa - ax[c] * ab ) / determinant, 0.f ), 255.f );
+    }
+    return true;
+}
+
+template <int C>
+int squaredDistance( const int* x, const int* y )
+{
+    int sum = 0;
+    for( int c = 0; c < C; ++c )
+        sum += ( x[c] - y[c] ) * ( x[c] - y[c] );
+    return sum;
+}
+
+// Choose the nearest palette entry for each pixel, returning the total squared error.
+template <int C>
+int chooseIndices( const int ( *pixels )[C], const int ( *palette )[C], unsigned int paletteSize, uint8_t* indices )
+{
+    int error = 0;
+    for( unsigned int i = 0; i < BLOCK_PIXELS; ++i )
+    {
+        int best = std::numeric_limits<int>::max();
+        for( unsigned int p = 0; p < paletteSize; ++p )
+        {
+            const int distance = squaredDistance<C>( pixels[i], palette[p] );
+            if( distance < best )
+            {
+                best       = distance;
+                indices[i] = static_cast<uint8_t>( p );
+            }
+        }
+        error += best;
+    }
+    return error;
+}
+
+// Write the low count bits of value at the given bit position of a zeroed buffer.
+void putBits( uint8_t* dst, unsigned int& position, unsigned int value, unsigned int count )
+{
+    for( unsigned int bit = 0; bit < count; ++bit, ++position )
+        dst[position / 8] |= static_cast<uint8_t>( ( ( value >> bit ) & 1 ) << ( position % 8 ) );
+}
+
+//------------------------------------------------------------------------------
+// BC1
+
+struct BC1Block
+{
+    uint16_t color0;
+    uint16_t color1;
+    uint8_t  indices[BLOCK_PIXELS];
+    int      error;
+};
+
+uint16_t quantize565( const float* color )
+{
+    const int r = static_cast<int>( color[0] * 31.f / 255.f + 0.5f );
+    const int g = static_cast<int>( color[1] * 63.f / 255.f + 0.5f );
+    const int b = static_cast<int>( color[2] * 31.f / 255.f + 0.5f );
+    return static_cast<uint16_t>( ( r << 11 ) | ( g << 5 ) | b );
+}
+
+void expand565( uint16_t color, int* rgb )
+{
+    const int r = ( color >> 11 ) & 31;
+    const int g = ( color >> 5 ) & 63;
+    const int b = color & 31;
+    rgb[0]      = ( r << 3 ) | ( r >> 2 );
+    rgb[1]      = ( g << 2 ) | ( g >> 4 );
+    rgb[2]      = ( b << 3 ) | ( b >> 2 );
+}
+
+// Quantize the endpoints and choose the indices, using the four color mode (color0 > color1).
+// Identical endpoints select the three color mode, in which index 0 still selects color0.
+void evaluateBC1( const int ( *pixels )[3], const float* a, const float* b, BC1Block& block )
+{
+    block.color0 = quantize565( a );
+    block.color1 = quantize565( b );
+    if( block.color0 < block.color1 )
+        std::swap( block.color0, block.color1 );
+
+    int palette[4][3];
+    expand565( block.color0, palette[0] );
+    expand565( block.color1, palette[1] );
+    for( int c = 0; c < 3; ++c )
+    {
+        palette[2][c] = ( 2 * palette[0][c] + palette[1][c] + 1 ) / 3;
+        palette[3][c] = ( palette[0][c] + 2 * palette[1][c] + 1 ) / 3;
+    }
+    const unsigned int paletteSize = ( block.color0 == block.color1 ) ? 1 : 4;
+    block.error                    = chooseIndices<3>( pixels, palette, paletteSize, block.indices );
+}
+
+//------------------------------------------------------------------------------
+// BC4
+
+struct BC4Block
+{
+    uint8_t value0;
+    uint8_t value1;
+    uint8_t indices[BLOCK_PIXELS];
+    int     error;
+};
+
+// Choose the indices for the given endpoints.  If value0 > value1 the palette interpolates eight
+// values between them; otherwise it interpolates six, followed by 0 and 255.
+void evaluateBC4( const int ( *values )[1], int value0, int value1, BC4Block& block )
+{
+    block.value0 = static_cast<uint8_t>( value0 );
+    block.value1 = static_cast<uint8_t>( value1 );
+
+    int palette[8][1];
+    palette[0][0] = value0;
+    palette[1][0] = value1;
+    if( value0 > value1 )
+    {
+        for( int i = 2; i < 8; ++i )
+            palette[i][0] = ( ( 8 - i ) * value0 + ( i - 1 ) * value1 + 3 ) / 7;
+    }
+    else
+    {
+        for( int i = 2; i < 6; ++i )
+            palette[i][0] = ( ( 6 - i ) * value0 + ( i - 1 ) * value1 + 2 ) / 5;
+        palette[6][0] = 0;
+        palette[7][0] = 255;
+    }
+    block.error = chooseIndices<1>( values, palette, 8, block.indices );
+}
+
+int roundEndpoint( float value )
+{
+    return std::min( std::max( static_cast<int>( value + 0.5f ), 0 ), 255 );
+}
+
+//------------------------------------------------------------------------------
+// BC7
+
+const int BC7_WEIGHTS[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+struct BC7Block
+{
+    int     endpoint0[4];  // 7-bit values
+    int     endpoint1[4];
+    int     pbit0;
+    int     pbit1;
+    uint8_t indices[BLOCK_PIXELS];
+    int     error;
+};
+
+// Quantize an endpoint to 7 bits per channel plus a shared low bit, choosing the low bit that
+// minimizes the error.
+void quantizeBC7Endpoint( const float* endpoint, int* quantized, int& pbit )
+{
+    float bestError = std::numeric_limits<float>::max();
+    for( int p = 0; p < 2; ++p )
+    {
+        int   candidate[4];
+        float error = 0.f;
+        for( int c = 0; c < 4; ++c )
+        {
+            candidate[c]     = std::min( std::max( static_cast<int>( ( endpoint[c] - p ) / 2.f + 0.5f ), 0 ), 127 );
+            const float diff = static_cast<float>( candidate[c] * 2 + p ) - endpoint[c];
+            error += diff * diff;
+        }
+        if( error < bestError )
+        {
+            bestError = error;
+            pbit      = p;
+            std::copy( candidate, candidate + 4, quantized );
+        }
+    }
+}
+
+void evaluateBC7( const int ( *pixels )[4], const float* a, const float* b, BC7Block& block )
+{
+    quantizeBC7Endpoint( a, block.endpoint0, block.pbit0 );
+    quantizeBC7Endpoint( b, block.endpoint1, block.pbit1 );
+
+    int palette[16][4];
+    for( int c = 0; c < 4; ++c )
+    {
+        const int e0 = block.endpoint0[c] * 2 + block.pbit0;
+        const int e1 = block.endpoint1[c] * 2 + block.pbit1;
+        for( int i = 0; i < 16; ++i )
+            palette[i][c] = ( ( 64 - BC7_WEIGHTS[i] ) * e0 + BC7_WEIGHTS[i] * e1 + 32 ) >> 6;
+    }
+    block.error = chooseIndices<4>( pixels, palette, 16, block.indices );
+}
+
+void writeBC7Block( BC7Block& block, uint8_t* dst )
+{
+    // The high bit of the first index is implicitly zero, so swap the endpoints if necessary.
+    if( block.indices[0] & 8 )
+    {
+        std::swap( block.endpoint0, block.endpoint1 );
+        std::swap( block.pbit0, block.pbit1 );
+        for( unsigned int i = 0; i < BLOCK_PIXELS; ++i )
+            block.indices[i] = static_cast<uint8_t>( 15 - block.indices[i] );
+    }
+
+    std::memset( dst, 0, 16 );
+    unsigned int position = 0;
+    putBits( dst, position, 1 << 6, 7 );  // mode 6
+    for( int c = 0; c < 4; ++c )
+    {
+        putBits( dst, position, block.endpoint0[c], 7 );
+        putBits( dst, position, block.endpoint1[c], 7 );
+    }
+    putBits( dst, position, block.pbit0, 1 );
+    putBits( dst, position, block.pbit1, 1 );
+    putBits( dst, position, block.indices[0], 3 );
+    for( unsigned int i = 1; i < BLOCK_PIXELS; ++i )
+        putBits( dst, position, block.indices[i], 4 );
+}
+
+}  // namespace
+
+bool canEncodeBlocks( CUarray_format srcFormat, unsigned int numChannels, CUarray_format dstFormat )
+{
+    if( srcFormat != CU_AD_FORMAT_UNSIGNED_INT8 && srcFormat != CU_AD_FORMAT_HALF && srcFormat != CU_AD_FORMAT_FLOAT )
+        return false;
+    switch( dstFormat )
+    {
+        case CU_AD_FORMAT_BC1_UNORM:
+        case CU_AD_FORMAT_BC7_UNORM:
+            return numChannels == 4;
+        case CU_AD_FORMAT_BC4_UNORM:
+            return numChannels == 1;
+        case CU_AD_FORMAT_BC5_UNORM:
+            return numChannels == 2;
+        default:
+            return false;
+    }
+}
+
+void encodeBlocks( const char*    src,
+                   CUarray_format srcFormat,
+                   unsigned int   numChannels,
+                   unsigned int   width,
+                   unsigned int   height,
+                   char*          dst,
+                   CUarray_format dstFormat,
+                   EncodeQuality  quality )
+{
+    OTK_ASSERT_MSG( canEncodeBlocks( srcFormat, numChannels, dstFormat ), "Unsupported block encoding" );
+
+    const unsigned int pixelSize = numChannels * getBytesPerChannel( srcFormat );
+    const size_t       rowPitch  = static_cast<size_t>( width ) * pixelSize;
+    const unsigned int blockSize = getBytesPerBlock( dstFormat );
+
+    char    pixels[BLOCK_PIXELS * 4 * sizeof( float )];
+    uint8_t values[BLOCK_PIXELS * 4];
+    uint8_t red[BLOCK_PIXELS];
+    uint8_t green[BLOCK_PIXELS];
+    uint8_t* block = reinterpret_cast<uint8_t*>( dst );
+
+    for( unsigned int blockY = 0; blockY < height; blockY += 4 )
+    {
+        for( unsigned int blockX = 0; blockX < width; blockX += 4, block += blockSize )
+        {
+            // Gather the block, replicating the last column and row of the image.
+            for( unsigned int i = 0; i < BLOCK_PIXELS; ++i )
+            {
+                const unsigned int x = std::min( blockX + i % 4, width - 1 );
+                const unsigned int y = std::min( blockY + i / 4, height - 1 );
+                std::memcpy( pixels + i * pixelSize, src + y * rowPitch + x * pixelSize, pixelSize );
+            }
+            convertFormat( pixels, srcFormat, reinterpret_cast<char*>( values ), CU_AD_FORMAT_UNSIGNED_INT8, BLOCK_PIXELS * numChannels );
+
+            switch( dstFormat )
+            {
+                case CU_AD_FORMAT_BC1_UNORM:
+                    encodeBC1Block( values, block, quality );
+                    break;
+                case CU_AD_FORMAT_BC4_UNORM:
+                    encodeBC4Block( values, block, quality );
+                    break;
+                case CU_AD_FORMAT_BC5_UNORM:
+                    for( unsigned int i = 0; i < BLOCK_PIXELS; ++i )
+                    {
+                        red[i]   = values[2 * i];
+                        green[i] = values[2 * i + 1];
+                    }
+                    encodeBC4Block( red, block, quality );
+                    encodeBC4Block( green, block + 8, quality );
+                    break;
+                default:
+                    encodeBC7Block( values, block, quality );
+                    break;
+            }
+        }
+    }
+}
+
+void encodeBC1Block( const uint8_t* rgba, uint8_t* dst, EncodeQuality quality )
+{
+    int   pixels[BLOCK_PIXELS][3];
+    float fpixels[BLOCK_PIXELS][3];
+    for( unsigned int i = 0; i < BLOCK_PIXELS; ++i )
+    {
+        for( int c = 0; c < 3; ++c )
+        {
+            pixels[i][c]  = rgba[4 * i + c];
+            fpixels[i][c] = rgba[4 * i + c];
+        }
+    }
+
+    float    a[3], b[3];
+    BC1Block best;
+    fitBoundingBox<3>( fpixels, a, b );
+    evaluateBC1( pixels, a, b, best );
+
+    if( quality == ENCODE_HIGH_QUALITY && best.error > 0 )
+    {
+        BC1Block candidate;
+        fitPrincipalAxis<3>( fpixels, a, b );
+        evaluateBC1( pixels, a, b, candidate );
+        if( candidate.error < best.error )
+            best = candidate;
+
+        const float weights[4] = {0.f, 1.f, 1.f / 3.f, 2.f / 3.f};
+        for( int iteration = 0; iteration < 2; ++iteration )
+        {
+            float t[BLOCK_PIXELS];
+            for( unsigned int i = 0; i < BLOCK_PIXELS; ++i )
+                t[i] = weights[best.indices[i]];
+            if( !fitLeastSquares<3>( fpixels, t, a, b ) )
+                break;
+            evaluateBC1( pixels, a, b, candidate );
+            if( candidate.error >= best.error )
+                break;
+            best = candidate;
+        }
+    }
+
+    dst[0] = static_cast<uint8_t>( best.color0 & 0xFF );
+    dst[1] = static_cast<uint8_t>( best.color0 >> 8 );
+    dst[2] = static_cast<uint8_t>( best.color1 & 0xFF );
+    dst[3] = static_cast<uint8_t>( best.color1 >> 8 );
+    uint32_t indices = 0;
+    for( unsigned int i = 0; i < BLOCK_PIXELS; ++i )
+        indices |= static_cast<uint32_t>( best.indices[i] ) << ( 2 * i );
+    for( int i = 0; i < 4; ++i )
+        dst[4 + i] = static_cast<uint8_t>( indices >> ( 8 * i ) );
+}
+
+void encodeBC4Block( const uint8_t* values, uint8_t* dst, EncodeQuality quality )
+{
+    int ivalues[BLOCK_PIXELS][1];
+    int lo = 255, hi = 0;
+    for( unsigned int i = 0; i < BLOCK_PIXELS; ++i )
+    {
+        ivalues[i][0] = values[i];
+        lo            = std::min( lo, ivalues[i][0] );
+        hi            = std::max( hi, ivalues[i][0] );
+    }
+
+    BC4Block best;
+    evaluateBC4( ivalues, hi, lo, best );
+
+    if( quality == ENCODE_HIGH_QUALITY && best.error > 0 )
+    {
+        // Refine the eight value endpoints by least squares.
+        BC4Block candidate;
+        float    fvalues[BLOCK_PIXELS][1];
+        for( unsigned int i = 0; i < BLOCK_PIXELS; ++i )
+            fvalues[i][0] = static_cast<float>( values[i] );
+        for( int iteration = 0; iteration < 2 && best.value0 > best.value1; ++iteration )
+        {
+            float t[BLOCK_PIXELS];
+            for( unsigned int i = 0; i < BLOCK_PIXELS; ++i )
+                t[i] = ( best.indices[i] <= 1 ) ? static_cast<float>( best.indices[i] ) : ( best.indices[i] - 1 ) / 7.f;
+            float a, b;
+            if( !fitLeastSquares<1>( fvalues, t, &a, &b ) )
+                break;
+            const int value0 = roundEndpoint( a );
+            const int value1 = roundEndpoint( b );
+            if( value0 <= value1 )
+                break;
+            evaluateBC4( ivalues, value0, value1, candidate );
+            if( candidate.error >= best.error )
+                break;
+            best = candidate;
+        }
+
+        // Try the six value mode, which represents 0 and 255 exactly, spanning the other values.
+        int innerLo = 255, innerHi = 0;
+        for( unsigned int i = 0; i < BLOCK_PIXELS; ++i )
+        {
+            if( values[i] != 0 && values[i] != 255 )
+            {
+                innerLo = std::min( innerLo, ivalues[i][0] );
+                innerHi = std::max( innerHi, ivalues[i][0] );
+            }
+        }
+        if( innerLo <= innerHi )
+        {
+            evaluateBC4( ivalues, innerLo, innerHi, candidate );
+            if( candidate.error < best.error )
+                best = candidate;
+        }
+    }
+
+    dst[0] = best.value0;
+    dst[1] = best.value1;
+    uint64_t indices = 0;
+    for( unsigned int i = 0; i < BLOCK_PIXELS; ++i )
+        indices |= static_cast<uint64_t>( best.indices[i] ) << ( 3 * i );
+    for( int i = 0; i < 6; ++i )
+        dst[2 + i] = static_cast<uint8_t>( indices >> ( 8 * i ) );
+}
+
+void encodeBC7Block( const uint8_t* rgba, uint8_t* dst, EncodeQuality quality )
+{
+    int   pixels[BLOCK_PIXELS][4];
+    float fpixels[BLOCK_PIXELS][4];
+    for( unsigned int i = 0; i < BLOCK_PIXELS; ++i )
+    {
+        for( int c = 0; c < 4; ++c )
+        {
+            pixels[i][c]  = rgba[4 * i + c];
+            fpixels[i][c] = rgba[4 * i + c];
+        }
+    }
+
+    float    a[4], b[4];
+    BC7Block best;
+    fitBoundingBox<4>( fpixels, a, b );
+    evaluateBC7( pixels, a, b, best );
+
+    if( quality == ENCODE_HIGH_QUALITY && best.error > 0 )
+    {
+        BC7Block candidate;
+        fitPrincipalAxis<4>( fpixels, a, b );
+        evaluateBC7( pixels, a, b, candidate );
+        if( candidate.error < best.error )
+            best = candidate;
+
+        for( int iteration = 0; iteration < 2; ++iteration )
+        {
+            float t[BLOCK_PIXELS];
+            for( unsigned int i = 0; i < BLOCK_PIXELS; ++i )
+                t[i] = BC7_WEIGHTS[best.indices[i]] / 64.f;
+            if( !fitLeastSquares<4>( fpixels, t, a, b ) )
+                break;
+            evaluateBC7( pixels, a, b, candidate );
+            if( candidate.error >= best.error )
+                break;
+            best = candidate;
+        }
+    }
+
+    writeBC7Block( best, dst );
+}
+
+}  // namespace imageSource
@@ -30,6 +30,8 @@
 
 #include "Stopwatch.h"
 
+#include <OptiXToolkit/ImageSource/BaseColor.h>
+
 #include <OptiXToolkit/Error/ErrorCheck.h>
 
 #include <half.h>
@@ -39,9 +41,22 @@
 #include <cmath>
 #include <cstring>
 #include <sstream>
+#include <vector>
 
 namespace imageSource {
 
+namespace {
+
+// Fold the given bytes into a 64-bit hash.
+uint64_t hashBytes( const char* data, size_t size, uint64_t hash )
+{
+    const uint64_t prime = 0x100000001B3ULL;
+    for( size_t i = 0; i < size; ++i )
+        hash = ( hash ^ static_cast<unsigned char>( data[i] ) ) * prime;
+    return hash;
+}
+
+}  // namespace
 
 CoreEXRReader::CoreEXRReader( const std::string& filename, bool readBaseColor )
     : m_filename( filename )
@@ -170,6 +185,11 @@ void CoreEXRReader::open( TextureInfo* info )
             m_baseColorWasRead = true;
         }
     }
+    // Otherwise use the base color computed in an earlier run, if the file hasn't changed.
+    else if( m_readBaseColor && !m_baseColorWasRead )
+    {
+        m_baseColorWasRead = readBaseColorFile( m_filename, m_baseColor );
+    }
 
     if( info != nullptr )
         *info = m_info;
@@ -356,6 +376,42 @@ bool CoreEXRReader::readTile( char* dest, unsigned int mipLevel, const Tile& til
     return true;
 }
 
+bool CoreEXRReader::readTileHash( uint64_t& hash, unsigned int mipLevel, const Tile& tile )
+{
+    OTK_ASSERT_MSG( isOpen(), "Attempting to read from image that isn't open." );
+    if( m_isScanline )
+        return false;
+
+    // The requested tile is made up of whole EXR tiles (see readTile).
+    const int sourceTileWidth  = m_tileWidths[mipLevel];
+    const int sourceTileHeight = m_tileHeights[mipLevel];
+    if( tile.width % sourceTileWidth != 0 || tile.height % sourceTileHeight != 0 )
+        return false;
+
+    const int numXTiles  = ( m_levelWidths[mipLevel] + sourceTileWidth - 1 ) / sourceTileWidth;
+    const int numYTiles  = ( m_levelHeights[mipLevel] + sourceTileHeight - 1 ) / sourceTileHeight;
+    const int firstTileX = tile.x * ( tile.width / sourceTileWidth );
+    const int firstTileY = tile.y * ( tile.height / sourceTileHeight );
+    const int endTileX   = std::min<int>( firstTileX + tile.width / sourceTileWidth, numXTiles );
+    const int endTileY   = std::min<int>( firstTileY + tile.height / sourceTileHeight, numYTiles );
+
+    // Hash the packed (compressed) data of each EXR tile, which is much cheaper than decoding it.
+    hash = 0xCBF29CE484222325ULL;
+    std::vector<char> packedData;
+    for( int tileY = firstTileY; tileY < endTileY; ++tileY )
+    {
+        for( int tileX = firstTileX; tileX < endTileX; ++tileX )
+        {
+            exr_chunk_info_t cinfo;
+            OTK_ERROR_CHECK( exr_read_tile_chunk_info( m_exrCtx, m_partIndex, tileX, tileY, mipLevel, mipLevel, &cinfo ) );
+            packedData.resize( static_cast<size_t>( cinfo.packed_size ) );
+            OTK_ERROR_CHECK( exr_read_chunk( m_exrCtx, m_partIndex, &cinfo, packedData.data() ) );
+            hash = hashBytes( packedData.data(), packedData.size(), hash ^ cinfo.compression );
+        }
+    }
+    return true;
+}
+
 bool CoreEXRReader::readMipLevel( char* dest, unsigned int mipLevel, unsigned int expectedWidth, unsigned int expectedHeight, CUstream /*stream*/ )
 {
     OTK_ASSERT_MSG( isOpen(), "Attempting to read from image that isn't open." );
@@ -400,8 +456,19 @@ bool CoreEXRReader::readMipLevel( char* dest, unsigned int mipLevel, unsigned in
 
 bool CoreEXRReader::readBaseColor( float4& dest )
 {
+    std::unique_lock<std::mutex> lock( m_initMutex );
     dest = m_baseColor;
     return m_baseColorWasRead;
 }
 
+void CoreEXRReader::writeBaseColor( const float4& baseColor )
+{
+    {
+        std::unique_lock<std::mutex> lock( m_initMutex );
+        m_baseColor        = baseColor;
+        m_baseColorWasRead = true;
+    }
+    writeBaseColorFile( m_filename, baseColor );
+}
+
 }  // namespace demandLoading
@@ -28,6 +28,7 @@
 
 #include "Stopwatch.h"
 
+#include <OptiXToolkit/ImageSource/BaseColor.h>
 #include <OptiXToolkit/ImageSource/EXRReader.h>
 #include <OptiXToolkit/Error/cuErrorCheck.h>
 
@@ -171,6 +172,11 @@ void EXRReader::open( TextureInfo* info )
                     m_baseColorWasRead = true;
                 }
             }
+            // Otherwise use the base color computed in an earlier run, if the file hasn't changed.
+            else if( m_readBaseColor && !m_baseColorWasRead )
+            {
+                m_baseColorWasRead = readBaseColorFile( m_filename, m_baseColor );
+            }
 
             m_info.isValid = true;
         }
@@ -372,10 +378,21 @@ bool EXRReader::readMipLevel( char* dest, unsigned int mipLevel, unsigned int ex
 
 bool EXRReader::readBaseColor( float4& dest )
 {
+    std::unique_lock<std::mutex> lock( m_mutex );
     dest = m_baseColor;
     return m_baseColorWasRead;
 }
 
+void EXRReader::writeBaseColor( const float4& baseColor )
+{
+    {
+        std::unique_lock<std::mutex> lock( m_mutex );
+        m_baseColor        = baseColor;
+        m_baseColorWasRead = true;
+    }
+    writeBaseColorFile( m_filename, baseColor );
+}
+
 void EXRReader::serialize( std::ostream& stream ) const
 {
     // Serialize the filename, preceded by its length.
@@ -0,0 +1,174 @@
+//
+// Copyright (c) 2024, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <OptiXToolkit/ImageSource/FileUtil.h>
+
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <sstream>
+#include <thread>
+
+namespace imageSource {
+
+bool writeFileAtomically( const std::string& path, const char* data, size_t size )
+{
+    // The temporary file name is made unique with the thread and the time.
+    std::ostringstream tempPathStream;
+    tempPathStream << path << '.' << std::hash<std::thread::id>()( std::this_thread::get_id() ) << '.'
+                   << std::chrono::high_resolution_clock::now().time_since_epoch().count() << ".tmp";
+    const std::string tempPath = tempPathStream.str();
+    {
+        std::ofstream file( tempPath, std::ios::binary );
+        if( !file || !file.write( data, size ) )
+        {
+            file.close();
+            std::remove( tempPath.c_str() );
+            return false;
+        }
+    }
+
+    // Renaming replaces an existing file on POSIX systems, but fails on some other platforms, in which
+    // case the existing file is removed and the rename is retried.
+    if( std::rename( tempPath.c_str(), path.c_str() ) == 0 )
+        return true;
+    std::remove( path.c_str() );
+    if( std::rename( tempPath.c_str(), path.c_str() ) == 0 )
+        return true;
+    std::remove( tempPath.c_str() );
+    return false;
+}
+
+#ifdef _WIN32
+
+bool PositionalFile::open( const std::string& path )
+{
+    close();
+    HANDLE handle = CreateFileA( path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr );
+    if( handle == INVALID_HANDLE_VALUE )
+        return false;
+    m_handle = handle;
+    return true;
+}
+
+void PositionalFile::close()
+{
+    if( m_handle )
+        CloseHandle( m_handle );
+    m_handle = nullptr;
+}
+
+bool PositionalFile::isOpen() const
+{
+    return m_handle != nullptr;
+}
+
+size_t PositionalFile::getSize() const
+{
+    LARGE_INTEGER size{};
+    return m_handle && GetFileSizeEx( m_handle, &size ) ? static_cast<size_t>( size.QuadPart ) : 0;
+}
+
+size_t PositionalFile::read( char* dest, size_t offset, size_t size ) const
+{
+    // ReadFile reads at the offset given in the OVERLAPPED structure.  It reads at most 4 GB at a time.
+    size_t numRead = 0;
+    while( numRead < size )
+    {
+        OVERLAPPED overlapped{};
+        const unsigned long long position = offset + numRead;
+        overlapped.Offset                 = static_cast<DWORD>( position );
+        overlapped.OffsetHigh             = static_cast<DWORD>( position >> 32 );
+        const DWORD chunkSize             = static_cast<DWORD>( std::min<size_t>( size - numRead, 0x80000000 ) );
+        DWORD       chunkRead             = 0;
+        if( !ReadFile( m_handle, dest + numRead, chunkSize, &chunkRead, &overlapped ) || chunkRead == 0 )
+            break;
+        numRead += chunkRead;
+    }
+    return numRead;
+}
+
+#else
+
+bool PositionalFile::open( const std::string& path )
+{
+    close();
+    m_fd = ::open( path.c_str(), O_RDONLY );
+    return m_fd >= 0;
+}
+
+void PositionalFile::close()
+{
+    if( m_fd >= 0 )
+        ::close( m_fd );
+    m_fd = -1;
+}
+
+bool PositionalFile::isOpen() const
+{
+    return m_fd >= 0;
+}
+
+size_t PositionalFile::getSize() const
+{
+    struct stat status;
+    return m_fd >= 0 && fstat( m_fd, &status ) == 0 ? static_cast<size_t>( status.st_size ) : 0;
+}
+
+size_t PositionalFile::read( char* dest, size_t offset, size_t size ) const
+{
+    // pread may return fewer bytes than requested, or be interrupted by a signal.
+    size_t numRead = 0;
+    while( numRead < size )
+    {
+        const ssize_t chunkRead = pread( m_fd, dest + numRead, size - numRead, static_cast<off_t>( offset + numRead ) );
+        if( chunkRead < 0 && errno == EINTR )
+            continue;
+        if( chunkRead <= 0 )
+            break;
+        numRead += static_cast<size_t>( chunkRead );
+    }
+    return numRead;
+}
+
+#endif
+
+}  // namespace imageSource
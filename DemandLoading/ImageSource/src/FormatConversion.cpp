@@ -0,0 +1,281 @@
+//
+// Copyright (c) 2024, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <OptiXToolkit/ImageSource/FormatConversion.h>
+#include <OptiXToolkit/ImageSource/TextureInfo.h>
+
+#include <OptiXToolkit/Error/cuErrorCheck.h>
+
+#include <cstring>
+
+#if defined( __SSE2__ ) || defined( _M_X64 )
+#define OTK_FORMAT_CONVERSION_SSE2
+#include <emmintrin.h>
+#endif
+
+// The F16C conversions are compiled for x86-64 even when the compiler does not target F16C by
+// default, and are used if the CPU supports them (see hasF16C).
+#if defined( __x86_64__ ) || defined( _M_X64 )
+#define OTK_FORMAT_CONVERSION_F16C
+#include <immintrin.h>
+#if defined( _MSC_VER )
+#include <intrin.h>
+#define OTK_TARGET_F16C
+#else
+#include <cpuid.h>
+#define OTK_TARGET_F16C __attribute__( ( target( "avx,f16c" ) ) )
+#endif
+#endif
+
+namespace imageSource {
+
+namespace {
+
+uint16_t floatToHalf( float value )
+{
+    uint32_t bits;
+    std::memcpy( &bits, &value, sizeof( bits ) );
+    const uint32_t sign = ( bits >> 16 ) & 0x8000;
+    const uint32_t absBits = bits & 0x7FFFFFFF;
+
+    // Infinity and NaN (keeping NaNs quiet).
+    if( absBits >= 0x7F800000 )
+        return static_cast<uint16_t>( sign | 0x7C00 | ( absBits > 0x7F800000 ? 0x200 | ( ( absBits >> 13 ) & 0x3FF ) : 0 ) );
+
+    // Values that round to 65520 or more overflow to infinity.
+    if( absBits >= 0x477FF000 )
+        return static_cast<uint16_t>( sign | 0x7C00 );
+
+    // Values below 2^-14 become half denormals (or zero).
+    if( absBits < 0x38800000 )
+    {
+        if( absBits < 0x33000000 )
+            return static_cast<uint16_t>( sign );
+        const uint32_t exponent = absBits >> 23;
+        const uint32_t mantissa = ( absBits & 0x7FFFFF ) | 0x800000;
+        const uint32_t shift    = 126 - exponent;
+        uint32_t       result   = mantissa >> shift;
+        const uint32_t rest     = mantissa & ( ( 1u << shift ) - 1 );
+        const uint32_t halfway  = 1u << ( shift - 1 );
+        if( rest > halfway || ( rest == halfway && ( result & 1 ) ) )
+            ++result;
+        return static_cast<uint16_t>( sign | result );
+    }
+
+    // Normal values: rebias the exponent and round the mantissa to nearest even.
+    uint32_t       result = ( absBits - 0x38000000 ) >> 13;
+    const uint32_t rest   = absBits & 0x1FFF;
+    if( rest > 0x1000 || ( rest == 0x1000 && ( result & 1 ) ) )
+        ++result;
+    return static_cast<uint16_t>( sign | result );
+}
+
+float halfToFloat( uint16_t value )
+{
+    const uint32_t sign     = static_cast<uint32_t>( value & 0x8000 ) << 16;
+    uint32_t       exponent = ( value >> 10 ) & 0x1F;
+    uint32_t       mantissa = value & 0x3FF;
+
+    uint32_t bits;
+    if( exponent == 0x1F )
+        bits = sign | 0x7F800000 | ( mantissa << 13 );
+    else if( exponent != 0 )
+        bits = sign | ( ( exponent + 112 ) << 23 ) | ( mantissa << 13 );
+    else if( mantissa == 0 )
+        bits = sign;
+    else
+    {
+        // Normalize the denormal.
+        exponent = 113;
+        while( !( mantissa & 0x400 ) )
+        {
+            mantissa <<= 1;
+            --exponent;
+        }
+        bits = sign | ( exponent << 23 ) | ( ( mantissa & 0x3FF ) << 13 );
+    }
+
+    float result;
+    std::memcpy( &result, &bits, sizeof( result ) );
+    return result;
+}
+
+#ifdef OTK_FORMAT_CONVERSION_F16C
+
+bool detectF16C()
+{
+#if defined( _MSC_VER )
+    int info[4];
+    __cpuid( info, 1 );
+    const unsigned int ecx = static_cast<unsigned int>( info[2] );
+#else
+    unsigned int eax, ebx, ecx, edx;
+    if( !__get_cpuid( 1, &eax, &ebx, &ecx, &edx ) )
+        return false;
+#endif
+    // The conversions use AVX registers, so the OS must also save them (OSXSAVE and XCR0).
+    const unsigned int OSXSAVE = 1u << 27;
+    const unsigned int AVX     = 1u << 28;
+    const unsigned int F16C    = 1u << 29;
+    if( ( ecx & ( OSXSAVE | AVX | F16C ) ) != ( OSXSAVE | AVX | F16C ) )
+        return false;
+#if defined( _MSC_VER )
+    const unsigned long long xcr0 = _xgetbv( 0 );
+#else
+    unsigned int xcr0Low, xcr0High;
+    __asm__( "xgetbv" : "=a"( xcr0Low ), "=d"( xcr0High ) : "c"( 0 ) );
+    const unsigned long long xcr0 = xcr0Low;
+#endif
+    return ( xcr0 & 0x6 ) == 0x6;
+}
+
+bool hasF16C()
+{
+    static const bool supported = detectF16C();
+    return supported;
+}
+
+// Convert groups of 8 values, returning the number converted.
+OTK_TARGET_F16C size_t convertFloatToHalfF16C( const float* src, uint16_t* dst, size_t count )
+{
+    size_t i = 0;
+    for( ; i + 8 <= count; i += 8 )
+    {
+        const __m128i halves = _mm256_cvtps_ph( _mm256_loadu_ps( src + i ), _MM_FROUND_TO_NEAREST_INT );
+        _mm_storeu_si128( reinterpret_cast<__m128i*>( dst + i ), halves );
+    }
+    return i;
+}
+
+OTK_TARGET_F16C size_t convertHalfToFloatF16C( const uint16_t* src, float* dst, size_t count )
+{
+    size_t i = 0;
+    for( ; i + 8 <= count; i += 8 )
+    {
+        const __m128i halves = _mm_loadu_si128( reinterpret_cast<const __m128i*>( src + i ) );
+        _mm256_storeu_ps( dst + i, _mm256_cvtph_ps( halves ) );
+    }
+    return i;
+}
+
+#endif  // OTK_FORMAT_CONVERSION_F16C
+
+// NaN maps to zero, matching the SIMD min/max below.
+inline uint8_t floatToUnorm8( float value )
+{
+    const float clamped = value > 0.f ? ( value < 1.f ? value : 1.f ) : 0.f;
+    return static_cast<uint8_t>( clamped * 255.f + 0.5f );
+}
+
+}  // namespace
+
+bool canConvertFormat( CUarray_format srcFormat, CUarray_format dstFormat )
+{
+    return srcFormat == dstFormat                                                     //
+           || ( srcFormat == CU_AD_FORMAT_FLOAT && dstFormat == CU_AD_FORMAT_HALF )  //
+           || ( srcFormat == CU_AD_FORMAT_FLOAT && dstFormat == CU_AD_FORMAT_UNSIGNED_INT8 )
+           || ( srcFormat == CU_AD_FORMAT_HALF && dstFormat == CU_AD_FORMAT_UNSIGNED_INT8 );
+}
+
+void convertFormat( const char* src, CUarray_format srcFormat, char* dst, CUarray_format dstFormat, size_t numValues )
+{
+    OTK_ASSERT_MSG( canConvertFormat( srcFormat, dstFormat ), "Unsupported format conversion" );
+
+    if( srcFormat == dstFormat )
+        std::memcpy( dst, src, numValues * getBytesPerChannel( srcFormat ) );
+    else if( srcFormat == CU_AD_FORMAT_FLOAT && dstFormat == CU_AD_FORMAT_HALF )
+        convertFloatToHalf( reinterpret_cast<const float*>( src ), reinterpret_cast<uint16_t*>( dst ), numValues );
+    else if( srcFormat == CU_AD_FORMAT_FLOAT )
+        convertFloatToUnorm8( reinterpret_cast<const float*>( src ), reinterpret_cast<uint8_t*>( dst ), numValues );
+    else
+        convertHalfToUnorm8( reinterpret_cast<const uint16_t*>( src ), reinterpret_cast<uint8_t*>( dst ), numValues );
+}
+
+void convertFloatToHalf( const float* src, uint16_t* dst, size_t count )
+{
+    size_t i = 0;
+#ifdef OTK_FORMAT_CONVERSION_F16C
+    if( hasF16C() )
+        i = convertFloatToHalfF16C( src, dst, count );
+#endif
+    for( ; i < count; ++i )
+        dst[i] = floatToHalf( src[i] );
+}
+
+void convertHalfToFloat( const uint16_t* src, float* dst, size_t count )
+{
+    size_t i = 0;
+#ifdef OTK_FORMAT_CONVERSION_F16C
+    if( hasF16C() )
+        i = convertHalfToFloatF16C( src, dst, count );
+#endif
+    for( ; i < count; ++i )
+        dst[i] = halfToFloat( src[i] );
+}
+
+void convertFloatToUnorm8( const float* src, uint8_t* dst, size_t count )
+{
+    size_t i = 0;
+#ifdef OTK_FORMAT_CONVERSION_SSE2
+    // Convert 16 values at a time, packing the 32-bit results down to bytes with saturation.
+    const __m128 zero  = _mm_setzero_ps();
+    const __m128 one   = _mm_set1_ps( 1.f );
+    const __m128 scale = _mm_set1_ps( 255.f );
+    const __m128 bias  = _mm_set1_ps( 0.5f );
+    for( ; i + 16 <= count; i += 16 )
+    {
+        __m128i ints[4];
+        for( int j = 0; j < 4; ++j )
+        {
+            // _mm_max_ps returns its second operand when the first is NaN.
+            const __m128 clamped = _mm_min_ps( _mm_max_ps( _mm_loadu_ps( src + i + 4 * j ), zero ), one );
+            ints[j] = _mm_cvttps_epi32( _mm_add_ps( _mm_mul_ps( clamped, scale ), bias ) );
+        }
+        const __m128i shorts0 = _mm_packs_epi32( ints[0], ints[1] );
+        const __m128i shorts1 = _mm_packs_epi32( ints[2], ints[3] );
+        _mm_storeu_si128( reinterpret_cast<__m128i*>( dst + i ), _mm_packus_epi16( shorts0, shorts1 ) );
+    }
+#endif
+    for( ; i < count; ++i )
+        dst[i] = floatToUnorm8( src[i] );
+}
+
+void convertHalfToUnorm8( const uint16_t* src, uint8_t* dst, size_t count )
+{
+    // Widen to float in chunks that stay in the L1 cache.
+    const size_t CHUNK_SIZE = 256;
+    float        floats[CHUNK_SIZE];
+    for( size_t i = 0; i < count; i += CHUNK_SIZE )
+    {
+        const size_t chunk = ( count - i < CHUNK_SIZE ) ? count - i : CHUNK_SIZE;
+        convertHalfToFloat( src + i, floats, chunk );
+        convertFloatToUnorm8( floats, dst + i, chunk );
+    }
+}
+
+}  // namespace imageSource
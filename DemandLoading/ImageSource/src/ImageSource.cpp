@@ -31,6 +31,7 @@
 #include "Config.h"  // for OTK_USE_OIIO
 
 #include <OptiXToolkit/Error/cuErrorCheck.h>
+#include <OptiXToolkit/ImageSource/BlockCompressedReader.h>
 #include <OptiXToolkit/ImageSource/CheckerBoardImage.h>
 #include <OptiXToolkit/ImageSource/CoreEXRReader.h>
 #if OTK_USE_OIIO
@@ -67,8 +68,12 @@ bool ImageSourceBase::readMipTail( char*        dest,
         const uint2 levelDims = mipLevelDims[mipLevel];
         readMipLevel( dest + offset, mipLevel, levelDims.x, levelDims.y, stream );
 
-        // Increment offset.
-        offset += levelDims.x * levelDims.y * pixelSizeInBytes;
+        // Increment offset.  Block compressed levels are stored as rows of blocks.
+        const TextureInfo& info = getInfo();
+        if( isBlockCompressed( info.format ) )
+            offset += getImageSizeInBytes( info.format, info.numChannels, levelDims.x, levelDims.y );
+        else
+            offset += levelDims.x * levelDims.y * pixelSizeInBytes;
     }
 
     return true;
@@ -89,6 +94,10 @@ std::shared_ptr<ImageSource> createImageSource( const std::string& filename, con
     // Attempt relative path first, then absolute path.
     const std::string path = directory.empty() ? filename : ( fileExists( filename ) ? filename : directory + '/' + filename );
 
+    if( extension == ".dds" || extension == ".ktx2" )
+    {
+        return std::make_shared<BlockCompressedReader>( path );
+    }
 #if OTK_USE_OPENEXR    
     if( extension == ".exr" )
     {
@@ -202,6 +202,17 @@ bool MipMapImageSource::readTile( char* dest, unsigned mipLevel, const Tile& til
     return true;
 }
 
+bool MipMapImageSource::readTileHash( uint64_t& hash, unsigned int mipLevel, const Tile& tile )
+{
+    // Only tiles read directly from a mipmapped base image correspond to its stored tiles.
+    {
+        std::unique_lock<std::mutex> lock( m_dataMutex );
+        if( !m_mipMappedBase )
+            return false;
+    }
+    return WrappedImageSource::readTileHash( hash, mipLevel, tile );
+}
+
 bool MipMapImageSource::readMipLevel( char* dest, unsigned int mipLevel, unsigned int expectedWidth, unsigned int expectedHeight, CUstream stream )
 {
     {
@@ -27,6 +27,7 @@
 //
 
 #include <OptiXToolkit/ImageSource/OIIOReader.h>
+#include <OptiXToolkit/ImageSource/BaseColor.h>
 #include <OptiXToolkit/Error/cuErrorCheck.h>
 
 #include <cuda_runtime.h>
@@ -155,6 +156,12 @@ void OIIOReader::open( TextureInfo* info )
 
         m_baseColorWasRead = true;
     }
+    // Otherwise use the base color computed in an earlier run, if the file hasn't changed.
+    else if( m_readBaseColor && !m_baseColorWasRead )
+    {
+        std::lock_guard<std::mutex> guard( m_mutex );
+        m_baseColorWasRead = readBaseColorFile( m_filename, m_baseColor );
+    }
 
     if( info != nullptr )
         *info = m_info;
@@ -265,11 +272,23 @@ bool OIIOReader::readTile( char* dest, unsigned int mipLevel, const Tile& tile,
 
 bool OIIOReader::readBaseColor( float4& dest )
 {
+    std::lock_guard<std::mutex> guard( m_mutex );
     dest = m_baseColor;
     return m_baseColorWasRead;
 }
 
 
+void OIIOReader::writeBaseColor( const float4& baseColor )
+{
+    {
+        std::lock_guard<std::mutex> guard( m_mutex );
+        m_baseColor        = baseColor;
+        m_baseColorWasRead = true;
+    }
+    writeBaseColorFile( m_filename, baseColor );
+}
+
+
 bool OIIOReader::readMipLevel( char* dest, unsigned int mipLevel, unsigned int expectedWidth, unsigned int expectedHeight, CUstream stream )
 {
     return readMipLevel( dest, mipLevel, expectedWidth, expectedHeight, 1, stream );
@@ -66,9 +66,67 @@ unsigned int getBytesPerChannel( const CUarray_format format )
     }
 }
 
+bool isBlockCompressed( const CUarray_format format )
+{
+    switch( format )
+    {
+        case CU_AD_FORMAT_BC1_UNORM:
+        case CU_AD_FORMAT_BC1_UNORM_SRGB:
+        case CU_AD_FORMAT_BC2_UNORM:
+        case CU_AD_FORMAT_BC2_UNORM_SRGB:
+        case CU_AD_FORMAT_BC3_UNORM:
+        case CU_AD_FORMAT_BC3_UNORM_SRGB:
+        case CU_AD_FORMAT_BC4_UNORM:
+        case CU_AD_FORMAT_BC4_SNORM:
+        case CU_AD_FORMAT_BC5_UNORM:
+        case CU_AD_FORMAT_BC5_SNORM:
+        case CU_AD_FORMAT_BC6H_UF16:
+        case CU_AD_FORMAT_BC6H_SF16:
+        case CU_AD_FORMAT_BC7_UNORM:
+        case CU_AD_FORMAT_BC7_UNORM_SRGB:
+            return true;
+
+        default:
+            return false;
+    }
+}
+
+unsigned int getBytesPerBlock( const CUarray_format format )
+{
+    OTK_ASSERT_MSG( isBlockCompressed( format ), "Expected block compressed CUDA array format" );
+    switch( format )
+    {
+        case CU_AD_FORMAT_BC1_UNORM:
+        case CU_AD_FORMAT_BC1_UNORM_SRGB:
+        case CU_AD_FORMAT_BC4_UNORM:
+        case CU_AD_FORMAT_BC4_SNORM:
+            return 8;
+
+        default:
+            return 16;
+    }
+}
+
+size_t getRowSizeInBytes( const CUarray_format format, unsigned int numChannels, unsigned int width )
+{
+    if( isBlockCompressed( format ) )
+        return static_cast<size_t>( ( width + 3 ) / 4 ) * getBytesPerBlock( format );
+    return static_cast<size_t>( width ) * numChannels * getBytesPerChannel( format );
+}
+
+unsigned int getNumRows( const CUarray_format format, unsigned int height )
+{
+    return isBlockCompressed( format ) ? ( height + 3 ) / 4 : height;
+}
+
+size_t getImageSizeInBytes( const CUarray_format format, unsigned int numChannels, unsigned int width, unsigned int height )
+{
+    return getRowSizeInBytes( format, numChannels, width ) * getNumRows( format, height );
+}
+
 size_t getTextureSizeInBytes( const TextureInfo& info )
 {
-    size_t texSize = static_cast<size_t>( getBytesPerChannel( info.format ) ) * info.numChannels * info.width * info.height;
+    size_t texSize = getImageSizeInBytes( info.format, info.numChannels, info.width, info.height );
     if( info.numMipLevels > 1 )
         texSize = texSize * 4ULL / 3ULL;
     return texSize;
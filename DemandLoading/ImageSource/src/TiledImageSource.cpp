@@ -154,6 +154,17 @@ bool TiledImageSource::readTile( char* dest, unsigned int mipLevel, const Tile&
     return true;
 }
 
+bool TiledImageSource::readTileHash( uint64_t& hash, unsigned int mipLevel, const Tile& tile )
+{
+    // Only tiles read directly from a tiled base image correspond to its stored tiles.
+    {
+        std::unique_lock<std::mutex> lock( m_dataMutex );
+        if( !m_baseIsTiled )
+            return false;
+    }
+    return WrappedImageSource::readTileHash( hash, mipLevel, tile );
+}
+
 bool TiledImageSource::readMipTail( char*        dest,
                                     unsigned int mipTailFirstLevel,
                                     unsigned int numMipLevels,
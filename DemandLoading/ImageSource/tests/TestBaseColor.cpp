@@ -0,0 +1,224 @@
+//
+// Copyright (c) 2024, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <OptiXToolkit/ImageSource/BaseColor.h>
+#include <OptiXToolkit/ImageSource/FormatConversion.h>
+#include <OptiXToolkit/ImageSource/ImageSource.h>
+#include <OptiXToolkit/ImageSource/TextureInfo.h>
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace imageSource;
+
+namespace {
+
+// A single level image whose texels are given by the test, which is tiled if a tile size is given.
+class TexelImage : public ImageSourceBase
+{
+  public:
+    TexelImage( CUarray_format format, unsigned int numChannels, unsigned int width, unsigned int height, std::vector<char> texels,
+                unsigned int tileWidth = 0, unsigned int tileHeight = 0 )
+        : m_texels( std::move( texels ) )
+        , m_tileWidth( tileWidth )
+        , m_tileHeight( tileHeight )
+    {
+        m_info = TextureInfo{ width, height, format, numChannels, /*numMipLevels=*/1, /*isValid=*/true, /*isTiled=*/tileWidth > 0 };
+    }
+
+    void open( TextureInfo* info ) override
+    {
+        if( info )
+            *info = m_info;
+    }
+    void               close() override {}
+    bool               isOpen() const override { return true; }
+    const TextureInfo& getInfo() const override { return m_info; }
+    CUmemorytype       getFillType() const override { return CU_MEMORYTYPE_HOST; }
+    unsigned int       getTileWidth() const override { return m_tileWidth; }
+    unsigned int       getTileHeight() const override { return m_tileHeight; }
+    bool readTile( char* dest, unsigned int mipLevel, const Tile& tile, CUstream /*stream*/ ) override
+    {
+        if( mipLevel != 0 || tile.width != m_tileWidth || tile.height != m_tileHeight )
+            return false;
+        ++m_numTilesRead;
+
+        // Texels outside the image are left with garbage, which must not be averaged.
+        const size_t bytesPerPixel = getBytesPerChannel( m_info.format ) * m_info.numChannels;
+        std::memset( dest, 0x7f, tile.width * tile.height * bytesPerPixel );
+        const PixelPosition start = pixelPosition( tile );
+        for( unsigned int y = start.y; y < std::min( start.y + tile.height, m_info.height ); ++y )
+        {
+            const unsigned int width = std::min( tile.width, m_info.width - start.x );
+            std::memcpy( dest + ( y - start.y ) * tile.width * bytesPerPixel,
+                         m_texels.data() + ( y * m_info.width + start.x ) * bytesPerPixel, width * bytesPerPixel );
+        }
+        return true;
+    }
+    bool readMipLevel( char* dest, unsigned int mipLevel, unsigned int expectedWidth, unsigned int expectedHeight, CUstream /*stream*/ ) override
+    {
+        if( mipLevel != 0 || expectedWidth != m_info.width || expectedHeight != m_info.height )
+            return false;
+        std::memcpy( dest, m_texels.data(), m_texels.size() );
+        return true;
+    }
+    bool readBaseColor( float4& /*dest*/ ) override { return false; }
+
+    unsigned int m_numTilesRead = 0;
+
+  private:
+    TextureInfo       m_info{};
+    std::vector<char> m_texels;
+    unsigned int      m_tileWidth;
+    unsigned int      m_tileHeight;
+};
+
+template <typename T>
+std::vector<char> toBytes( const std::vector<T>& values )
+{
+    std::vector<char> bytes( values.size() * sizeof( T ) );
+    std::memcpy( bytes.data(), values.data(), bytes.size() );
+    return bytes;
+}
+
+void writeFile( const std::string& filename, const std::string& contents )
+{
+    std::ofstream file( filename, std::ios::out | std::ios::binary );
+    file << contents;
+}
+
+}  // namespace
+
+class TestBaseColor : public testing::Test
+{
+  protected:
+    void TearDown() override
+    {
+        std::remove( m_imageFile.c_str() );
+        std::remove( ( m_imageFile + ".basecolor" ).c_str() );
+    }
+
+    const std::string m_imageFile{ "TestBaseColor.img" };
+};
+
+TEST_F( TestBaseColor, AveragesFloatTexels )
+{
+    TexelImage image( CU_AD_FORMAT_FLOAT, 4, 2, 1, toBytes( std::vector<float>{ 1.f, 0.f, 0.5f, 1.f, 0.f, 1.f, 0.5f, 0.f } ) );
+
+    float4 color{};
+    ASSERT_TRUE( computeBaseColor( image, color ) );
+
+    EXPECT_FLOAT_EQ( 0.5f, color.x );
+    EXPECT_FLOAT_EQ( 0.5f, color.y );
+    EXPECT_FLOAT_EQ( 0.5f, color.z );
+    EXPECT_FLOAT_EQ( 0.5f, color.w );
+}
+
+TEST_F( TestBaseColor, AveragesHalfTexels )
+{
+    const std::vector<float> floats{ 0.25f, 0.75f, 0.5f, 1.f };
+    std::vector<uint16_t>    halfs( floats.size() );
+    convertFloatToHalf( floats.data(), halfs.data(), floats.size() );
+    TexelImage image( CU_AD_FORMAT_HALF, 1, 2, 2, toBytes( halfs ) );
+
+    float4 color{};
+    ASSERT_TRUE( computeBaseColor( image, color ) );
+
+    EXPECT_FLOAT_EQ( 0.625f, color.x );
+    EXPECT_EQ( 0.f, color.y );
+}
+
+TEST_F( TestBaseColor, NormalizesIntegerTexels )
+{
+    TexelImage image( CU_AD_FORMAT_UNSIGNED_INT8, 2, 2, 1, toBytes( std::vector<uint8_t>{ 255, 0, 0, 51 } ) );
+
+    float4 color{};
+    ASSERT_TRUE( computeBaseColor( image, color ) );
+
+    EXPECT_FLOAT_EQ( 0.5f, color.x );
+    EXPECT_FLOAT_EQ( 0.1f, color.y );
+}
+
+TEST_F( TestBaseColor, AveragesTiledImageByTile )
+{
+    // A 3x3 image read in 2x2 tiles, with partial tiles along the right and bottom edges.
+    TexelImage image( CU_AD_FORMAT_FLOAT, 1, 3, 3, toBytes( std::vector<float>{ 1.f, 2.f, 3.f, 4.f, 5.f, 6.f, 7.f, 8.f, 9.f } ), 2, 2 );
+
+    float4 color{};
+    ASSERT_TRUE( computeBaseColor( image, color ) );
+
+    EXPECT_FLOAT_EQ( 5.f, color.x );
+    EXPECT_EQ( 4U, image.m_numTilesRead );
+}
+
+TEST_F( TestBaseColor, SkipsBlockCompressedImages )
+{
+    TexelImage image( CU_AD_FORMAT_BC1_UNORM, 4, 4, 4, std::vector<char>( 8 ) );
+
+    float4 color{};
+    EXPECT_FALSE( computeBaseColor( image, color ) );
+}
+
+TEST_F( TestBaseColor, CachesBaseColorAlongsideFile )
+{
+    writeFile( m_imageFile, "image" );
+    float4 color{};
+    EXPECT_FALSE( readBaseColorFile( m_imageFile, color ) );
+
+    writeBaseColorFile( m_imageFile, float4{ 0.1f, 0.2f, 0.3f, 0.4f } );
+    ASSERT_TRUE( readBaseColorFile( m_imageFile, color ) );
+
+    EXPECT_EQ( 0.1f, color.x );
+    EXPECT_EQ( 0.2f, color.y );
+    EXPECT_EQ( 0.3f, color.z );
+    EXPECT_EQ( 0.4f, color.w );
+}
+
+TEST_F( TestBaseColor, IgnoresCacheOfChangedFile )
+{
+    writeFile( m_imageFile, "image" );
+    writeBaseColorFile( m_imageFile, float4{ 0.1f, 0.2f, 0.3f, 0.4f } );
+
+    writeFile( m_imageFile, "changed image" );
+    float4 color{};
+    EXPECT_FALSE( readBaseColorFile( m_imageFile, color ) );
+}
+
+TEST_F( TestBaseColor, IgnoresCacheOfMissingFile )
+{
+    float4 color{};
+    EXPECT_FALSE( readBaseColorFile( m_imageFile, color ) );
+    writeBaseColorFile( m_imageFile, float4{ 0.1f, 0.2f, 0.3f, 0.4f } );
+    EXPECT_FALSE( readBaseColorFile( m_imageFile, color ) );
+}
@@ -0,0 +1,258 @@
+//
+// Copyright (c) 2024, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "ImageSourceTestConfig.h"  // generated from ImageSourceTestConfig.h.in
+
+#include <OptiXToolkit/ImageSource/BlockCompressedReader.h>
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace imageSource;
+
+// The sample files were written so that the first three bytes of each block are its mip level and
+// block coordinates.  The remaining bytes are (16 * mipLevel + byteIndex).
+class TestBlockCompressedReader : public testing::Test
+{
+  protected:
+    static std::string getTexturePath( const char* filename ) { return getSourceDir() + "/Textures/" + filename; }
+
+    static void expectBlock( const char* block, unsigned int mipLevel, unsigned int blockX, unsigned int blockY )
+    {
+        EXPECT_EQ( mipLevel, static_cast<unsigned char>( block[0] ) );
+        EXPECT_EQ( blockX, static_cast<unsigned char>( block[1] ) );
+        EXPECT_EQ( blockY, static_cast<unsigned char>( block[2] ) );
+    }
+};
+
+TEST_F( TestBlockCompressedReader, OpenDDS )
+{
+    BlockCompressedReader reader( getTexturePath( "BC1MipMapped16x16.dds" ) );
+    TextureInfo           info{};
+    reader.open( &info );
+
+    EXPECT_TRUE( info.isValid );
+    EXPECT_TRUE( info.isTiled );
+    EXPECT_EQ( 16U, info.width );
+    EXPECT_EQ( 16U, info.height );
+    EXPECT_EQ( CU_AD_FORMAT_BC1_UNORM, info.format );
+    EXPECT_EQ( 4U, info.numChannels );
+    EXPECT_EQ( 5U, info.numMipLevels );
+    EXPECT_EQ( 128U * 4U / 3U, getTextureSizeInBytes( info ) );
+}
+
+TEST_F( TestBlockCompressedReader, ReadTile )
+{
+    BlockCompressedReader reader( getTexturePath( "BC1MipMapped16x16.dds" ) );
+    reader.open( nullptr );
+
+    // An 8x8 tile holds 2x2 blocks of 8 bytes.
+    std::vector<char> buffer( 4 * 8 );
+    EXPECT_TRUE( reader.readTile( buffer.data(), 0, Tile{ 1, 1, 8, 8 }, CUstream{} ) );
+    expectBlock( &buffer[0], 0, 2, 2 );
+    expectBlock( &buffer[8], 0, 3, 2 );
+    expectBlock( &buffer[16], 0, 2, 3 );
+    expectBlock( &buffer[24], 0, 3, 3 );
+    EXPECT_EQ( 1ULL, reader.getNumTilesRead() );
+}
+
+TEST_F( TestBlockCompressedReader, ReadTilesConcurrently )
+{
+    BlockCompressedReader reader( getTexturePath( "BC1MipMapped16x16.dds" ) );
+    reader.open( nullptr );
+    const unsigned long long numBytesRead = reader.getNumBytesRead();
+
+    // Each thread reads one of the four 8x8 tiles of the finest level many times.
+    const unsigned int       numReads = 100;
+    std::vector<std::thread> threads;
+    for( unsigned int tileIndex = 0; tileIndex < 4; ++tileIndex )
+    {
+        threads.emplace_back( [&reader, tileIndex, numReads] {
+            const unsigned int tileX = tileIndex % 2;
+            const unsigned int tileY = tileIndex / 2;
+            std::vector<char>  buffer( 4 * 8 );
+            for( unsigned int i = 0; i < numReads; ++i )
+            {
+                ASSERT_TRUE( reader.readTile( buffer.data(), 0, Tile{ tileX, tileY, 8, 8 }, CUstream{} ) );
+                expectBlock( &buffer[24], 0, 2 * tileX + 1, 2 * tileY + 1 );
+            }
+        } );
+    }
+    for( std::thread& thread : threads )
+        thread.join();
+    EXPECT_EQ( 4ULL * numReads, reader.getNumTilesRead() );
+    EXPECT_EQ( numBytesRead + 4ULL * numReads * 4 * 8, reader.getNumBytesRead() );
+}
+
+TEST_F( TestBlockCompressedReader, ReadPartialTile )
+{
+    BlockCompressedReader reader( getTexturePath( "BC1MipMapped16x16.dds" ) );
+    reader.open( nullptr );
+
+    // Mip level 2 is 4x4 pixels, a single block.  The rest of the tile is zero.
+    std::vector<char> buffer( 4 * 8, 1 );
+    EXPECT_TRUE( reader.readTile( buffer.data(), 2, Tile{ 0, 0, 8, 8 }, CUstream{} ) );
+    expectBlock( &buffer[0], 2, 0, 0 );
+    for( size_t i = 8; i < buffer.size(); ++i )
+        EXPECT_EQ( 0, buffer[i] );
+}
+
+TEST_F( TestBlockCompressedReader, ReadMipLevel )
+{
+    BlockCompressedReader reader( getTexturePath( "BC1MipMapped16x16.dds" ) );
+    reader.open( nullptr );
+
+    std::vector<char> buffer( getImageSizeInBytes( CU_AD_FORMAT_BC1_UNORM, 4, 8, 8 ) );
+    ASSERT_EQ( 32U, buffer.size() );
+    EXPECT_TRUE( reader.readMipLevel( buffer.data(), 1, 8, 8, CUstream{} ) );
+    expectBlock( &buffer[0], 1, 0, 0 );
+    expectBlock( &buffer[8], 1, 1, 0 );
+    expectBlock( &buffer[16], 1, 0, 1 );
+    expectBlock( &buffer[24], 1, 1, 1 );
+}
+
+TEST_F( TestBlockCompressedReader, ReadMipTail )
+{
+    BlockCompressedReader reader( getTexturePath( "BC1MipMapped16x16.dds" ) );
+    reader.open( nullptr );
+
+    // Levels smaller than 4x4 pixels still occupy a whole block.
+    const uint2       levelDims[] = { { 16, 16 }, { 8, 8 }, { 4, 4 }, { 2, 2 }, { 1, 1 } };
+    std::vector<char> buffer( 3 * 8 );
+    EXPECT_TRUE( reader.readMipTail( buffer.data(), 2, 5, levelDims, 0, CUstream{} ) );
+    expectBlock( &buffer[0], 2, 0, 0 );
+    expectBlock( &buffer[8], 3, 0, 0 );
+    expectBlock( &buffer[16], 4, 0, 0 );
+}
+
+TEST_F( TestBlockCompressedReader, BaseColorBC1 )
+{
+    BlockCompressedReader reader( getTexturePath( "BC1MipMapped16x16.dds" ) );
+    reader.open( nullptr );
+
+    // The 1x1 block has color0 = 0x0004 and texel 0 uses color0.
+    float4 color{};
+    EXPECT_TRUE( reader.readBaseColor( color ) );
+    EXPECT_FLOAT_EQ( 0.f, color.x );
+    EXPECT_FLOAT_EQ( 0.f, color.y );
+    EXPECT_FLOAT_EQ( 4.f / 31.f, color.z );
+    EXPECT_FLOAT_EQ( 1.f, color.w );
+}
+
+TEST_F( TestBlockCompressedReader, OpenDDSWithDX10Header )
+{
+    BlockCompressedReader reader( getTexturePath( "BC5MipMapped16x8.dds" ) );
+    TextureInfo           info{};
+    reader.open( &info );
+
+    EXPECT_EQ( 16U, info.width );
+    EXPECT_EQ( 8U, info.height );
+    EXPECT_EQ( CU_AD_FORMAT_BC5_UNORM, info.format );
+    EXPECT_EQ( 2U, info.numChannels );
+    EXPECT_EQ( 5U, info.numMipLevels );
+
+    std::vector<char> buffer( 16 );
+    EXPECT_TRUE( reader.readTile( buffer.data(), 0, Tile{ 3, 1, 4, 4 }, CUstream{} ) );
+    expectBlock( buffer.data(), 0, 3, 1 );
+
+    // Red uses texel index 0 of (4, 0).  Green uses index 2 of (72, 73), which has six values.
+    float4 color{};
+    EXPECT_TRUE( reader.readBaseColor( color ) );
+    EXPECT_FLOAT_EQ( 4.f / 255.f, color.x );
+    EXPECT_FLOAT_EQ( ( 4.f * 72.f / 255.f + 73.f / 255.f ) / 5.f, color.y );
+    EXPECT_FLOAT_EQ( 0.f, color.z );
+    EXPECT_FLOAT_EQ( 1.f, color.w );
+}
+
+TEST_F( TestBlockCompressedReader, OpenKTX2 )
+{
+    BlockCompressedReader reader( getTexturePath( "BC7MipMapped16x16.ktx2" ) );
+    TextureInfo           info{};
+    reader.open( &info );
+
+    EXPECT_EQ( 16U, info.width );
+    EXPECT_EQ( 16U, info.height );
+    EXPECT_EQ( CU_AD_FORMAT_BC7_UNORM, info.format );
+    EXPECT_EQ( 4U, info.numChannels );
+    EXPECT_EQ( 5U, info.numMipLevels );
+
+    // The KTX2 file stores the coarsest level first.
+    std::vector<char> buffer( 16 * 16 );
+    EXPECT_TRUE( reader.readMipLevel( buffer.data(), 0, 16, 16, CUstream{} ) );
+    expectBlock( &buffer[0], 0, 0, 0 );
+    expectBlock( &buffer[16 * 5], 0, 1, 1 );
+    expectBlock( &buffer[16 * 15], 0, 3, 3 );
+
+    EXPECT_TRUE( reader.readTile( buffer.data(), 1, Tile{ 0, 0, 8, 8 }, CUstream{} ) );
+    expectBlock( &buffer[16 * 3], 1, 1, 1 );
+
+    // BC7 blocks are not decoded.
+    float4 color{};
+    EXPECT_FALSE( reader.readBaseColor( color ) );
+}
+
+TEST_F( TestBlockCompressedReader, CreateImageSource )
+{
+    std::shared_ptr<ImageSource> image( createImageSource( getTexturePath( "BC7MipMapped16x16.ktx2" ) ) );
+    EXPECT_TRUE( std::dynamic_pointer_cast<BlockCompressedReader>( image ) );
+}
+
+TEST_F( TestBlockCompressedReader, RejectsOtherFiles )
+{
+    BlockCompressedReader missing( getTexturePath( "Missing.dds" ) );
+    EXPECT_THROW( missing.open( nullptr ), std::runtime_error );
+
+    BlockCompressedReader exr( getTexturePath( "TiledMipMapped.exr" ) );
+    EXPECT_THROW( exr.open( nullptr ), std::runtime_error );
+}
+
+TEST_F( TestBlockCompressedReader, DecodeFirstTexel )
+{
+    // BC4 with a0 < a1 has six interpolated values plus 0 and 1; index 7 is 1.
+    const unsigned char bc4[8] = { 10, 20, 7, 0, 0, 0, 0, 0 };
+    float4              color{};
+    EXPECT_TRUE( decodeFirstTexel( reinterpret_cast<const char*>( bc4 ), CU_AD_FORMAT_BC4_UNORM, color ) );
+    EXPECT_FLOAT_EQ( 1.f, color.x );
+
+    // Signed BC4 with a0 > a1 interpolates eight values.
+    const unsigned char bc4s[8] = { 127, 0x81, 1, 0, 0, 0, 0, 0 };
+    EXPECT_TRUE( decodeFirstTexel( reinterpret_cast<const char*>( bc4s ), CU_AD_FORMAT_BC4_SNORM, color ) );
+    EXPECT_FLOAT_EQ( -1.f, color.x );
+
+    // BC1 with color0 <= color1 has a transparent black entry.
+    const unsigned char bc1[8] = { 0x00, 0x00, 0xFF, 0xFF, 3, 0, 0, 0 };
+    EXPECT_TRUE( decodeFirstTexel( reinterpret_cast<const char*>( bc1 ), CU_AD_FORMAT_BC1_UNORM, color ) );
+    EXPECT_FLOAT_EQ( 0.f, color.w );
+
+    const char bc7[16] = {};
+    EXPECT_FALSE( decodeFirstTexel( bc7, CU_AD_FORMAT_BC7_UNORM, color ) );
+}
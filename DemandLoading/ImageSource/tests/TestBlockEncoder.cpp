@@ -0,0 +1,323 @@
+//
+// Copyright (c) 2024, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <OptiXToolkit/ImageSource/BlockEncoder.h>
+#include <OptiXToolkit/ImageSource/TextureInfo.h>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+
+using namespace imageSource;
+
+namespace {
+
+unsigned int getBits( const uint8_t* block, unsigned int& position, unsigned int count )
+{
+    unsigned int value = 0;
+    for( unsigned int bit = 0; bit < count; ++bit, ++position )
+        value |= ( ( block[position / 8] >> ( position % 8 ) ) & 1 ) << bit;
+    return value;
+}
+
+void expand565( unsigned int color, int* rgb )
+{
+    const int r = ( color >> 11 ) & 31;
+    const int g = ( color >> 5 ) & 63;
+    const int b = color & 31;
+    rgb[0]      = ( r << 3 ) | ( r >> 2 );
+    rgb[1]      = ( g << 2 ) | ( g >> 4 );
+    rgb[2]      = ( b << 3 ) | ( b >> 2 );
+}
+
+// Decode a four color mode BC1 block to RGB.
+void decodeBC1( const uint8_t* block, int ( *rgb )[3] )
+{
+    int palette[4][3];
+    expand565( block[0] | ( block[1] << 8 ), palette[0] );
+    expand565( block[2] | ( block[3] << 8 ), palette[1] );
+    for( int c = 0; c < 3; ++c )
+    {
+        palette[2][c] = ( 2 * palette[0][c] + palette[1][c] + 1 ) / 3;
+        palette[3][c] = ( palette[0][c] + 2 * palette[1][c] + 1 ) / 3;
+    }
+    for( int i = 0; i < 16; ++i )
+    {
+        const int index = ( block[4 + i / 4] >> ( 2 * ( i % 4 ) ) ) & 3;
+        std::copy( palette[index], palette[index] + 3, rgb[i] );
+    }
+}
+
+void decodeBC4( const uint8_t* block, int* values )
+{
+    const int value0 = block[0];
+    const int value1 = block[1];
+    int       palette[8] = {value0, value1};
+    if( value0 > value1 )
+    {
+        for( int i = 2; i < 8; ++i )
+            palette[i] = ( ( 8 - i ) * value0 + ( i - 1 ) * value1 + 3 ) / 7;
+    }
+    else
+    {
+        for( int i = 2; i < 6; ++i )
+            palette[i] = ( ( 6 - i ) * value0 + ( i - 1 ) * value1 + 2 ) / 5;
+        palette[6] = 0;
+        palette[7] = 255;
+    }
+    unsigned int position = 16;
+    for( int i = 0; i < 16; ++i )
+        values[i] = palette[getBits( block, position, 3 )];
+}
+
+// Decode a mode 6 BC7 block to RGBA.
+void decodeBC7Mode6( const uint8_t* block, int ( *rgba )[4] )
+{
+    const int    weights[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+    unsigned int position    = 7;
+    int          endpoints[2][4];
+    for( int c = 0; c < 4; ++c )
+    {
+        endpoints[0][c] = getBits( block, position, 7 );
+        endpoints[1][c] = getBits( block, position, 7 );
+    }
+    const int pbit0 = getBits( block, position, 1 );
+    const int pbit1 = getBits( block, position, 1 );
+    for( int i = 0; i < 16; ++i )
+    {
+        const int weight = weights[getBits( block, position, i == 0 ? 3 : 4 )];
+        for( int c = 0; c < 4; ++c )
+        {
+            const int e0 = endpoints[0][c] * 2 + pbit0;
+            const int e1 = endpoints[1][c] * 2 + pbit1;
+            rgba[i][c]   = ( ( 64 - weight ) * e0 + weight * e1 + 32 ) >> 6;
+        }
+    }
+}
+
+// Make a block of RGBA pixels with a diagonal gradient between two colors and some noise.
+std::vector<uint8_t> makeGradientBlock( unsigned int seed )
+{
+    std::srand( seed );
+    const int            from[4] = {20, 200, 60, 255};
+    const int            to[4]   = {230, 40, 90, 128};
+    std::vector<uint8_t> rgba( 64 );
+    for( int i = 0; i < 16; ++i )
+    {
+        const int t = ( i % 4 ) + ( i / 4 );
+        for( int c = 0; c < 4; ++c )
+        {
+            const int value = from[c] + ( to[c] - from[c] ) * t / 6 + std::rand() % 9 - 4;
+            rgba[4 * i + c] = static_cast<uint8_t>( std::min( std::max( value, 0 ), 255 ) );
+        }
+    }
+    return rgba;
+}
+
+int bc1Error( const std::vector<uint8_t>& rgba, EncodeQuality quality )
+{
+    uint8_t block[8];
+    int     decoded[16][3];
+    encodeBC1Block( rgba.data(), block, quality );
+    decodeBC1( block, decoded );
+    int error = 0;
+    for( int i = 0; i < 16; ++i )
+        for( int c = 0; c < 3; ++c )
+            error += ( decoded[i][c] - rgba[4 * i + c] ) * ( decoded[i][c] - rgba[4 * i + c] );
+    return error;
+}
+
+int bc7Error( const std::vector<uint8_t>& rgba, EncodeQuality quality, int* maxDifference = nullptr )
+{
+    uint8_t block[16];
+    int     decoded[16][4];
+    encodeBC7Block( rgba.data(), block, quality );
+    decodeBC7Mode6( block, decoded );
+    int error = 0;
+    for( int i = 0; i < 16; ++i )
+    {
+        for( int c = 0; c < 4; ++c )
+        {
+            const int difference = decoded[i][c] - rgba[4 * i + c];
+            error += difference * difference;
+            if( maxDifference )
+                *maxDifference = std::max( *maxDifference, std::abs( difference ) );
+        }
+    }
+    return error;
+}
+
+}  // namespace
+
+class TestBlockEncoder : public testing::Test
+{
+};
+
+TEST_F( TestBlockEncoder, CanEncodeBlocks )
+{
+    EXPECT_TRUE( canEncodeBlocks( CU_AD_FORMAT_FLOAT, 4, CU_AD_FORMAT_BC1_UNORM ) );
+    EXPECT_TRUE( canEncodeBlocks( CU_AD_FORMAT_HALF, 4, CU_AD_FORMAT_BC7_UNORM ) );
+    EXPECT_TRUE( canEncodeBlocks( CU_AD_FORMAT_UNSIGNED_INT8, 1, CU_AD_FORMAT_BC4_UNORM ) );
+    EXPECT_TRUE( canEncodeBlocks( CU_AD_FORMAT_FLOAT, 2, CU_AD_FORMAT_BC5_UNORM ) );
+    EXPECT_FALSE( canEncodeBlocks( CU_AD_FORMAT_FLOAT, 1, CU_AD_FORMAT_BC1_UNORM ) );
+    EXPECT_FALSE( canEncodeBlocks( CU_AD_FORMAT_FLOAT, 4, CU_AD_FORMAT_BC4_UNORM ) );
+    EXPECT_FALSE( canEncodeBlocks( CU_AD_FORMAT_UNSIGNED_INT16, 4, CU_AD_FORMAT_BC7_UNORM ) );
+    EXPECT_FALSE( canEncodeBlocks( CU_AD_FORMAT_FLOAT, 4, CU_AD_FORMAT_HALF ) );
+}
+
+TEST_F( TestBlockEncoder, BC1SolidColor )
+{
+    const std::vector<uint8_t> rgba = {255, 0, 0, 255, 255, 0, 0, 255, 255, 0, 0, 255, 255, 0, 0, 255,
+                                       255, 0, 0, 255, 255, 0, 0, 255, 255, 0, 0, 255, 255, 0, 0, 255,
+                                       255, 0, 0, 255, 255, 0, 0, 255, 255, 0, 0, 255, 255, 0, 0, 255,
+                                       255, 0, 0, 255, 255, 0, 0, 255, 255, 0, 0, 255, 255, 0, 0, 255};
+    EXPECT_EQ( 0, bc1Error( rgba, ENCODE_FAST ) );
+    EXPECT_EQ( 0, bc1Error( rgba, ENCODE_HIGH_QUALITY ) );
+}
+
+TEST_F( TestBlockEncoder, BC1Gradient )
+{
+    for( unsigned int seed = 1; seed <= 16; ++seed )
+    {
+        const std::vector<uint8_t> rgba = makeGradientBlock( seed );
+        const int fastError = bc1Error( rgba, ENCODE_FAST );
+        const int highError = bc1Error( rgba, ENCODE_HIGH_QUALITY );
+        EXPECT_LE( highError, fastError );
+        EXPECT_LT( highError, 16 * 3 * 16 * 16 );  // RMS error below 16
+    }
+}
+
+TEST_F( TestBlockEncoder, BC4TwoValuesAreExact )
+{
+    uint8_t values[16];
+    for( int i = 0; i < 16; ++i )
+        values[i] = ( i % 3 == 0 ) ? 17 : 201;
+    uint8_t block[8];
+    int     decoded[16];
+    encodeBC4Block( values, block, ENCODE_FAST );
+    decodeBC4( block, decoded );
+    for( int i = 0; i < 16; ++i )
+        EXPECT_EQ( values[i], decoded[i] );
+}
+
+TEST_F( TestBlockEncoder, BC4Gradient )
+{
+    uint8_t values[16];
+    for( int i = 0; i < 16; ++i )
+        values[i] = static_cast<uint8_t>( 10 + i * 13 );
+    for( EncodeQuality quality : {ENCODE_FAST, ENCODE_HIGH_QUALITY} )
+    {
+        uint8_t block[8];
+        int     decoded[16];
+        encodeBC4Block( values, block, quality );
+        decodeBC4( block, decoded );
+        for( int i = 0; i < 16; ++i )
+            EXPECT_NEAR( values[i], decoded[i], 16 );
+    }
+}
+
+TEST_F( TestBlockEncoder, BC4HighQualityUsesExtremes )
+{
+    // Black and white pixels with midtones are represented exactly by the six value mode.
+    uint8_t values[16];
+    for( int i = 0; i < 16; ++i )
+        values[i] = ( i < 4 ) ? 0 : ( i < 8 ) ? 255 : static_cast<uint8_t>( 100 + i );
+    uint8_t block[8];
+    int     decoded[16];
+    encodeBC4Block( values, block, ENCODE_HIGH_QUALITY );
+    EXPECT_LE( block[0], block[1] );
+    decodeBC4( block, decoded );
+    for( int i = 0; i < 8; ++i )
+        EXPECT_EQ( values[i], decoded[i] );
+}
+
+TEST_F( TestBlockEncoder, BC7Gradient )
+{
+    for( unsigned int seed = 1; seed <= 16; ++seed )
+    {
+        const std::vector<uint8_t> rgba = makeGradientBlock( seed );
+        int       maxDifference = 0;
+        const int fastError     = bc7Error( rgba, ENCODE_FAST );
+        const int highError     = bc7Error( rgba, ENCODE_HIGH_QUALITY, &maxDifference );
+        EXPECT_LE( highError, fastError );
+        EXPECT_LE( maxDifference, 16 );
+    }
+}
+
+TEST_F( TestBlockEncoder, BC7BlockLayout )
+{
+    // Reverse the gradient, so the first pixel is nearest the second endpoint of the bounding box.
+    // The endpoints are swapped when encoding, since the high bit of the first index is implicit.
+    std::vector<uint8_t> rgba = makeGradientBlock( 7 );
+    for( int i = 0; i < 8; ++i )
+        std::swap_ranges( &rgba[4 * i], &rgba[4 * i + 4], &rgba[4 * ( 15 - i )] );
+
+    uint8_t block[16];
+    encodeBC7Block( rgba.data(), block, ENCODE_FAST );
+    EXPECT_EQ( 0x40, block[0] & 0x7F );  // mode 6
+
+    int decoded[16][4];
+    decodeBC7Mode6( block, decoded );
+    for( int i = 0; i < 16; ++i )
+        for( int c = 0; c < 4; ++c )
+            EXPECT_NEAR( rgba[4 * i + c], decoded[i][c], 16 );
+}
+
+TEST_F( TestBlockEncoder, EncodeFloatImageWithPartialBlocks )
+{
+    // A 6x5 image has 2x2 blocks, the right and bottom ones partially padded.
+    const unsigned int width = 6, height = 5;
+    std::vector<float> image( width * height * 2 );
+    for( unsigned int y = 0; y < height; ++y )
+    {
+        for( unsigned int x = 0; x < width; ++x )
+        {
+            image[2 * ( y * width + x )]     = 0.25f;
+            image[2 * ( y * width + x ) + 1] = ( x < 4 ) ? 1.f : 0.f;
+        }
+    }
+    std::vector<char> blocks( getImageSizeInBytes( CU_AD_FORMAT_BC5_UNORM, 2, width, height ) );
+    ASSERT_EQ( 4U * 16U, blocks.size() );
+    encodeBlocks( reinterpret_cast<const char*>( image.data() ), CU_AD_FORMAT_FLOAT, 2, width, height, blocks.data(),
+                  CU_AD_FORMAT_BC5_UNORM, ENCODE_FAST );
+
+    for( unsigned int blockIndex = 0; blockIndex < 4; ++blockIndex )
+    {
+        const uint8_t* block = reinterpret_cast<const uint8_t*>( blocks.data() ) + 16 * blockIndex;
+        int            red[16], green[16];
+        decodeBC4( block, red );
+        decodeBC4( block + 8, green );
+        for( int i = 0; i < 16; ++i )
+        {
+            EXPECT_EQ( 64, red[i] );
+            EXPECT_EQ( ( blockIndex % 2 == 0 ) ? 255 : 0, green[i] );
+        }
+    }
+}
@@ -0,0 +1,112 @@
+//
+// Copyright (c) 2024, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <OptiXToolkit/ImageSource/FileUtil.h>
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+using namespace imageSource;
+
+namespace {
+
+std::string readFile( const std::string& path )
+{
+    std::ifstream file( path, std::ios::binary );
+    return std::string( std::istreambuf_iterator<char>( file ), std::istreambuf_iterator<char>() );
+}
+
+}  // namespace
+
+class TestFileUtil : public testing::Test
+{
+  protected:
+    void TearDown() override { std::remove( m_path.c_str() ); }
+
+    const std::string m_path{ testing::TempDir() + "TestFileUtil.dat" };
+};
+
+TEST_F( TestFileUtil, WritesFile )
+{
+    const std::string contents( "contents" );
+    ASSERT_TRUE( writeFileAtomically( m_path, contents.data(), contents.size() ) );
+    EXPECT_EQ( contents, readFile( m_path ) );
+}
+
+TEST_F( TestFileUtil, ReplacesExistingFile )
+{
+    const std::string oldContents( "old contents" );
+    const std::string newContents( "new" );
+    ASSERT_TRUE( writeFileAtomically( m_path, oldContents.data(), oldContents.size() ) );
+    ASSERT_TRUE( writeFileAtomically( m_path, newContents.data(), newContents.size() ) );
+    EXPECT_EQ( newContents, readFile( m_path ) );
+}
+
+TEST_F( TestFileUtil, FailsInMissingDirectory )
+{
+    const std::string contents( "contents" );
+    EXPECT_FALSE( writeFileAtomically( testing::TempDir() + "no/such/directory/file.dat", contents.data(), contents.size() ) );
+}
+
+TEST_F( TestFileUtil, ReadsAtOffset )
+{
+    const std::string contents( "0123456789" );
+    ASSERT_TRUE( writeFileAtomically( m_path, contents.data(), contents.size() ) );
+
+    PositionalFile file;
+    ASSERT_TRUE( file.open( m_path ) );
+    EXPECT_EQ( contents.size(), file.getSize() );
+    char buffer[4]{};
+    ASSERT_EQ( 4U, file.read( buffer, 3, 4 ) );
+    EXPECT_EQ( "3456", std::string( buffer, 4 ) );
+    ASSERT_EQ( 2U, file.read( buffer, 1, 2 ) );
+    EXPECT_EQ( "12", std::string( buffer, 2 ) );
+}
+
+TEST_F( TestFileUtil, ReadsPartiallyAtEnd )
+{
+    const std::string contents( "0123456789" );
+    ASSERT_TRUE( writeFileAtomically( m_path, contents.data(), contents.size() ) );
+
+    PositionalFile file;
+    ASSERT_TRUE( file.open( m_path ) );
+    char buffer[4]{};
+    EXPECT_EQ( 2U, file.read( buffer, 8, 4 ) );
+    EXPECT_EQ( 0U, file.read( buffer, 20, 4 ) );
+}
+
+TEST_F( TestFileUtil, FailsToOpenMissingFile )
+{
+    PositionalFile file;
+    EXPECT_FALSE( file.open( testing::TempDir() + "no/such/directory/file.dat" ) );
+    EXPECT_FALSE( file.isOpen() );
+}
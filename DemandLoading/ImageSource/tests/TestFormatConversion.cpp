@@ -0,0 +1,157 @@
+//
+// Copyright (c) 2024, NVIDIA CORPORATION. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <OptiXToolkit/ImageSource/FormatConversion.h>
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+using namespace imageSource;
+
+namespace {
+
+uint16_t toHalf( float value )
+{
+    uint16_t result;
+    convertFloatToHalf( &value, &result, 1 );
+    return result;
+}
+
+float fromBits( uint32_t bits )
+{
+    float result;
+    std::memcpy( &result, &bits, sizeof( result ) );
+    return result;
+}
+
+}  // namespace
+
+class TestFormatConversion : public testing::Test
+{
+};
+
+TEST_F( TestFormatConversion, CanConvertFormat )
+{
+    EXPECT_TRUE( canConvertFormat( CU_AD_FORMAT_FLOAT, CU_AD_FORMAT_HALF ) );
+    EXPECT_TRUE( canConvertFormat( CU_AD_FORMAT_FLOAT, CU_AD_FORMAT_UNSIGNED_INT8 ) );
+    EXPECT_TRUE( canConvertFormat( CU_AD_FORMAT_HALF, CU_AD_FORMAT_UNSIGNED_INT8 ) );
+    EXPECT_TRUE( canConvertFormat( CU_AD_FORMAT_UNSIGNED_INT8, CU_AD_FORMAT_UNSIGNED_INT8 ) );
+    EXPECT_FALSE( canConvertFormat( CU_AD_FORMAT_HALF, CU_AD_FORMAT_FLOAT ) );
+    EXPECT_FALSE( canConvertFormat( CU_AD_FORMAT_UNSIGNED_INT8, CU_AD_FORMAT_HALF ) );
+}
+
+TEST_F( TestFormatConversion, FloatToHalf )
+{
+    EXPECT_EQ( 0x0000, toHalf( 0.f ) );
+    EXPECT_EQ( 0x8000, toHalf( -0.f ) );
+    EXPECT_EQ( 0x3C00, toHalf( 1.f ) );
+    EXPECT_EQ( 0xC000, toHalf( -2.f ) );
+    EXPECT_EQ( 0x2E66, toHalf( 0.1f ) );
+    EXPECT_EQ( 0x7BFF, toHalf( 65504.f ) );
+    EXPECT_EQ( 0x7BFF, toHalf( 65519.f ) );
+    EXPECT_EQ( 0x7C00, toHalf( 65520.f ) );
+    EXPECT_EQ( 0x7C00, toHalf( std::numeric_limits<float>::infinity() ) );
+    EXPECT_EQ( 0xFC00, toHalf( -std::numeric_limits<float>::infinity() ) );
+    EXPECT_GT( toHalf( std::numeric_limits<float>::quiet_NaN() ) & 0x3FF, 0 );
+
+    // Denormals, including ties that round to even.
+    EXPECT_EQ( 0x0001, toHalf( std::ldexp( 1.f, -24 ) ) );
+    EXPECT_EQ( 0x0000, toHalf( std::ldexp( 1.f, -25 ) ) );
+    EXPECT_EQ( 0x0002, toHalf( std::ldexp( 3.f, -25 ) ) );
+    EXPECT_EQ( 0x0001, toHalf( std::ldexp( 1.5f, -25 ) ) );
+    EXPECT_EQ( 0x0400, toHalf( std::ldexp( 1.f, -14 ) ) );
+
+    // Normal ties round to even.
+    EXPECT_EQ( 0x3C00, toHalf( fromBits( 0x3F801000 ) ) );
+    EXPECT_EQ( 0x3C02, toHalf( fromBits( 0x3F803000 ) ) );
+}
+
+TEST_F( TestFormatConversion, HalfRoundTrip )
+{
+    std::vector<uint16_t> halves;
+    for( uint32_t bits = 0; bits <= 0xFFFF; ++bits )
+    {
+        // Skip NaNs, whose payloads need not round trip.
+        if( ( bits & 0x7C00 ) != 0x7C00 || ( bits & 0x3FF ) == 0 )
+            halves.push_back( static_cast<uint16_t>( bits ) );
+    }
+    std::vector<float>    floats( halves.size() );
+    std::vector<uint16_t> result( halves.size() );
+    convertHalfToFloat( halves.data(), floats.data(), halves.size() );
+    convertFloatToHalf( floats.data(), result.data(), floats.size() );
+
+    EXPECT_EQ( 1.f, floats[0x3C00] );
+    EXPECT_EQ( std::ldexp( 1.f, -24 ), floats[1] );
+    EXPECT_EQ( halves, result );
+}
+
+TEST_F( TestFormatConversion, FloatToUnorm8 )
+{
+    // Enough values to exercise both the vector loop and the scalar remainder.
+    const float values[] = { 0.f, 1.f, 0.5f, -1.f, 2.f, 1.f / 255.f, 0.25f, 0.75f, 100.f, -0.f, 0.999f,
+                             0.001f, 0.2f, 0.4f, 0.6f, 0.8f, std::numeric_limits<float>::quiet_NaN(), 0.1f };
+    const uint8_t expected[] = { 0, 255, 128, 0, 255, 1, 64, 191, 255, 0, 255, 0, 51, 102, 153, 204, 0, 26 };
+    const size_t  count      = sizeof( values ) / sizeof( values[0] );
+
+    std::vector<uint8_t> result( count );
+    convertFloatToUnorm8( values, result.data(), count );
+    for( size_t i = 0; i < count; ++i )
+        EXPECT_EQ( expected[i], result[i] ) << "value " << i;
+}
+
+TEST_F( TestFormatConversion, ConvertFormat )
+{
+    const size_t       count = 1000;
+    std::vector<float> floats( count );
+    for( size_t i = 0; i < count; ++i )
+        floats[i] = static_cast<float>( i ) / ( count - 1 );
+
+    std::vector<uint16_t> halves( count );
+    convertFormat( reinterpret_cast<const char*>( floats.data() ), CU_AD_FORMAT_FLOAT,
+                   reinterpret_cast<char*>( halves.data() ), CU_AD_FORMAT_HALF, count );
+
+    std::vector<uint8_t> fromFloats( count );
+    std::vector<uint8_t> fromHalves( count );
+    convertFormat( reinterpret_cast<const char*>( floats.data() ), CU_AD_FORMAT_FLOAT,
+                   reinterpret_cast<char*>( fromFloats.data() ), CU_AD_FORMAT_UNSIGNED_INT8, count );
+    convertFormat( reinterpret_cast<const char*>( halves.data() ), CU_AD_FORMAT_HALF,
+                   reinterpret_cast<char*>( fromHalves.data() ), CU_AD_FORMAT_UNSIGNED_INT8, count );
+
+    for( size_t i = 0; i < count; ++i )
+        EXPECT_NEAR( fromFloats[i], fromHalves[i], 1 );
+    EXPECT_EQ( 0, fromHalves.front() );
+    EXPECT_EQ( 255, fromHalves.back() );
+
+    EXPECT_THROW( convertFormat( reinterpret_cast<const char*>( halves.data() ), CU_AD_FORMAT_HALF,
+                                 reinterpret_cast<char*>( floats.data() ), CU_AD_FORMAT_FLOAT, count ),
+                  std::exception );
+}
@@ -421,6 +421,49 @@ void runReadPartialTileNonSquare()
 
 INSTANTIATE_READER_TESTS( ReadPartialTileNonSquare )
 
+//------------------------------------------------------------------------------
+
+#if OTK_USE_OPENEXR
+
+TEST_F( TestCoreEXRReader, ReadTileHash )
+{
+    CoreEXRReader reader( getSourceDir() + "/Textures/TiledMipMappedFloat.exr" );
+    TextureInfo   info = {};
+    ASSERT_NO_THROW( reader.open( &info ) );
+
+    const unsigned int width  = reader.getTileWidth();
+    const unsigned int height = reader.getTileHeight();
+    uint64_t           fineHash;
+    ASSERT_TRUE( reader.readTileHash( fineHash, 0, { 0, 0, width, height } ) );
+
+    // The hash of the same tile is the same in another reader.
+    CoreEXRReader otherReader( getSourceDir() + "/Textures/TiledMipMappedFloat.exr" );
+    ASSERT_NO_THROW( otherReader.open( &info ) );
+    uint64_t otherHash;
+    ASSERT_TRUE( otherReader.readTileHash( otherHash, 0, { 0, 0, width, height } ) );
+    EXPECT_EQ( fineHash, otherHash );
+
+    // The coarser level has a different (blue/white) pattern.
+    uint64_t coarseHash;
+    ASSERT_TRUE( reader.readTileHash( coarseHash, 1, { 0, 0, width, height } ) );
+    EXPECT_NE( fineHash, coarseHash );
+
+    // Tiles that aren't made of whole EXR tiles are not hashed.
+    EXPECT_FALSE( reader.readTileHash( otherHash, 0, { 0, 0, width / 2, height / 2 } ) );
+}
+
+TEST_F( TestCoreEXRReader, ReadTileHashScanline )
+{
+    CoreEXRReader reader( getSourceDir() + "/Textures/ScanlineFineFloat.exr" );
+    TextureInfo   info = {};
+    ASSERT_NO_THROW( reader.open( &info ) );
+
+    uint64_t hash;
+    EXPECT_FALSE( reader.readTileHash( hash, 0, { 0, 0, 64, 64 } ) );
+}
+
+#endif  // OTK_USE_OPENEXR
+
 #if OTK_USE_OIIO
 
 template <typename T>